@@ -0,0 +1,283 @@
+#include "pch.h"
+#include "AnthemCache.h"
+#include "AudioDecoder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+
+// Paths from the library, the watcher and the CVars differ in separators and "." segments
+static std::string CacheKey(const std::string& path)
+{
+    return PathToUtf8(Utf8ToPath(path).lexically_normal());
+}
+
+void ConvertWavSamples(const WavInfo& wav, const unsigned char* p, size_t count, float* out)
+{
+    if (wav.formatTag == 3 && wav.bitsPerSample == 32) {
+        memcpy(out, p, count * sizeof(float));
+    }
+    else if (wav.formatTag == 3) {
+        for (size_t i = 0; i < count; i++) {
+            double value;
+            memcpy(&value, p + i * 8, sizeof(value));
+            out[i] = (float)value;
+        }
+    }
+    else if (wav.bitsPerSample == 8) {
+        for (size_t i = 0; i < count; i++) {
+            out[i] = ((int)p[i] - 128) * (1.0f / 128.0f);     // 8-bit PCM is unsigned
+        }
+    }
+    else if (wav.bitsPerSample == 16) {
+        for (size_t i = 0; i < count; i++) {
+            out[i] = (int16_t)(p[i * 2] | (p[i * 2 + 1] << 8)) * (1.0f / 32768.0f);
+        }
+    }
+    else if (wav.bitsPerSample == 24) {
+        for (size_t i = 0; i < count; i++) {
+            const unsigned char* s = p + i * 3;
+            int32_t value = (int32_t)(((uint32_t)s[0] << 8) | ((uint32_t)s[1] << 16) | ((uint32_t)s[2] << 24)) >> 8;
+            out[i] = value * (1.0f / 8388608.0f);
+        }
+    }
+    else {
+        for (size_t i = 0; i < count; i++) {
+            int32_t value;
+            memcpy(&value, p + i * 4, sizeof(value));
+            out[i] = (float)(value * (1.0 / 2147483648.0));
+        }
+    }
+}
+
+bool DecodeWavFile(const std::filesystem::path& path, DecodedAnthem& out)
+{
+    auto start = std::chrono::steady_clock::now();
+    WavInfo wav;
+    if (!ProbeWavHeader(path, wav)) {
+        return false;
+    }
+    std::error_code ec;
+    uint64_t fileSize = std::filesystem::file_size(path, ec);
+    int64_t writeTime = (int64_t)std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+
+    std::ifstream file(path, std::ios::binary);
+    std::vector<unsigned char> data(wav.dataBytes / wav.blockAlign * wav.blockAlign);
+    file.seekg(wav.dataOffset);
+    if (!file.read((char*)data.data(), (std::streamsize)data.size())) {
+        return false;
+    }
+
+    const size_t count = data.size() / (wav.bitsPerSample / 8);
+    std::vector<float> samples(count);
+    ConvertWavSamples(wav, data.data(), count, samples.data());
+
+    out.wav = wav;
+    out.sampleRate = wav.sampleRate;
+    out.channels = wav.channels;
+    out.samples = std::move(samples);
+    out.fileSize = fileSize;
+    out.writeTime = writeTime;
+    out.decodeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+void CompactAnthem(DecodedAnthem& anthem, ResidentFormat format)
+{
+    if (format == ResidentFormat::Float32 || anthem.samples.empty()) {
+        return;
+    }
+    anthem.compact.Encode(format, anthem.samples.data(), anthem.samples.size() / anthem.channels, anthem.channels);
+    std::vector<float>().swap(anthem.samples);
+}
+
+bool DecodeAnthemFile(const std::filesystem::path& path, DecodedAnthem& out)
+{
+    auto start = std::chrono::steady_clock::now();
+    std::unique_ptr<AudioDecoder> decoder = OpenAudioDecoder(path);
+    if (!decoder) {
+        return false;
+    }
+    const WavInfo& wav = decoder->GetInfo();
+    if (wav.formatTag != formatTagFlac && wav.formatTag != formatTagVorbis) {
+        return DecodeWavFile(path, out);     // One read of the whole data chunk
+    }
+    std::error_code ec;
+    uint64_t fileSize = std::filesystem::file_size(path, ec);
+    int64_t writeTime = (int64_t)std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+
+    const size_t frames = (size_t)decoder->GetFrameCount();
+    std::vector<float> samples(frames * wav.channels);
+    if (decoder->Read(samples.data(), frames) != frames) {
+        return false;
+    }
+
+    out.wav = wav;
+    out.sampleRate = wav.sampleRate;
+    out.channels = wav.channels;
+    out.samples = std::move(samples);
+    out.fileSize = fileSize;
+    out.writeTime = writeTime;
+    out.decodeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+AnthemCache::AnthemCache()
+{
+    worker = std::thread([this]() { Run(); });
+}
+
+AnthemCache::~AnthemCache()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    worker.join();
+}
+
+bool AnthemCache::IsQueued(const std::string& key) const
+{
+    return std::any_of(jobs.begin(), jobs.end(), [&](const Job& job) { return job.path == key; });
+}
+
+void AnthemCache::Request(const std::string& path)
+{
+    std::string key = CacheKey(path);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (entries.count(key) || IsQueued(key)) {
+            return;
+        }
+        jobs.push_back(Job{ key, false });
+    }
+    wake.notify_one();
+}
+
+int AnthemCache::Reload(const std::vector<std::string>& paths)
+{
+    int queued = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const std::string& path : paths) {
+            std::string key = CacheKey(path);
+            if (entries.count(key) && !IsQueued(key)) {
+                jobs.push_back(Job{ key, true });
+                queued++;
+            }
+        }
+    }
+    if (queued > 0) {
+        wake.notify_one();
+    }
+    return queued;
+}
+
+void AnthemCache::Evict(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.erase(CacheKey(path));
+}
+
+void AnthemCache::SetResidentFormat(ResidentFormat format)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    residentFormat = format;
+}
+
+std::shared_ptr<const DecodedAnthem> AnthemCache::Get(const std::string& path) const
+{
+    std::string key = CacheKey(path);
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = entries.find(key);
+    return found != entries.end() ? found->second : nullptr;
+}
+
+AnthemCacheStats AnthemCache::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    AnthemCacheStats result = stats;
+    result.entries = (int)entries.size();
+    result.bytes = 0;
+    result.format = residentFormat;
+    for (const auto& entry : entries) {
+        const DecodedAnthem& anthem = *entry.second;
+        result.bytes += anthem.samples.size() * sizeof(float) + anthem.compact.GetMemoryBytes() + anthem.peaks.GetMemoryBytes();
+    }
+    return result;
+}
+
+void AnthemCache::SetOnDecoded(std::function<void(const std::string& path, std::shared_ptr<const DecodedAnthem> anthem, bool reload)> callback)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    onDecoded = std::move(callback);
+}
+
+void AnthemCache::Run()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this]() { return stopping || !jobs.empty(); });
+        if (stopping) {
+            return;
+        }
+        Job job = std::move(jobs.front());
+        jobs.pop_front();
+        std::shared_ptr<const DecodedAnthem> current;
+        auto found = entries.find(job.path);
+        if (found != entries.end()) {
+            current = found->second;
+        }
+        if (job.reload ? !current : current != nullptr) {
+            continue;   // Evicted before its reload, or decoded by an earlier request
+        }
+        auto callback = onDecoded;
+        const ResidentFormat format = residentFormat;
+        lock.unlock();
+
+        // Decoding happens without the lock: Get() keeps returning the previous samples meanwhile
+        std::filesystem::path path = Utf8ToPath(job.path);
+        std::shared_ptr<DecodedAnthem> decoded;
+        bool unchanged = false;
+        if (current) {
+            std::error_code ec;
+            uint64_t fileSize = std::filesystem::file_size(path, ec);
+            int64_t writeTime = (int64_t)std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+            unchanged = !ec && fileSize == current->fileSize && writeTime == current->writeTime;
+        }
+        if (!unchanged) {
+            decoded = std::make_shared<DecodedAnthem>();
+            decoded->path = job.path;
+            if (DecodeAnthemFile(path, *decoded)) {
+                decoded->peaks.Build(decoded->samples.data(), decoded->GetFrameCount(), decoded->channels);
+                AnalyzeLoudness(decoded->samples.data(), decoded->GetFrameCount(), decoded->channels, decoded->sampleRate, decoded->loudness);
+                CompactAnthem(*decoded, format);
+            }
+            else {
+                decoded.reset();
+            }
+        }
+
+        lock.lock();
+        if (unchanged) {
+            continue;
+        }
+        if (!decoded) {
+            stats.failures++;
+        }
+        else if (!job.reload || entries.count(job.path)) {
+            decoded->version = current ? current->version + 1 : 1;
+            entries[job.path] = decoded;
+            stats.decodes++;
+            stats.reloads += job.reload ? 1 : 0;
+            stats.lastDecodeMs = decoded->decodeMs;
+        }
+        if (callback) {
+            lock.unlock();
+            callback(job.path, decoded, job.reload);
+            lock.lock();
+        }
+    }
+}
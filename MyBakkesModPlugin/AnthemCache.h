@@ -0,0 +1,101 @@
+#pragma once
+#include "AnthemLibrary.h"
+#include "WaveformPeaks.h"
+#include "LoudnessMeter.h"
+#include "CompactPcm.h"
+
+#include <condition_variable>
+#include <deque>
+#include <unordered_map>
+
+// An anthem file (WAV, FLAC or Ogg Vorbis) decoded to interleaved float samples in [-1, 1].
+// In a compact resident format the samples are moved to 'compact' once peaks and loudness are built, and 'samples' is empty.
+struct DecodedAnthem
+{
+    std::string path;               // UTF-8, as passed to AnthemCache::Request()
+    WavInfo wav;                    // Source format
+    uint32_t sampleRate = 0;
+    uint16_t channels = 0;
+    std::vector<float> samples;
+    CompactPcm compact;             // Used when 'samples' is empty
+    WaveformPeaks peaks;            // Built with the decode, for the waveform preview
+    LoudnessInfo loudness;          // Measured with the decode, its gain is applied as the voice gain
+    uint64_t fileSize = 0;
+    int64_t writeTime = 0;
+    double decodeMs = 0.0;
+    int version = 0;                // 1 for the first decode, +1 for every hot reload
+
+    size_t GetFrameCount() const { return !samples.empty() ? samples.size() / channels : compact.GetFrameCount(); }
+    double GetDurationSeconds() const { return sampleRate ? (double)GetFrameCount() / sampleRate : 0.0; }
+};
+
+// Converts 'count' samples of the WAV data format (PCM 8/16/24/32-bit or IEEE float 32/64-bit) to float
+void ConvertWavSamples(const WavInfo& wav, const unsigned char* data, size_t count, float* out);
+
+// Reads and converts a PCM (8/16/24/32-bit) or IEEE float (32/64-bit) WAV file
+bool DecodeWavFile(const std::filesystem::path& path, DecodedAnthem& out);
+
+// DecodeWavFile() for WAV files, the file's AudioDecoder for FLAC and Ogg Vorbis
+bool DecodeAnthemFile(const std::filesystem::path& path, DecodedAnthem& out);
+
+// Moves the float samples of 'anthem' to 'format' (nothing to do for Float32)
+void CompactAnthem(DecodedAnthem& anthem, ResidentFormat format);
+
+struct AnthemCacheStats
+{
+    int entries = 0;
+    int decodes = 0;
+    int reloads = 0;                // Decodes triggered by a change on disk
+    int failures = 0;
+    double lastDecodeMs = 0.0;
+    size_t bytes = 0;               // Decoded samples and waveform peaks held
+    ResidentFormat format = ResidentFormat::Float32;
+};
+
+// Decoded anthems by path. Decoding runs on a worker thread: Request() and Reload() only queue work, and Get() returns the
+// current decode (or null) without waiting. A reload replaces the entry once the new decode is complete, so a reader keeps
+// its shared_ptr to the previous samples for as long as it needs them.
+class AnthemCache
+{
+public:
+    AnthemCache();
+    ~AnthemCache();
+
+    AnthemCache(const AnthemCache&) = delete;
+    AnthemCache& operator=(const AnthemCache&) = delete;
+
+    // Decode 'path' if it is not cached or queued yet
+    void Request(const std::string& path);
+    // Queue a new decode of the cached paths among 'paths' and return how many were queued.
+    // The worker skips files whose size and write time did not change; a failed reload keeps the previous decode.
+    int Reload(const std::vector<std::string>& paths);
+    void Evict(const std::string& path);
+    // Format of the next decodes; cached anthems keep theirs until they are decoded again
+    void SetResidentFormat(ResidentFormat format);
+
+    std::shared_ptr<const DecodedAnthem> Get(const std::string& path) const;
+    AnthemCacheStats GetStats() const;
+
+    // Called on the worker thread after every decode, successful or not (null on failure)
+    void SetOnDecoded(std::function<void(const std::string& path, std::shared_ptr<const DecodedAnthem> anthem, bool reload)> callback);
+
+private:
+    struct Job
+    {
+        std::string path;
+        bool reload = false;
+    };
+
+    void Run();
+    bool IsQueued(const std::string& key) const;
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::unordered_map<std::string, std::shared_ptr<const DecodedAnthem>> entries;
+    std::deque<Job> jobs;
+    std::function<void(const std::string&, std::shared_ptr<const DecodedAnthem>, bool)> onDecoded;
+    AnthemCacheStats stats;
+    ResidentFormat residentFormat = ResidentFormat::Float32;
+    bool stopping = false;
+    std::thread worker;
+};
@@ -0,0 +1,626 @@
+#include "pch.h"
+#include "AnthemLibrary.h"
+#include "AudioDecoder.h"
+#include "WorkStealingPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+
+static double ElapsedMs(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static uint16_t ReadU16(const unsigned char* p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+static uint32_t ReadU32(const unsigned char* p) { return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24); }
+
+bool ProbeWavHeader(const std::filesystem::path& path, WavInfo& info)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    file.seekg(0, std::ios::end);
+    const uint64_t fileSize = (uint64_t)file.tellg();
+    file.seekg(0, std::ios::beg);
+
+    unsigned char riff[12];
+    if (!file.read((char*)riff, sizeof(riff)) || memcmp(riff, "RIFF", 4) != 0 || memcmp(riff + 8, "WAVE", 4) != 0) {
+        return false;
+    }
+
+    WavInfo result;
+    bool haveFormat = false;
+    uint64_t offset = 12;
+    // Bounded walk: real files have a handful of chunks (fmt, LIST, bext, ...) before data
+    for (int chunk = 0; chunk < 64 && offset + 8 <= fileSize; chunk++) {
+        unsigned char header[8];
+        file.seekg((std::streamoff)offset);
+        if (!file.read((char*)header, sizeof(header))) {
+            return false;
+        }
+        const uint32_t size = ReadU32(header + 4);
+        const uint64_t body = offset + 8;
+
+        if (memcmp(header, "fmt ", 4) == 0) {
+            unsigned char fmt[40] = {};
+            if (size < 16 || !file.read((char*)fmt, std::min<uint32_t>(size, sizeof(fmt)))) {
+                return false;
+            }
+            result.formatTag = ReadU16(fmt + 0);
+            result.channels = ReadU16(fmt + 2);
+            result.sampleRate = ReadU32(fmt + 4);
+            result.blockAlign = ReadU16(fmt + 12);
+            result.bitsPerSample = ReadU16(fmt + 14);
+            if (result.formatTag == 0xFFFE && size >= 40) {
+                result.formatTag = ReadU16(fmt + 24);   // First two bytes of the sub-format GUID
+            }
+            haveFormat = true;
+        }
+        else if (memcmp(header, "data", 4) == 0) {
+            if (!haveFormat) {
+                return false;
+            }
+            result.dataOffset = (uint32_t)body;
+            result.dataBytes = (uint32_t)std::min<uint64_t>(size, fileSize - body);
+            break;
+        }
+        offset = body + size + (size & 1);  // Chunks are word aligned
+    }
+    if (result.dataOffset == 0) {
+        return false;
+    }
+
+    const bool pcm = result.formatTag == 1 && (result.bitsPerSample == 8 || result.bitsPerSample == 16 || result.bitsPerSample == 24 || result.bitsPerSample == 32);
+    const bool ieee = result.formatTag == 3 && (result.bitsPerSample == 32 || result.bitsPerSample == 64);
+    if (!(pcm || ieee) || result.channels == 0 || result.channels > 8 || result.sampleRate < 8000 || result.sampleRate > 384000
+        || result.blockAlign != result.channels * result.bitsPerSample / 8) {
+        return false;
+    }
+    info = result;
+    return true;
+}
+
+AnthemLibrary::AnthemLibrary(std::filesystem::path indexPath)
+    : indexPath(std::move(indexPath)), entries(std::make_shared<const std::vector<LibraryEntry>>())
+{
+}
+
+AnthemLibrary::~AnthemLibrary()
+{
+    // A watcher batch may be running a full scan: cancel it before waiting for the watcher thread
+    cancel = true;
+    StopWatching();
+    CancelScan();
+}
+
+void AnthemLibrary::SetFolders(std::vector<std::filesystem::path> newFolders)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        folders = std::move(newFolders);
+    }
+    std::lock_guard<std::mutex> lock(watchMutex);
+    if (watching) {
+        RestartWatcher();
+    }
+}
+
+std::vector<std::filesystem::path> AnthemLibrary::GetFolders() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return folders;
+}
+
+std::shared_ptr<const std::vector<LibraryEntry>> AnthemLibrary::GetEntries() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries;
+}
+
+LibraryScanStats AnthemLibrary::GetLastStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return lastStats;
+}
+
+void AnthemLibrary::Publish(std::vector<LibraryEntry> newEntries)
+{
+    auto snapshot = std::make_shared<const std::vector<LibraryEntry>>(std::move(newEntries));
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        entries = std::move(snapshot);
+    }
+    generation++;
+}
+
+// Index file: header, then per entry the UTF-8 path, size, write time and WAV fields (little endian, no padding)
+static const char indexMagic[4] = { 'C', 'P', 'A', 'L' };
+static const uint32_t indexVersion = 1;
+
+template <typename T>
+static void Put(std::string& out, T value)
+{
+    out.append((const char*)&value, sizeof(T));
+}
+
+template <typename T>
+static bool Get(const char*& p, const char* end, T& value)
+{
+    if ((size_t)(end - p) < sizeof(T)) {
+        return false;
+    }
+    memcpy(&value, p, sizeof(T));
+    p += sizeof(T);
+    return true;
+}
+
+bool AnthemLibrary::SaveIndex(const std::vector<LibraryEntry>& list) const
+{
+    std::string out;
+    out.reserve(16 + list.size() * 96);
+    out.append(indexMagic, sizeof(indexMagic));
+    Put(out, indexVersion);
+    Put(out, (uint32_t)list.size());
+    for (const LibraryEntry& entry : list) {
+        Put(out, (uint16_t)entry.path.size());
+        out.append(entry.path);
+        Put(out, entry.fileSize);
+        Put(out, entry.writeTime);
+        Put(out, (uint8_t)entry.valid);
+        Put(out, entry.wav.formatTag);
+        Put(out, entry.wav.channels);
+        Put(out, entry.wav.sampleRate);
+        Put(out, entry.wav.bitsPerSample);
+        Put(out, entry.wav.blockAlign);
+        Put(out, entry.wav.dataOffset);
+        Put(out, entry.wav.dataBytes);
+    }
+    return WriteFileAtomic(indexPath, out);
+}
+
+bool AnthemLibrary::LoadIndex()
+{
+    std::ifstream file(indexPath, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    const char* p = data.data();
+    const char* end = p + data.size();
+
+    uint32_t version = 0, count = 0;
+    if (data.size() < sizeof(indexMagic) || memcmp(p, indexMagic, sizeof(indexMagic)) != 0) {
+        return false;
+    }
+    p += sizeof(indexMagic);
+    if (!Get(p, end, version) || version != indexVersion || !Get(p, end, count)) {
+        return false;
+    }
+
+    std::vector<LibraryEntry> list;
+    list.reserve(std::min<size_t>(count, data.size() / 39));   // Each entry takes at least 39 bytes, a corrupt count cannot over-allocate
+    for (uint32_t i = 0; i < count; i++) {
+        LibraryEntry entry;
+        uint16_t pathSize = 0;
+        uint8_t valid = 0;
+        if (!Get(p, end, pathSize) || (size_t)(end - p) < pathSize) {
+            return false;
+        }
+        entry.path.assign(p, pathSize);
+        p += pathSize;
+        if (!Get(p, end, entry.fileSize) || !Get(p, end, entry.writeTime) || !Get(p, end, valid)
+            || !Get(p, end, entry.wav.formatTag) || !Get(p, end, entry.wav.channels) || !Get(p, end, entry.wav.sampleRate)
+            || !Get(p, end, entry.wav.bitsPerSample) || !Get(p, end, entry.wav.blockAlign)
+            || !Get(p, end, entry.wav.dataOffset) || !Get(p, end, entry.wav.dataBytes)) {
+            return false;
+        }
+        entry.valid = valid != 0;
+        entry.name = PathToUtf8(Utf8ToPath(entry.path).filename());
+        list.push_back(std::move(entry));
+    }
+    Publish(std::move(list));
+    return true;
+}
+
+LibraryScanStats AnthemLibrary::Scan(int threads)
+{
+    std::lock_guard<std::mutex> update(updateMutex);
+    auto start = std::chrono::steady_clock::now();
+    LibraryScanStats stats;
+
+    std::shared_ptr<const std::vector<LibraryEntry>> previous = GetEntries();
+    std::unordered_map<std::string_view, const LibraryEntry*> previousByPath;
+    previousByPath.reserve(previous->size());
+    for (const LibraryEntry& entry : *previous) {
+        previousByPath.emplace(entry.path, &entry);
+    }
+
+    std::mutex resultsMutex;
+    std::vector<LibraryEntry> results;
+    results.reserve(previous->size());
+    std::atomic<int> directories{ 0 }, probed{ 0 }, reused{ 0 }, invalid{ 0 }, known{ 0 };
+
+    {
+        WorkStealingPool pool(threads);
+        stats.threads = pool.GetThreadCount();
+
+        // One task per directory: list it, queue its subdirectories, probe its new or changed anthem files
+        std::function<void(std::filesystem::path)> visit = [&](std::filesystem::path directory) {
+            if (cancel) {
+                return;
+            }
+            directories++;
+            std::vector<LibraryEntry> local;
+            std::error_code ec;
+            for (std::filesystem::directory_iterator it(directory, std::filesystem::directory_options::skip_permission_denied, ec), end;
+                !ec && it != end; it.increment(ec)) {
+                const std::filesystem::directory_entry& item = *it;
+                std::error_code itemEc;
+                if (item.is_directory(itemEc) && !item.is_symlink(itemEc)) {
+                    pool.Submit([&visit, path = item.path()]() { visit(path); });
+                    continue;
+                }
+                if (!IsAnthemFile(item.path())) {
+                    continue;
+                }
+
+                LibraryEntry entry;
+                entry.path = PathToUtf8(item.path());
+                entry.fileSize = item.file_size(itemEc);
+                entry.writeTime = (int64_t)item.last_write_time(itemEc).time_since_epoch().count();
+                auto found = previousByPath.find(entry.path);
+                if (found != previousByPath.end()) {
+                    known++;
+                    if (found->second->fileSize == entry.fileSize && found->second->writeTime == entry.writeTime) {
+                        local.push_back(*found->second);
+                        reused++;
+                        continue;
+                    }
+                }
+                entry.name = PathToUtf8(item.path().filename());
+                entry.valid = ProbeAudioHeader(item.path(), entry.wav);
+                probed++;
+                if (!entry.valid) {
+                    invalid++;
+                }
+                local.push_back(std::move(entry));
+            }
+            std::lock_guard<std::mutex> lock(resultsMutex);
+            results.insert(results.end(), std::make_move_iterator(local.begin()), std::make_move_iterator(local.end()));
+        };
+
+        for (const std::filesystem::path& folder : GetFolders()) {
+            pool.Submit([&visit, folder]() { visit(folder); });
+        }
+        pool.Wait();
+        stats.steals = pool.GetStealCount();
+    }
+
+    // Sorted by path; overlapping folders would list the same file twice
+    std::sort(results.begin(), results.end(), [](const LibraryEntry& a, const LibraryEntry& b) { return a.path < b.path; });
+    results.erase(std::unique(results.begin(), results.end(), [](const LibraryEntry& a, const LibraryEntry& b) { return a.path == b.path; }), results.end());
+
+    stats.directories = directories;
+    stats.files = (int)results.size();
+    stats.probed = probed;
+    stats.reused = reused;
+    stats.invalid = invalid;
+    stats.removed = std::max(0, (int)previous->size() - known);
+    stats.cancelled = cancel;
+    stats.scanMs = ElapsedMs(start);
+
+    // A cancelled scan saw only part of the tree: keep the previous snapshot and index
+    if (!stats.cancelled) {
+        if (stats.probed > 0 || stats.removed > 0) {
+            auto saveStart = std::chrono::steady_clock::now();
+            stats.indexSaved = SaveIndex(results);
+            stats.saveIndexMs = ElapsedMs(saveStart);
+        }
+        Publish(std::move(results));
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        lastStats = stats;
+    }
+    return stats;
+}
+
+void AnthemLibrary::JoinScanThread()
+{
+    if (scanThread.joinable()) {
+        scanThread.join();
+    }
+}
+
+void AnthemLibrary::StartScan(int threads, std::function<void(const LibraryScanStats&)> onFinished)
+{
+    if (scanning.exchange(true)) {
+        return;
+    }
+    JoinScanThread();
+    cancel = false;
+    scanThread = std::thread([this, threads, onFinished]() {
+        LibraryScanStats stats = Scan(threads);
+        if (onFinished) {
+            onFinished(stats);
+        }
+        scanning = false;
+    });
+}
+
+void AnthemLibrary::CancelScan()
+{
+    cancel = true;
+    JoinScanThread();
+}
+
+static LibraryEntry MakeEntry(const std::filesystem::path& path, uint64_t fileSize, int64_t writeTime)
+{
+    LibraryEntry entry;
+    entry.path = PathToUtf8(path);
+    entry.name = PathToUtf8(path.filename());
+    entry.fileSize = fileSize;
+    entry.writeTime = writeTime;
+    entry.valid = ProbeAudioHeader(path, entry.wav);
+    return entry;
+}
+
+std::vector<std::string> AnthemLibrary::ApplyChanges(const std::vector<FileChange>& changes, int threads)
+{
+    auto start = std::chrono::steady_clock::now();
+    auto byPath = [](const LibraryEntry& a, const LibraryEntry& b) { return a.path < b.path; };
+    std::vector<std::string> changed;
+    std::shared_ptr<const std::vector<LibraryEntry>> previous = GetEntries();
+
+    if (std::any_of(changes.begin(), changes.end(), [](const FileChange& change) { return change.kind == FileChange::Kind::Overflow; })) {
+        // Events were lost: scan everything, then diff the two sorted snapshots to find what changed
+        Scan(threads);
+        std::shared_ptr<const std::vector<LibraryEntry>> current = GetEntries();
+        auto a = previous->begin(), b = current->begin();
+        while (a != previous->end() || b != current->end()) {
+            if (b == current->end() || (a != previous->end() && a->path < b->path)) {
+                changed.push_back((a++)->path);
+            }
+            else if (a == previous->end() || b->path < a->path) {
+                changed.push_back((b++)->path);
+            }
+            else {
+                if (a->fileSize != b->fileSize || a->writeTime != b->writeTime) {
+                    changed.push_back(b->path);
+                }
+                ++a;
+                ++b;
+            }
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        watchStats.batches++;
+        watchStats.changes += changes.size();
+        watchStats.fullRescans++;
+        watchStats.lastApplyMs = ElapsedMs(start);
+        return changed;
+    }
+
+    std::lock_guard<std::mutex> update(updateMutex);
+    previous = GetEntries();
+    const std::vector<LibraryEntry>& list = *previous;
+    auto find = [&](const std::string& path) {
+        auto it = std::lower_bound(list.begin(), list.end(), path, [](const LibraryEntry& entry, const std::string& p) { return entry.path < p; });
+        return it != list.end() && it->path == path ? it : list.end();
+    };
+
+    // Entries of the previous snapshot to drop, and new or re-probed entries to merge in
+    std::vector<bool> drop(list.size(), false);
+    std::vector<LibraryEntry> probed;
+    uint64_t removed = 0;
+    auto upsert = [&](const std::filesystem::path& path, uint64_t fileSize, int64_t writeTime) {
+        std::string key = PathToUtf8(path);
+        auto found = find(key);
+        if (found != list.end()) {
+            if (found->fileSize == fileSize && found->writeTime == writeTime) {
+                return;     // Metadata-only change, or already up to date
+            }
+            drop[found - list.begin()] = true;
+        }
+        probed.push_back(MakeEntry(path, fileSize, writeTime));
+        changed.push_back(std::move(key));
+    };
+
+    for (const FileChange& change : changes) {
+        std::error_code ec;
+        std::filesystem::file_status status = std::filesystem::symlink_status(change.path, ec);
+        if (std::filesystem::is_regular_file(status)) {
+            if (IsAnthemFile(change.path)) {
+                uint64_t fileSize = std::filesystem::file_size(change.path, ec);
+                int64_t writeTime = (int64_t)std::filesystem::last_write_time(change.path, ec).time_since_epoch().count();
+                upsert(change.path, fileSize, writeTime);
+            }
+        }
+        else if (std::filesystem::is_directory(status)) {
+            // A folder moved or copied in; changes inside a known folder are reported per file
+            if (change.kind != FileChange::Kind::Added) {
+                continue;
+            }
+            for (std::filesystem::recursive_directory_iterator it(change.path, std::filesystem::directory_options::skip_permission_denied, ec), end;
+                !ec && it != end; it.increment(ec)) {
+                std::error_code itemEc;
+                if (it->is_regular_file(itemEc) && IsAnthemFile(it->path())) {
+                    upsert(it->path(), it->file_size(itemEc), (int64_t)it->last_write_time(itemEc).time_since_epoch().count());
+                }
+            }
+        }
+        else if (!std::filesystem::exists(status)) {
+            // Gone: the file itself, or everything below it if it was a folder
+            std::string key = PathToUtf8(change.path);
+            std::string prefix = key + (char)std::filesystem::path::preferred_separator;
+            auto found = find(key);
+            if (found != list.end() && !drop[found - list.begin()]) {
+                drop[found - list.begin()] = true;
+                changed.push_back(key);
+                removed++;
+            }
+            auto it = std::lower_bound(list.begin(), list.end(), prefix, [](const LibraryEntry& entry, const std::string& p) { return entry.path < p; });
+            for (; it != list.end() && it->path.compare(0, prefix.size(), prefix) == 0; ++it) {
+                if (!drop[it - list.begin()]) {
+                    drop[it - list.begin()] = true;
+                    changed.push_back(it->path);
+                    removed++;
+                }
+            }
+        }
+    }
+
+    std::sort(changed.begin(), changed.end());
+    changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+    if (!changed.empty()) {
+        // Copy-on-write: readers keep the previous snapshot until they pick up the new generation
+        std::sort(probed.begin(), probed.end(), byPath);
+        probed.erase(std::unique(probed.begin(), probed.end(), [](const LibraryEntry& a, const LibraryEntry& b) { return a.path == b.path; }), probed.end());
+        std::vector<LibraryEntry> kept;
+        kept.reserve(list.size());
+        for (size_t i = 0; i < list.size(); i++) {
+            if (!drop[i]) {
+                kept.push_back(list[i]);
+            }
+        }
+        std::vector<LibraryEntry> results;
+        results.reserve(kept.size() + probed.size());
+        std::merge(std::make_move_iterator(kept.begin()), std::make_move_iterator(kept.end()),
+            std::make_move_iterator(probed.begin()), std::make_move_iterator(probed.end()), std::back_inserter(results), byPath);
+        SaveIndex(results);
+        Publish(std::move(results));
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    watchStats.batches++;
+    watchStats.changes += changes.size();
+    watchStats.probed += probed.size();
+    watchStats.removed += removed;
+    watchStats.lastApplyMs = ElapsedMs(start);
+    return changed;
+}
+
+void AnthemLibrary::RestartWatcher()
+{
+    // The previous watcher thread may be applying a batch: it only takes updateMutex and mutex, never watchMutex
+    watcher.reset();
+    watcher = FileWatcher::Create(GetFolders(), [this, threads = watchThreads, onChanged = onWatchChanged](const std::vector<FileChange>& changes) {
+        std::vector<std::string> changed = ApplyChanges(changes, threads);
+        if (!changed.empty() && onChanged) {
+            onChanged(changed);
+        }
+    });
+}
+
+void AnthemLibrary::StartWatching(int threads, std::function<void(const std::vector<std::string>& changedPaths)> onChanged)
+{
+    std::lock_guard<std::mutex> lock(watchMutex);
+    watching = true;
+    watchThreads = threads;
+    onWatchChanged = std::move(onChanged);
+    RestartWatcher();
+}
+
+void AnthemLibrary::StopWatching()
+{
+    std::lock_guard<std::mutex> lock(watchMutex);
+    watching = false;
+    watcher.reset();
+}
+
+bool AnthemLibrary::IsWatching() const
+{
+    std::lock_guard<std::mutex> lock(watchMutex);
+    return watcher != nullptr;
+}
+
+LibraryWatchStats AnthemLibrary::GetWatchStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return watchStats;
+}
+
+FileWatcherStats AnthemLibrary::GetWatcherStats() const
+{
+    std::lock_guard<std::mutex> lock(watchMutex);
+    return watcher ? watcher->GetStats() : FileWatcherStats();
+}
+
+// Smallest valid file: RIFF header, 16 byte fmt chunk and a short data chunk of silence
+static bool WriteSyntheticWav(const std::filesystem::path& path, uint32_t sampleRate, uint16_t channels, uint32_t dataBytes)
+{
+    std::string out;
+    const uint16_t bits = 16;
+    const uint16_t blockAlign = channels * bits / 8;
+    out.append("RIFF");
+    Put(out, (uint32_t)(36 + dataBytes));
+    out.append("WAVEfmt ");
+    Put(out, (uint32_t)16);
+    Put(out, (uint16_t)1);
+    Put(out, channels);
+    Put(out, sampleRate);
+    Put(out, (uint32_t)(sampleRate * blockAlign));
+    Put(out, blockAlign);
+    Put(out, bits);
+    out.append("data");
+    Put(out, dataBytes);
+    out.append(dataBytes, '\0');
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    return (bool)file.write(out.data(), (std::streamsize)out.size());
+}
+
+LibraryBenchmarkResult RunLibraryBenchmark(const std::filesystem::path& root, int files, int threads)
+{
+    LibraryBenchmarkResult result;
+    const int filesPerDirectory = 100;
+    const int directoriesPerGroup = 50;
+    auto filePath = [&](int i) {
+        int directory = i / filesPerDirectory;
+        return root / ("group" + std::to_string(directory / directoriesPerGroup)) / ("artist" + std::to_string(directory))
+            / ("anthem" + std::to_string(i) + ".wav");
+    };
+
+    // Tree: root/groupN/artistM/anthemK.wav, reused across runs when it already has the requested size
+    std::error_code ec;
+    if (!std::filesystem::exists(filePath(files - 1), ec) || std::filesystem::exists(filePath(files), ec)) {
+        auto createStart = std::chrono::steady_clock::now();
+        std::filesystem::remove_all(root, ec);
+        for (int i = 0; i < files; i++) {
+            if (i % filesPerDirectory == 0) {
+                std::filesystem::create_directories(filePath(i).parent_path(), ec);
+            }
+            WriteSyntheticWav(filePath(i), i % 3 == 0 ? 48000 : 44100, (uint16_t)(1 + i % 2), 64);
+        }
+        result.created = true;
+        result.createMs = ElapsedMs(createStart);
+    }
+
+    std::filesystem::path indexPath = root.parent_path() / "library_bench.index";
+    std::filesystem::remove(indexPath, ec);
+    {
+        AnthemLibrary library(indexPath);
+        library.SetFolders({ root });
+        result.cold = library.Scan(threads);
+    }
+    {
+        AnthemLibrary library(indexPath);
+        library.SetFolders({ root });
+        library.LoadIndex();
+        result.unchanged = library.Scan(threads);
+    }
+    {
+        // Alternate the data size so a touched file always differs from the index, even with coarse write times
+        for (int i = 0; i < files; i += 100) {
+            uint64_t size = std::filesystem::file_size(filePath(i), ec);
+            WriteSyntheticWav(filePath(i), 44100, 2, size == 44 + 64 ? 128 : 64);
+        }
+        AnthemLibrary library(indexPath);
+        library.SetFolders({ root });
+        library.LoadIndex();
+        result.touched = library.Scan(threads);
+    }
+    return result;
+}
@@ -0,0 +1,148 @@
+#pragma once
+#include "FileWatcher.h"
+#include "FileUtil.h"
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Format of an anthem file, read from its headers only (the sample data is never touched): the RIFF chunks of a WAV file, or the
+// stream headers of a FLAC or Ogg Vorbis file (see AudioDecoder.h)
+struct WavInfo
+{
+    uint16_t formatTag = 0;         // 1: PCM, 3: IEEE float (WAVE_FORMAT_EXTENSIBLE is resolved to its sub-format), formatTagFlac, formatTagVorbis
+    uint16_t channels = 0;
+    uint32_t sampleRate = 0;
+    uint16_t bitsPerSample = 0;
+    uint16_t blockAlign = 0;
+    uint32_t dataOffset = 0;        // Start of the sample data in the file
+    uint32_t dataBytes = 0;         // Clamped to the file size
+
+    double GetDurationSeconds() const { return blockAlign && sampleRate ? (double)(dataBytes / blockAlign) / sampleRate : 0.0; }
+};
+
+// Walks the chunks up to "data". Fails for non-RIFF/WAVE files and for formats other than PCM and IEEE float.
+bool ProbeWavHeader(const std::filesystem::path& path, WavInfo& info);
+
+struct LibraryEntry
+{
+    std::string path;               // UTF-8
+    std::string name;               // File name, UTF-8
+    uint64_t fileSize = 0;
+    int64_t writeTime = 0;          // file_time_type ticks, only compared for change detection
+    bool valid = false;             // Header probed successfully
+    WavInfo wav;
+};
+
+struct LibraryScanStats
+{
+    int directories = 0;
+    int files = 0;                  // .wav, .flac and .ogg files found
+    int probed = 0;                 // New or changed files whose header was read
+    int reused = 0;                 // Unchanged since the index (same size and write time), not opened
+    int invalid = 0;                // Probed but not a usable anthem file
+    int removed = 0;                // In the index but no longer on disk
+    int threads = 0;
+    uint64_t steals = 0;            // Directory tasks taken from another worker's queue
+    double scanMs = 0.0;
+    double saveIndexMs = 0.0;
+    bool indexSaved = false;
+    bool cancelled = false;
+};
+
+// Totals of the incremental updates applied from file watcher batches
+struct LibraryWatchStats
+{
+    uint64_t batches = 0;
+    uint64_t changes = 0;           // Paths reported by the watcher
+    uint64_t probed = 0;            // Headers read again
+    uint64_t removed = 0;
+    uint64_t fullRescans = 0;       // The watcher dropped events, the folders were scanned again
+    double lastApplyMs = 0.0;
+};
+
+// Anthem files found under a set of folders, with their WAV headers.
+// Scans run on a background thread and walk the folders with a WorkStealingPool, one task per directory.
+// The result is kept in a compact index file: entries whose size and write time did not change are reused without opening the file,
+// so a rescan of an unchanged library costs one directory listing per folder.
+// While watching, file system changes are applied as they happen: only the touched entries are probed again.
+// Readers get immutable snapshots (GetEntries()); GetGeneration() changes whenever a new snapshot is published.
+class AnthemLibrary
+{
+public:
+    explicit AnthemLibrary(std::filesystem::path indexPath);
+    ~AnthemLibrary();
+
+    void SetFolders(std::vector<std::filesystem::path> folders);
+    std::vector<std::filesystem::path> GetFolders() const;
+
+    // Publishes the entries of the index file, so the library is usable before the first scan completes
+    bool LoadIndex();
+    bool SaveIndex(const std::vector<LibraryEntry>& entries) const;
+
+    // Background scan, ignored while one is running. 'onFinished' is called on the scan thread.
+    void StartScan(int threads, std::function<void(const LibraryScanStats&)> onFinished = nullptr);
+    bool IsScanning() const { return scanning.load(); }
+    void CancelScan();
+
+    // Synchronous scan on the calling thread (plus 'threads' workers)
+    LibraryScanStats Scan(int threads);
+
+    // Updates the entries for the touched paths only: a new folder is walked, a removed one drops every entry below it.
+    // An Overflow change falls back to a full scan. Returns the UTF-8 paths of the files that changed or disappeared.
+    std::vector<std::string> ApplyChanges(const std::vector<FileChange>& changes, int threads);
+
+    // Applies the changes reported by a FileWatcher on the folders, restarted by SetFolders().
+    // 'onChanged' gets the result of every ApplyChanges() that found something, on the watcher thread.
+    void StartWatching(int threads, std::function<void(const std::vector<std::string>& changedPaths)> onChanged = nullptr);
+    void StopWatching();
+    bool IsWatching() const;
+    LibraryWatchStats GetWatchStats() const;
+    FileWatcherStats GetWatcherStats() const;
+
+    std::shared_ptr<const std::vector<LibraryEntry>> GetEntries() const;
+    uint64_t GetGeneration() const { return generation.load(); }
+    LibraryScanStats GetLastStats() const;
+
+private:
+    void Publish(std::vector<LibraryEntry> entries);
+    void JoinScanThread();
+    void RestartWatcher();
+
+    std::filesystem::path indexPath;
+    mutable std::mutex mutex;       // folders, entries, lastStats
+    std::vector<std::filesystem::path> folders;
+    std::shared_ptr<const std::vector<LibraryEntry>> entries;
+    LibraryScanStats lastStats;
+    LibraryWatchStats watchStats;
+    std::atomic<uint64_t> generation{ 0 };
+    std::mutex updateMutex;         // Serializes Scan() and ApplyChanges(), which both build on the current snapshot
+
+    mutable std::mutex watchMutex;  // watcher and its settings
+    std::unique_ptr<FileWatcher> watcher;
+    bool watching = false;
+    int watchThreads = 1;
+    std::function<void(const std::vector<std::string>&)> onWatchChanged;
+
+    std::thread scanThread;
+    std::atomic<bool> scanning{ false };
+    std::atomic<bool> cancel{ false };
+};
+
+// Cold vs incremental scans over a synthetic tree of 'files' small WAV files under 'root' (created on first use)
+struct LibraryBenchmarkResult
+{
+    bool created = false;           // The tree was generated by this run
+    double createMs = 0.0;
+    LibraryScanStats cold;          // No index: every header is read
+    LibraryScanStats unchanged;     // Index loaded, nothing changed on disk
+    LibraryScanStats touched;       // Index loaded, 1% of the files rewritten
+};
+
+LibraryBenchmarkResult RunLibraryBenchmark(const std::filesystem::path& root, int files, int threads);
@@ -0,0 +1,269 @@
+#include "pch.h"
+#include "AnthemPlaylist.h"
+#include "FileUtil.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+void AliasTable::Build(const std::vector<float>& weights)
+{
+    const int n = (int)weights.size();
+    probability.assign(n, 1.0);
+    alias.resize(n);
+    double total = 0.0;
+    for (float weight : weights) {
+        total += std::max(weight, 0.0f);
+    }
+    if (n == 0 || total <= 0.0) {
+        for (int i = 0; i < n; i++) {
+            alias[i] = i;
+        }
+        return;
+    }
+
+    // Scaled so the average column holds 1: columns under 1 are topped up from one column over 1
+    std::vector<double> scaled(n);
+    std::vector<int> small;
+    std::vector<int> large;
+    for (int i = 0; i < n; i++) {
+        scaled[i] = std::max(weights[i], 0.0f) * n / total;
+        (scaled[i] < 1.0 ? small : large).push_back(i);
+    }
+    while (!small.empty() && !large.empty()) {
+        const int less = small.back();
+        small.pop_back();
+        const int more = large.back();
+        probability[less] = scaled[less];
+        alias[less] = more;
+        scaled[more] -= 1.0 - scaled[less];
+        if (scaled[more] < 1.0) {
+            large.pop_back();
+            small.push_back(more);
+        }
+    }
+    // Whatever is left is 1 up to rounding
+    for (int i : large) {
+        probability[i] = 1.0;
+        alias[i] = i;
+    }
+    for (int i : small) {
+        probability[i] = 1.0;
+        alias[i] = i;
+    }
+}
+
+int AliasTable::Sample(double u) const
+{
+    const double column = u * probability.size();
+    const int index = std::min((int)column, (int)probability.size() - 1);
+    return column - index < probability[index] ? index : alias[index];
+}
+
+AnthemPlaylist::AnthemPlaylist(std::filesystem::path path)
+    : filePath(std::move(path)), rng(std::random_device()())
+{
+}
+
+int AnthemPlaylist::Find(const std::string& path) const
+{
+    for (size_t i = 0; i < entries.size(); i++) {
+        if (entries[i].path == path) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+bool AnthemPlaylist::Add(PlaylistEntry entry)
+{
+    if (Contains(entry.path)) {
+        return false;
+    }
+    entries.push_back(std::move(entry));
+    Rebuild();
+    return true;
+}
+
+void AnthemPlaylist::Remove(int index)
+{
+    if (index < 0 || index >= (int)entries.size()) {
+        return;
+    }
+    entries.erase(entries.begin() + index);
+    if (roundRobin >= index) {
+        roundRobin--;   // The next entry in order is still the one after the last played
+    }
+    Rebuild();
+}
+
+void AnthemPlaylist::Clear()
+{
+    entries.clear();
+    roundRobin = -1;
+    Rebuild();
+}
+
+void AnthemPlaylist::SetWeight(int index, float weight)
+{
+    if (index >= 0 && index < (int)entries.size()) {
+        entries[index].weight = std::max(weight, 0.0f);
+        Rebuild();
+    }
+}
+
+void AnthemPlaylist::SetTrim(int index, float start, float end)
+{
+    if (index >= 0 && index < (int)entries.size()) {
+        entries[index].trimStart = start;
+        entries[index].trimEnd = end;
+    }
+}
+
+void AnthemPlaylist::SetProbe(int index, const WavInfo& wav, bool streamed)
+{
+    if (index >= 0 && index < (int)entries.size()) {
+        entries[index].wav = wav;
+        entries[index].streamed = streamed;
+    }
+}
+
+void AnthemPlaylist::SetMode(PlaylistMode value)
+{
+    mode = value;
+    ForgetRecent();
+}
+
+void AnthemPlaylist::SetNoRepeatCount(int count)
+{
+    noRepeatCount = std::max(count, 0);
+    ForgetRecent();
+}
+
+void AnthemPlaylist::Rebuild()
+{
+    std::vector<float> weights;
+    weights.reserve(entries.size());
+    for (const PlaylistEntry& entry : entries) {
+        weights.push_back(entry.weight);
+    }
+    table.Build(weights);
+    ForgetRecent();
+}
+
+void AnthemPlaylist::ForgetRecent()
+{
+    // Indices change with every edit, the history starts over
+    recent.clear();
+    recentFlags.assign(entries.size(), 0);
+}
+
+int AnthemPlaylist::PickNotRecent()
+{
+    for (int attempt = 0; attempt < 16; attempt++) {
+        const int index = table.Sample(uniform(rng));
+        if (!recentFlags[index]) {
+            return index;
+        }
+    }
+    // The recent entries hold nearly all the weight: pick among the others directly (uniformly if they all weigh 0)
+    double total = 0.0;
+    int others = 0;
+    for (size_t i = 0; i < entries.size(); i++) {
+        if (!recentFlags[i]) {
+            total += entries[i].weight;
+            others++;
+        }
+    }
+    double target = total > 0.0 ? uniform(rng) * total : std::floor(uniform(rng) * others);
+    int last = -1;
+    for (size_t i = 0; i < entries.size(); i++) {
+        if (recentFlags[i]) {
+            continue;
+        }
+        last = (int)i;
+        target -= total > 0.0 ? entries[i].weight : 1.0;
+        if (target < 0.0) {
+            break;
+        }
+    }
+    return last;
+}
+
+int AnthemPlaylist::Next()
+{
+    const int count = (int)entries.size();
+    if (count == 0) {
+        return -1;
+    }
+    if (mode == PlaylistMode::RoundRobin) {
+        roundRobin = (roundRobin + 1) % count;
+        return roundRobin;
+    }
+    if (mode == PlaylistMode::Weighted) {
+        return table.Sample(uniform(rng));
+    }
+
+    const int index = PickNotRecent();
+    recent.push_back(index);
+    recentFlags[index] = 1;
+    while ((int)recent.size() > std::min(noRepeatCount, count - 1)) {
+        recentFlags[recent.front()] = 0;
+        recent.pop_front();
+    }
+    return index;
+}
+
+bool AnthemPlaylist::Load()
+{
+    std::ifstream file(filePath, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    entries.clear();
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        // weight \t trim start \t trim end \t path
+        size_t tabs[3];
+        size_t from = 0;
+        bool valid = true;
+        for (size_t& tab : tabs) {
+            tab = line.find('\t', from);
+            if (tab == std::string::npos) {
+                valid = false;
+                break;
+            }
+            from = tab + 1;
+        }
+        if (!valid || from == line.size()) {
+            continue;
+        }
+        PlaylistEntry entry;
+        entry.weight = std::max(std::strtof(line.c_str(), nullptr), 0.0f);
+        entry.trimStart = std::strtof(line.c_str() + tabs[0] + 1, nullptr);
+        entry.trimEnd = std::strtof(line.c_str() + tabs[1] + 1, nullptr);
+        entry.path = line.substr(from);
+        if (!Contains(entry.path)) {
+            entries.push_back(std::move(entry));
+        }
+    }
+    roundRobin = -1;
+    Rebuild();
+    return true;
+}
+
+bool AnthemPlaylist::Save() const
+{
+    std::string out;
+    char numbers[96];
+    for (const PlaylistEntry& entry : entries) {
+        snprintf(numbers, sizeof(numbers), "%g\t%g\t%g\t", entry.weight, entry.trimStart, entry.trimEnd);
+        out += numbers;
+        out += entry.path;
+        out += '\n';
+    }
+    return WriteFileAtomic(filePath, out);
+}
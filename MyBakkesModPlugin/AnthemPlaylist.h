@@ -0,0 +1,92 @@
+#pragma once
+#include "AnthemLibrary.h"
+
+#include <deque>
+#include <random>
+
+enum class PlaylistMode
+{
+    Weighted,       // Random, in proportion to the weights
+    RoundRobin,     // In list order, weights ignored
+    NoRepeat        // Weighted, but never one of the last N picks
+};
+
+struct PlaylistEntry
+{
+    std::string path;               // UTF-8
+    float weight = 1.0f;
+    float trimStart = 0.0f;         // Seconds; trimEnd <= trimStart plays the whole file
+    float trimEnd = 0.0f;
+
+    // Probed when the entry is added or loaded, not saved
+    WavInfo wav;
+    bool streamed = false;          // Longer than helloworld_stream_seconds: read from disk when it plays, not decoded up front
+};
+
+// Vose's alias method: O(n) to build, O(1) per weighted pick (one random number, one table lookup)
+class AliasTable
+{
+public:
+    // Negative weights count as 0; if every weight is 0 the picks are uniform
+    void Build(const std::vector<float>& weights);
+    // 'u' uniform in [0, 1)
+    int Sample(double u) const;
+    int GetSize() const { return (int)probability.size(); }
+
+private:
+    std::vector<double> probability;    // Of keeping the column's own index
+    std::vector<int> alias;
+};
+
+// Anthems played on goals, one picked per goal. Edits rebuild the alias table, so a weighted or round-robin Next() is O(1) whatever
+// the playlist size (NoRepeat: see Next()).
+// Entries are saved as text lines (weight, trim start, trim end, path) and written next to the file then renamed over it.
+class AnthemPlaylist
+{
+public:
+    explicit AnthemPlaylist(std::filesystem::path filePath);
+
+    const std::vector<PlaylistEntry>& GetEntries() const { return entries; }
+    int Find(const std::string& path) const;
+    bool Contains(const std::string& path) const { return Find(path) >= 0; }
+
+    // Returns false if 'path' is already in the playlist
+    bool Add(PlaylistEntry entry);
+    void Remove(int index);
+    void Clear();
+    void SetWeight(int index, float weight);
+    void SetTrim(int index, float start, float end);
+    void SetProbe(int index, const WavInfo& wav, bool streamed);
+
+    void SetMode(PlaylistMode value);
+    PlaylistMode GetMode() const { return mode; }
+    // Picks in NoRepeat mode avoid the last 'count' picks (at most the playlist size - 1)
+    void SetNoRepeatCount(int count);
+
+    // Index of the entry to play next, or -1 if the playlist is empty.
+    // NoRepeat is not O(1): it rejection-samples the alias table, at most 16 draws of O(1) each, for an entry that was not played
+    // recently. Each draw misses with the share of the weight held by the recent entries, so heavy recent entries mean more draws.
+    // After 16 misses it picks among the others in one O(n) pass.
+    int Next();
+
+    bool Load();
+    bool Save() const;
+
+private:
+    void Rebuild();
+    void ForgetRecent();
+    int PickNotRecent();
+
+    std::filesystem::path filePath;
+    std::vector<PlaylistEntry> entries;
+    PlaylistMode mode = PlaylistMode::Weighted;
+    AliasTable table;
+    std::mt19937_64 rng;
+    std::uniform_real_distribution<double> uniform{ 0.0, 1.0 };
+    int roundRobin = -1;            // Last entry played in RoundRobin mode
+
+    // NoRepeat: the last picks, oldest first, and whether each entry is among them
+    int noRepeatCount = 2;
+    std::deque<int> recent;
+    std::vector<uint8_t> recentFlags;
+};
@@ -0,0 +1,222 @@
+#include "pch.h"
+#include "AnthemRules.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+bool RuleCondition::Evaluate(const GoalFacts& facts) const
+{
+    const int margin = facts.teamScore - facts.opponentScore;
+    int n = 0;
+    switch (fact) {
+    case Fact::Overtime:  n = facts.overtime; break;
+    case Fact::Winner:    n = facts.overtime || (facts.secondsRemaining <= 0 && margin > 0); break;
+    case Fact::HatTrick:  n = facts.scorerGoals == 3; break;
+    case Fact::Equalizer: n = margin == 0; break;
+    case Fact::GoAhead:   n = margin == 1; break;
+    case Fact::Goals:     n = facts.scorerGoals; break;
+    case Fact::Seconds:   n = facts.secondsRemaining; break;
+    case Fact::Margin:    n = margin; break;
+    }
+    switch (test) {
+    case Test::True:    return n != 0;
+    case Test::False:   return n == 0;
+    case Test::AtLeast: return n >= value;
+    case Test::AtMost:  return n <= value;
+    case Test::Equal:   return n == value;
+    }
+    return false;
+}
+
+static std::string Trim(const std::string& text)
+{
+    const size_t first = text.find_first_not_of(" \t");
+    if (first == std::string::npos) {
+        return "";
+    }
+    return text.substr(first, text.find_last_not_of(" \t") - first + 1);
+}
+
+static bool ParseCondition(std::string token, RuleCondition& condition)
+{
+    static const struct { const char* name; RuleCondition::Fact fact; bool counter; } facts[] = {
+        { "overtime", RuleCondition::Fact::Overtime, false },
+        { "winner", RuleCondition::Fact::Winner, false },
+        { "hattrick", RuleCondition::Fact::HatTrick, false },
+        { "equalizer", RuleCondition::Fact::Equalizer, false },
+        { "goahead", RuleCondition::Fact::GoAhead, false },
+        { "goals", RuleCondition::Fact::Goals, true },
+        { "seconds", RuleCondition::Fact::Seconds, true },
+        { "margin", RuleCondition::Fact::Margin, true },
+    };
+
+    const bool negated = !token.empty() && token[0] == '!';
+    if (negated) {
+        token = Trim(token.substr(1));
+    }
+    const size_t op = token.find_first_of("<>=");
+    const std::string name = Trim(token.substr(0, op));
+    for (const auto& entry : facts) {
+        if (name != entry.name) {
+            continue;
+        }
+        condition.fact = entry.fact;
+        if (!entry.counter) {
+            // Flags take no comparison
+            condition.test = negated ? RuleCondition::Test::False : RuleCondition::Test::True;
+            return op == std::string::npos;
+        }
+        if (negated || op == std::string::npos || op + 2 > token.size() || token[op + 1] != '=') {
+            return false;
+        }
+        condition.test = token[op] == '>' ? RuleCondition::Test::AtLeast : (token[op] == '<' ? RuleCondition::Test::AtMost : RuleCondition::Test::Equal);
+        const std::string number = Trim(token.substr(op + 2));
+        char* end = nullptr;
+        condition.value = (int)std::strtol(number.c_str(), &end, 10);
+        return !number.empty() && *end == '\0';
+    }
+    return false;
+}
+
+// The '=' between the conditions and the path, not one of '>=', '<=' or '=='
+static size_t FindSeparator(const std::string& line)
+{
+    for (size_t i = 0; i < line.size(); i++) {
+        if (line[i] != '=') {
+            continue;
+        }
+        const bool compare = (i > 0 && (line[i - 1] == '<' || line[i - 1] == '>' || line[i - 1] == '='))
+            || (i + 1 < line.size() && line[i + 1] == '=');
+        if (!compare) {
+            return i;
+        }
+    }
+    return std::string::npos;
+}
+
+bool AnthemRules::Load(const std::filesystem::path& filePath, const std::filesystem::path& anthemFolder, std::vector<std::string>& errors)
+{
+    std::ifstream file(filePath, std::ios::binary);
+    if (!file) {
+        Compile("", anthemFolder, errors);
+        return false;
+    }
+    std::stringstream text;
+    text << file.rdbuf();
+    Compile(text.str(), anthemFolder, errors);
+    return true;
+}
+
+void AnthemRules::Compile(const std::string& text, const std::filesystem::path& anthemFolder, std::vector<std::string>& errors)
+{
+    conditions.clear();
+    rules.clear();
+
+    std::istringstream lines(text);
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(lines, line)) {
+        lineNumber++;
+        line = Trim(line.substr(0, line.find_last_not_of('\r') + 1));
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        const size_t separator = FindSeparator(line);
+        if (separator == std::string::npos) {
+            errors.push_back("line " + std::to_string(lineNumber) + ": expected 'conditions = anthem'");
+            continue;
+        }
+
+        AnthemRule rule;
+        rule.text = Trim(line.substr(0, separator));
+        rule.line = lineNumber;
+        const std::string path = Trim(line.substr(separator + 1));
+        if (path.empty()) {
+            errors.push_back("line " + std::to_string(lineNumber) + ": no anthem");
+            continue;
+        }
+        std::filesystem::path resolved = Utf8ToPath(path);
+        rule.path = PathToUtf8(resolved.is_absolute() ? resolved : anthemFolder / resolved);
+
+        // "default" (or nothing) matches every goal
+        std::vector<RuleCondition> parsed;
+        bool valid = true;
+        if (rule.text != "default" && !rule.text.empty()) {
+            size_t start = 0;
+            while (valid) {
+                const size_t next = rule.text.find("&&", start);
+                RuleCondition condition;
+                valid = ParseCondition(Trim(rule.text.substr(start, next - start)), condition);
+                parsed.push_back(condition);
+                if (next == std::string::npos) {
+                    break;
+                }
+                start = next + 2;
+            }
+        }
+        if (!valid) {
+            errors.push_back("line " + std::to_string(lineNumber) + ": bad condition in '" + rule.text + "'");
+            continue;
+        }
+
+        // Conditions shared between rules are tested once per goal
+        const size_t known = conditions.size();
+        for (const RuleCondition& condition : parsed) {
+            auto it = std::find(conditions.begin(), conditions.end(), condition);
+            if (it == conditions.end()) {
+                it = conditions.insert(conditions.end(), condition);
+            }
+            rule.mask |= 1u << (it - conditions.begin());
+            if ((int)conditions.size() > maxConditions) {
+                break;
+            }
+        }
+        if ((int)conditions.size() > maxConditions) {
+            conditions.resize(known);
+            errors.push_back("line " + std::to_string(lineNumber) + ": more than " + std::to_string(maxConditions) + " different conditions");
+            continue;
+        }
+        rules.push_back(std::move(rule));
+    }
+
+    // First rule satisfied by each combination of conditions. Rules are listed in priority order, so a later rule only takes the
+    // combinations no earlier one covers.
+    const uint32_t combinations = 1u << conditions.size();
+    table.assign(combinations, -1);
+    for (uint32_t bits = 0; bits < combinations; bits++) {
+        for (size_t i = 0; i < rules.size(); i++) {
+            if ((rules[i].mask & bits) == rules[i].mask) {
+                table[bits] = (int16_t)i;
+                break;
+            }
+        }
+    }
+}
+
+int AnthemRules::Evaluate(const GoalFacts& facts) const
+{
+    uint32_t bits = 0;
+    for (size_t i = 0; i < conditions.size(); i++) {
+        bits |= (uint32_t)conditions[i].Evaluate(facts) << i;
+    }
+    return table.empty() ? -1 : table[bits];
+}
+
+bool AnthemRules::Uses(const std::string& path) const
+{
+    for (const AnthemRule& rule : rules) {
+        if (rule.path == path) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void AnthemRules::SetProbe(int index, const WavInfo& wav, bool streamed)
+{
+    if (index >= 0 && index < (int)rules.size()) {
+        rules[index].wav = wav;
+        rules[index].streamed = streamed;
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include "AnthemLibrary.h"
+
+// What the rules can test about a goal, gathered once per goal from the match state
+struct GoalFacts
+{
+    bool overtime = false;
+    int secondsRemaining = 0;
+    int scorerGoals = 0;            // The scorer's goals in this match, this one included
+    int teamScore = 0;              // Scores after the goal
+    int opponentScore = 0;
+};
+
+// One condition of a rule: a flag of the goal, or one of its counters compared to 'value'
+struct RuleCondition
+{
+    enum class Fact : uint8_t
+    {
+        Overtime,
+        Winner,             // Overtime goal, or a lead taken or extended with no time left
+        HatTrick,           // The scorer's third goal
+        Equalizer,          // Ties the score
+        GoAhead,            // Takes a one-goal lead
+        Goals,              // The scorer's goals this match
+        Seconds,            // Seconds left on the clock
+        Margin              // Scorer's team score minus the opponents'
+    };
+    enum class Test : uint8_t { True, False, AtLeast, AtMost, Equal };
+
+    Fact fact = Fact::Overtime;
+    Test test = Test::True;
+    int value = 0;
+
+    bool Evaluate(const GoalFacts& facts) const;
+    bool operator==(const RuleCondition& other) const { return fact == other.fact && test == other.test && value == other.value; }
+};
+
+struct AnthemRule
+{
+    std::string text;               // Conditions as written, for the log
+    std::string path;               // UTF-8, relative paths resolved against the anthem folder
+    int line = 0;
+    uint32_t mask = 0;              // Bit i: compiled condition i must hold
+
+    // Probed when the rules are loaded
+    WavInfo wav;
+    bool streamed = false;
+};
+
+// Anthems for particular goals, one rule per line of a text file:
+//     overtime && winner = ot.wav
+//     hattrick = C:\anthems\hat trick.flac
+//     goals>=5 && !overtime = five.wav
+// The first rule whose conditions all hold picks the anthem; goals no rule matches play the playlist.
+// Rules are compiled when loaded: every distinct condition gets one bit, and a table indexed by the set of bits that hold gives the
+// first rule each combination satisfies. A goal then costs one test per distinct condition and one table read.
+class AnthemRules
+{
+public:
+    static constexpr int maxConditions = 12;    // 4096 table entries
+
+    // A missing file leaves no rules and is not an error. Lines that do not parse are skipped and reported in 'errors'.
+    bool Load(const std::filesystem::path& filePath, const std::filesystem::path& anthemFolder, std::vector<std::string>& errors);
+    void Compile(const std::string& text, const std::filesystem::path& anthemFolder, std::vector<std::string>& errors);
+
+    // Index of the rule for this goal, or -1
+    int Evaluate(const GoalFacts& facts) const;
+
+    const std::vector<AnthemRule>& GetRules() const { return rules; }
+    int GetConditionCount() const { return (int)conditions.size(); }
+    bool Uses(const std::string& path) const;
+    void SetProbe(int index, const WavInfo& wav, bool streamed);
+
+private:
+    std::vector<RuleCondition> conditions;
+    std::vector<AnthemRule> rules;
+    std::vector<int16_t> table;     // 1 << conditions.size() entries
+};
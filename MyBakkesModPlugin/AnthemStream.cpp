@@ -0,0 +1,158 @@
+#include "pch.h"
+#include "AnthemStream.h"
+
+#include <algorithm>
+
+std::shared_ptr<AnthemStream> AnthemStream::Open(const std::filesystem::path& path, size_t offset, size_t length)
+{
+    std::shared_ptr<AnthemStream> stream(new AnthemStream());
+    stream->decoder = OpenAudioDecoder(path);
+    if (!stream->decoder) {
+        return nullptr;
+    }
+    const WavInfo& wav = stream->wav = stream->decoder->GetInfo();
+    const size_t frames = (size_t)stream->decoder->GetFrameCount();
+    stream->offset = std::min(offset, frames);
+    stream->length = std::min(length, frames - stream->offset);
+    if (!stream->decoder->Seek(stream->offset)) {
+        return nullptr;
+    }
+
+    stream->ring.assign(ringFrames * 2, 0.0f);
+    stream->converted.resize(chunkFrames * wav.channels);
+    if (stream->length == 0) {
+        stream->complete = true;
+        stream->primed = true;
+    }
+    return stream;
+}
+
+size_t AnthemStream::GetMemoryBytes() const
+{
+    return ring.size() * sizeof(float) + converted.size() * sizeof(float) + decoder->GetMemoryBytes();
+}
+
+bool AnthemStream::Refill()
+{
+    if (complete || closed) {
+        return false;
+    }
+    // Low watermark: refill once a whole half of the ring is free
+    const uint64_t position = written.load(std::memory_order_relaxed);
+    if (ringFrames - (size_t)(position - read.load(std::memory_order_acquire)) < chunkFrames) {
+        return false;
+    }
+
+    const size_t wanted = std::min(chunkFrames, length - (size_t)position);
+    const size_t frames = decoder->Read(converted.data(), wanted);
+
+    // Stereo in the ring: mono is doubled, channels past the second are dropped (same as the decoded voices)
+    const int channels = wav.channels;
+    for (size_t f = 0; f < frames; f++) {
+        float* frame = &ring[((position + f) & (ringFrames - 1)) * 2];
+        const float* source = &converted[f * channels];
+        frame[0] = source[0];
+        frame[1] = channels > 1 ? source[1] : source[0];
+    }
+    written.store(position + frames, std::memory_order_release);
+
+    refills++;
+    bytesRead += frames * wav.blockAlign;
+    if (frames < wanted || position + frames == length) {
+        complete = true;        // Truncated or corrupt files end where the data ends
+    }
+    if (position + frames >= std::min(ringFrames, length)) {
+        primed = true;
+    }
+    return true;
+}
+
+AnthemStreamReader::AnthemStreamReader()
+{
+    worker = std::thread([this]() { Run(); });
+}
+
+AnthemStreamReader::~AnthemStreamReader()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    worker.join();
+}
+
+void AnthemStreamReader::Add(std::shared_ptr<AnthemStream> stream)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        streams.push_back(std::move(stream));
+    }
+    wake.notify_one();
+}
+
+void AnthemStreamReader::Accumulate(const AnthemStream& stream)
+{
+    closedTotals.refills += stream.refills;
+    closedTotals.bytesRead += stream.bytesRead;
+    closedTotals.underruns += stream.underruns;
+    closedTotals.underrunFrames += stream.underrunFrames;
+    const int fill = stream.lowestFill;
+    if (fill >= 0 && (closedTotals.lowestFillFrames < 0 || fill < closedTotals.lowestFillFrames)) {
+        closedTotals.lowestFillFrames = fill;
+    }
+}
+
+AnthemStreamStats AnthemStreamReader::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    AnthemStreamStats result = closedTotals;
+    for (const auto& stream : streams) {
+        result.streams++;
+        result.refills += stream->refills;
+        result.bytesRead += stream->bytesRead;
+        result.underruns += stream->underruns;
+        result.underrunFrames += stream->underrunFrames;
+        result.memoryBytes += stream->GetMemoryBytes();
+        const int fill = stream->lowestFill;
+        if (fill >= 0 && (result.lowestFillFrames < 0 || fill < result.lowestFillFrames)) {
+            result.lowestFillFrames = fill;
+        }
+    }
+    return result;
+}
+
+void AnthemStreamReader::Run()
+{
+    std::vector<std::shared_ptr<AnthemStream>> active;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        if (streams.empty()) {
+            wake.wait(lock, [this]() { return stopping || !streams.empty(); });
+            continue;
+        }
+
+        // File reads happen outside the lock, so Add() and GetStats() never wait for the disk
+        active = streams;
+        lock.unlock();
+        for (const auto& stream : active) {
+            while (stream->Refill()) {
+            }
+        }
+        active.clear();
+        lock.lock();
+
+        // Closed by its voice, or never played and released by everyone else
+        auto done = std::remove_if(streams.begin(), streams.end(), [this](const std::shared_ptr<AnthemStream>& stream) {
+            if (!stream->IsClosed() && stream.use_count() > 1) {
+                return false;
+            }
+            Accumulate(*stream);
+            return true;
+        });
+        streams.erase(done, streams.end());
+
+        // A chunk lasts 170 ms at 48 kHz: polling every 5 ms refills a half long before the other one runs out
+        wake.wait_for(lock, std::chrono::milliseconds(5));
+    }
+}
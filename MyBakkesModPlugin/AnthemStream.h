@@ -0,0 +1,99 @@
+#pragma once
+#include "AnthemCache.h"
+#include "AudioDecoder.h"
+
+struct AnthemStreamStats
+{
+    int streams = 0;                // Open streams
+    uint64_t refills = 0;           // Chunks read by the I/O thread
+    uint64_t bytesRead = 0;         // Decoded, in the source format's frame size
+    uint64_t underruns = 0;         // Blocks in which a voice ran out of streamed frames
+    uint64_t underrunFrames = 0;    // Output frames of silence caused by underruns
+    int lowestFillFrames = -1;      // Lowest ring fill seen by the mixer while streaming (-1: none yet)
+    size_t memoryBytes = 0;         // Rings, read buffers and decoder state of the open streams
+};
+
+// A range of an anthem file (WAV, FLAC or Ogg Vorbis) decoded from disk while it plays, for anthems too long to keep decoded.
+// The file is decoded one chunk at a time by the I/O thread (AnthemStreamReader) into a ring of two chunks, converted to stereo
+// float: whenever the mixer has emptied one half (the fill dropped to the low watermark), the reader refills it while the mixer
+// plays the other. Memory per stream is the ring, one chunk and the decoder's state, whatever the length of the file.
+// Single producer (the I/O thread), single consumer (the mixer): the positions are atomics, no lock on either side.
+class AnthemStream
+{
+public:
+    static constexpr size_t chunkFrames = 8192;             // One refill, 170 ms at 48 kHz
+    static constexpr size_t ringFrames = chunkFrames * 2;
+
+    // Opens 'path' for the frames [offset, offset + length), clamped to the file. Null if the file is not a supported anthem file.
+    static std::shared_ptr<AnthemStream> Open(const std::filesystem::path& path, size_t offset, size_t length);
+
+    const WavInfo& GetInfo() const { return wav; }
+    size_t GetOffset() const { return offset; }
+    size_t GetLength() const { return length; }
+    size_t GetMemoryBytes() const;
+
+    // I/O thread: decodes one chunk if a ring half is free. Returns false when there was nothing to do.
+    bool Refill();
+    bool IsComplete() const { return complete; }            // Everything was read, or the file failed
+    bool IsPrimed() const { return primed; }                // The ring was filled once: the voice may start
+
+    // Mixer: frames readable from the read position, and the stereo frame 'i' frames after it
+    size_t BeginRead() const { return (size_t)(written.load(std::memory_order_acquire) - read.load(std::memory_order_relaxed)); }
+    const float* GetFrame(size_t i) const { return &ring[((read.load(std::memory_order_relaxed) + i) & (ringFrames - 1)) * 2]; }
+    void EndRead(size_t frames) { read.store(read.load(std::memory_order_relaxed) + frames, std::memory_order_release); }
+    size_t GetReadFrame() const { return offset + (size_t)read.load(std::memory_order_relaxed); }
+
+    // Mixer: the voice is done with the stream, the reader drops it
+    void Close() { closed = true; }
+    bool IsClosed() const { return closed; }
+
+    std::atomic<uint64_t> underruns{ 0 };
+    std::atomic<uint64_t> underrunFrames{ 0 };
+    std::atomic<int> lowestFill{ -1 };
+    std::atomic<uint64_t> refills{ 0 };
+    std::atomic<uint64_t> bytesRead{ 0 };
+
+private:
+    AnthemStream() = default;
+
+    std::unique_ptr<AudioDecoder> decoder;
+    WavInfo wav;
+    size_t offset = 0;
+    size_t length = 0;
+
+    std::vector<float> ring;                // ringFrames stereo frames
+    std::vector<float> converted;           // One chunk, decoded in the file's channel layout
+    std::atomic<uint64_t> written{ 0 };     // Frames from 'offset', written by the reader
+    std::atomic<uint64_t> read{ 0 };        // Frames from 'offset', consumed by the mixer
+    std::atomic<bool> complete{ false };
+    std::atomic<bool> primed{ false };
+    std::atomic<bool> closed{ false };
+};
+
+// The I/O thread: polls the open streams and refills the ones under their low watermark. A stream is dropped once its voice
+// closed it or nothing else references it.
+class AnthemStreamReader
+{
+public:
+    AnthemStreamReader();
+    ~AnthemStreamReader();
+
+    AnthemStreamReader(const AnthemStreamReader&) = delete;
+    AnthemStreamReader& operator=(const AnthemStreamReader&) = delete;
+
+    // Starts filling the stream right away
+    void Add(std::shared_ptr<AnthemStream> stream);
+
+    AnthemStreamStats GetStats() const;
+
+private:
+    void Run();
+    void Accumulate(const AnthemStream& stream);
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<std::shared_ptr<AnthemStream>> streams;
+    AnthemStreamStats closedTotals;         // Counters of the streams already dropped
+    bool stopping = false;
+    std::thread worker;
+};
@@ -0,0 +1,213 @@
+#include "pch.h"
+#include "AudioDecoder.h"
+#include "AnthemCache.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <random>
+
+bool FileReader::Open(const std::filesystem::path& path)
+{
+    file.open(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    file.seekg(0, std::ios::end);
+    size = (uint64_t)file.tellg();
+    file.seekg(0, std::ios::beg);
+    bufferStart = 0;
+    position = 0;
+    filled = 0;
+    return true;
+}
+
+bool FileReader::Fill()
+{
+    bufferStart += filled;
+    position = 0;
+    filled = 0;
+    if (bufferStart >= size) {
+        return false;
+    }
+    file.clear();
+    file.seekg((std::streamoff)bufferStart);
+    file.read((char*)buffer.data(), (std::streamsize)std::min<uint64_t>(buffer.size(), size - bufferStart));
+    filled = (size_t)file.gcount();
+    return filled > 0;
+}
+
+bool FileReader::Seek(uint64_t offset)
+{
+    if (offset > size) {
+        return false;
+    }
+    if (offset >= bufferStart && offset < bufferStart + filled) {
+        position = (size_t)(offset - bufferStart);     // Inside the buffer: no file access
+        return true;
+    }
+    bufferStart = offset;
+    position = 0;
+    filled = 0;
+    return true;
+}
+
+size_t FileReader::Read(void* out, size_t bytes)
+{
+    size_t copied = 0;
+    while (copied < bytes) {
+        if (position == filled && !Fill()) {
+            break;
+        }
+        size_t n = std::min(bytes - copied, filled - position);
+        memcpy((uint8_t*)out + copied, buffer.data() + position, n);
+        position += n;
+        copied += n;
+    }
+    return copied;
+}
+
+// PCM and IEEE float WAV, converted a block at a time
+class WavDecoder : public AudioDecoder
+{
+public:
+    bool Open(const std::filesystem::path& path)
+    {
+        if (!ProbeWavHeader(path, info) || !reader.Open(path)) {
+            return false;
+        }
+        frames = info.dataBytes / info.blockAlign;
+        return Seek(0);
+    }
+
+    size_t Read(float* out, size_t count) override
+    {
+        count = (size_t)std::min<uint64_t>(count, frames - position);
+        size_t done = 0;
+        while (done < count) {
+            const size_t n = std::min(count - done, blockFrames);
+            raw.resize(blockFrames * info.blockAlign);
+            const size_t bytes = reader.Read(raw.data(), n * info.blockAlign);
+            const size_t got = bytes / info.blockAlign;
+            ConvertWavSamples(info, raw.data(), got * info.channels, out + done * info.channels);
+            done += got;
+            position += got;
+            if (got < n) {
+                break;
+            }
+        }
+        return done;
+    }
+
+    bool Seek(uint64_t frame) override
+    {
+        position = std::min(frame, frames);
+        return reader.Seek(info.dataOffset + position * info.blockAlign);
+    }
+
+    size_t GetMemoryBytes() const override { return 64 * 1024 + raw.capacity(); }
+
+private:
+    static constexpr size_t blockFrames = 4096;
+
+    FileReader reader;
+    std::vector<uint8_t> raw;
+    uint64_t position = 0;
+};
+
+std::unique_ptr<AudioDecoder> OpenWavDecoder(const std::filesystem::path& path)
+{
+    auto decoder = std::make_unique<WavDecoder>();
+    if (!decoder->Open(path)) {
+        return nullptr;
+    }
+    return decoder;
+}
+
+static int ReadSignature(const std::filesystem::path& path, uint8_t* signature, size_t size)
+{
+    std::ifstream file(path, std::ios::binary);
+    file.read((char*)signature, (std::streamsize)size);
+    return (int)file.gcount();
+}
+
+std::unique_ptr<AudioDecoder> OpenAudioDecoder(const std::filesystem::path& path)
+{
+    uint8_t signature[4] = {};
+    if (ReadSignature(path, signature, sizeof(signature)) < 4) {
+        return nullptr;
+    }
+    if (memcmp(signature, "RIFF", 4) == 0) {
+        return OpenWavDecoder(path);
+    }
+    if (memcmp(signature, "fLaC", 4) == 0) {
+        return OpenFlacDecoder(path);
+    }
+    if (memcmp(signature, "OggS", 4) == 0) {
+        return OpenVorbisDecoder(path);
+    }
+    return nullptr;
+}
+
+bool ProbeAudioHeader(const std::filesystem::path& path, WavInfo& info)
+{
+    uint8_t signature[4] = {};
+    if (ReadSignature(path, signature, sizeof(signature)) < 4) {
+        return false;
+    }
+    if (memcmp(signature, "fLaC", 4) == 0) {
+        return ProbeFlacHeader(path, info);
+    }
+    if (memcmp(signature, "OggS", 4) == 0) {
+        return ProbeVorbisHeader(path, info);
+    }
+    return ProbeWavHeader(path, info);
+}
+
+bool IsAnthemFile(const std::filesystem::path& path)
+{
+    std::string extension = PathToUtf8(path.extension());
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+    return extension == ".wav" || extension == ".flac" || extension == ".ogg" || extension == ".oga";
+}
+
+CodecBenchmarkResult RunCodecBenchmark(const std::filesystem::path& path, int seeks)
+{
+    using Clock = std::chrono::steady_clock;
+    CodecBenchmarkResult result;
+    result.path = PathToUtf8(path);
+
+    // Full decode, as the anthem cache does it
+    auto start = Clock::now();
+    DecodedAnthem anthem;
+    if (!DecodeAnthemFile(path, anthem)) {
+        return result;
+    }
+    result.fullMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    result.formatTag = anthem.wav.formatTag;
+    result.audioSeconds = anthem.GetDurationSeconds();
+
+    // Streaming: one ring chunk at a time, as the I/O thread reads it
+    std::unique_ptr<AudioDecoder> decoder = OpenAudioDecoder(path);
+    if (!decoder) {
+        return result;
+    }
+    const int channels = decoder->GetInfo().channels;
+    std::vector<float> chunk((size_t)8192 * channels);
+    start = Clock::now();
+    while (decoder->Read(chunk.data(), 8192) == 8192) {
+    }
+    result.streamMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    // Trims: seek to random frames and decode a little from there
+    std::mt19937_64 rng(42);
+    const uint64_t frames = std::max<uint64_t>(decoder->GetFrameCount(), 1);
+    start = Clock::now();
+    for (int i = 0; i < seeks; i++) {
+        decoder->Seek(rng() % frames);
+        decoder->Read(chunk.data(), 1024);
+    }
+    result.seekMs = seeks > 0 ? std::chrono::duration<double, std::milli>(Clock::now() - start).count() / seeks : 0.0;
+    result.ok = true;
+    return result;
+}
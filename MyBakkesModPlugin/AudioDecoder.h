@@ -0,0 +1,91 @@
+#pragma once
+#include "AnthemLibrary.h"
+
+#include <fstream>
+
+// WAVE format tags stored in WavInfo::formatTag for the compressed formats, so library entries and the index keep one layout.
+// For these, bitsPerSample is the source resolution (Vorbis: 16), blockAlign is channels * bitsPerSample / 8 and dataBytes is the
+// decoded length in that layout, so WavInfo::GetDurationSeconds() works for every format; dataOffset is unused.
+constexpr uint16_t formatTagFlac = 0xF1AC;
+constexpr uint16_t formatTagVorbis = 0x674F;
+
+// Buffered sequential reads with cheap seeks, shared by the FLAC and Ogg parsers
+class FileReader
+{
+public:
+    bool Open(const std::filesystem::path& path);
+    uint64_t GetSize() const { return size; }
+    uint64_t Tell() const { return bufferStart + position; }
+    bool Seek(uint64_t offset);
+    // Copies up to 'bytes' bytes, returns the count copied (short at the end of the file)
+    size_t Read(void* out, size_t bytes);
+    bool ReadByte(uint8_t& value)
+    {
+        if (position == filled && !Fill()) {
+            return false;
+        }
+        value = buffer[position++];
+        return true;
+    }
+
+private:
+    bool Fill();
+
+    std::ifstream file;
+    uint64_t size = 0;
+    std::vector<uint8_t> buffer = std::vector<uint8_t>(64 * 1024);
+    uint64_t bufferStart = 0;       // File offset of buffer[0]
+    size_t position = 0;
+    size_t filled = 0;
+};
+
+// Sequential decoder of one anthem file to interleaved float samples, with frame-accurate seeking.
+// Full decodes read everything in one go (DecodeAnthemFile()); streams call Read() one chunk at a time and keep only the decoder's
+// own state (one FLAC frame, or one Vorbis packet and its overlap), whatever the length of the file.
+class AudioDecoder
+{
+public:
+    virtual ~AudioDecoder() = default;
+
+    const WavInfo& GetInfo() const { return info; }
+    uint64_t GetFrameCount() const { return frames; }
+
+    // Decodes up to 'count' frames (channels interleaved as in the file) at the current position. Returns the frames written,
+    // fewer than 'count' only at the end of the file or on a decode error.
+    virtual size_t Read(float* out, size_t count) = 0;
+    // The next Read() starts at 'frame'
+    virtual bool Seek(uint64_t frame) = 0;
+    virtual size_t GetMemoryBytes() const = 0;
+
+protected:
+    WavInfo info;
+    uint64_t frames = 0;
+};
+
+// The decoder for 'path', chosen by the file's signature (RIFF/WAVE, fLaC or OggS + Vorbis), or null
+std::unique_ptr<AudioDecoder> OpenAudioDecoder(const std::filesystem::path& path);
+std::unique_ptr<AudioDecoder> OpenWavDecoder(const std::filesystem::path& path);
+std::unique_ptr<AudioDecoder> OpenFlacDecoder(const std::filesystem::path& path);
+std::unique_ptr<AudioDecoder> OpenVorbisDecoder(const std::filesystem::path& path);
+
+// Header-only probes used by the library: format, channels, rate and length, without decoding any audio
+bool ProbeAudioHeader(const std::filesystem::path& path, WavInfo& info);
+bool ProbeFlacHeader(const std::filesystem::path& path, WavInfo& info);
+bool ProbeVorbisHeader(const std::filesystem::path& path, WavInfo& info);
+
+// .wav, .flac, .ogg and .oga
+bool IsAnthemFile(const std::filesystem::path& path);
+
+// Decode speed of a file in multiples of real time: in one go, in stream-sized chunks, and the cost of a seek to random frames
+struct CodecBenchmarkResult
+{
+    std::string path;
+    uint16_t formatTag = 0;
+    double audioSeconds = 0.0;
+    double fullMs = 0.0;
+    double streamMs = 0.0;
+    double seekMs = 0.0;            // Average of the seeks, each followed by a 1024-frame read
+    bool ok = false;
+};
+
+CodecBenchmarkResult RunCodecBenchmark(const std::filesystem::path& path, int seeks);
@@ -0,0 +1,568 @@
+#include "pch.h"
+#include "AudioEngine.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <mmsystem.h>
+#endif
+
+// Fade-in after SeekVoice(), short enough to keep the new position's attack
+static const float seekFadeSeconds = 0.005f;
+
+AnthemClip AnthemClip::FromSeconds(std::shared_ptr<const DecodedAnthem> anthem, double startSeconds, double endSeconds, float fadeOutSeconds)
+{
+    AnthemClip clip;
+    if (!anthem || anthem->sampleRate == 0) {
+        return clip;
+    }
+    const size_t frames = anthem->GetFrameCount();
+    clip.offset = std::min(frames, (size_t)std::max(0.0, startSeconds * anthem->sampleRate));
+    size_t end = endSeconds > startSeconds ? std::min(frames, (size_t)(endSeconds * anthem->sampleRate)) : frames;
+    clip.length = end > clip.offset ? end - clip.offset : 0;
+    clip.fadeOutSeconds = fadeOutSeconds;
+    clip.anthem = std::move(anthem);
+    return clip;
+}
+
+AnthemClip AnthemClip::FromStream(std::shared_ptr<AnthemStream> stream, float fadeOutSeconds)
+{
+    AnthemClip clip;
+    if (!stream) {
+        return clip;
+    }
+    clip.offset = stream->GetOffset();
+    clip.length = stream->GetLength();
+    clip.fadeOutSeconds = fadeOutSeconds;
+    clip.stream = std::move(stream);
+    return clip;
+}
+
+AudioEngine::AudioEngine()
+{
+    limiter.Prepare(sampleRate);
+    ducking.Prepare(sampleRate);
+    effectsBus.resize((size_t)blockFrames * 2);
+    compactScratch.resize(CompactPcm::GetDecodeCapacity(compactChunkFrames) * 2);
+}
+
+AudioEngine::~AudioEngine()
+{
+    Stop();
+}
+
+bool AudioEngine::Start(uint32_t rate, int frames)
+{
+    if (output.joinable()) {
+        return deviceOpen;
+    }
+    sampleRate = rate;
+    blockFrames = frames;
+    limiter.Prepare(sampleRate);
+    limiterChanged = true;
+    ducking.Prepare(sampleRate);
+    effectsBus.resize((size_t)blockFrames * 2);
+    stopping = false;
+    std::promise<bool> opened;
+    std::future<bool> result = opened.get_future();
+    output = std::thread([this, opened = std::move(opened)]() mutable { RunOutput(std::move(opened)); });
+    deviceOpen = result.get();
+    return deviceOpen;
+}
+
+void AudioEngine::Stop()
+{
+    stopping = true;
+    if (output.joinable()) {
+        output.join();
+    }
+    deviceOpen = false;
+}
+
+int AudioEngine::Play(const AnthemClip& clip)
+{
+    if ((!clip.anthem && !clip.stream) || clip.length == 0) {
+        return 0;
+    }
+    if (clip.stream) {
+        streamReader.Add(clip.stream);
+    }
+    std::vector<AnthemClip> released;
+    int id;
+    {
+        std::lock_guard<std::mutex> lock(commandMutex);
+        released.swap(retired);
+        id = nextId++;
+        voicesStarted++;
+        commands.push_back(Command{ CommandType::Play, id, clip, 0.0f, DuckingParameters{} });
+    }
+    return id;  // 'released' frees the samples of finished voices here, outside the lock
+}
+
+void AudioEngine::StopVoice(int id, float fadeSeconds)
+{
+    std::vector<AnthemClip> released;
+    std::lock_guard<std::mutex> lock(commandMutex);
+    released.swap(retired);
+    commands.push_back(Command{ CommandType::Stop, id, {}, fadeSeconds, DuckingParameters{} });
+}
+
+void AudioEngine::StopAll(float fadeSeconds)
+{
+    std::vector<AnthemClip> released;
+    std::lock_guard<std::mutex> lock(commandMutex);
+    released.swap(retired);
+    commands.push_back(Command{ CommandType::StopAll, 0, {}, fadeSeconds, DuckingParameters{} });
+}
+
+void AudioEngine::SetLimiter(bool enabled, float ceilingDb, float releaseMs)
+{
+    limiterCeilingDb = ceilingDb;
+    limiterReleaseMs = releaseMs;
+    limiterEnabled = enabled;
+    limiterChanged = true;
+}
+
+void AudioEngine::SetDucking(const DuckingParameters& parameters)
+{
+    duckingEnabled = parameters.enabled;
+    std::vector<AnthemClip> released;
+    std::lock_guard<std::mutex> lock(commandMutex);
+    released.swap(retired);
+    Command command;
+    command.type = CommandType::SetDucking;
+    command.ducking = parameters;
+    commands.push_back(std::move(command));
+}
+
+void AudioEngine::SeekVoice(int id, double seconds)
+{
+    std::vector<AnthemClip> released;
+    std::lock_guard<std::mutex> lock(commandMutex);
+    released.swap(retired);
+    Command command;
+    command.type = CommandType::Seek;
+    command.id = id;
+    command.seconds = seconds;
+    commands.push_back(std::move(command));
+}
+
+double AudioEngine::GetVoicePosition(int id) const
+{
+    for (int i = 0; i < maxVoices; i++) {
+        if (voiceIds[i] == id) {
+            return voicePositions[i];
+        }
+    }
+    return -1.0;
+}
+
+AudioEngineStats AudioEngine::GetStats() const
+{
+    AudioEngineStats result;
+    result.deviceOpen = deviceOpen;
+    result.sampleRate = sampleRate;
+    result.blockFrames = blockFrames;
+    result.activeVoices = activeVoices;
+    result.blocks = blocks;
+    result.underruns = underruns;
+    result.lastMixUs = lastMixUs;
+    result.avgMixUs = avgMixUs;
+    result.maxMixUs = maxMixUs;
+    result.limiterEnabled = limiterEnabled;
+    result.limiterLatencyFrames = limiter.GetLatencyFrames();
+    result.avgLimiterUs = avgLimiterUs;
+    result.maxLimiterUs = maxLimiterUs;
+    result.limiterReductionDb = limiterReductionDb;
+    result.duckingEnabled = duckingEnabled;
+    result.duckingGainDb = duckingGainDb;
+    result.avgDuckingUs = avgDuckingUs;
+    result.maxDuckingUs = maxDuckingUs;
+    result.avgCompactUs = avgCompactUs;
+    result.maxCompactUs = maxCompactUs;
+    result.streaming = streamReader.GetStats();
+    {
+        std::lock_guard<std::mutex> lock(commandMutex);
+        result.voicesStarted = voicesStarted;
+    }
+    return result;
+}
+
+void AudioEngine::Retire(Voice& voice)
+{
+    if (voice.clip.stream) {
+        voice.clip.stream->Close();
+    }
+    retired.push_back(std::move(voice.clip));
+}
+
+void AudioEngine::DrainCommands()
+{
+    // Never wait: if the game thread holds the queue, the commands are picked up by the next block
+    std::unique_lock<std::mutex> lock(commandMutex, std::try_to_lock);
+    if (!lock) {
+        return;
+    }
+
+    for (Voice& voice : voices) {
+        if (voice.id != 0 && voice.finished) {
+            Retire(voice);
+            voice = Voice();
+        }
+    }
+
+    for (Command& command : commands) {
+        if (command.type == CommandType::SetDucking) {
+            ducking.SetParameters(command.ducking);
+        }
+        else if (command.type == CommandType::Seek) {
+            for (Voice& voice : voices) {
+                if (voice.id != command.id || voice.finished || voice.clip.stream || voice.end <= voice.position) {
+                    continue;
+                }
+                // Whole source frame, so the samples line up exactly with the clip's; the fade-in hides the jump
+                const double frame = std::floor(std::max(command.seconds, 0.0) * voice.sourceRate + 0.5);
+                voice.position = std::clamp(frame, (double)voice.clip.offset, voice.end - 1.0);
+                voice.attack = 0.0f;
+                voice.attackStep = 1.0f / (seekFadeSeconds * sampleRate);
+            }
+        }
+        else if (command.type == CommandType::Play) {
+            // Free slot, or the oldest voice
+            Voice* slot = &voices[0];
+            for (Voice& voice : voices) {
+                if (voice.id == 0) {
+                    slot = &voice;
+                    break;
+                }
+                if (voice.id < slot->id) {
+                    slot = &voice;
+                }
+            }
+            if (slot->id != 0) {
+                Retire(*slot);
+            }
+            Voice voice;
+            voice.id = command.id;
+            voice.clip = std::move(command.clip);
+            if (voice.clip.stream) {
+                voice.sourceRate = voice.clip.stream->GetInfo().sampleRate;
+            }
+            else {
+                const DecodedAnthem& anthem = *voice.clip.anthem;
+                voice.clip.length = std::min(voice.clip.length, anthem.GetFrameCount() - std::min(voice.clip.offset, anthem.GetFrameCount()));
+                voice.sourceRate = anthem.sampleRate;
+            }
+            voice.position = (double)voice.clip.offset;
+            voice.end = (double)(voice.clip.offset + voice.clip.length);
+            voice.step = (double)voice.sourceRate / sampleRate;
+            *slot = std::move(voice);
+        }
+        else {
+            for (Voice& voice : voices) {
+                if (voice.id != 0 && (command.type == CommandType::StopAll || voice.id == command.id)) {
+                    if (command.fadeSeconds > 0.0f) {
+                        voice.releaseStep = std::max(voice.releaseStep, 1.0f / (command.fadeSeconds * sampleRate));
+                    }
+                    else {
+                        voice.finished = true;
+                    }
+                }
+            }
+        }
+    }
+    commands.clear();
+}
+
+int AudioEngine::MixVoice(Voice& voice, const float* samples, size_t base, int channels, float* out, int frames)
+{
+    const size_t last = (size_t)voice.end - 1;
+    // Fade length in source frames, anchored to the end of the clip (the trim end, not the end of the file)
+    const double fadeFrames = std::min((double)voice.clip.length, (double)voice.clip.fadeOutSeconds * voice.sourceRate);
+
+    for (int i = 0; i < frames; i++) {
+        if (voice.position >= voice.end || voice.release <= 0.0f) {
+            voice.finished = true;
+            return i;
+        }
+        // Linear interpolation, a no-op when the rates match (frac stays 0)
+        const size_t index = (size_t)voice.position;
+        const float frac = (float)(voice.position - (double)index);
+        const float* a = samples + (index - base) * channels;
+        const float* b = samples + (std::min(index + 1, last) - base) * channels;
+        float left = a[0] + (b[0] - a[0]) * frac;
+        float right = channels > 1 ? a[1] + (b[1] - a[1]) * frac : left;
+
+        float gain = voice.clip.gain * voice.release * voice.attack;
+        if (fadeFrames > 0.0) {
+            gain *= (float)std::min(1.0, (voice.end - voice.position) / fadeFrames);
+        }
+        out[i * 2] += left * gain;
+        out[i * 2 + 1] += right * gain;
+
+        voice.position += voice.step;
+        voice.release -= voice.releaseStep;
+        voice.attack = std::min(voice.attack + voice.attackStep, 1.0f);
+    }
+    return frames;
+}
+
+void AudioEngine::RenderVoice(Voice& voice, float* out, int frames)
+{
+    const DecodedAnthem& anthem = *voice.clip.anthem;
+    MixVoice(voice, anthem.samples.data(), 0, anthem.channels, out, frames);
+}
+
+void AudioEngine::RenderCompactVoice(Voice& voice, float* out, int frames)
+{
+    // Decoded a chunk at a time into the scratch buffer: the work per block is bounded by the source frames the block plays,
+    // plus at most two partial ADPCM blocks per chunk
+    const CompactPcm& compact = voice.clip.anthem->compact;
+    const size_t last = (size_t)voice.end - 1;
+    const int chunkFrames = std::max(1, (int)((compactChunkFrames - 2) / voice.step));
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames && !voice.finished;) {
+        if (voice.position >= voice.end || voice.release <= 0.0f) {
+            voice.finished = true;
+            break;
+        }
+        const int n = std::min(frames - i, chunkFrames);
+        const size_t first = (size_t)voice.position;
+        const size_t needed = std::min((size_t)(voice.position + voice.step * n) + 1, last);
+        const size_t base = compact.Decode(first, needed + 1 - first, compactScratch.data());
+        i += MixVoice(voice, compactScratch.data(), base, compact.GetChannels(), out + i * 2, n);
+    }
+    compactUs += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+void AudioEngine::RenderStreamVoice(Voice& voice, float* out, int frames)
+{
+    AnthemStream& stream = *voice.clip.stream;
+    if (!stream.IsPrimed()) {
+        return;     // The reader has not filled the ring yet: the voice starts a block later, this is not an underrun
+    }
+    const size_t available = stream.BeginRead();
+    const size_t base = stream.GetReadFrame();
+    const size_t last = (size_t)voice.end - 1;
+    const double fadeFrames = std::min((double)voice.clip.length, (double)voice.clip.fadeOutSeconds * voice.sourceRate);
+    if (!stream.IsComplete()) {
+        // The tail of the file drains the ring on purpose, only the fill while more data is coming tells how close the reader ran
+        const int fill = (int)available;
+        const int lowest = stream.lowestFill;
+        if (lowest < 0 || fill < lowest) {
+            stream.lowestFill = fill;
+        }
+    }
+
+    for (int i = 0; i < frames; i++) {
+        if (voice.position >= voice.end || voice.release <= 0.0f) {
+            voice.finished = true;
+            break;
+        }
+        const size_t index = (size_t)voice.position;
+        const size_t next = std::min(index + 1, last);
+        if (next - base >= available) {
+            if (stream.IsComplete()) {
+                voice.finished = true;      // The file ended before the clip did
+            }
+            else {
+                // Underrun: hold the position and play silence until the reader catches up
+                stream.underruns++;
+                stream.underrunFrames += frames - i;
+            }
+            break;
+        }
+        // The ring is always stereo
+        const float frac = (float)(voice.position - (double)index);
+        const float* a = stream.GetFrame(index - base);
+        const float* b = stream.GetFrame(next - base);
+        float left = a[0] + (b[0] - a[0]) * frac;
+        float right = a[1] + (b[1] - a[1]) * frac;
+
+        float gain = voice.clip.gain * voice.release;
+        if (fadeFrames > 0.0) {
+            gain *= (float)std::min(1.0, (voice.end - voice.position) / fadeFrames);
+        }
+        out[i * 2] += left * gain;
+        out[i * 2 + 1] += right * gain;
+
+        voice.position += voice.step;
+        voice.release -= voice.releaseStep;
+    }
+    // Frames before the current position are no longer needed (never more than were written)
+    stream.EndRead(std::min((size_t)voice.position - base, available));
+}
+
+void AudioEngine::Render(float* out, int frames)
+{
+    auto start = std::chrono::steady_clock::now();
+    DrainCommands();
+    memset(out, 0, sizeof(float) * 2 * frames);
+    if (effectsBus.size() < (size_t)frames * 2) {
+        effectsBus.resize((size_t)frames * 2);   // Only for offline blocks larger than the device block
+    }
+
+    // Anthem voices are mixed straight into 'out', the effects voices into their own bus
+    int active = 0;
+    bool effects = false;
+    bool compact = false;
+    compactUs = 0.0;
+    for (int i = 0; i < maxVoices; i++) {
+        Voice& voice = voices[i];
+        if (voice.id != 0 && !voice.finished) {
+            const bool effect = voice.clip.bus == AudioBus::Effects;
+            if (effect && !effects) {
+                memset(effectsBus.data(), 0, sizeof(float) * 2 * frames);
+                effects = true;
+            }
+            float* target = effect ? effectsBus.data() : out;
+            if (voice.clip.stream) {
+                RenderStreamVoice(voice, target, frames);
+            }
+            else if (voice.clip.anthem->samples.empty()) {
+                RenderCompactVoice(voice, target, frames);
+                compact = true;
+            }
+            else {
+                RenderVoice(voice, target, frames);
+            }
+        }
+        active += voice.id != 0 && !voice.finished ? 1 : 0;
+        voiceIds[i] = voice.finished ? 0 : voice.id;
+        voicePositions[i] = voice.id != 0 ? voice.position / voice.sourceRate : -1.0;
+    }
+
+    if (compact) {
+        avgCompactUs = compactBlocks == 0 ? compactUs : avgCompactUs + (compactUs - avgCompactUs) / 256.0;
+        maxCompactUs = std::max(maxCompactUs.load(), compactUs);
+        compactBlocks++;
+    }
+
+    // The anthem mix keys the ducker, which adds the effects bus on top. Nothing to duck without effects voices: the envelope is
+    // skipped, and starts over from unity with the next effects voice.
+    if (effects) {
+        auto duckingStart = std::chrono::steady_clock::now();
+        ducking.Process(out, effectsBus.data(), out, frames);
+        const double duckingUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - duckingStart).count();
+        avgDuckingUs = duckingBlocks == 0 ? duckingUs : avgDuckingUs + (duckingUs - avgDuckingUs) / 256.0;
+        maxDuckingUs = std::max(maxDuckingUs.load(), duckingUs);
+        duckingGainDb = 20.0f * std::log10(std::max(ducking.GetGain(), 1e-6f));
+        duckingBlocks++;
+    }
+    else if (effectsActive) {
+        ducking.Reset();
+        duckingGainDb = 0.0f;
+    }
+    effectsActive = effects;
+
+    if (limiterChanged.exchange(false)) {
+        limiter.SetParameters(limiterCeilingDb, limiterReleaseMs);
+        if (limiterEnabled && !limiterActive) {
+            limiter.Reset();
+        }
+        limiterActive = limiterEnabled;
+    }
+    if (limiterActive) {
+        auto limiterStart = std::chrono::steady_clock::now();
+        limiter.Process(out, frames);
+        const double limiterUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - limiterStart).count();
+        avgLimiterUs = blocks == 0 ? limiterUs : avgLimiterUs + (limiterUs - avgLimiterUs) / 256.0;
+        maxLimiterUs = std::max(maxLimiterUs.load(), limiterUs);
+        limiterReductionDb = 20.0f * std::log10(std::max(limiter.GetLastMinGain(), 1e-6f));
+    }
+
+    const double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    activeVoices = active;
+    lastMixUs = us;
+    avgMixUs = blocks == 0 ? us : avgMixUs + (us - avgMixUs) / 256.0;
+    maxMixUs = std::max(maxMixUs.load(), us);
+    blocks++;
+}
+
+#ifdef _WIN32
+
+// A few blocks queued with waveOutWrite, refilled as the device hands them back
+static bool RunWaveOut(AudioEngine& engine, uint32_t sampleRate, int blockFrames, std::atomic<bool>& stopping,
+    std::atomic<uint64_t>& underruns, std::promise<bool>& opened)
+{
+    WAVEFORMATEX format = {};
+    format.wFormatTag = WAVE_FORMAT_IEEE_FLOAT;
+    format.nChannels = 2;
+    format.nSamplesPerSec = sampleRate;
+    format.wBitsPerSample = 32;
+    format.nBlockAlign = format.nChannels * format.wBitsPerSample / 8;
+    format.nAvgBytesPerSec = format.nSamplesPerSec * format.nBlockAlign;
+
+    HANDLE event = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    HWAVEOUT device = nullptr;
+    if (waveOutOpen(&device, WAVE_MAPPER, &format, (DWORD_PTR)event, 0, CALLBACK_EVENT) != MMSYSERR_NOERROR) {
+        CloseHandle(event);
+        return false;
+    }
+    opened.set_value(true);
+
+    const int bufferCount = 4;
+    std::vector<float> buffers[bufferCount];
+    WAVEHDR headers[bufferCount] = {};
+    for (int i = 0; i < bufferCount; i++) {
+        buffers[i].resize((size_t)blockFrames * 2);
+        engine.Render(buffers[i].data(), blockFrames);
+        headers[i].lpData = (LPSTR)buffers[i].data();
+        headers[i].dwBufferLength = (DWORD)(buffers[i].size() * sizeof(float));
+        waveOutPrepareHeader(device, &headers[i], sizeof(WAVEHDR));
+        waveOutWrite(device, &headers[i], sizeof(WAVEHDR));
+    }
+
+    while (!stopping) {
+        WaitForSingleObject(event, 100);
+        int done = 0;
+        for (int i = 0; i < bufferCount; i++) {
+            if (headers[i].dwFlags & WHDR_DONE) {
+                done++;
+                engine.Render(buffers[i].data(), blockFrames);
+                waveOutWrite(device, &headers[i], sizeof(WAVEHDR));
+            }
+        }
+        if (done == bufferCount) {
+            underruns++;
+        }
+    }
+
+    waveOutReset(device);
+    for (int i = 0; i < bufferCount; i++) {
+        waveOutUnprepareHeader(device, &headers[i], sizeof(WAVEHDR));
+    }
+    waveOutClose(device);
+    CloseHandle(event);
+    return true;
+}
+
+#endif
+
+void AudioEngine::RunOutput(std::promise<bool> opened)
+{
+#ifdef _WIN32
+    if (RunWaveOut(*this, sampleRate, blockFrames, stopping, underruns, opened)) {
+        return;
+    }
+#endif
+    opened.set_value(false);
+
+    // No device: keep voices advancing in real time so positions, fades and stats behave the same
+    std::vector<float> block((size_t)blockFrames * 2);
+    const auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>((double)blockFrames / sampleRate));
+    auto next = std::chrono::steady_clock::now();
+    while (!stopping) {
+        Render(block.data(), blockFrames);
+        next += period;
+        auto now = std::chrono::steady_clock::now();
+        if (next < now) {
+            next = now;
+        }
+        std::this_thread::sleep_until(next);
+    }
+}
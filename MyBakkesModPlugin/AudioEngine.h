@@ -0,0 +1,186 @@
+#pragma once
+#include "AnthemCache.h"
+#include "AnthemStream.h"
+#include "PeakLimiter.h"
+#include "DuckingBus.h"
+
+#include <array>
+#include <future>
+
+// Anthem voices key the ducking bus; voices on the effects bus are ducked under them. The plugin has no sounds besides the anthems
+// yet, so nothing plays on the effects bus: the ducker is inert, and Render() skips it while the bus has no voice.
+enum class AudioBus { Anthem, Effects };
+
+// A playable range of a decoded anthem. Copies share the decoded samples: a voice reads them in place through the shared_ptr
+// (compact resident formats are decoded a chunk at a time by the mixer).
+// A streamed clip has no decoded anthem: its voice reads the range the stream was opened on from the stream's ring.
+struct AnthemClip
+{
+    std::shared_ptr<const DecodedAnthem> anthem;
+    std::shared_ptr<AnthemStream> stream;
+    size_t offset = 0;              // First frame
+    size_t length = 0;              // Frames from 'offset', clamped to the anthem
+    float fadeOutSeconds = 0.0f;    // Fade ending at offset + length
+    float gain = 1.0f;
+    AudioBus bus = AudioBus::Anthem;
+
+    static AnthemClip FromSeconds(std::shared_ptr<const DecodedAnthem> anthem, double startSeconds, double endSeconds, float fadeOutSeconds);
+    static AnthemClip FromStream(std::shared_ptr<AnthemStream> stream, float fadeOutSeconds);
+};
+
+struct AudioEngineStats
+{
+    bool deviceOpen = false;        // False: mixing runs at real-time pace without output
+    uint32_t sampleRate = 0;
+    int blockFrames = 0;
+    int activeVoices = 0;
+    uint64_t blocks = 0;
+    uint64_t voicesStarted = 0;
+    uint64_t underruns = 0;         // The device ran out of queued blocks
+    double lastMixUs = 0.0;         // Whole block, limiter included
+    double avgMixUs = 0.0;
+    double maxMixUs = 0.0;
+    bool limiterEnabled = false;
+    int limiterLatencyFrames = 0;
+    double avgLimiterUs = 0.0;
+    double maxLimiterUs = 0.0;
+    float limiterReductionDb = 0.0f;    // Deepest gain reduction of the last block
+    bool duckingEnabled = false;
+    float duckingGainDb = 0.0f;     // Current gain of the effects bus
+    double avgDuckingUs = 0.0;      // Per block that had effects voices
+    double maxDuckingUs = 0.0;
+    double avgCompactUs = 0.0;      // Voices in a compact resident format, decode and mix, per block that had any
+    double maxCompactUs = 0.0;
+    AnthemStreamStats streaming;
+};
+
+// Stereo float mixer and output thread. Play()/StopVoice() queue commands and never wait for the mixer; the mixer only try-locks
+// the command queue, so the game thread can never stall the audio. Finished voices hand their anthem reference back to the caller's
+// thread (released on the next command), so the audio thread never frees decoded samples. Streamed clips are filled by the engine's
+// I/O thread; a voice that runs out of streamed frames waits for them and counts an underrun.
+// Output: waveOut on Windows; elsewhere, or when no device opens, blocks are mixed at real-time pace and discarded.
+class AudioEngine
+{
+public:
+    static constexpr int maxVoices = 8;
+
+    AudioEngine();
+    ~AudioEngine();
+
+    AudioEngine(const AudioEngine&) = delete;
+    AudioEngine& operator=(const AudioEngine&) = delete;
+
+    // Returns whether an output device was opened; the engine runs either way
+    bool Start(uint32_t sampleRate = 48000, int blockFrames = 480);
+    void Stop();
+
+    // Returns a voice id (> 0), or 0 if the clip is empty. A streamed clip starts reading ahead right away.
+    int Play(const AnthemClip& clip);
+    void StopVoice(int id, float fadeSeconds = 0.05f);
+    void StopAll(float fadeSeconds = 0.05f);
+
+    // Position of a playing voice in seconds from the start of its anthem, or -1 once it has finished
+    double GetVoicePosition(int id) const;
+    // Moves a playing voice to 'seconds' from the start of its anthem (clamped to its clip), exact to the source frame, with a short
+    // fade-in. Takes effect at the next block. Only a pointer moves: nothing is allocated or decoded again. Streamed voices ignore it.
+    void SeekVoice(int id, double seconds);
+
+    // Master bus limiter, picked up by the next block
+    void SetLimiter(bool enabled, float ceilingDb, float releaseMs);
+    // Ducking of the effects bus under the anthem voices, queued like a command
+    void SetDucking(const DuckingParameters& parameters);
+
+    // Mixes 'frames' interleaved stereo frames into 'out' (overwritten). Called by the output thread, or directly for offline rendering.
+    void Render(float* out, int frames);
+
+    AudioEngineStats GetStats() const;
+
+private:
+    enum class CommandType { Play, Stop, StopAll, SetDucking, Seek };
+    struct Command
+    {
+        CommandType type = CommandType::Play;
+        int id = 0;
+        AnthemClip clip;
+        float fadeSeconds = 0.0f;
+        DuckingParameters ducking;
+        double seconds = 0.0;       // Seek target
+    };
+
+    // Owned by the mixer; 'position' and 'id' are mirrored in the atomics below for GetVoicePosition()
+    struct Voice
+    {
+        int id = 0;
+        AnthemClip clip;
+        double position = 0.0;      // Source frame
+        double step = 1.0;          // Source frames per output frame
+        double end = 0.0;
+        float release = 1.0f;       // Stop() ramp, 1 until stopped
+        float releaseStep = 0.0f;
+        float attack = 1.0f;        // Fade-in after a seek, 1 otherwise
+        float attackStep = 0.0f;
+        uint32_t sourceRate = 0;
+        bool finished = false;      // Waiting to hand its anthem back
+    };
+
+    void DrainCommands();
+    void Retire(Voice& voice);
+    // Mixes source frames from 'samples' (frame 'base' first) until the voice ends, returns the output frames mixed
+    int MixVoice(Voice& voice, const float* samples, size_t base, int channels, float* out, int frames);
+    void RenderVoice(Voice& voice, float* out, int frames);
+    void RenderCompactVoice(Voice& voice, float* out, int frames);
+    void RenderStreamVoice(Voice& voice, float* out, int frames);
+    void RunOutput(std::promise<bool> opened);
+
+    uint32_t sampleRate = 48000;
+    int blockFrames = 480;
+
+    mutable std::mutex commandMutex;
+    std::vector<Command> commands;
+    std::vector<AnthemClip> retired;    // Released by the next command, off the audio thread
+    int nextId = 1;
+    uint64_t voicesStarted = 0;
+
+    std::array<Voice, maxVoices> voices;
+    std::array<std::atomic<int>, maxVoices> voiceIds{};
+    std::array<std::atomic<double>, maxVoices> voicePositions{};
+
+    PeakLimiter limiter;            // Mixer only, after Start()
+    bool limiterActive = false;
+    std::atomic<bool> limiterEnabled{ true };
+    std::atomic<float> limiterCeilingDb{ -1.0f };
+    std::atomic<float> limiterReleaseMs{ 100.0f };
+    std::atomic<bool> limiterChanged{ true };
+
+    DuckingBus ducking;             // Mixer only
+    bool effectsActive = false;     // Mixer only, the last block had effects voices
+    std::vector<float> effectsBus;  // Sized by Start(), grown by Render() for larger offline blocks
+    static constexpr size_t compactChunkFrames = 2048;
+    std::vector<float> compactScratch;  // Decoded frames of one compact voice chunk
+    double compactUs = 0.0;         // Mixer only, this block
+    std::atomic<bool> duckingEnabled{ true };
+
+    AnthemStreamReader streamReader;
+
+    std::thread output;
+    std::atomic<bool> stopping{ false };
+    std::atomic<bool> deviceOpen{ false };
+
+    // Written by the mixer only
+    std::atomic<int> activeVoices{ 0 };
+    std::atomic<uint64_t> blocks{ 0 };
+    std::atomic<uint64_t> underruns{ 0 };
+    std::atomic<double> lastMixUs{ 0.0 };
+    std::atomic<double> avgMixUs{ 0.0 };
+    std::atomic<double> maxMixUs{ 0.0 };
+    std::atomic<double> avgLimiterUs{ 0.0 };
+    std::atomic<double> maxLimiterUs{ 0.0 };
+    std::atomic<float> limiterReductionDb{ 0.0f };
+    std::atomic<float> duckingGainDb{ 0.0f };
+    std::atomic<double> avgDuckingUs{ 0.0 };
+    std::atomic<double> maxDuckingUs{ 0.0 };
+    std::atomic<double> avgCompactUs{ 0.0 };
+    std::atomic<double> maxCompactUs{ 0.0 };
+    std::atomic<uint64_t> compactBlocks{ 0 };
+    std::atomic<uint64_t> duckingBlocks{ 0 };
+};
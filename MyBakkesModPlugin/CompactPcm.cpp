@@ -0,0 +1,343 @@
+#include "pch.h"
+#include "CompactPcm.h"
+#include "AudioEngine.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define COMPACT_SSE2 1
+#endif
+
+static const double pi = 3.14159265358979323846;
+static const float int16Scale = 1.0f / 32768.0f;
+
+// Per channel and block: 4 lane headers (int16 predictor, uint8 step index, 1 spare byte), then one 16-bit word per frame of a lane
+// holding the 4 lanes' nibbles (lane 0 in the low nibble)
+static const size_t adpcmHeaderBytes = CompactPcm::adpcmLanes * 4;
+static const size_t adpcmChannelBytes = adpcmHeaderBytes + CompactPcm::adpcmLaneFrames * 2;
+
+static const int32_t adpcmSteps[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45, 50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143,
+    157, 173, 190, 209, 230, 253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963, 1060, 1166, 1282, 1411, 1552,
+    1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487,
+    12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+static const int adpcmIndexAdjust[8] = { -1, -1, -1, -1, 2, 4, 6, 8 };
+
+const char* GetResidentFormatName(ResidentFormat format)
+{
+    switch (format) {
+    case ResidentFormat::Int16:
+        return "int16";
+    case ResidentFormat::Adpcm:
+        return "ADPCM";
+    default:
+        return "float";
+    }
+}
+
+static int16_t ToInt16(float sample)
+{
+    return (int16_t)std::clamp((int)std::lrint(sample * 32768.0f), -32768, 32767);
+}
+
+// One IMA-ADPCM step of the decoder, shared by the encoder so both stay in the same state
+static void AdpcmUpdate(int32_t& predictor, int32_t& index, int nibble)
+{
+    const int32_t step = adpcmSteps[index];
+    int32_t diff = step >> 3;
+    if (nibble & 4) {
+        diff += step;
+    }
+    if (nibble & 2) {
+        diff += step >> 1;
+    }
+    if (nibble & 1) {
+        diff += step >> 2;
+    }
+    predictor = std::clamp(nibble & 8 ? predictor - diff : predictor + diff, -32768, 32767);
+    index = std::clamp(index + adpcmIndexAdjust[nibble & 7], 0, 88);
+}
+
+static int AdpcmEncodeSample(int32_t& predictor, int32_t& index, int32_t sample)
+{
+    int32_t step = adpcmSteps[index];
+    int32_t diff = sample - predictor;
+    int nibble = 0;
+    if (diff < 0) {
+        nibble = 8;
+        diff = -diff;
+    }
+    for (int bit = 4; bit > 0; bit >>= 1) {
+        if (diff >= step) {
+            nibble |= bit;
+            diff -= step;
+        }
+        step >>= 1;
+    }
+    AdpcmUpdate(predictor, index, nibble);
+    return nibble;
+}
+
+void CompactPcm::Encode(ResidentFormat targetFormat, const float* samples, size_t frameCount, int sourceChannels)
+{
+    format = targetFormat;
+    frames = frameCount;
+    channels = std::min(sourceChannels, 2);
+    data.clear();
+
+    if (format == ResidentFormat::Int16) {
+        data.resize(frames * channels * sizeof(int16_t));
+        int16_t* out = (int16_t*)data.data();
+        for (size_t f = 0; f < frames; f++) {
+            for (int c = 0; c < channels; c++) {
+                out[f * channels + c] = ToInt16(samples[f * sourceChannels + c]);
+            }
+        }
+        return;
+    }
+
+    const size_t blocks = (frames + adpcmBlockFrames - 1) / adpcmBlockFrames;
+    data.assign(blocks * channels * adpcmChannelBytes, 0);
+    for (int c = 0; c < channels; c++) {
+        int32_t predictor = frames > 0 ? ToInt16(samples[c]) : 0;
+        int32_t index = 0;
+        for (size_t b = 0; b < blocks; b++) {
+            uint8_t* block = &data[(b * channels + c) * adpcmChannelBytes];
+            for (size_t lane = 0; lane < adpcmLanes; lane++) {
+                block[lane * 4] = (uint8_t)(predictor & 0xff);
+                block[lane * 4 + 1] = (uint8_t)((predictor >> 8) & 0xff);
+                block[lane * 4 + 2] = (uint8_t)index;
+                uint8_t* nibbles = block + adpcmHeaderBytes + lane / 2;
+                const int shift = (lane & 1) * 4;
+                for (size_t j = 0; j < adpcmLaneFrames; j++) {
+                    // The padding after the last frame repeats it
+                    const size_t f = std::min(b * adpcmBlockFrames + lane * adpcmLaneFrames + j, frames - 1);
+                    nibbles[j * 2] |= (uint8_t)(AdpcmEncodeSample(predictor, index, ToInt16(samples[f * sourceChannels + c])) << shift);
+                }
+            }
+        }
+    }
+}
+
+void CompactPcm::DecodeAdpcmBlock(size_t block, float* out, bool simd) const
+{
+    for (int c = 0; c < channels; c++) {
+        const uint8_t* header = &data[(block * channels + c) * adpcmChannelBytes];
+        const uint8_t* nibbles = header + adpcmHeaderBytes;
+        float* target = out + c;
+#ifdef COMPACT_SSE2
+        if (simd) {
+            // The 4 lanes side by side; only the step table lookup is done per lane
+            alignas(16) int32_t index[4];
+            alignas(16) float values[4];
+            for (int lane = 0; lane < 4; lane++) {
+                index[lane] = header[lane * 4 + 2];
+            }
+            __m128i predictor = _mm_setr_epi32((int16_t)(header[0] | header[1] << 8), (int16_t)(header[4] | header[5] << 8),
+                (int16_t)(header[8] | header[9] << 8), (int16_t)(header[12] | header[13] << 8));
+            __m128i indices = _mm_load_si128((const __m128i*)index);
+            const __m128i one = _mm_set1_epi32(1);
+            const __m128i two = _mm_set1_epi32(2);
+            const __m128i four = _mm_set1_epi32(4);
+            const __m128i seven = _mm_set1_epi32(7);
+            const __m128i eight = _mm_set1_epi32(8);
+            const __m128i six = _mm_set1_epi32(6);
+            const __m128i maxIndex = _mm_set1_epi32(88);
+            const __m128 scale = _mm_set1_ps(int16Scale);
+            const size_t laneStride = adpcmLaneFrames * channels;
+            for (size_t j = 0; j < adpcmLaneFrames; j++) {
+                const int word = nibbles[j * 2] | nibbles[j * 2 + 1] << 8;
+                const __m128i nibble = _mm_setr_epi32(word & 15, (word >> 4) & 15, (word >> 8) & 15, word >> 12);
+                const __m128i step = _mm_setr_epi32(adpcmSteps[index[0]], adpcmSteps[index[1]], adpcmSteps[index[2]], adpcmSteps[index[3]]);
+
+                __m128i diff = _mm_srai_epi32(step, 3);
+                diff = _mm_add_epi32(diff, _mm_and_si128(_mm_cmpeq_epi32(_mm_and_si128(nibble, four), four), step));
+                diff = _mm_add_epi32(diff, _mm_and_si128(_mm_cmpeq_epi32(_mm_and_si128(nibble, two), two), _mm_srai_epi32(step, 1)));
+                diff = _mm_add_epi32(diff, _mm_and_si128(_mm_cmpeq_epi32(_mm_and_si128(nibble, one), one), _mm_srai_epi32(step, 2)));
+                const __m128i negative = _mm_cmpeq_epi32(_mm_and_si128(nibble, eight), eight);
+                diff = _mm_sub_epi32(_mm_xor_si128(diff, negative), negative);
+                // Saturate to int16 and sign-extend back
+                const __m128i packed = _mm_packs_epi32(_mm_add_epi32(predictor, diff), _mm_setzero_si128());
+                predictor = _mm_srai_epi32(_mm_unpacklo_epi16(packed, packed), 16);
+
+                // Index adjustment: -1 for magnitudes 0-3, 2 * magnitude - 6 above. Values stay in int16 range, so the 16-bit min/max clamp.
+                const __m128i magnitude = _mm_and_si128(nibble, seven);
+                const __m128i small = _mm_cmplt_epi32(magnitude, four);
+                const __m128i adjust = _mm_or_si128(small, _mm_andnot_si128(small, _mm_sub_epi32(_mm_slli_epi32(magnitude, 1), six)));
+                indices = _mm_min_epi16(_mm_max_epi16(_mm_add_epi32(indices, adjust), _mm_setzero_si128()), maxIndex);
+                _mm_store_si128((__m128i*)index, indices);
+
+                _mm_store_ps(values, _mm_mul_ps(_mm_cvtepi32_ps(predictor), scale));
+                float* frame = target + j * channels;
+                frame[0] = values[0];
+                frame[laneStride] = values[1];
+                frame[laneStride * 2] = values[2];
+                frame[laneStride * 3] = values[3];
+            }
+            continue;
+        }
+#endif
+        for (size_t lane = 0; lane < adpcmLanes; lane++) {
+            int32_t predictor = (int16_t)(header[lane * 4] | header[lane * 4 + 1] << 8);
+            int32_t index = header[lane * 4 + 2];
+            const uint8_t* laneNibbles = nibbles + lane / 2;
+            const int shift = (lane & 1) * 4;
+            float* frame = target + lane * adpcmLaneFrames * channels;
+            for (size_t j = 0; j < adpcmLaneFrames; j++) {
+                AdpcmUpdate(predictor, index, (laneNibbles[j * 2] >> shift) & 15);
+                frame[j * channels] = predictor * int16Scale;
+            }
+        }
+    }
+}
+
+size_t CompactPcm::Decode(size_t first, size_t count, float* out, bool simd) const
+{
+    if (first >= frames || count == 0) {
+        return first;
+    }
+    count = std::min(count, frames - first);
+
+    if (format == ResidentFormat::Int16) {
+        const int16_t* in = (const int16_t*)data.data() + first * channels;
+        const size_t samples = count * channels;
+        size_t i = 0;
+#ifdef COMPACT_SSE2
+        if (simd) {
+            const __m128 scale = _mm_set1_ps(int16Scale);
+            for (; i + 8 <= samples; i += 8) {
+                const __m128i packed = _mm_loadu_si128((const __m128i*)(in + i));
+                const __m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(packed, packed), 16);
+                const __m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(packed, packed), 16);
+                _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(low), scale));
+                _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(high), scale));
+            }
+        }
+#endif
+        for (; i < samples; i++) {
+            out[i] = in[i] * int16Scale;
+        }
+        return first;
+    }
+
+    const size_t firstBlock = first / adpcmBlockFrames;
+    const size_t lastBlock = (first + count - 1) / adpcmBlockFrames;
+    for (size_t b = firstBlock; b <= lastBlock; b++) {
+        DecodeAdpcmBlock(b, out + (b - firstBlock) * adpcmBlockFrames * channels, simd);
+    }
+    return firstBlock * adpcmBlockFrames;
+}
+
+// Anthem-like test signal: a chord with a slow tremolo and a little noise, different for every 'seed'
+static std::vector<float> MakeBenchmarkAnthem(size_t frames, uint32_t sampleRate, int seed)
+{
+    std::vector<float> samples(frames * 2);
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> noise(-0.02f, 0.02f);
+    const double root = 110.0 * std::pow(2.0, (seed % 12) / 12.0);
+    for (size_t f = 0; f < frames; f++) {
+        const double t = (double)f / sampleRate;
+        const double chord = std::sin(2.0 * pi * root * t) + 0.6 * std::sin(2.0 * pi * root * 1.5 * t) + 0.4 * std::sin(2.0 * pi * root * 2.52 * t);
+        const float value = (float)(0.25 * chord * (0.75 + 0.25 * std::sin(2.0 * pi * 2.0 * t)));
+        samples[f * 2] = value + noise(rng);
+        samples[f * 2 + 1] = 0.9f * value + noise(rng);
+    }
+    return samples;
+}
+
+ResidentBenchmarkResult RunResidentBenchmark(double anthemSeconds, int blocks)
+{
+    using Clock = std::chrono::steady_clock;
+    ResidentBenchmarkResult result;
+    const uint32_t sampleRate = 48000;
+    const int blockFrames = 480;
+    const int restartBlocks = 100;      // New voices every second, so every resident anthem gets played
+    const int maxAnthems = ResidentBenchmarkResult::anthemCounts[2];
+    const size_t frames = std::max<size_t>((size_t)(anthemSeconds * sampleRate), CompactPcm::adpcmBlockFrames);
+    result.anthemSeconds = (double)frames / sampleRate;
+    result.blocks = std::max(blocks, 1);
+    const ResidentFormat formats[3] = { ResidentFormat::Float32, ResidentFormat::Int16, ResidentFormat::Adpcm };
+    std::vector<float> out((size_t)blockFrames * 2);
+
+    for (int fi = 0; fi < 3; fi++) {
+        ResidentBenchmarkResult::Format& entry = result.formats[fi];
+        entry.format = formats[fi];
+
+        // One format resident at a time, built the way the anthem cache builds it
+        std::vector<std::shared_ptr<const DecodedAnthem>> anthems;
+        for (int a = 0; a < maxAnthems; a++) {
+            auto anthem = std::make_shared<DecodedAnthem>();
+            anthem->sampleRate = sampleRate;
+            anthem->channels = 2;
+            anthem->samples = MakeBenchmarkAnthem(frames, sampleRate, a);
+            if (a == 0 && entry.format != ResidentFormat::Float32) {
+                // Quality against the float samples
+                CompactPcm compact;
+                compact.Encode(entry.format, anthem->samples.data(), frames, 2);
+                std::vector<float> decoded(CompactPcm::GetDecodeCapacity(frames) * 2);
+                const size_t base = compact.Decode(0, frames, decoded.data());
+                double signal = 0.0;
+                double noise = 0.0;
+                for (size_t i = 0; i < frames * 2; i++) {
+                    const double error = decoded[i + base * 2] - anthem->samples[i];
+                    signal += (double)anthem->samples[i] * anthem->samples[i];
+                    noise += error * error;
+                }
+                entry.snrDb = 10.0 * std::log10(signal / std::max(noise, 1e-20));
+
+                if (entry.format == ResidentFormat::Adpcm) {
+                    const double perMinute = 60.0 / result.anthemSeconds;
+                    for (int pass = 0; pass < 2; pass++) {
+                        auto start = Clock::now();
+                        for (size_t f = 0; f < frames; f += 2048) {
+                            compact.Decode(f, 2048, decoded.data(), pass == 0);
+                        }
+                        const double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count() * perMinute;
+                        (pass == 0 ? result.adpcmSimdMsPerMinute : result.adpcmScalarMsPerMinute) = ms;
+                    }
+                }
+            }
+            CompactAnthem(*anthem, entry.format);
+            anthems.push_back(std::move(anthem));
+        }
+
+        for (int ci = 0; ci < 3; ci++) {
+            const int count = ResidentBenchmarkResult::anthemCounts[ci];
+            for (int a = 0; a < count; a++) {
+                entry.bytes[ci] += anthems[a]->samples.size() * sizeof(float) + anthems[a]->compact.GetMemoryBytes();
+            }
+
+            AudioEngine engine;     // Not started: rendered here, as the output thread would
+            std::mt19937 rng(7);
+            double totalUs = 0.0;
+            double maxUs = 0.0;
+            for (int b = 0; b < result.blocks; b++) {
+                if (b % restartBlocks == 0) {
+                    engine.StopAll(0.0f);
+                    const int voices = std::min(count, AudioEngine::maxVoices);
+                    for (int v = 0; v < voices; v++) {
+                        AnthemClip clip = AnthemClip::FromSeconds(anthems[(b / restartBlocks * voices + v) % count], 0.0, 0.0, 0.0f);
+                        clip.offset = rng() % (frames / 2);
+                        clip.length = frames - clip.offset;
+                        clip.gain = 0.1f;
+                        engine.Play(clip);
+                    }
+                }
+                auto start = Clock::now();
+                engine.Render(out.data(), blockFrames);
+                const double us = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+                totalUs += us;
+                maxUs = std::max(maxUs, us);
+            }
+            entry.renderUsPerBlock[ci] = totalUs / result.blocks;
+            entry.maxRenderUs[ci] = maxUs;
+        }
+    }
+    return result;
+}
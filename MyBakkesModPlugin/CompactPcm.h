@@ -0,0 +1,72 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// How a decoded anthem is kept in memory. Float32 is what the decoders produce (about 11 MB per stereo minute at 48 kHz);
+// the compact formats are decoded by the mixer on the fly.
+enum class ResidentFormat
+{
+    Float32,
+    Int16,      // Half the size, lossless for 16-bit sources
+    Adpcm       // IMA-ADPCM, 4 bits per sample (a quarter of Int16)
+};
+
+const char* GetResidentFormatName(ResidentFormat format);
+
+// Samples of a decoded anthem in a compact resident format, stereo at most (the mixer drops the other channels anyway).
+// ADPCM is stored in blocks of 256 frames. Within a block, each channel is split into 4 lanes of 64 consecutive frames, each with its
+// own predictor and step index, so the 4 lanes decode side by side in one SSE2 register. The encoder runs through the lanes in order
+// and stores its state at the start of each one, so the result is the same as one continuous IMA-ADPCM stream.
+class CompactPcm
+{
+public:
+    static constexpr size_t adpcmLanes = 4;
+    static constexpr size_t adpcmLaneFrames = 64;
+    static constexpr size_t adpcmBlockFrames = adpcmLanes * adpcmLaneFrames;
+
+    // 'format' must not be Float32. 'samples' are interleaved with 'channels' channels.
+    void Encode(ResidentFormat format, const float* samples, size_t frames, int channels);
+
+    ResidentFormat GetFormat() const { return format; }
+    size_t GetFrameCount() const { return frames; }
+    int GetChannels() const { return channels; }
+    size_t GetMemoryBytes() const { return data.capacity(); }
+
+    // Frames a Decode() of 'count' frames may write: ADPCM decodes whole blocks
+    static size_t GetDecodeCapacity(size_t count) { return count + 2 * adpcmBlockFrames; }
+
+    // Decodes at least the frames [first, first + count) to interleaved float into 'out', which must hold GetDecodeCapacity(count)
+    // frames. Returns the frame written to out[0]: 'first' for Int16, the start of its block for ADPCM.
+    size_t Decode(size_t first, size_t count, float* out, bool simd = true) const;
+
+private:
+    void DecodeAdpcmBlock(size_t block, float* out, bool simd) const;
+
+    ResidentFormat format = ResidentFormat::Float32;
+    size_t frames = 0;
+    int channels = 0;
+    std::vector<uint8_t> data;      // int16 frames, or ADPCM blocks
+};
+
+// Memory and mixer cost of the resident formats with 1, 8 and 32 anthems resident (at most AudioEngine::maxVoices of them playing)
+struct ResidentBenchmarkResult
+{
+    struct Format
+    {
+        ResidentFormat format = ResidentFormat::Float32;
+        size_t bytes[3] = {};               // Samples held for 1, 8 and 32 anthems
+        double renderUsPerBlock[3] = {};    // Whole mixer callback per 480-frame block
+        double maxRenderUs[3] = {};
+        double snrDb = 0.0;                 // Against the float samples (Float32: 0)
+    };
+
+    static constexpr int anthemCounts[3] = { 1, 8, 32 };
+    double anthemSeconds = 0.0;
+    int blocks = 0;
+    Format formats[3];
+    double adpcmSimdMsPerMinute = 0.0;      // Decode of one stereo minute, SSE2 lanes
+    double adpcmScalarMsPerMinute = 0.0;
+};
+
+ResidentBenchmarkResult RunResidentBenchmark(double anthemSeconds, int blocks);
@@ -0,0 +1,177 @@
+#include "pch.h"
+#include "DuckingBus.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define DUCKING_SSE2 1
+#endif
+
+// Release of the envelope follower itself: bridges the gaps between notes so the hold only starts once the key really stops
+static const float envelopeReleaseMs = 50.0f;
+static const double pi = 3.14159265358979323846;
+
+void DuckingBus::Prepare(uint32_t rate)
+{
+    sampleRate = rate;
+    SetParameters(parameters);
+    Reset();
+}
+
+float DuckingBus::Coefficient(float ms, int frames) const
+{
+    return 1.0f - std::exp(-(float)frames / (std::max(ms, 0.1f) * 0.001f * sampleRate));
+}
+
+void DuckingBus::SetParameters(const DuckingParameters& value)
+{
+    parameters = value;
+    depth = std::pow(10.0f, std::min(parameters.depthDb, 0.0f) / 20.0f);
+    threshold = std::pow(10.0f, parameters.thresholdDb / 20.0f);
+    attackCoefficient = Coefficient(parameters.attackMs, controlFrames);
+    releaseCoefficient = Coefficient(parameters.releaseMs, controlFrames);
+    envelopeDecay = 1.0f - Coefficient(envelopeReleaseMs, controlFrames);
+    holdFrames = (int)std::lround(std::max(parameters.holdMs, 0.0f) * 0.001f * sampleRate);
+}
+
+void DuckingBus::Reset()
+{
+    envelope = 0.0f;
+    gain = 1.0f;
+    holdLeft = 0;
+}
+
+// out += bus * gain, the gain going linearly from 'from' (exclusive) to 'to' (reached on the last frame)
+static void MixRamp(const float* bus, float* out, int frames, float from, float to, bool simd)
+{
+    const float step = (to - from) / frames;
+    int i = 0;
+#ifdef DUCKING_SSE2
+    if (simd) {
+        __m128 g = _mm_setr_ps(from + step, from + step, from + 2.0f * step, from + 2.0f * step);
+        const __m128 increment = _mm_set1_ps(2.0f * step);
+        for (; i + 2 <= frames; i += 2) {
+            _mm_storeu_ps(out + i * 2, _mm_add_ps(_mm_loadu_ps(out + i * 2), _mm_mul_ps(_mm_loadu_ps(bus + i * 2), g)));
+            g = _mm_add_ps(g, increment);
+        }
+    }
+#endif
+    for (; i < frames; i++) {
+        const float g = from + step * (i + 1);
+        out[i * 2] += bus[i * 2] * g;
+        out[i * 2 + 1] += bus[i * 2 + 1] * g;
+    }
+}
+
+static float BlockPeak(const float* stereo, int frames, bool simd)
+{
+    float peak = 0.0f;
+    int i = 0;
+#ifdef DUCKING_SSE2
+    if (simd) {
+        const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+        __m128 m = _mm_setzero_ps();
+        for (; i + 2 <= frames; i += 2) {
+            m = _mm_max_ps(m, _mm_and_ps(_mm_loadu_ps(stereo + i * 2), absMask));
+        }
+        m = _mm_max_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(1, 0, 3, 2)));
+        m = _mm_max_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
+        peak = _mm_cvtss_f32(m);
+    }
+#endif
+    for (; i < frames; i++) {
+        peak = std::max(peak, std::max(std::fabs(stereo[i * 2]), std::fabs(stereo[i * 2 + 1])));
+    }
+    return peak;
+}
+
+void DuckingBus::Process(const float* key, const float* bus, float* out, int frames, bool simd)
+{
+    for (int start = 0; start < frames; start += controlFrames) {
+        const int n = std::min(controlFrames, frames - start);
+        const bool full = n == controlFrames;
+
+        const float peak = BlockPeak(key + start * 2, n, simd);
+        envelope = std::max(peak, envelope * (full ? envelopeDecay : 1.0f - Coefficient(envelopeReleaseMs, n)));
+
+        float target = 1.0f;
+        if (parameters.enabled) {
+            if (envelope >= threshold) {
+                holdLeft = holdFrames;
+                target = depth;
+            }
+            else if (holdLeft > 0) {
+                holdLeft -= n;
+                target = depth;
+            }
+        }
+
+        const bool attacking = target < gain;
+        const float coefficient = full ? (attacking ? attackCoefficient : releaseCoefficient)
+            : Coefficient(attacking ? parameters.attackMs : parameters.releaseMs, n);
+        const float from = gain;
+        gain += (target - gain) * coefficient;
+        if (std::fabs(gain - target) < 1e-5f) {
+            gain = target;  // Settle, so a constant gain is exactly 1 (or the depth)
+        }
+        if (bus) {
+            MixRamp(bus + start * 2, out + start * 2, n, from, gain, simd);
+        }
+    }
+}
+
+DuckingBenchmarkResult RunDuckingBenchmark(double audioSeconds, const DuckingParameters& parameters)
+{
+    DuckingBenchmarkResult result;
+    const uint32_t sampleRate = 48000;
+    const int blockFrames = 480;
+    result.blocks = std::max(1, (int)(audioSeconds * sampleRate / blockFrames));
+    const size_t frames = (size_t)result.blocks * blockFrames;
+
+    // Key: an anthem-like tone that plays 3 s out of every 6. Bus: a constant 1, so the output is the gain itself.
+    std::vector<float> key(frames * 2);
+    for (size_t f = 0; f < frames; f++) {
+        const bool playing = (f / sampleRate) % 6 >= 1 && (f / sampleRate) % 6 < 4;
+        key[f * 2] = key[f * 2 + 1] = playing ? 0.3f * (float)std::sin(2.0 * pi * 220.0 * f / sampleRate) : 0.0f;
+    }
+    const std::vector<float> bus((size_t)blockFrames * 2, 1.0f);
+    std::vector<float> out((size_t)blockFrames * 2);
+
+    for (int pass = 0; pass < 2; pass++) {
+        const bool simd = pass == 0;
+        DuckingBus ducking;
+        ducking.Prepare(sampleRate);
+        ducking.SetParameters(parameters);
+        double totalUs = 0.0;
+        float minGain = 1.0f;
+        float previous = 1.0f;
+        float maxStep = 0.0f;
+        for (int b = 0; b < result.blocks; b++) {
+            std::fill(out.begin(), out.end(), 0.0f);
+            auto start = std::chrono::steady_clock::now();
+            ducking.Process(key.data() + (size_t)b * blockFrames * 2, bus.data(), out.data(), blockFrames, simd);
+            totalUs += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+            if (simd) {
+                for (int i = 0; i < blockFrames; i++) {
+                    const float g = std::max(out[i * 2], 1e-6f);
+                    maxStep = std::max(maxStep, std::fabs(20.0f * std::log10(g / previous)));
+                    minGain = std::min(minGain, g);
+                    previous = g;
+                }
+            }
+        }
+        if (simd) {
+            result.simdUsPerBlock = totalUs / result.blocks;
+            result.duckedGainDb = 20.0f * std::log10(minGain);
+            result.maxStepDb = maxStep;
+        }
+        else {
+            result.scalarUsPerBlock = totalUs / result.blocks;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <cstdint>
+
+struct DuckingParameters
+{
+    bool enabled = true;
+    float depthDb = -12.0f;         // Gain of the ducked bus while the key signal is present
+    float thresholdDb = -40.0f;     // Key envelope level that starts the ducking
+    float attackMs = 20.0f;
+    float holdMs = 300.0f;          // Time the gain stays down after the key drops under the threshold
+    float releaseMs = 600.0f;
+};
+
+// Sidechain ducker: mixes an interleaved stereo bus into the output at a gain driven by a key signal (the anthem voices).
+// The key goes through a peak envelope follower once per control period (32 frames, SSE2 max of the absolute values). The gain then
+// follows an attack/hold/release envelope towards the ducking depth or unity, and is ramped linearly across every control period,
+// so it changes a little on every sample and never steps. The ramped gain and the mix into the output are done with SSE2.
+class DuckingBus
+{
+public:
+    static constexpr int controlFrames = 32;
+
+    void Prepare(uint32_t sampleRate);
+    void SetParameters(const DuckingParameters& parameters);
+    void Reset();
+
+    // out += bus * gain, the gain following 'key'. All three are interleaved stereo; 'key' may be 'out' (each control period is
+    // measured before it is mixed). 'bus' may be null: only the envelope advances.
+    // 'simd' false forces the scalar path, for the benchmark.
+    void Process(const float* key, const float* bus, float* out, int frames, bool simd = true);
+
+    float GetGain() const { return gain; }
+    float GetEnvelope() const { return envelope; }
+
+private:
+    float Coefficient(float ms, int frames) const;
+
+    uint32_t sampleRate = 48000;
+    DuckingParameters parameters;
+    float depth = 1.0f;             // Linear
+    float threshold = 0.0f;         // Linear
+    float attackCoefficient = 1.0f; // Per control period
+    float releaseCoefficient = 1.0f;
+    float envelopeDecay = 0.0f;     // Per control period, the follower's own release
+    int holdFrames = 0;
+
+    float envelope = 0.0f;
+    float gain = 1.0f;
+    int holdLeft = 0;
+};
+
+// Cost of the ducking bus per 480-frame block with and without SSE2, and the largest gain change between two samples
+struct DuckingBenchmarkResult
+{
+    int blocks = 0;
+    double simdUsPerBlock = 0.0;
+    double scalarUsPerBlock = 0.0;
+    float duckedGainDb = 0.0f;      // Gain reached while the key plays
+    float maxStepDb = 0.0f;         // Largest gain change between two consecutive samples
+};
+
+DuckingBenchmarkResult RunDuckingBenchmark(double audioSeconds, const DuckingParameters& parameters);
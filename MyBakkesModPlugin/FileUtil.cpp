@@ -0,0 +1,37 @@
+#include "pch.h"
+#include "FileUtil.h"
+
+#include <fstream>
+
+std::string PathToUtf8(const std::filesystem::path& path)
+{
+    std::u8string utf8 = path.u8string();
+    return std::string(utf8.begin(), utf8.end());
+}
+
+std::filesystem::path Utf8ToPath(const std::string& utf8)
+{
+    return std::filesystem::path(std::u8string(utf8.begin(), utf8.end()));
+}
+
+bool WriteFileAtomic(const std::filesystem::path& path, const std::string& contents)
+{
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+    std::filesystem::path temp = path;
+    temp += ".tmp";
+    std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+    file.write(contents.data(), (std::streamsize)contents.size());
+    // write() may only have filled the stream buffer: a full disk shows up when close() flushes it
+    file.close();
+    if (file.fail()) {
+        std::filesystem::remove(temp, ec);
+        return false;
+    }
+    std::filesystem::rename(temp, path, ec);
+    if (ec) {
+        std::filesystem::remove(temp, ec);
+        return false;
+    }
+    return true;
+}
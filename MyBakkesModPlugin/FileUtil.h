@@ -0,0 +1,12 @@
+#pragma once
+#include <filesystem>
+#include <string>
+
+// Paths are kept as UTF-8 strings in the plugin's lists and files
+std::string PathToUtf8(const std::filesystem::path& path);
+std::filesystem::path Utf8ToPath(const std::string& utf8);
+
+// Writes 'contents' to a temporary file next to 'path' and renames it over 'path', so a crash never leaves a partial file.
+// Creates the parent folders. Returns false if the write, the flush on close or the rename failed: 'path' is then left as it was
+// and the temporary file is removed.
+bool WriteFileAtomic(const std::filesystem::path& path, const std::string& contents);
@@ -0,0 +1,348 @@
+#include "pch.h"
+#include "FileWatcher.h"
+
+#include <algorithm>
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+FileWatcher::FileWatcher(Callback onChanges, int quietMs, int maxDelayMs)
+    : onChanges(std::move(onChanges)), quiet(quietMs), maxDelay(std::max(quietMs, maxDelayMs))
+{
+}
+
+FileWatcherStats FileWatcher::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return stats;
+}
+
+void FileWatcher::Start()
+{
+    thread = std::thread([this]() { Run(); });
+}
+
+void FileWatcher::Stop()
+{
+    stopping = true;
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+void FileWatcher::Push(FileChange::Kind kind, const std::filesystem::path& path)
+{
+    auto now = std::chrono::steady_clock::now();
+    if (pending.empty()) {
+        firstEvent = now;
+    }
+    lastEvent = now;
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        stats.rawEvents++;
+    }
+
+    // One entry per path: a file created and then written during the burst is still reported as added.
+    // Added/Modified/Removed only tell the consumer which paths to look at again, it checks what is on disk.
+    const std::filesystem::path::string_type& key = kind == FileChange::Kind::Overflow ? std::filesystem::path::string_type() : path.native();
+    auto found = pending.find(key);
+    if (found == pending.end()) {
+        pending.emplace(key, FileChange{ kind, path });
+        pendingOrder.push_back(key);
+    }
+    else if (!(found->second.kind == FileChange::Kind::Added && kind == FileChange::Kind::Modified)) {
+        found->second.kind = kind;
+    }
+}
+
+void FileWatcher::Flush()
+{
+    std::vector<FileChange> changes;
+    const bool overflow = pending.count(std::filesystem::path::string_type()) != 0;
+    if (overflow) {
+        // Per-path events are meaningless once some were dropped
+        changes.push_back(FileChange{ FileChange::Kind::Overflow, {} });
+    }
+    else {
+        changes.reserve(pendingOrder.size());
+        for (const auto& key : pendingOrder) {
+            changes.push_back(std::move(pending[key]));
+        }
+    }
+    pending.clear();
+    pendingOrder.clear();
+
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        stats.batches++;
+        stats.delivered += changes.size();
+        stats.overflows += overflow ? 1 : 0;
+    }
+    if (onChanges) {
+        onChanges(changes);
+    }
+}
+
+void FileWatcher::Run()
+{
+    using Clock = std::chrono::steady_clock;
+    while (!stopping) {
+        // Short waits so Stop() never waits long, shorter when a batch is due
+        int timeoutMs = 100;
+        Clock::time_point due;
+        if (!pending.empty()) {
+            due = std::min(lastEvent + quiet, firstEvent + maxDelay);
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(due - Clock::now()).count();
+            timeoutMs = (int)std::clamp<long long>(remaining, 0, 100);
+        }
+        WaitForEvents(timeoutMs);
+
+        if (!pending.empty() && Clock::now() >= std::min(lastEvent + quiet, firstEvent + maxDelay)) {
+            Flush();
+        }
+    }
+}
+
+#if defined(_WIN32)
+
+// One overlapped ReadDirectoryChangesW per folder, subtrees included
+class DirectoryChangesWatcher : public FileWatcher
+{
+public:
+    DirectoryChangesWatcher(Callback onChanges, int quietMs, int maxDelayMs) : FileWatcher(std::move(onChanges), quietMs, maxDelayMs) {}
+
+    ~DirectoryChangesWatcher() override
+    {
+        Stop();
+        for (auto& folder : folders) {
+            DWORD bytes = 0;
+            CancelIoEx(folder->directory, &folder->overlapped);
+            GetOverlappedResult(folder->directory, &folder->overlapped, &bytes, TRUE);
+            CloseHandle(folder->directory);
+            CloseHandle(folder->overlapped.hEvent);
+        }
+    }
+
+    bool Add(const std::filesystem::path& root)
+    {
+        auto folder = std::make_unique<Folder>();
+        folder->root = root;
+        folder->directory = CreateFileW(root.c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+            nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+        if (folder->directory == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+        folder->overlapped.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+        if (!Arm(*folder)) {
+            CloseHandle(folder->directory);
+            CloseHandle(folder->overlapped.hEvent);
+            return false;
+        }
+        folders.push_back(std::move(folder));
+        return true;
+    }
+
+    bool IsEmpty() const { return folders.empty(); }
+
+protected:
+    void WaitForEvents(int timeoutMs) override
+    {
+        HANDLE events[MAXIMUM_WAIT_OBJECTS];
+        DWORD count = (DWORD)std::min<size_t>(folders.size(), MAXIMUM_WAIT_OBJECTS);
+        for (DWORD i = 0; i < count; i++) {
+            events[i] = folders[i]->overlapped.hEvent;
+        }
+        DWORD result = WaitForMultipleObjects(count, events, FALSE, (DWORD)timeoutMs);
+        if (result < WAIT_OBJECT_0 || result >= WAIT_OBJECT_0 + count) {
+            return;
+        }
+
+        Folder& folder = *folders[result - WAIT_OBJECT_0];
+        DWORD bytes = 0;
+        BOOL ok = GetOverlappedResult(folder.directory, &folder.overlapped, &bytes, FALSE);
+        ResetEvent(folder.overlapped.hEvent);
+        if (!ok || bytes == 0) {
+            // The buffer overflowed (or the call failed): the changes are lost
+            Push(FileChange::Kind::Overflow, {});
+        }
+        else {
+            const BYTE* p = folder.buffer;
+            while (true) {
+                const FILE_NOTIFY_INFORMATION* info = (const FILE_NOTIFY_INFORMATION*)p;
+                std::filesystem::path path = folder.root / std::wstring(info->FileName, info->FileNameLength / sizeof(WCHAR));
+                switch (info->Action) {
+                case FILE_ACTION_ADDED:
+                case FILE_ACTION_RENAMED_NEW_NAME:
+                    Push(FileChange::Kind::Added, path);
+                    break;
+                case FILE_ACTION_REMOVED:
+                case FILE_ACTION_RENAMED_OLD_NAME:
+                    Push(FileChange::Kind::Removed, path);
+                    break;
+                default:
+                    Push(FileChange::Kind::Modified, path);
+                    break;
+                }
+                if (info->NextEntryOffset == 0) {
+                    break;
+                }
+                p += info->NextEntryOffset;
+            }
+        }
+        Arm(folder);
+    }
+
+private:
+    struct Folder
+    {
+        std::filesystem::path root;
+        HANDLE directory = INVALID_HANDLE_VALUE;
+        OVERLAPPED overlapped = {};
+        alignas(DWORD) BYTE buffer[64 * 1024];
+    };
+
+    static bool Arm(Folder& folder)
+    {
+        const DWORD filter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME | FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE;
+        return ReadDirectoryChangesW(folder.directory, folder.buffer, sizeof(folder.buffer), TRUE, filter, nullptr, &folder.overlapped, nullptr) != 0;
+    }
+
+    std::vector<std::unique_ptr<Folder>> folders;
+};
+
+std::unique_ptr<FileWatcher> FileWatcher::Create(const std::vector<std::filesystem::path>& folders, Callback onChanges, int quietMs, int maxDelayMs)
+{
+    auto watcher = std::make_unique<DirectoryChangesWatcher>(std::move(onChanges), quietMs, maxDelayMs);
+    for (const auto& folder : folders) {
+        watcher->Add(folder);
+    }
+    if (watcher->IsEmpty()) {
+        return nullptr;
+    }
+    watcher->Start();
+    return watcher;
+}
+
+#elif defined(__linux__)
+
+// inotify has no recursive mode: one watch per directory, added for new subdirectories as they appear
+class InotifyWatcher : public FileWatcher
+{
+public:
+    InotifyWatcher(Callback onChanges, int quietMs, int maxDelayMs)
+        : FileWatcher(std::move(onChanges), quietMs, maxDelayMs), fd(inotify_init1(IN_NONBLOCK | IN_CLOEXEC))
+    {
+    }
+
+    ~InotifyWatcher() override
+    {
+        Stop();
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+
+    void AddTree(const std::filesystem::path& root)
+    {
+        if (fd < 0 || !AddDirectory(root)) {
+            return;
+        }
+        std::error_code ec;
+        for (std::filesystem::recursive_directory_iterator it(root, std::filesystem::directory_options::skip_permission_denied, ec), end;
+            !ec && it != end; it.increment(ec)) {
+            if (it->is_directory(ec) && !it->is_symlink(ec)) {
+                AddDirectory(it->path());
+            }
+        }
+    }
+
+    bool IsEmpty() const { return watches.empty(); }
+
+protected:
+    void WaitForEvents(int timeoutMs) override
+    {
+        pollfd descriptor = { fd, POLLIN, 0 };
+        if (poll(&descriptor, 1, timeoutMs) <= 0) {
+            return;
+        }
+
+        alignas(inotify_event) char buffer[64 * 1024];
+        ssize_t length;
+        while ((length = read(fd, buffer, sizeof(buffer))) > 0) {
+            for (char* p = buffer; p < buffer + length; p += sizeof(inotify_event) + ((inotify_event*)p)->len) {
+                const inotify_event* event = (const inotify_event*)p;
+                if (event->mask & IN_Q_OVERFLOW) {
+                    Push(FileChange::Kind::Overflow, {});
+                    continue;
+                }
+                auto watch = watches.find(event->wd);
+                if (watch == watches.end()) {
+                    continue;
+                }
+                if (event->mask & IN_IGNORED) {
+                    watches.erase(watch);
+                    continue;
+                }
+                if (event->len == 0) {
+                    continue;   // Event on the watched directory itself, its parent reports it
+                }
+
+                std::filesystem::path path = watch->second / event->name;
+                if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                    if (event->mask & IN_ISDIR) {
+                        AddTree(path);
+                    }
+                    Push(FileChange::Kind::Added, path);
+                }
+                else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                    Push(FileChange::Kind::Removed, path);
+                }
+                else {
+                    Push(FileChange::Kind::Modified, path);
+                }
+            }
+        }
+    }
+
+private:
+    bool AddDirectory(const std::filesystem::path& directory)
+    {
+        const uint32_t mask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_CLOSE_WRITE | IN_MODIFY | IN_ONLYDIR;
+        int wd = inotify_add_watch(fd, directory.c_str(), mask);
+        if (wd < 0) {
+            return false;
+        }
+        watches[wd] = directory;
+        return true;
+    }
+
+    int fd;
+    std::unordered_map<int, std::filesystem::path> watches;
+};
+
+std::unique_ptr<FileWatcher> FileWatcher::Create(const std::vector<std::filesystem::path>& folders, Callback onChanges, int quietMs, int maxDelayMs)
+{
+    auto watcher = std::make_unique<InotifyWatcher>(std::move(onChanges), quietMs, maxDelayMs);
+    for (const auto& folder : folders) {
+        watcher->AddTree(folder);
+    }
+    if (watcher->IsEmpty()) {
+        return nullptr;
+    }
+    watcher->Start();
+    return watcher;
+}
+
+#else
+
+std::unique_ptr<FileWatcher> FileWatcher::Create(const std::vector<std::filesystem::path>&, Callback, int, int)
+{
+    return nullptr;
+}
+
+#endif
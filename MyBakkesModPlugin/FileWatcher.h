@@ -0,0 +1,73 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+struct FileChange
+{
+    enum class Kind { Added, Modified, Removed, Overflow };    // Overflow: events were dropped, the folders need a full rescan
+
+    Kind kind = Kind::Modified;
+    std::filesystem::path path;
+};
+
+struct FileWatcherStats
+{
+    uint64_t rawEvents = 0;         // Events reported by the OS
+    uint64_t batches = 0;           // Coalesced batches delivered
+    uint64_t delivered = 0;         // Changes delivered (one per path per batch)
+    uint64_t overflows = 0;
+};
+
+// Recursive change notifications for a set of folders, delivered in coalesced batches on the watcher thread.
+// Editors and copy tools touch a file many times in a row (create, several writes, attribute updates): events are merged per path
+// and delivered once no new event arrived for 'quietMs', or at the latest 'maxDelayMs' after the first event of a burst.
+// Backends: ReadDirectoryChangesW on Windows, inotify on Linux. Create() returns nullptr elsewhere or when nothing can be watched.
+class FileWatcher
+{
+public:
+    using Callback = std::function<void(const std::vector<FileChange>& changes)>;
+
+    static std::unique_ptr<FileWatcher> Create(const std::vector<std::filesystem::path>& folders, Callback onChanges,
+        int quietMs = 250, int maxDelayMs = 2000);
+
+    virtual ~FileWatcher() = default;
+
+    FileWatcherStats GetStats() const;
+
+protected:
+    FileWatcher(Callback onChanges, int quietMs, int maxDelayMs);
+
+    // Implemented by the backends: wait up to 'timeoutMs' for OS events and report them with Push()
+    virtual void WaitForEvents(int timeoutMs) = 0;
+
+    void Push(FileChange::Kind kind, const std::filesystem::path& path);
+    void Start();
+    void Stop();    // Backends call it first thing in their destructor, before their handles go away
+
+private:
+    void Run();
+    void Flush();
+
+    Callback onChanges;
+    std::chrono::milliseconds quiet;
+    std::chrono::milliseconds maxDelay;
+
+    // Only touched by the watcher thread
+    std::unordered_map<std::filesystem::path::string_type, FileChange> pending;
+    std::vector<std::filesystem::path::string_type> pendingOrder;
+    std::chrono::steady_clock::time_point firstEvent;
+    std::chrono::steady_clock::time_point lastEvent;
+
+    std::thread thread;
+    std::atomic<bool> stopping{ false };
+    mutable std::mutex statsMutex;
+    FileWatcherStats stats;
+};
@@ -0,0 +1,628 @@
+#include "pch.h"
+#include "AudioDecoder.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+// MSB-first bit reader over the file. The cache holds up to 64 bits, left-aligned; bytes past the end of the file read as zero,
+// and Overrun() tells when any of them was consumed, so a truncated frame fails instead of looping.
+class FlacBitReader
+{
+public:
+    explicit FlacBitReader(FileReader& reader) : reader(reader) {}
+
+    void Reset(uint64_t offset)
+    {
+        reader.Seek(offset);
+        fetched = offset;
+        cache = 0;
+        bits = 0;
+    }
+
+    // Byte offset of the next unread bit, rounded down
+    uint64_t Tell() const { return fetched - bits / 8; }
+    bool Overrun() const { return fetched * 8 - (uint64_t)bits > reader.GetSize() * 8; }
+
+    uint32_t Read(int n)
+    {
+        if (n == 0) {
+            return 0;
+        }
+        if (bits < n) {
+            Refill();
+        }
+        const uint32_t value = (uint32_t)(cache >> (64 - n));
+        Skip(n);
+        return value;
+    }
+
+    int32_t ReadSigned(int n)
+    {
+        if (n == 0) {
+            return 0;
+        }
+        return (int32_t)(Read(n) << (32 - n)) >> (32 - n);
+    }
+
+    // Zeros before the next 1 bit, which is consumed
+    uint32_t ReadUnary()
+    {
+        uint32_t zeros = 0;
+        for (;;) {
+            if (bits == 0) {
+                Refill();
+                if (Overrun()) {
+                    return zeros;
+                }
+            }
+            if (cache != 0) {
+                const int lz = std::countl_zero(cache);
+                if (lz < bits) {
+                    Skip(lz + 1);
+                    return zeros + lz;
+                }
+            }
+            zeros += bits;
+            cache = 0;
+            bits = 0;
+        }
+    }
+
+    void AlignToByte() { Skip(bits % 8); }
+
+private:
+    void Skip(int n)
+    {
+        cache = n == 64 ? 0 : cache << n;
+        bits -= n;
+    }
+
+    void Refill()
+    {
+        while (bits <= 56) {
+            uint8_t byte = 0;
+            reader.ReadByte(byte);
+            cache |= (uint64_t)byte << (56 - bits);
+            bits += 8;
+            fetched++;
+        }
+    }
+
+    FileReader& reader;
+    uint64_t cache = 0;
+    int bits = 0;
+    uint64_t fetched = 0;       // File offset of the next byte to load into the cache
+};
+
+struct FlacStreamInfo
+{
+    uint32_t minBlockSize = 0;
+    uint32_t maxBlockSize = 0;
+    uint32_t sampleRate = 0;
+    uint16_t channels = 0;
+    uint16_t bitsPerSample = 0;
+    uint64_t totalSamples = 0;
+    uint64_t firstFrame = 0;        // File offset of the first audio frame
+    std::vector<std::pair<uint64_t, uint64_t>> seekPoints;      // (sample, offset from firstFrame), ascending
+};
+
+static uint32_t ReadBigEndian(const uint8_t* p, int bytes)
+{
+    uint32_t value = 0;
+    for (int i = 0; i < bytes; i++) {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+// "fLaC", STREAMINFO and the optional SEEKTABLE; the other metadata blocks are skipped
+static bool ReadFlacMetadata(FileReader& reader, FlacStreamInfo& info)
+{
+    uint8_t magic[4];
+    if (reader.Read(magic, 4) != 4 || memcmp(magic, "fLaC", 4) != 0) {
+        return false;
+    }
+    bool haveStreamInfo = false;
+    for (;;) {
+        uint8_t header[4];
+        if (reader.Read(header, 4) != 4) {
+            return false;
+        }
+        const bool last = (header[0] & 0x80) != 0;
+        const int type = header[0] & 0x7F;
+        const uint32_t length = ReadBigEndian(header + 1, 3);
+        const uint64_t next = reader.Tell() + length;
+
+        if (type == 0 && length >= 34) {
+            uint8_t s[34];
+            if (reader.Read(s, 34) != 34) {
+                return false;
+            }
+            info.minBlockSize = ReadBigEndian(s, 2);
+            info.maxBlockSize = ReadBigEndian(s + 2, 2);
+            info.sampleRate = (ReadBigEndian(s + 10, 3) >> 4);
+            info.channels = (uint16_t)(((s[12] >> 1) & 0x07) + 1);
+            info.bitsPerSample = (uint16_t)((((s[12] & 0x01) << 4) | (s[13] >> 4)) + 1);
+            info.totalSamples = ((uint64_t)(s[13] & 0x0F) << 32) | ReadBigEndian(s + 14, 4);
+            haveStreamInfo = true;
+        }
+        else if (type == 3) {
+            std::vector<uint8_t> table(length);
+            if (reader.Read(table.data(), length) != length) {
+                return false;
+            }
+            for (uint32_t i = 0; i + 18 <= length; i += 18) {
+                const uint64_t sample = ((uint64_t)ReadBigEndian(&table[i], 4) << 32) | ReadBigEndian(&table[i + 4], 4);
+                const uint64_t offset = ((uint64_t)ReadBigEndian(&table[i + 8], 4) << 32) | ReadBigEndian(&table[i + 12], 4);
+                if (sample != ~0ull) {      // Placeholder points
+                    info.seekPoints.emplace_back(sample, offset);
+                }
+            }
+            std::sort(info.seekPoints.begin(), info.seekPoints.end());
+        }
+        if (!reader.Seek(next)) {
+            return false;
+        }
+        if (last) {
+            break;
+        }
+    }
+    info.firstFrame = reader.Tell();
+
+    // Streams of unknown length (totalSamples == 0, live encodes) are not supported: the library needs the duration up front
+    return haveStreamInfo && info.channels > 0 && info.sampleRate > 0 && info.totalSamples > 0 && info.maxBlockSize >= 16
+        && info.bitsPerSample >= 4 && info.bitsPerSample <= 32;
+}
+
+static void FillWavInfo(const FlacStreamInfo& stream, WavInfo& info)
+{
+    info.formatTag = formatTagFlac;
+    info.channels = stream.channels;
+    info.sampleRate = stream.sampleRate;
+    info.bitsPerSample = stream.bitsPerSample;
+    info.blockAlign = (uint16_t)(stream.channels * ((stream.bitsPerSample + 7) / 8));
+    info.dataOffset = 0;
+    info.dataBytes = (uint32_t)std::min<uint64_t>(stream.totalSamples * info.blockAlign, UINT32_MAX);
+}
+
+bool ProbeFlacHeader(const std::filesystem::path& path, WavInfo& info)
+{
+    FileReader reader;
+    FlacStreamInfo stream;
+    if (!reader.Open(path) || !ReadFlacMetadata(reader, stream)) {
+        return false;
+    }
+    FillWavInfo(stream, info);
+    return true;
+}
+
+static uint8_t Crc8(const uint8_t* data, size_t size)
+{
+    uint8_t crc = 0;
+    for (size_t i = 0; i < size; i++) {
+        crc ^= data[i];
+        for (int b = 0; b < 8; b++) {
+            crc = (uint8_t)((crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1);
+        }
+    }
+    return crc;
+}
+
+class FlacDecoder : public AudioDecoder
+{
+public:
+    FlacDecoder() : bits(reader) {}
+
+    bool Open(const std::filesystem::path& path)
+    {
+        if (!reader.Open(path) || !ReadFlacMetadata(reader, stream)) {
+            return false;
+        }
+        FillWavInfo(stream, info);
+        frames = stream.totalSamples;
+        block.resize((size_t)stream.maxBlockSize * stream.channels);
+        residual.resize(stream.maxBlockSize);
+        bits.Reset(stream.firstFrame);
+        return true;
+    }
+
+    size_t Read(float* out, size_t count) override
+    {
+        size_t done = 0;
+        while (done < count && position < frames) {
+            if (blockPosition == blockLength && !DecodeFrame()) {
+                break;
+            }
+            const size_t n = std::min<uint64_t>({ count - done, blockLength - blockPosition, frames - position });
+            const int channels = stream.channels;
+            for (size_t f = 0; f < n; f++) {
+                for (int c = 0; c < channels; c++) {
+                    out[(done + f) * channels + c] = block[(size_t)c * stream.maxBlockSize + blockPosition + f] * scale;
+                }
+            }
+            blockPosition += (uint32_t)n;
+            position += n;
+            done += n;
+        }
+        return done;
+    }
+
+    bool Seek(uint64_t frame) override
+    {
+        frame = std::min(frame, frames);
+        if (frame >= blockStart && frame < blockStart + blockLength) {
+            blockPosition = (uint32_t)(frame - blockStart);      // Inside the decoded frame
+            position = frame;
+            return true;
+        }
+        if (frame == frames) {
+            blockLength = blockPosition = 0;
+            position = frames;
+            return true;
+        }
+
+        // Start at the last frame at or before the target, then decode forward to the frame that holds it
+        uint64_t offset = stream.firstFrame;
+        auto point = std::upper_bound(stream.seekPoints.begin(), stream.seekPoints.end(), std::pair<uint64_t, uint64_t>(frame, ~0ull));
+        if (point != stream.seekPoints.begin()) {
+            offset = stream.firstFrame + std::prev(point)->second;
+        }
+        if (frame >= (uint64_t)stream.maxBlockSize * 4) {
+            offset = std::max(offset, BisectFrame(std::max(offset, stream.firstFrame), frame));
+        }
+
+        bits.Reset(offset);
+        blockLength = blockPosition = 0;
+        for (;;) {
+            if (!DecodeFrame()) {
+                position = frames;
+                return false;
+            }
+            if (frame < blockStart + blockLength) {
+                break;
+            }
+        }
+        blockPosition = (uint32_t)(frame > blockStart ? frame - blockStart : 0);
+        position = blockStart + blockPosition;
+        return true;
+    }
+
+    size_t GetMemoryBytes() const override
+    {
+        return 64 * 1024 + block.capacity() * sizeof(int32_t) + residual.capacity() * sizeof(int32_t);
+    }
+
+private:
+    struct FrameHeader
+    {
+        uint32_t blockSize = 0;
+        int channelAssignment = 0;      // 0-7: independent channels, 8: left/side, 9: side/right, 10: mid/side
+        int bitsPerSample = 0;
+        uint64_t firstSample = 0;
+    };
+
+    // Parses and checks (CRC-8) the frame header at the bit reader's position, which must be byte-aligned
+    bool ReadFrameHeader(FrameHeader& header)
+    {
+        uint8_t raw[16];
+        int size = 0;
+        auto next = [&]() { return raw[size++] = (uint8_t)bits.Read(8); };
+
+        if (next() != 0xFF || (next() & 0xFE) != 0xF8) {
+            return false;
+        }
+        const bool variableBlocks = (raw[1] & 0x01) != 0;
+        const uint8_t codes = next();
+        const uint8_t format = next();
+        const int blockCode = codes >> 4;
+        const int rateCode = codes & 0x0F;
+        header.channelAssignment = format >> 4;
+        const int sizeCode = (format >> 1) & 0x07;
+        if (blockCode == 0 || rateCode == 15 || header.channelAssignment > 10 || sizeCode == 3 || (format & 0x01)) {
+            return false;
+        }
+
+        // Frame or sample number, UTF-8 style
+        uint64_t number = next();
+        int extra = 0;
+        if (number >= 0x80) {
+            if (number >= 0xFE || (number & 0xC0) == 0x80) {
+                return false;
+            }
+            extra = std::countl_one((uint8_t)number) - 1;
+            number &= 0x3F >> extra;
+            for (int i = 0; i < extra; i++) {
+                const uint8_t byte = next();
+                if ((byte & 0xC0) != 0x80) {
+                    return false;
+                }
+                number = (number << 6) | (byte & 0x3F);
+            }
+        }
+
+        if (blockCode == 1) {
+            header.blockSize = 192;
+        }
+        else if (blockCode <= 5) {
+            header.blockSize = 576u << (blockCode - 2);
+        }
+        else if (blockCode == 6) {
+            header.blockSize = next() + 1u;
+        }
+        else if (blockCode == 7) {
+            header.blockSize = (next() << 8);
+            header.blockSize = (header.blockSize | next()) + 1u;
+        }
+        else {
+            header.blockSize = 256u << (blockCode - 8);
+        }
+        if (rateCode == 12) {
+            next();
+        }
+        else if (rateCode >= 13) {
+            next();
+            next();
+        }
+
+        static const int sampleSizes[8] = { 0, 8, 12, 0, 16, 20, 24, 32 };
+        header.bitsPerSample = sizeCode == 0 ? stream.bitsPerSample : sampleSizes[sizeCode];
+        header.firstSample = variableBlocks ? number : number * stream.minBlockSize;
+
+        const uint8_t crc = (uint8_t)bits.Read(8);
+        return !bits.Overrun() && crc == Crc8(raw, size) && header.blockSize <= stream.maxBlockSize
+            && (header.channelAssignment >= 8 ? 2 : header.channelAssignment + 1) == stream.channels;
+    }
+
+    // Offset of a frame starting at or before 'target', found by bisecting the file on frame sync codes
+    uint64_t BisectFrame(uint64_t low, uint64_t target)
+    {
+        uint64_t high = reader.GetSize();
+        uint64_t best = low;
+        while (high - low > 16 * 1024) {
+            const uint64_t middle = low + (high - low) / 2;
+            uint64_t found = 0;
+            FrameHeader header;
+            if (!FindFrame(middle, std::min(high, middle + 256 * 1024), found, header)) {
+                high = middle;
+            }
+            else if (header.firstSample <= target) {
+                best = found;
+                low = found + 1;
+            }
+            else {
+                high = middle;
+            }
+        }
+        return best;
+    }
+
+    // First valid frame header in [from, to)
+    bool FindFrame(uint64_t from, uint64_t to, uint64_t& offset, FrameHeader& header)
+    {
+        reader.Seek(from);
+        uint8_t previous = 0;
+        for (uint64_t at = from; at < to; at++) {
+            uint8_t byte;
+            if (!reader.ReadByte(byte)) {
+                return false;
+            }
+            if (previous == 0xFF && (byte & 0xFE) == 0xF8) {
+                bits.Reset(at - 1);
+                if (ReadFrameHeader(header) && header.firstSample < frames) {
+                    offset = at - 1;
+                    return true;
+                }
+                reader.Seek(at + 1);
+            }
+            previous = byte;
+        }
+        return false;
+    }
+
+    bool DecodeFrame()
+    {
+        FrameHeader header;
+        if (!ReadFrameHeader(header)) {
+            return false;
+        }
+        const uint32_t size = header.blockSize;
+        for (int c = 0; c < stream.channels; c++) {
+            // The side channel has one bit more
+            int sampleBits = header.bitsPerSample;
+            if ((header.channelAssignment == 8 && c == 1) || (header.channelAssignment == 9 && c == 0)
+                || (header.channelAssignment == 10 && c == 1)) {
+                sampleBits++;
+            }
+            if (sampleBits > 32 || !DecodeSubframe(&block[(size_t)c * stream.maxBlockSize], size, sampleBits)) {
+                return false;
+            }
+        }
+        bits.AlignToByte();
+        bits.Read(16);      // Frame CRC-16: a corrupt frame is played as decoded
+
+        if (header.channelAssignment >= 8) {
+            int32_t* left = &block[0];
+            int32_t* right = &block[stream.maxBlockSize];
+            for (uint32_t i = 0; i < size; i++) {
+                if (header.channelAssignment == 8) {
+                    right[i] = left[i] - right[i];
+                }
+                else if (header.channelAssignment == 9) {
+                    left[i] += right[i];
+                }
+                else {
+                    const int64_t side = right[i];
+                    const int64_t mid = ((int64_t)left[i] << 1) | (side & 1);
+                    left[i] = (int32_t)((mid + side) >> 1);
+                    right[i] = (int32_t)((mid - side) >> 1);
+                }
+            }
+        }
+
+        scale = 1.0f / (float)(1ull << (header.bitsPerSample - 1));
+        blockStart = header.firstSample;
+        blockLength = size;
+        blockPosition = 0;
+        return !bits.Overrun();
+    }
+
+    bool DecodeSubframe(int32_t* out, uint32_t size, int sampleBits)
+    {
+        if (bits.Read(1) != 0) {
+            return false;
+        }
+        const uint32_t type = bits.Read(6);
+        int wasted = 0;
+        if (bits.Read(1)) {
+            wasted = (int)bits.ReadUnary() + 1;
+            sampleBits -= wasted;
+            if (sampleBits <= 0) {
+                return false;
+            }
+        }
+
+        if (type == 0) {
+            std::fill(out, out + size, bits.ReadSigned(sampleBits));
+        }
+        else if (type == 1) {
+            for (uint32_t i = 0; i < size; i++) {
+                out[i] = bits.ReadSigned(sampleBits);
+            }
+        }
+        else if (type >= 8 && type <= 12) {
+            const uint32_t order = type - 8;
+            if (order > size) {
+                return false;
+            }
+            for (uint32_t i = 0; i < order; i++) {
+                out[i] = bits.ReadSigned(sampleBits);
+            }
+            if (!DecodeResidual(size, order)) {
+                return false;
+            }
+            const int32_t* r = residual.data();
+            switch (order) {
+            case 0:
+                std::copy(r, r + size, out);
+                break;
+            case 1:
+                for (uint32_t i = 1; i < size; i++) {
+                    out[i] = out[i - 1] + r[i];
+                }
+                break;
+            case 2:
+                for (uint32_t i = 2; i < size; i++) {
+                    out[i] = (int32_t)(2 * (int64_t)out[i - 1] - out[i - 2] + r[i]);
+                }
+                break;
+            case 3:
+                for (uint32_t i = 3; i < size; i++) {
+                    out[i] = (int32_t)(3 * ((int64_t)out[i - 1] - out[i - 2]) + out[i - 3] + r[i]);
+                }
+                break;
+            default:
+                for (uint32_t i = 4; i < size; i++) {
+                    out[i] = (int32_t)(4 * ((int64_t)out[i - 1] + out[i - 3]) - 6 * (int64_t)out[i - 2] - out[i - 4] + r[i]);
+                }
+                break;
+            }
+        }
+        else if (type >= 32) {
+            const uint32_t order = type - 31;
+            if (order > size) {
+                return false;
+            }
+            for (uint32_t i = 0; i < order; i++) {
+                out[i] = bits.ReadSigned(sampleBits);
+            }
+            const int precision = (int)bits.Read(4) + 1;
+            const int shift = bits.ReadSigned(5);
+            if (precision == 16 || shift < 0) {
+                return false;
+            }
+            int32_t coefficients[32];
+            for (uint32_t i = 0; i < order; i++) {
+                coefficients[i] = bits.ReadSigned(precision);
+            }
+            if (!DecodeResidual(size, order)) {
+                return false;
+            }
+            for (uint32_t i = order; i < size; i++) {
+                int64_t sum = 0;
+                for (uint32_t j = 0; j < order; j++) {
+                    sum += (int64_t)coefficients[j] * out[i - 1 - j];
+                }
+                out[i] = (int32_t)(residual[i] + (sum >> shift));
+            }
+        }
+        else {
+            return false;
+        }
+
+        if (wasted > 0) {
+            for (uint32_t i = 0; i < size; i++) {
+                out[i] = (int32_t)((uint32_t)out[i] << wasted);
+            }
+        }
+        return !bits.Overrun();
+    }
+
+    // Rice-coded residual of the samples [order, size), into residual[order...]
+    bool DecodeResidual(uint32_t size, uint32_t order)
+    {
+        const uint32_t method = bits.Read(2);
+        if (method > 1) {
+            return false;
+        }
+        const int parameterBits = method == 0 ? 4 : 5;
+        const uint32_t escape = method == 0 ? 15 : 31;
+        const uint32_t partitionOrder = bits.Read(4);
+        const uint32_t partitionSize = size >> partitionOrder;
+        if ((partitionSize << partitionOrder) != size || partitionSize < order) {
+            return false;
+        }
+
+        uint32_t i = order;
+        for (uint32_t p = 0; p < (1u << partitionOrder); p++) {
+            const uint32_t end = (p + 1) * partitionSize;
+            const uint32_t k = bits.Read(parameterBits);
+            if (k == escape) {
+                const int rawBits = (int)bits.Read(5);
+                for (; i < end; i++) {
+                    residual[i] = bits.ReadSigned(rawBits);
+                }
+            }
+            else {
+                for (; i < end; i++) {
+                    const uint32_t value = (bits.ReadUnary() << k) | bits.Read((int)k);
+                    residual[i] = (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+                }
+            }
+            if (bits.Overrun()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    FileReader reader;
+    FlacBitReader bits;
+    FlacStreamInfo stream;
+    std::vector<int32_t> block;         // The current frame, maxBlockSize samples per channel, planar
+    std::vector<int32_t> residual;
+    uint64_t blockStart = 0;            // First frame of 'block' in the file
+    uint32_t blockLength = 0;
+    uint32_t blockPosition = 0;         // Next frame of 'block' to output
+    uint64_t position = 0;
+    float scale = 1.0f;
+};
+
+std::unique_ptr<AudioDecoder> OpenFlacDecoder(const std::filesystem::path& path)
+{
+    auto decoder = std::make_unique<FlacDecoder>();
+    if (!decoder->Open(path)) {
+        return nullptr;
+    }
+    return decoder;
+}
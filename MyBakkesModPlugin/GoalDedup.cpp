@@ -0,0 +1,158 @@
+#include "pch.h"
+#include "GoalDedup.h"
+
+GoalDedup::GoalDedup(double windowSeconds)
+{
+    SetWindow(windowSeconds);
+}
+
+void GoalDedup::SetWindow(double seconds)
+{
+    window = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+}
+
+uint64_t GoalDedup::HashMatchId(const std::string& matchId)
+{
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : matchId) {
+        hash = (hash ^ c) * 1099511628211ull;
+    }
+    return hash;
+}
+
+bool GoalDedup::Accept(uint64_t match, int blueScore, int orangeScore, Clock::time_point now)
+{
+    for (const Entry& entry : ring) {
+        if (entry.used && entry.match == match && entry.scores[0] == blueScore && entry.scores[1] == orangeScore && now - entry.seen < window) {
+            dropped++;
+            return false;
+        }
+    }
+    // Overwrites the oldest goal
+    Entry& entry = ring[next];
+    entry.match = match;
+    entry.scores[0] = blueScore;
+    entry.scores[1] = orangeScore;
+    entry.seen = now;
+    entry.used = true;
+    next = (next + 1) % capacity;
+    accepted++;
+    return true;
+}
+
+void GoalDedup::Clear()
+{
+    ring = {};
+    next = 0;
+}
+
+namespace
+{
+    struct TraceEvent
+    {
+        uint64_t match;
+        int blue;
+        int orange;
+        int64_t ms;
+    };
+
+    int CountDropped(const std::vector<TraceEvent>& events)
+    {
+        GoalDedup dedup;
+        const GoalDedup::Clock::time_point start;
+        int dropped = 0;
+        for (const TraceEvent& event : events) {
+            dropped += dedup.Accept(event.match, event.blue, event.orange, start + std::chrono::milliseconds(event.ms)) ? 0 : 1;
+        }
+        return dropped;
+    }
+
+    // Goal i of a match: the teams take turns scoring
+    TraceEvent Goal(uint64_t match, int i, int64_t ms)
+    {
+        return { match, (i + 2) / 2, (i + 1) / 2, ms };
+    }
+}
+
+GoalDedupBenchmarkResult RunGoalDedupBenchmark(int events)
+{
+    GoalDedupBenchmarkResult result;
+    const uint64_t match = GoalDedup::HashMatchId("match-a");
+    const uint64_t other = GoalDedup::HashMatchId("match-b");
+    auto add = [&result](const char* name, const std::vector<TraceEvent>& trace, int expectedDropped) {
+        GoalDedupBenchmarkResult::Trace entry;
+        entry.name = name;
+        entry.events = (int)trace.size();
+        entry.expectedDropped = expectedDropped;
+        entry.dropped = CountDropped(trace);
+        result.traces.push_back(entry);
+    };
+
+    std::vector<TraceEvent> trace;
+    for (int i = 0; i < 10; i++) {
+        trace.push_back(Goal(match, i, i * 30000));
+    }
+    add("clean match", trace, 0);
+
+    trace.clear();
+    for (int i = 0; i < 10; i++) {
+        trace.push_back(Goal(match, i, i * 30000));
+        trace.push_back(Goal(match, i, i * 30000 + 1));
+    }
+    add("double fire", trace, 10);
+
+    trace.clear();
+    for (int i = 0; i < 5; i++) {
+        for (int repeat = 0; repeat < 5; repeat++) {
+            trace.push_back(Goal(match, i, i * 30000 + repeat * 100));
+        }
+    }
+    add("resync burst", trace, 20);
+
+    trace.clear();
+    for (int i = 0; i < 5; i++) {
+        trace.push_back(Goal(match, i, i * 30000));
+        trace.push_back(Goal(match, i, i * 30000 + 6000));    // Again when the goal replay ends
+    }
+    add("goal replay", trace, 5);
+
+    // Past the window the same key is a new goal: a rewatched replay plays its anthems again
+    trace = { Goal(match, 0, 0), Goal(match, 0, 12000) };
+    add("after window", trace, 0);
+
+    trace.clear();
+    for (int i = 0; i < 5; i++) {
+        trace.push_back(Goal(match, i, i * 1000));
+        trace.push_back(Goal(other, i, i * 1000 + 10));
+    }
+    add("two matches", trace, 0);
+
+    // The ring holds the last 16 goals: older ones are forgotten even within the window
+    trace.clear();
+    for (int i = 0; i < 20; i++) {
+        trace.push_back(Goal(match, i, i * 100));
+    }
+    for (int i = 19; i >= 4; i--) {
+        trace.push_back(Goal(match, i, 2000));
+    }
+    trace.push_back(Goal(match, 0, 2000));
+    add("ring overflow", trace, 16);
+
+    // Timed: every goal reported twice
+    GoalDedup dedup;
+    const GoalDedup::Clock::time_point start;
+    uint64_t sink = 0;
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < events; i++) {
+        const int goal = i / 2;
+        sink += dedup.Accept(match + goal / 64, goal % 64, goal % 7, start + std::chrono::milliseconds(goal * 10)) ? 1 : 0;
+    }
+    const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+    result.events = events;
+    result.nsPerEvent = events > 0 ? ns / events : 0.0;
+    if (sink != dedup.GetAccepted()) {
+        result.nsPerEvent = -1.0;   // Keeps the loop from being optimized out
+    }
+    return result;
+}
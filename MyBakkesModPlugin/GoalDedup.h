@@ -0,0 +1,60 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Drops repeated reports of the same goal (network resync, replay transitions). A goal is keyed by its match and the score after it,
+// which no later goal of the match can share; a key is remembered for 'window' after it was first seen, in a fixed ring of the last
+// 'capacity' goals. Accept() scans the ring: constant time, no allocation.
+class GoalDedup
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    static constexpr size_t capacity = 16;
+
+    explicit GoalDedup(double windowSeconds = 10.0);
+    void SetWindow(double seconds);
+
+    static uint64_t HashMatchId(const std::string& matchId);
+
+    // Returns true for a new goal (and remembers it), false for a goal already seen within the window
+    bool Accept(uint64_t match, int blueScore, int orangeScore, Clock::time_point now);
+    void Clear();
+
+    uint64_t GetAccepted() const { return accepted; }
+    uint64_t GetDropped() const { return dropped; }
+
+private:
+    struct Entry
+    {
+        uint64_t match = 0;
+        int32_t scores[2] = {};
+        Clock::time_point seen;
+        bool used = false;
+    };
+
+    std::array<Entry, capacity> ring;
+    size_t next = 0;
+    Clock::duration window;
+    uint64_t accepted = 0;
+    uint64_t dropped = 0;
+};
+
+// Synthetic goal event traces, each with the duplicates it should drop
+struct GoalDedupBenchmarkResult
+{
+    struct Trace
+    {
+        const char* name = "";
+        int events = 0;
+        int expectedDropped = 0;
+        int dropped = 0;
+    };
+    std::vector<Trace> traces;
+    int events = 0;                 // Timed run
+    double nsPerEvent = 0.0;
+};
+
+GoalDedupBenchmarkResult RunGoalDedupBenchmark(int events);
@@ -0,0 +1,36 @@
+#include "pch.h"
+#include "GoalReplay.h"
+
+bool GoalReplayTracker::Begin()
+{
+    if (active) {
+        dropped++;
+        return false;
+    }
+    active = true;
+    synced = false;
+    replays++;
+    return true;
+}
+
+void GoalReplayTracker::End()
+{
+    active = false;
+}
+
+bool GoalReplayTracker::TrySync(Clock::time_point now)
+{
+    if (!active) {
+        return false;
+    }
+    const bool debounced = everSynced && std::chrono::duration<double>(now - lastSync).count() < debounceSeconds;
+    if (synced || debounced) {
+        dropped++;
+        return false;
+    }
+    synced = true;
+    everSynced = true;
+    lastSync = now;
+    syncs++;
+    return true;
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+// What a goal replay does to the anthem of the goal
+enum class GoalReplayMode
+{
+    KeepPlaying,
+    Restart         // From the start of the clip, when the replay reaches the goal
+};
+
+// Goal replay state, from the replay playback start and end hooks. The game can fire those (and the goal moment inside the replay)
+// more than once per replay, so the anthem is re-synced at most once per replay and never twice within 'debounceSeconds'.
+class GoalReplayTracker
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    static constexpr double debounceSeconds = 1.0;
+
+    // Returns false if a replay is already in progress
+    bool Begin();
+    void End();
+    bool IsActive() const { return active; }
+
+    // Whether the anthem may be re-synced now. Counts the sync when it returns true.
+    bool TrySync(Clock::time_point now);
+
+    uint64_t GetReplays() const { return replays; }
+    uint64_t GetSyncs() const { return syncs; }
+    uint64_t GetDropped() const { return dropped; }     // Repeated starts and syncs that were debounced
+
+private:
+    bool active = false;
+    bool synced = false;            // This replay already re-synced the anthem
+    bool everSynced = false;
+    Clock::time_point lastSync;
+    uint64_t replays = 0;
+    uint64_t syncs = 0;
+    uint64_t dropped = 0;
+};
@@ -2710,14 +2710,17 @@ void ImFont::AddRemapChar(ImWchar dst, ImWchar src, bool overwrite_dst)
     IndexAdvanceX[dst] = (src < index_size) ? IndexAdvanceX.Data[src] : 1.0f;
 }
 
+ImFontGlyphMissHandler GImFontGlyphMissHandler = NULL;
+
 const ImFontGlyph* ImFont::FindGlyph(ImWchar c) const
 {
-    if (c >= IndexLookup.Size)
-        return FallbackGlyph;
-    const ImWchar i = IndexLookup.Data[c];
-    if (i == (ImWchar)-1)
+    if (c >= IndexLookup.Size || IndexLookup.Data[c] == (ImWchar)-1)
+    {
+        if (GImFontGlyphMissHandler)
+            GImFontGlyphMissHandler(this, c);
         return FallbackGlyph;
-    return &Glyphs.Data[i];
+    }
+    return &Glyphs.Data[IndexLookup.Data[c]];
 }
 
 const ImFontGlyph* ImFont::FindGlyphNoFallback(ImWchar c) const
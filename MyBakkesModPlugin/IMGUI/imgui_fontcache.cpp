@@ -0,0 +1,343 @@
+// dear imgui: on-disk cache for baked font atlases
+// See imgui_fontcache.h for usage.
+
+// File layout (native endianness, the file is a local cache and is never shared between machines):
+//   Header       magic, format version, IMGUI_VERSION_NUM, key, texture size, font count, custom rect count, TexUvScale, TexUvWhitePixel
+//   CustomRects  packed X, Y of every custom rect (the inputs are part of the key)
+//   Fonts        FontSize, Ascent, Descent, ConfigDataCount, EllipsisChar, MetricsTotalSurface, glyph count, ImFontGlyph[]
+//   Pixels       TexWidth * TexHeight alpha8 texels
+
+#include "pch.h"
+#include "imgui.h"
+#ifndef IMGUI_DEFINE_MATH_OPERATORS
+#define IMGUI_DEFINE_MATH_OPERATORS
+#endif
+#include "imgui_internal.h"
+#include "imgui_fontcache.h"
+
+#include <stdio.h>
+#include <chrono>
+
+static const ImU32  FONT_CACHE_MAGIC = 0x43414649; // "IFAC"
+static const ImU32  FONT_CACHE_VERSION = 1;
+
+static ImFontAtlasCacheProfile g_LastProfile;
+
+static double ImFontCache_ElapsedMs(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// FNV-1a, 64-bit
+static ImU64 ImFontCache_Hash(const void* data, size_t size, ImU64 seed)
+{
+    const unsigned char* p = (const unsigned char*)data;
+    ImU64 h = seed;
+    for (size_t i = 0; i < size; i++)
+    {
+        h ^= p[i];
+        h *= 0x100000001B3ULL;
+    }
+    return h;
+}
+
+template<typename T>
+static ImU64 ImFontCache_HashValue(const T& v, ImU64 seed) { return ImFontCache_Hash(&v, sizeof(T), seed); }
+
+static int ImFontCache_FindFontIndex(const ImFontAtlas* atlas, const ImFont* font)
+{
+    for (int i = 0; i < atlas->Fonts.Size; i++)
+        if (atlas->Fonts[i] == font)
+            return i;
+    return -1;
+}
+
+ImU64 ImFontAtlasCache_ComputeKey(ImFontAtlas* atlas)
+{
+    ImU64 h = 0xCBF29CE484222325ULL;
+    h = ImFontCache_HashValue(FONT_CACHE_VERSION, h);
+    h = ImFontCache_HashValue((int)IMGUI_VERSION_NUM, h);
+    h = ImFontCache_HashValue(atlas->Flags, h);
+    h = ImFontCache_HashValue(atlas->TexDesiredWidth, h);
+    h = ImFontCache_HashValue(atlas->TexGlyphPadding, h);
+    h = ImFontCache_HashValue(atlas->Fonts.Size, h);
+
+    for (int i = 0; i < atlas->ConfigData.Size; i++)
+    {
+        const ImFontConfig& cfg = atlas->ConfigData[i];
+        h = ImFontCache_Hash(cfg.FontData, (size_t)cfg.FontDataSize, h);
+        h = ImFontCache_HashValue(cfg.FontNo, h);
+        h = ImFontCache_HashValue(cfg.SizePixels, h);
+        h = ImFontCache_HashValue(cfg.OversampleH, h);
+        h = ImFontCache_HashValue(cfg.OversampleV, h);
+        h = ImFontCache_HashValue(cfg.PixelSnapH, h);
+        h = ImFontCache_HashValue(cfg.GlyphExtraSpacing, h);
+        h = ImFontCache_HashValue(cfg.GlyphOffset, h);
+        h = ImFontCache_HashValue(cfg.GlyphMinAdvanceX, h);
+        h = ImFontCache_HashValue(cfg.GlyphMaxAdvanceX, h);
+        h = ImFontCache_HashValue(cfg.MergeMode, h);
+        h = ImFontCache_HashValue(cfg.RasterizerFlags, h);
+        h = ImFontCache_HashValue(cfg.RasterizerMultiply, h);
+        h = ImFontCache_HashValue(cfg.EllipsisChar, h);
+        h = ImFontCache_HashValue(ImFontCache_FindFontIndex(atlas, cfg.DstFont), h);
+
+        // Glyph ranges are hashed by content, the same ranges table may live at another address next run
+        const ImWchar* ranges = cfg.GlyphRanges ? cfg.GlyphRanges : atlas->GetGlyphRangesDefault();
+        int ranges_count = 0;
+        while (ranges[ranges_count])
+            ranges_count++;
+        h = ImFontCache_Hash(ranges, (size_t)ranges_count * sizeof(ImWchar), h);
+        h = ImFontCache_HashValue(ranges_count, h);
+    }
+
+    for (int i = 0; i < atlas->CustomRects.Size; i++)
+    {
+        const ImFontAtlasCustomRect& r = atlas->CustomRects[i];
+        h = ImFontCache_HashValue(r.ID, h);
+        h = ImFontCache_HashValue(r.Width, h);
+        h = ImFontCache_HashValue(r.Height, h);
+        h = ImFontCache_HashValue(r.GlyphAdvanceX, h);
+        h = ImFontCache_HashValue(r.GlyphOffset, h);
+        h = ImFontCache_HashValue(ImFontCache_FindFontIndex(atlas, r.Font), h);
+    }
+    return h;
+}
+
+//-----------------------------------------------------------------------------
+// Reading / writing
+//-----------------------------------------------------------------------------
+
+struct ImFontCacheHeader
+{
+    ImU32   Magic;
+    ImU32   Version;
+    int     ImGuiVersion;
+    ImU64   Key;
+    int     TexWidth;
+    int     TexHeight;
+    int     FontCount;
+    int     CustomRectCount;
+    ImVec2  TexUvScale;
+    ImVec2  TexUvWhitePixel;
+};
+
+struct ImFontCacheFontHeader
+{
+    float   FontSize;
+    float   Ascent;
+    float   Descent;
+    int     ConfigDataCount;
+    ImWchar EllipsisChar;
+    int     MetricsTotalSurface;
+    int     GlyphCount;
+};
+
+static bool ImFontCache_Read(ImFileHandle f, void* dst, size_t size)    { return size == 0 || ImFileRead(dst, 1, (ImU64)size, f) == (ImU64)size; }
+static bool ImFontCache_Write(ImFileHandle f, const void* src, size_t size) { return size == 0 || ImFileWrite(src, 1, (ImU64)size, f) == (ImU64)size; }
+
+bool ImFontAtlasCache_Load(ImFontAtlas* atlas, const char* filename)
+{
+    IM_ASSERT(!atlas->Locked && "Cannot modify a locked ImFontAtlas between NewFrame() and EndFrame/Render()!");
+    if (filename == NULL || atlas->ConfigData.empty())
+        return false;
+
+    ImFileHandle f = ImFileOpen(filename, "rb");
+    if (f == NULL)
+        return false;
+
+    // Same preparation as ImFontAtlasBuildWithStbTruetype(), so the custom rect list matches the one that was baked
+    ImFontAtlasBuildRegisterDefaultCustomRects(atlas);
+
+    ImFontCacheHeader header;
+    bool ok = ImFontCache_Read(f, &header, sizeof(header))
+        && header.Magic == FONT_CACHE_MAGIC
+        && header.Version == FONT_CACHE_VERSION
+        && header.ImGuiVersion == IMGUI_VERSION_NUM
+        && header.Key == ImFontAtlasCache_ComputeKey(atlas)
+        && header.FontCount == atlas->Fonts.Size
+        && header.CustomRectCount == atlas->CustomRects.Size
+        && header.TexWidth > 0 && header.TexHeight > 0;
+
+    // Read everything into temporaries first, a truncated file must not leave the atlas half-filled
+    ImVector<unsigned short> rect_positions;
+    ImVector<ImFontCacheFontHeader> font_headers;
+    ImVector<ImFontGlyph> glyphs;        // Glyphs of all fonts, back to back
+    ImVector<int> glyph_offsets;
+    if (ok)
+    {
+        rect_positions.resize(header.CustomRectCount * 2);
+        ok = ImFontCache_Read(f, rect_positions.Data, (size_t)rect_positions.size_in_bytes());
+    }
+    if (ok)
+    {
+        font_headers.resize(header.FontCount);
+        glyph_offsets.resize(header.FontCount);
+        for (int i = 0; i < header.FontCount && ok; i++)
+        {
+            ok = ImFontCache_Read(f, &font_headers[i], sizeof(ImFontCacheFontHeader)) && font_headers[i].GlyphCount >= 0 && font_headers[i].GlyphCount < 0xFFFF;
+            if (ok)
+            {
+                glyph_offsets[i] = glyphs.Size;
+                glyphs.resize(glyphs.Size + font_headers[i].GlyphCount);
+                ok = ImFontCache_Read(f, glyphs.Data + glyph_offsets[i], (size_t)font_headers[i].GlyphCount * sizeof(ImFontGlyph));
+            }
+        }
+    }
+    unsigned char* pixels = NULL;
+    if (ok)
+    {
+        const size_t pixels_size = (size_t)header.TexWidth * header.TexHeight;
+        pixels = (unsigned char*)IM_ALLOC(pixels_size);
+        ok = ImFontCache_Read(f, pixels, pixels_size);
+    }
+    ImFileClose(f);
+    if (!ok)
+    {
+        if (pixels)
+            IM_FREE(pixels);
+        return false;
+    }
+
+    // Commit to the atlas
+    atlas->ClearTexData();
+    atlas->TexPixelsAlpha8 = pixels;
+    atlas->TexWidth = header.TexWidth;
+    atlas->TexHeight = header.TexHeight;
+    atlas->TexUvScale = header.TexUvScale;
+    atlas->TexUvWhitePixel = header.TexUvWhitePixel;
+    for (int i = 0; i < atlas->CustomRects.Size; i++)
+    {
+        atlas->CustomRects[i].X = rect_positions[i * 2 + 0];
+        atlas->CustomRects[i].Y = rect_positions[i * 2 + 1];
+    }
+
+    for (int i = 0; i < atlas->Fonts.Size; i++)
+    {
+        ImFont* font = atlas->Fonts[i];
+        const ImFontCacheFontHeader& fh = font_headers[i];
+        font->ClearOutputData();
+        font->ContainerAtlas = atlas;
+        font->FontSize = fh.FontSize;
+        font->Ascent = fh.Ascent;
+        font->Descent = fh.Descent;
+        font->ConfigDataCount = (short)fh.ConfigDataCount;
+        font->EllipsisChar = fh.EllipsisChar;
+        font->MetricsTotalSurface = fh.MetricsTotalSurface;
+        font->ConfigData = NULL;
+        for (int n = 0; n < atlas->ConfigData.Size && font->ConfigData == NULL; n++)
+            if (atlas->ConfigData[n].DstFont == font)
+                font->ConfigData = &atlas->ConfigData[n];
+        font->Glyphs.resize(fh.GlyphCount);
+        if (fh.GlyphCount > 0)
+            memcpy(font->Glyphs.Data, glyphs.Data + glyph_offsets[i], (size_t)fh.GlyphCount * sizeof(ImFontGlyph));
+        font->BuildLookupTable();
+    }
+    return true;
+}
+
+bool ImFontAtlasCache_Save(ImFontAtlas* atlas, const char* filename)
+{
+    if (filename == NULL || atlas->TexPixelsAlpha8 == NULL || atlas->TexWidth <= 0 || atlas->TexHeight <= 0)
+        return false;
+
+    ImGuiTextBuffer tmp_filename;
+    tmp_filename.appendf("%s.tmp", filename);
+    ImFileHandle f = ImFileOpen(tmp_filename.c_str(), "wb");
+    if (f == NULL)
+        return false;
+
+    ImFontCacheHeader header;
+    memset((void*)&header, 0, sizeof(header));
+    header.Magic = FONT_CACHE_MAGIC;
+    header.Version = FONT_CACHE_VERSION;
+    header.ImGuiVersion = IMGUI_VERSION_NUM;
+    header.Key = ImFontAtlasCache_ComputeKey(atlas);
+    header.TexWidth = atlas->TexWidth;
+    header.TexHeight = atlas->TexHeight;
+    header.FontCount = atlas->Fonts.Size;
+    header.CustomRectCount = atlas->CustomRects.Size;
+    header.TexUvScale = atlas->TexUvScale;
+    header.TexUvWhitePixel = atlas->TexUvWhitePixel;
+    bool ok = ImFontCache_Write(f, &header, sizeof(header));
+
+    for (int i = 0; i < atlas->CustomRects.Size && ok; i++)
+    {
+        const unsigned short pos[2] = { atlas->CustomRects[i].X, atlas->CustomRects[i].Y };
+        ok = ImFontCache_Write(f, pos, sizeof(pos));
+    }
+    for (int i = 0; i < atlas->Fonts.Size && ok; i++)
+    {
+        const ImFont* font = atlas->Fonts[i];
+        ImFontCacheFontHeader fh;
+        memset(&fh, 0, sizeof(fh));
+        fh.FontSize = font->FontSize;
+        fh.Ascent = font->Ascent;
+        fh.Descent = font->Descent;
+        fh.ConfigDataCount = font->ConfigDataCount;
+        fh.EllipsisChar = font->EllipsisChar;
+        fh.MetricsTotalSurface = font->MetricsTotalSurface;
+        fh.GlyphCount = font->Glyphs.Size;
+        ok = ImFontCache_Write(f, &fh, sizeof(fh)) && ImFontCache_Write(f, font->Glyphs.Data, (size_t)font->Glyphs.size_in_bytes());
+    }
+    if (ok)
+        ok = ImFontCache_Write(f, atlas->TexPixelsAlpha8, (size_t)atlas->TexWidth * atlas->TexHeight);
+    ok = ImFileClose(f) && ok;
+
+    // rename() does not replace an existing file on Windows
+    if (ok)
+    {
+        remove(filename);
+        ok = rename(tmp_filename.c_str(), filename) == 0;
+    }
+    if (!ok)
+        remove(tmp_filename.c_str());
+    return ok;
+}
+
+bool ImFontAtlasCache_LoadOrBuild(ImFontAtlas* atlas, const char* filename, ImFontAtlasCacheProfile* out_profile)
+{
+    typedef std::chrono::steady_clock Clock;
+    ImFontAtlasCacheProfile profile;
+
+    // Same default as GetTexDataAsAlpha8(), and it has to happen before hashing
+    if (atlas->ConfigData.empty())
+        atlas->AddFontDefault();
+
+    bool ok = false;
+    if (filename != NULL)
+    {
+        Clock::time_point start = Clock::now();
+        ImFontAtlasBuildRegisterDefaultCustomRects(atlas);
+        profile.Key = ImFontAtlasCache_ComputeKey(atlas);
+        profile.HashMs = ImFontCache_ElapsedMs(start);
+
+        start = Clock::now();
+        profile.CacheHit = ok = ImFontAtlasCache_Load(atlas, filename);
+        profile.LoadMs = ImFontCache_ElapsedMs(start);
+    }
+    if (!ok)
+    {
+        Clock::time_point start = Clock::now();
+        ok = atlas->Build();
+        profile.BakeMs = ImFontCache_ElapsedMs(start);
+
+        if (ok && filename != NULL)
+        {
+            start = Clock::now();
+            profile.CacheWritten = ImFontAtlasCache_Save(atlas, filename);
+            profile.SaveMs = ImFontCache_ElapsedMs(start);
+        }
+    }
+    profile.TexWidth = atlas->TexWidth;
+    profile.TexHeight = atlas->TexHeight;
+
+    g_LastProfile = profile;
+    if (out_profile)
+        *out_profile = profile;
+    return ok;
+}
+
+const ImFontAtlasCacheProfile& ImFontAtlasCache_GetLastProfile()
+{
+    return g_LastProfile;
+}
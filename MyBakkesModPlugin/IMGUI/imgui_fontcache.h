@@ -0,0 +1,47 @@
+// dear imgui: on-disk cache for baked font atlases
+// Baking an atlas rasterizes every glyph with stb_truetype and packs them with stb_rect_pack, which is the bulk of start-up time.
+// The cache stores the baked alpha8 texture plus the glyph tables, keyed by a hash of the font data, sizes, glyph ranges and build settings.
+// A hit turns the build into a file read; RGBA32 pixels are still expanded on demand by GetTexDataAsRGBA32().
+// In this plugin only the offscreen UI benchmark builds its atlas through the cache: BakkesMod bakes the overlay fonts itself.
+
+// Usage:
+//   io.Fonts->AddFontFromFileTTF(...);                                  // Register fonts as usual
+//   ImFontAtlasCache_LoadOrBuild(io.Fonts, "fonts.cache", &profile);    // Instead of io.Fonts->Build()
+
+// Changelog:
+// - v0.10: Initial version.
+
+#pragma once
+
+#include "imgui.h"
+
+// Timings of the last ImFontAtlasCache_LoadOrBuild() call, for start-up profiles.
+struct ImFontAtlasCacheProfile
+{
+    ImU64           Key;            // Hash of the atlas inputs
+    bool            CacheHit;       // Atlas was read from disk, nothing was rasterized
+    bool            CacheWritten;   // Atlas was baked and a new cache file was written
+    double          HashMs;         // Time spent hashing the font data and settings
+    double          LoadMs;         // Time spent reading the cache file (also counted on a miss/mismatch)
+    double          BakeMs;         // Time spent in ImFontAtlas::Build() (0 on a hit)
+    double          SaveMs;         // Time spent writing the cache file
+    int             TexWidth;
+    int             TexHeight;
+
+    ImFontAtlasCacheProfile()       { memset(this, 0, sizeof(*this)); }
+};
+
+// Hash of everything that affects the baked output: font bytes, sizes, glyph ranges, oversampling, atlas flags, custom rects.
+IMGUI_API ImU64     ImFontAtlasCache_ComputeKey(ImFontAtlas* atlas);
+
+// Fill a not-yet-built atlas from 'filename'. Fails (leaving the atlas untouched) when the file is missing, truncated or was baked from other inputs.
+IMGUI_API bool      ImFontAtlasCache_Load(ImFontAtlas* atlas, const char* filename);
+
+// Write a built atlas to 'filename'. The file is written next to the target and renamed over it, so readers never see a partial file.
+IMGUI_API bool      ImFontAtlasCache_Save(ImFontAtlas* atlas, const char* filename);
+
+// Load the atlas from 'filename', or Build() it and refresh the cache. 'filename' may be NULL to just Build() with timings.
+IMGUI_API bool      ImFontAtlasCache_LoadOrBuild(ImFontAtlas* atlas, const char* filename, ImFontAtlasCacheProfile* out_profile = NULL);
+
+// Profile of the most recent ImFontAtlasCache_LoadOrBuild() call in this process.
+IMGUI_API const ImFontAtlasCacheProfile& ImFontAtlasCache_GetLastProfile();
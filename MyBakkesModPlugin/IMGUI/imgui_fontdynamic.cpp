@@ -0,0 +1,483 @@
+// dear imgui: lazily rasterized glyphs for ImFontAtlas
+// See imgui_fontdynamic.h for usage.
+
+#include "pch.h"
+#include "imgui.h"
+#ifndef IMGUI_DEFINE_MATH_OPERATORS
+#define IMGUI_DEFINE_MATH_OPERATORS
+#endif
+#include "imgui_internal.h"
+#include "imgui_fontdynamic.h"
+
+#include <limits.h>
+#include <chrono>
+
+#ifdef _MSC_VER
+#pragma warning (disable: 4505) // unreferenced local function has been removed (stb stuff)
+#endif
+
+// Same stb configuration as imgui_draw.cpp. Both implementations are static, each translation unit gets its own copy.
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wtype-limits"
+#pragma GCC diagnostic ignored "-Wcast-qual"
+#pragma GCC diagnostic ignored "-Wunused-function"
+#endif
+
+#ifndef STB_RECT_PACK_IMPLEMENTATION
+#define STBRP_STATIC
+#define STBRP_ASSERT(x)     IM_ASSERT(x)
+#define STBRP_SORT          ImQsort
+#define STB_RECT_PACK_IMPLEMENTATION
+#include "imstb_rectpack.h"
+#endif
+
+#ifndef STB_TRUETYPE_IMPLEMENTATION
+#define STBTT_malloc(x,u)   ((void)(u), IM_ALLOC(x))
+#define STBTT_free(x,u)     ((void)(u), IM_FREE(x))
+#define STBTT_assert(x)     IM_ASSERT(x)
+#define STBTT_fmod(x,y)     ImFmod(x,y)
+#define STBTT_sqrt(x)       ImSqrt(x)
+#define STBTT_pow(x,y)      ImPow(x,y)
+#define STBTT_fabs(x)       ImFabs(x)
+#define STBTT_ifloor(x)     ((int)ImFloorStd(x))
+#define STBTT_iceil(x)      ((int)ImCeil(x))
+#define STBTT_STATIC
+#define STB_TRUETYPE_IMPLEMENTATION
+#include "imstb_truetype.h"
+#endif
+
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+
+static const int CODEPOINT_WORDS = (IM_UNICODE_CODEPOINT_MAX + 1) / 32;
+
+// One ImFontConfig (source TTF) of the atlas
+struct ImFontDynamicSource
+{
+    int                 ConfigIndex;
+    stbtt_fontinfo      FontInfo;
+    ImVector<ImU32>     Allowed;        // 1 bit per codepoint of the source's own glyph ranges
+};
+
+// One ImFont of the atlas (possibly merged from several sources)
+struct ImFontDynamicFont
+{
+    ImFont*             Font;
+    ImVector<int>       Sources;        // Indices into ImFontAtlasDynamicData::Sources, in ConfigData order (first match wins, like Build())
+    ImVector<ImU32>     Requested;      // 1 bit per codepoint, set when queued so a codepoint is only ever tried once
+    ImVector<ImWchar>   Pending;
+};
+
+struct ImFontAtlasDynamicData
+{
+    ImFontAtlas*                    Atlas;
+    ImVector<ImFontDynamicSource>   Sources;
+    ImVector<ImFontDynamicFont>     Fonts;
+    stbrp_context                   Packer;         // Skyline over the reserved rows, kept between updates
+    ImVector<stbrp_node>            PackerNodes;
+    int                             ReserveY;       // First reserved texture row
+    ImFontAtlasDynamicStats         Stats;
+
+    ImFontAtlasDynamicData()        { Atlas = NULL; memset(&Packer, 0, sizeof(Packer)); ReserveY = 0; }
+    ~ImFontAtlasDynamicData()
+    {
+        // ImVector doesn't honor destructors
+        for (int i = 0; i < Sources.Size; i++)
+            Sources[i].~ImFontDynamicSource();
+        for (int i = 0; i < Fonts.Size; i++)
+            Fonts[i].~ImFontDynamicFont();
+    }
+};
+
+static ImVector<ImFontAtlasDynamicData*> g_DynamicAtlases;
+
+static inline bool ImFontDynamic_TestBit(const ImVector<ImU32>& bits, unsigned int c) { return (bits.Data[c >> 5] & (1u << (c & 31))) != 0; }
+static inline void ImFontDynamic_SetBit(ImVector<ImU32>& bits, unsigned int c)        { bits.Data[c >> 5] |= 1u << (c & 31); }
+
+static ImFontAtlasDynamicData* ImFontDynamic_FindAtlas(const ImFontAtlas* atlas)
+{
+    for (int i = 0; i < g_DynamicAtlases.Size; i++)
+        if (g_DynamicAtlases[i]->Atlas == atlas)
+            return g_DynamicAtlases[i];
+    return NULL;
+}
+
+static ImFontDynamicFont* ImFontDynamic_FindFont(const ImFont* font, ImFontAtlasDynamicData** out_data)
+{
+    ImFontAtlasDynamicData* data = font->ContainerAtlas ? ImFontDynamic_FindAtlas(font->ContainerAtlas) : NULL;
+    if (data == NULL)
+        return NULL;
+    for (int i = 0; i < data->Fonts.Size; i++)
+        if (data->Fonts[i].Font == font)
+        {
+            *out_data = data;
+            return &data->Fonts[i];
+        }
+    return NULL;
+}
+
+static void ImFontDynamic_Queue(ImFontAtlasDynamicData* data, ImFontDynamicFont* dyn, ImWchar c)
+{
+    if (ImFontDynamic_TestBit(dyn->Requested, c))
+        return;
+    ImFontDynamic_SetBit(dyn->Requested, c);
+    dyn->Pending.push_back(c);
+    data->Stats.GlyphsPending++;
+}
+
+// Installed as GImFontGlyphMissHandler while at least one atlas is dynamic
+static void ImFontDynamic_OnGlyphMiss(const ImFont* font, ImWchar c)
+{
+    ImFontAtlasDynamicData* data = NULL;
+    if (ImFontDynamicFont* dyn = ImFontDynamic_FindFont(font, &data))
+        ImFontDynamic_Queue(data, dyn, c);
+}
+
+bool ImFontAtlasDynamic_Build(ImFontAtlas* atlas, const ImWchar* resident_ranges, int reserve_height)
+{
+    typedef std::chrono::steady_clock Clock;
+    IM_ASSERT(!atlas->Locked && "Cannot modify a locked ImFontAtlas between NewFrame() and EndFrame/Render()!");
+    IM_ASSERT(reserve_height > 0);
+    const Clock::time_point start = Clock::now();
+
+    ImFontAtlasDynamic_Shutdown(atlas);
+    if (atlas->ConfigData.empty())
+        atlas->AddFontDefault();
+    if (resident_ranges == NULL)
+        resident_ranges = atlas->GetGlyphRangesDefault();
+
+    ImFontAtlasDynamicData* data = IM_NEW(ImFontAtlasDynamicData)();
+    data->Atlas = atlas;
+    data->Sources.resize(atlas->ConfigData.Size);
+    memset((void*)data->Sources.Data, 0, (size_t)data->Sources.size_in_bytes());
+
+    // 1. Narrow every source to the resident codepoints it covers, the rest of its ranges becomes lazy.
+    //    A non-merged font whose ranges don't overlap the resident ranges at all is baked in full, it needs at least one glyph to be set up.
+    ImVector<const ImWchar*> user_ranges;
+    ImVector<ImWchar> resident_storage;
+    ImVector<int> resident_offsets;
+    user_ranges.resize(atlas->ConfigData.Size);
+    resident_offsets.resize(atlas->ConfigData.Size);
+    for (int src_i = 0; src_i < atlas->ConfigData.Size; src_i++)
+    {
+        ImFontConfig& cfg = atlas->ConfigData[src_i];
+        ImFontDynamicSource& src = data->Sources[src_i];
+        src.ConfigIndex = src_i;
+        src.Allowed.resize(CODEPOINT_WORDS, 0);
+        user_ranges[src_i] = cfg.GlyphRanges;
+        const ImWchar* src_ranges = cfg.GlyphRanges ? cfg.GlyphRanges : atlas->GetGlyphRangesDefault();
+        for (const ImWchar* r = src_ranges; r[0] && r[1]; r += 2)
+            for (unsigned int c = r[0]; c <= r[1]; c++)
+                ImFontDynamic_SetBit(src.Allowed, c);
+
+        resident_offsets[src_i] = resident_storage.Size;
+        for (const ImWchar* r = resident_ranges; r[0] && r[1]; r += 2)
+            for (unsigned int c = r[0]; c <= r[1]; c++)
+            {
+                if (!ImFontDynamic_TestBit(src.Allowed, c))
+                    continue;
+                if (resident_storage.Size > resident_offsets[src_i] && resident_storage.back() == c - 1)
+                    resident_storage.back() = (ImWchar)c;
+                else
+                {
+                    resident_storage.push_back((ImWchar)c);
+                    resident_storage.push_back((ImWchar)c);
+                }
+            }
+        if (resident_storage.Size == resident_offsets[src_i] && !cfg.MergeMode)
+            for (const ImWchar* r = src_ranges; r[0] && r[1]; r += 2)
+            {
+                resident_storage.push_back(r[0]);
+                resident_storage.push_back(r[1]);
+            }
+        resident_storage.push_back(0);
+    }
+    for (int src_i = 0; src_i < atlas->ConfigData.Size; src_i++)
+        atlas->ConfigData[src_i].GlyphRanges = &resident_storage[resident_offsets[src_i]];
+    const bool built = atlas->Build();
+    for (int src_i = 0; src_i < atlas->ConfigData.Size; src_i++)
+        atlas->ConfigData[src_i].GlyphRanges = user_ranges[src_i];
+    if (!built)
+    {
+        IM_DELETE(data);
+        return false;
+    }
+
+    // 2. Keep stb_truetype handles on the font data (owned by the atlas until ClearInputData())
+    for (int src_i = 0; src_i < data->Sources.Size; src_i++)
+    {
+        ImFontConfig& cfg = atlas->ConfigData[src_i];
+        const int font_offset = stbtt_GetFontOffsetForIndex((unsigned char*)cfg.FontData, cfg.FontNo);
+        if (font_offset < 0 || !stbtt_InitFont(&data->Sources[src_i].FontInfo, (unsigned char*)cfg.FontData, font_offset))
+            data->Sources[src_i].Allowed.clear();
+    }
+
+    data->Fonts.resize(atlas->Fonts.Size);
+    memset((void*)data->Fonts.Data, 0, (size_t)data->Fonts.size_in_bytes());
+    for (int font_i = 0; font_i < atlas->Fonts.Size; font_i++)
+    {
+        ImFontDynamicFont& dyn = data->Fonts[font_i];
+        dyn.Font = atlas->Fonts[font_i];
+        dyn.Requested.resize(CODEPOINT_WORDS, 0);
+        for (int src_i = 0; src_i < data->Sources.Size; src_i++)
+            if (atlas->ConfigData[src_i].DstFont == dyn.Font && !data->Sources[src_i].Allowed.empty())
+                dyn.Sources.push_back(src_i);
+        data->Stats.GlyphsResident += dyn.Font->Glyphs.Size;
+    }
+
+    // 3. Grow the texture by the reserved rows. UVs are normalized, so V coordinates baked so far are rescaled to the new height.
+    const int old_height = atlas->TexHeight;
+    int new_height = old_height + reserve_height;
+    if (!(atlas->Flags & ImFontAtlasFlags_NoPowerOfTwoHeight))
+        new_height = ImUpperPowerOfTwo(new_height);
+    unsigned char* pixels = (unsigned char*)IM_ALLOC((size_t)atlas->TexWidth * new_height);
+    memcpy(pixels, atlas->TexPixelsAlpha8, (size_t)atlas->TexWidth * old_height);
+    memset(pixels + (size_t)atlas->TexWidth * old_height, 0, (size_t)atlas->TexWidth * (new_height - old_height));
+    atlas->ClearTexData();
+    atlas->TexPixelsAlpha8 = pixels;
+    atlas->TexHeight = new_height;
+    atlas->TexUvScale.y = 1.0f / new_height;
+
+    const float v_scale = (float)old_height / (float)new_height;
+    atlas->TexUvWhitePixel.y *= v_scale;
+    for (int font_i = 0; font_i < atlas->Fonts.Size; font_i++)
+    {
+        ImFont* font = atlas->Fonts[font_i];
+        for (int glyph_i = 0; glyph_i < font->Glyphs.Size; glyph_i++)
+        {
+            font->Glyphs[glyph_i].V0 *= v_scale;
+            font->Glyphs[glyph_i].V1 *= v_scale;
+        }
+    }
+
+    data->ReserveY = old_height;
+    data->PackerNodes.resize(atlas->TexWidth);
+    stbrp_init_target(&data->Packer, atlas->TexWidth, new_height - old_height, data->PackerNodes.Data, data->PackerNodes.Size);
+
+    data->Stats.TexWidth = atlas->TexWidth;
+    data->Stats.TexHeight = atlas->TexHeight;
+    data->Stats.TexUsedHeight = old_height;
+    data->Stats.BuildMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    g_DynamicAtlases.push_back(data);
+    GImFontGlyphMissHandler = ImFontDynamic_OnGlyphMiss;
+    return true;
+}
+
+void ImFontAtlasDynamic_Shutdown(ImFontAtlas* atlas)
+{
+    for (int i = 0; i < g_DynamicAtlases.Size; i++)
+        if (g_DynamicAtlases[i]->Atlas == atlas)
+        {
+            IM_DELETE(g_DynamicAtlases[i]);
+            g_DynamicAtlases.erase(g_DynamicAtlases.Data + i);
+            break;
+        }
+    if (g_DynamicAtlases.empty())
+    {
+        g_DynamicAtlases.clear(); // Free the storage
+        GImFontGlyphMissHandler = NULL;
+    }
+}
+
+bool ImFontAtlasDynamic_IsEnabled(const ImFontAtlas* atlas)
+{
+    return ImFontDynamic_FindAtlas(atlas) != NULL;
+}
+
+const ImFontAtlasDynamicStats* ImFontAtlasDynamic_GetStats(const ImFontAtlas* atlas)
+{
+    ImFontAtlasDynamicData* data = ImFontDynamic_FindAtlas(atlas);
+    return data ? &data->Stats : NULL;
+}
+
+void ImFontAtlasDynamic_RequestText(ImFont* font, const char* text, const char* text_end)
+{
+    ImFontAtlasDynamicData* data = NULL;
+    ImFontDynamicFont* dyn = ImFontDynamic_FindFont(font, &data);
+    if (dyn == NULL)
+        return;
+    if (text_end == NULL)
+        text_end = text + strlen(text);
+    while (text < text_end)
+    {
+        unsigned int c = (unsigned int)*text;
+        if (c < 0x80)
+            text++;
+        else
+            text += ImTextCharFromUtf8(&c, text, text_end);
+        if (c == 0)
+            break;
+        if (c < 0x20 || c > IM_UNICODE_CODEPOINT_MAX)
+            continue;
+        if (c < (unsigned int)font->IndexLookup.Size && font->IndexLookup.Data[c] != (ImWchar)-1)
+            continue;
+        ImFontDynamic_Queue(data, dyn, (ImWchar)c);
+    }
+}
+
+// Rasterize one glyph into the reserved rows and register it in the font. Mirrors steps 4-9 of ImFontAtlasBuildWithStbTruetype().
+static bool ImFontDynamic_RasterizeGlyph(ImFontAtlasDynamicData* data, ImFontDynamicFont* dyn, ImWchar c, stbtt_pack_context* spc, stbrp_rect* out_rect)
+{
+    ImFontAtlas* atlas = data->Atlas;
+    ImFont* font = dyn->Font;
+    if (font->Glyphs.Size >= 0xFFFE) // Glyph indices are ImWchar, -1 is reserved
+        return false;
+
+    ImFontDynamicSource* src = NULL;
+    int glyph_index_in_font = 0;
+    for (int n = 0; n < dyn->Sources.Size && src == NULL; n++)
+    {
+        ImFontDynamicSource& candidate = data->Sources[dyn->Sources[n]];
+        if (!ImFontDynamic_TestBit(candidate.Allowed, c))
+            continue;
+        glyph_index_in_font = stbtt_FindGlyphIndex(&candidate.FontInfo, c);
+        if (glyph_index_in_font != 0)
+            src = &candidate;
+    }
+    if (src == NULL)
+        return false;
+    const ImFontConfig& cfg = atlas->ConfigData[src->ConfigIndex];
+
+    // Pack
+    const float scale = (cfg.SizePixels > 0) ? stbtt_ScaleForPixelHeight(&src->FontInfo, cfg.SizePixels) : stbtt_ScaleForMappingEmToPixels(&src->FontInfo, -cfg.SizePixels);
+    int x0, y0, x1, y1;
+    stbtt_GetGlyphBitmapBoxSubpixel(&src->FontInfo, glyph_index_in_font, scale * cfg.OversampleH, scale * cfg.OversampleV, 0, 0, &x0, &y0, &x1, &y1);
+    stbrp_rect rect;
+    memset(&rect, 0, sizeof(rect));
+    rect.w = (stbrp_coord)(x1 - x0 + atlas->TexGlyphPadding + cfg.OversampleH - 1);
+    rect.h = (stbrp_coord)(y1 - y0 + atlas->TexGlyphPadding + cfg.OversampleV - 1);
+    stbrp_pack_rects(&data->Packer, &rect, 1);
+    if (!rect.was_packed)
+        return false;
+    rect.y = (stbrp_coord)(rect.y + data->ReserveY);
+    *out_rect = rect;
+
+    // Render
+    int codepoint = c;
+    stbtt_packedchar pc;
+    stbtt_pack_range range;
+    memset(&pc, 0, sizeof(pc));
+    memset(&range, 0, sizeof(range));
+    range.font_size = cfg.SizePixels;
+    range.array_of_unicode_codepoints = &codepoint;
+    range.num_chars = 1;
+    range.chardata_for_range = &pc;
+    range.h_oversample = (unsigned char)cfg.OversampleH;
+    range.v_oversample = (unsigned char)cfg.OversampleV;
+    stbtt_PackFontRangesRenderIntoRects(spc, &src->FontInfo, &range, 1, &rect);
+    if (cfg.RasterizerMultiply != 1.0f)
+    {
+        unsigned char multiply_table[256];
+        ImFontAtlasBuildMultiplyCalcLookupTable(multiply_table, cfg.RasterizerMultiply);
+        ImFontAtlasBuildMultiplyRectAlpha8(multiply_table, atlas->TexPixelsAlpha8, rect.x, rect.y, rect.w, rect.h, atlas->TexWidth * 1);
+    }
+
+    // Register
+    const float font_off_x = cfg.GlyphOffset.x;
+    const float font_off_y = cfg.GlyphOffset.y + IM_ROUND(font->Ascent);
+    const float char_advance_x_org = pc.xadvance;
+    const float char_advance_x_mod = ImClamp(char_advance_x_org, cfg.GlyphMinAdvanceX, cfg.GlyphMaxAdvanceX);
+    float char_off_x = font_off_x;
+    if (char_advance_x_org != char_advance_x_mod)
+        char_off_x += cfg.PixelSnapH ? ImFloor((char_advance_x_mod - char_advance_x_org) * 0.5f) : (char_advance_x_mod - char_advance_x_org) * 0.5f;
+
+    stbtt_aligned_quad q;
+    float dummy_x = 0.0f, dummy_y = 0.0f;
+    stbtt_GetPackedQuad(&pc, atlas->TexWidth, atlas->TexHeight, 0, &dummy_x, &dummy_y, &q, 0);
+    font->AddGlyph(c, q.x0 + char_off_x, q.y0 + font_off_y, q.x1 + char_off_x, q.y1 + font_off_y, q.s0, q.t0, q.s1, q.t1, char_advance_x_mod);
+
+    // Incremental ImFont::BuildLookupTable() for this codepoint (a full rebuild would also append another TAB glyph)
+    const int old_index_size = font->IndexLookup.Size;
+    if ((int)c >= old_index_size)
+    {
+        font->GrowIndex((int)c + 1);
+        for (int i = old_index_size; i < (int)c; i++)
+            font->IndexAdvanceX[i] = font->FallbackAdvanceX;
+    }
+    font->IndexAdvanceX[(int)c] = font->Glyphs.back().AdvanceX;
+    font->IndexLookup[(int)c] = (ImWchar)(font->Glyphs.Size - 1);
+    return true;
+}
+
+int ImFontAtlasDynamic_Update(ImFontAtlas* atlas, int* out_x, int* out_y, int* out_w, int* out_h)
+{
+    typedef std::chrono::steady_clock Clock;
+    ImFontAtlasDynamicData* data = ImFontDynamic_FindAtlas(atlas);
+    if (data == NULL || data->Stats.GlyphsPending == 0 || atlas->TexPixelsAlpha8 == NULL)
+        return 0;
+    IM_ASSERT(!atlas->Locked && "Cannot modify a locked ImFontAtlas between NewFrame() and EndFrame/Render()!");
+    IM_ASSERT(atlas->TexHeight == data->Stats.TexHeight && "Atlas was rebuilt without calling ImFontAtlasDynamic_Build() again!");
+    const Clock::time_point start = Clock::now();
+
+    // We do our own packing, the pack context only tells stb_truetype where to render
+    stbtt_pack_context spc;
+    memset(&spc, 0, sizeof(spc));
+    spc.width = atlas->TexWidth;
+    spc.height = atlas->TexHeight;
+    spc.stride_in_bytes = atlas->TexWidth;
+    spc.padding = atlas->TexGlyphPadding;
+    spc.h_oversample = spc.v_oversample = 1;
+    spc.pixels = atlas->TexPixelsAlpha8;
+
+    int added = 0;
+    int dirty_x0 = INT_MAX, dirty_y0 = INT_MAX, dirty_x1 = 0, dirty_y1 = 0;
+    for (int font_i = 0; font_i < data->Fonts.Size; font_i++)
+    {
+        ImFontDynamicFont& dyn = data->Fonts[font_i];
+        if (dyn.Pending.empty())
+            continue;
+
+        int font_added = 0;
+        for (int n = 0; n < dyn.Pending.Size; n++)
+        {
+            stbrp_rect rect;
+            if (!ImFontDynamic_RasterizeGlyph(data, &dyn, dyn.Pending[n], &spc, &rect))
+            {
+                data->Stats.GlyphsMissing++;
+                continue;
+            }
+            dirty_x0 = ImMin(dirty_x0, (int)rect.x);
+            dirty_y0 = ImMin(dirty_y0, (int)rect.y);
+            dirty_x1 = ImMax(dirty_x1, (int)rect.x + (int)rect.w);
+            dirty_y1 = ImMax(dirty_y1, (int)rect.y + (int)rect.h);
+            font_added++;
+        }
+        data->Stats.GlyphsPending -= dyn.Pending.Size;
+        dyn.Pending.resize(0);
+
+        // Glyphs may have been reallocated
+        if (font_added > 0)
+        {
+            dyn.Font->FallbackGlyph = dyn.Font->FindGlyphNoFallback(dyn.Font->FallbackChar);
+            dyn.Font->DirtyLookupTables = false;
+            added += font_added;
+        }
+    }
+    IM_ASSERT(data->Stats.GlyphsPending == 0);
+
+    if (added > 0)
+    {
+        // Keep the expanded copy in sync (same conversion as GetTexDataAsRGBA32)
+        if (atlas->TexPixelsRGBA32)
+            for (int y = dirty_y0; y < dirty_y1; y++)
+            {
+                const unsigned char* src = atlas->TexPixelsAlpha8 + (size_t)y * atlas->TexWidth + dirty_x0;
+                unsigned int* dst = atlas->TexPixelsRGBA32 + (size_t)y * atlas->TexWidth + dirty_x0;
+                for (int x = dirty_x0; x < dirty_x1; x++)
+                    *dst++ = IM_COL32(255, 255, 255, (unsigned int)(*src++));
+            }
+
+        data->Stats.GlyphsRasterized += added;
+        data->Stats.Uploads++;
+        data->Stats.TexUsedHeight = ImMax(data->Stats.TexUsedHeight, dirty_y1);
+        if (out_x) *out_x = dirty_x0;
+        if (out_y) *out_y = dirty_y0;
+        if (out_w) *out_w = dirty_x1 - dirty_x0;
+        if (out_h) *out_h = dirty_y1 - dirty_y0;
+    }
+    data->Stats.RasterMs += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    return added;
+}
@@ -0,0 +1,60 @@
+// dear imgui: lazily rasterized glyphs for ImFontAtlas
+// ImFontAtlas::Build() rasterizes every codepoint of every glyph range up front. With large ranges (e.g. CJK, 20k+ ideographs)
+// that dominates start-up time and texture memory, while a UI typically shows a few hundred of them.
+// With this helper the atlas is built with a small resident range only. Other codepoints of the fonts' glyph ranges are
+// rasterized with stb_truetype the first time ImFont::FindGlyph() misses them, packed with stb_rect_pack into rows reserved
+// at the bottom of the texture, and reported as a dirty rectangle for the renderer back-end to upload.
+// Text needing a new glyph draws the fallback glyph for one frame.
+// In this plugin only helloworld_bench_fonts builds an atlas with it. The overlay's fonts are baked by BakkesMod, so the DX11 upload
+// path in imgui_impl_dx11 is not exercised in game.
+
+// Usage:
+//   io.Fonts->AddFontFromFileTTF("msyh.ttc", 16.0f, NULL, io.Fonts->GetGlyphRangesChineseFull());
+//   ImFontAtlasDynamic_Build(io.Fonts);                        // Instead of io.Fonts->Build()
+//   ...
+//   ImFontAtlasDynamic_Update(io.Fonts, &x, &y, &w, &h);      // Before ImGui::NewFrame(), upload the rect if it returns > 0
+//                                                              // (imgui_impl_dx11 and imgui_impl_softraster do this in their _NewFrame())
+//   ImFontAtlasDynamic_Shutdown(io.Fonts);                     // Before the atlas is cleared, rebuilt or destroyed
+
+// Limitations:
+// - The reserved rows are not grown. Once full, further glyphs keep drawing the fallback glyph (counted in GlyphsMissing).
+// - ImGui::CalcTextSize() does not go through FindGlyph(), so only rendering requests glyphs. Text measured before it is
+//   ever drawn uses the fallback advance for one frame; use ImFontAtlasDynamic_RequestText() to prefetch such strings.
+
+// Changelog:
+// - v0.10: Initial version.
+
+#pragma once
+
+#include "imgui.h"
+
+struct ImFontAtlasDynamicStats
+{
+    int             GlyphsResident;     // Glyphs rasterized by the initial build
+    int             GlyphsRasterized;   // Glyphs rasterized on first use since then
+    int             GlyphsPending;      // Requested, will be rasterized by the next ImFontAtlasDynamic_Update()
+    int             GlyphsMissing;      // Requested but not in any source font/range, or no room left in the atlas
+    int             Uploads;            // ImFontAtlasDynamic_Update() calls that produced a dirty rectangle
+    double          BuildMs;            // Initial (resident) build
+    double          RasterMs;           // Total time spent rasterizing on demand
+    int             TexWidth;
+    int             TexHeight;          // Including the reserved rows
+    int             TexUsedHeight;      // Rows used so far (resident glyphs + highest on-demand glyph)
+
+    ImFontAtlasDynamicStats()           { memset(this, 0, sizeof(*this)); }
+};
+
+// Build 'atlas' with only the codepoints of 'resident_ranges' (NULL: GetGlyphRangesDefault()) that are also in each font's
+// own glyph ranges, then reserve 'reserve_height' texture rows for glyphs rasterized on demand.
+IMGUI_API bool      ImFontAtlasDynamic_Build(ImFontAtlas* atlas, const ImWchar* resident_ranges = NULL, int reserve_height = 1024);
+IMGUI_API void      ImFontAtlasDynamic_Shutdown(ImFontAtlas* atlas);
+IMGUI_API bool      ImFontAtlasDynamic_IsEnabled(const ImFontAtlas* atlas);
+
+// Queue every codepoint of a UTF-8 string that 'font' does not have yet, without drawing it.
+IMGUI_API void      ImFontAtlasDynamic_RequestText(ImFont* font, const char* text, const char* text_end = NULL);
+
+// Rasterize the queued glyphs into the atlas texture (alpha8, and RGBA32 if it was already expanded).
+// Returns the number of glyphs added; when > 0 the texels in (x, y, w, h) changed and need to be uploaded.
+IMGUI_API int       ImFontAtlasDynamic_Update(ImFontAtlas* atlas, int* out_x, int* out_y, int* out_w, int* out_h);
+
+IMGUI_API const ImFontAtlasDynamicStats* ImFontAtlasDynamic_GetStats(const ImFontAtlas* atlas);
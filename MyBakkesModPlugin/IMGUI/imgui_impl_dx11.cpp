@@ -12,6 +12,11 @@
 
 // CHANGELOG
 // (minor and older changes stripped away, please see git history for details)
+//  2026-10-19: DirectX11: Upload glyphs rasterized on demand by imgui_fontdynamic (UpdateSubresource on the dirty rectangle only).
+//  2026-10-19: DirectX11: Optional font atlas disk cache (ImGui_ImplDX11_SetFontCacheFilename), skips rasterizing the fonts when the inputs did not change.
+//  2026-10-19: DirectX11: Optional state cache (ImGui_ImplDX11_SetStateCacheEnabled) only sets/restores state that differs. Nothing is backed up when there is nothing to draw.
+//  2026-10-19: DirectX11: Vertex/index buffers are persistent rings written with MAP_WRITE_NO_OVERWRITE and grown geometrically. Added ImGui_ImplDX11_GetStats().
+//              The ring arithmetic lives in imgui_impl_dx11_ring.h, without D3D types, so it is tested with a fake buffer.
 //  2019-08-01: DirectX11: Fixed code querying the Geometry Shader state (would generally error with Debug layer enabled).
 //  2019-07-21: DirectX11: Backup, clear and restore Geometry Shader is any is bound when calling ImGui_ImplDX10_RenderDrawData. Clearing Hull/Domain/Compute shaders without backup/restore.
 //  2019-05-29: DirectX11: Added support for large mesh (64K+ vertices), enable ImGuiBackendFlags_RendererHasVtxOffset flag.
@@ -28,6 +33,9 @@
 
 #include "imgui.h"
 #include "imgui_impl_dx11.h"
+#include "imgui_impl_dx11_ring.h"
+#include "imgui_fontcache.h"
+#include "imgui_fontdynamic.h"
 
 // DirectX
 #include <stdio.h>
@@ -54,15 +62,79 @@ static ID3D11ShaderResourceView* g_pFontTextureView = NULL;
 static ID3D11RasterizerState* g_pRasterizerState = NULL;
 static ID3D11BlendState* g_pBlendState = NULL;
 static ID3D11DepthStencilState* g_pDepthStencilState = NULL;
-static int                      g_VertexBufferSize = 5000, g_IndexBufferSize = 10000;
+static ImGui_ImplDX11_Ring      g_VertexRing(5000), g_IndexRing(10000);
+static ImGui_ImplDX11_Stats     g_Stats = {};
+static bool                     g_StateCacheEnabled = false;
+static int                      g_FrameStateCalls = 0;
+static ImVector<char>           g_FontCacheFilename;
 
 struct VERTEX_CONSTANT_BUFFER
 {
     float   mvp[4][4];
 };
 
-static void ImGui_ImplDX11_SetupRenderState(ImDrawData* draw_data, ID3D11DeviceContext* ctx)
+// Backup DX state that will be modified to restore it afterwards (unfortunately this is very ugly looking and verbose. Close your eyes!)
+struct BACKUP_DX11_STATE
 {
+    UINT                        ScissorRectsCount, ViewportsCount;
+    D3D11_RECT                  ScissorRects[D3D11_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE];
+    D3D11_VIEWPORT              Viewports[D3D11_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE];
+    ID3D11RasterizerState* RS;
+    ID3D11BlendState* BlendState;
+    FLOAT                       BlendFactor[4];
+    UINT                        SampleMask;
+    UINT                        StencilRef;
+    ID3D11DepthStencilState* DepthStencilState;
+    ID3D11ShaderResourceView* PSShaderResource;
+    ID3D11SamplerState* PSSampler;
+    ID3D11PixelShader* PS;
+    ID3D11VertexShader* VS;
+    ID3D11GeometryShader* GS;
+    UINT                        PSInstancesCount, VSInstancesCount, GSInstancesCount;
+    ID3D11ClassInstance* PSInstances[256], * VSInstances[256], * GSInstances[256];   // 256 is max according to PSSetShader documentation
+    D3D11_PRIMITIVE_TOPOLOGY    PrimitiveTopology;
+    ID3D11Buffer* IndexBuffer, * VertexBuffer, * VSConstantBuffer;
+    UINT                        IndexBufferOffset, VertexBufferStride, VertexBufferOffset;
+    DXGI_FORMAT                 IndexBufferFormat;
+    ID3D11InputLayout* InputLayout;
+};
+
+// Pieces of pipeline state the back-end may modify. With the state cache enabled we only set the ones that differ
+// from the backup, and only restore what was actually set.
+enum ImGui_ImplDX11_State_
+{
+    ImGui_ImplDX11_State_Viewports          = 1 << 0,
+    ImGui_ImplDX11_State_ScissorRects       = 1 << 1,
+    ImGui_ImplDX11_State_Rasterizer         = 1 << 2,
+    ImGui_ImplDX11_State_Blend              = 1 << 3,
+    ImGui_ImplDX11_State_DepthStencil       = 1 << 4,
+    ImGui_ImplDX11_State_PSShaderResource   = 1 << 5,
+    ImGui_ImplDX11_State_PSSampler          = 1 << 6,
+    ImGui_ImplDX11_State_PS                 = 1 << 7,
+    ImGui_ImplDX11_State_VS                 = 1 << 8,
+    ImGui_ImplDX11_State_VSConstantBuffer   = 1 << 9,
+    ImGui_ImplDX11_State_GS                 = 1 << 10,
+    ImGui_ImplDX11_State_PrimitiveTopology  = 1 << 11,
+    ImGui_ImplDX11_State_IndexBuffer        = 1 << 12,
+    ImGui_ImplDX11_State_VertexBuffer       = 1 << 13,
+    ImGui_ImplDX11_State_InputLayout        = 1 << 14,
+    ImGui_ImplDX11_State_All                = (1 << 15) - 1
+};
+
+static int ImGui_ImplDX11_CountStates(unsigned int states)
+{
+    int count = 0;
+    for (; states != 0; states &= states - 1)
+        count++;
+    return count;
+}
+
+// Setup desired DX state. When 'old' is given (state cache), state already matching the backup is left alone.
+// Returns the ImGui_ImplDX11_State_ bits that were set.
+static unsigned int ImGui_ImplDX11_SetupRenderState(ImDrawData* draw_data, ID3D11DeviceContext* ctx, const BACKUP_DX11_STATE* old)
+{
+    unsigned int set = 0;
+
     // Setup viewport
     D3D11_VIEWPORT vp;
     memset(&vp, 0, sizeof(D3D11_VIEWPORT));
@@ -71,29 +143,192 @@ static void ImGui_ImplDX11_SetupRenderState(ImDrawData* draw_data, ID3D11DeviceC
     vp.MinDepth = 0.0f;
     vp.MaxDepth = 1.0f;
     vp.TopLeftX = vp.TopLeftY = 0;
-    ctx->RSSetViewports(1, &vp);
+    if (!old || old->ViewportsCount != 1 || memcmp(&old->Viewports[0], &vp, sizeof(vp)) != 0)
+    {
+        ctx->RSSetViewports(1, &vp);
+        set |= ImGui_ImplDX11_State_Viewports;
+    }
 
     // Setup shader and vertex buffers
     unsigned int stride = sizeof(ImDrawVert);
     unsigned int offset = 0;
-    ctx->IASetInputLayout(g_pInputLayout);
-    ctx->IASetVertexBuffers(0, 1, &g_pVB, &stride, &offset);
-    ctx->IASetIndexBuffer(g_pIB, sizeof(ImDrawIdx) == 2 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT, 0);
-    ctx->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-    ctx->VSSetShader(g_pVertexShader, NULL, 0);
-    ctx->VSSetConstantBuffers(0, 1, &g_pVertexConstantBuffer);
-    ctx->PSSetShader(g_pPixelShader, NULL, 0);
-    ctx->PSSetSamplers(0, 1, &g_pFontSampler);
-    ctx->GSSetShader(NULL, NULL, 0);
+    const DXGI_FORMAT idx_format = sizeof(ImDrawIdx) == 2 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+    if (!old || old->InputLayout != g_pInputLayout)
+    {
+        ctx->IASetInputLayout(g_pInputLayout);
+        set |= ImGui_ImplDX11_State_InputLayout;
+    }
+    if (!old || old->VertexBuffer != g_pVB || old->VertexBufferStride != stride || old->VertexBufferOffset != offset)
+    {
+        ctx->IASetVertexBuffers(0, 1, &g_pVB, &stride, &offset);
+        set |= ImGui_ImplDX11_State_VertexBuffer;
+    }
+    if (!old || old->IndexBuffer != g_pIB || old->IndexBufferFormat != idx_format || old->IndexBufferOffset != 0)
+    {
+        ctx->IASetIndexBuffer(g_pIB, idx_format, 0);
+        set |= ImGui_ImplDX11_State_IndexBuffer;
+    }
+    if (!old || old->PrimitiveTopology != D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST)
+    {
+        ctx->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+        set |= ImGui_ImplDX11_State_PrimitiveTopology;
+    }
+    if (!old || old->VS != g_pVertexShader || old->VSInstancesCount != 0)
+    {
+        ctx->VSSetShader(g_pVertexShader, NULL, 0);
+        set |= ImGui_ImplDX11_State_VS;
+    }
+    if (!old || old->VSConstantBuffer != g_pVertexConstantBuffer)
+    {
+        ctx->VSSetConstantBuffers(0, 1, &g_pVertexConstantBuffer);
+        set |= ImGui_ImplDX11_State_VSConstantBuffer;
+    }
+    if (!old || old->PS != g_pPixelShader || old->PSInstancesCount != 0)
+    {
+        ctx->PSSetShader(g_pPixelShader, NULL, 0);
+        set |= ImGui_ImplDX11_State_PS;
+    }
+    if (!old || old->PSSampler != g_pFontSampler)
+    {
+        ctx->PSSetSamplers(0, 1, &g_pFontSampler);
+        set |= ImGui_ImplDX11_State_PSSampler;
+    }
+    if (!old || old->GS != NULL || old->GSInstancesCount != 0)
+    {
+        ctx->GSSetShader(NULL, NULL, 0);
+        set |= ImGui_ImplDX11_State_GS;
+    }
     ctx->HSSetShader(NULL, NULL, 0); // In theory we should backup and restore this as well.. very infrequently used..
     ctx->DSSetShader(NULL, NULL, 0); // In theory we should backup and restore this as well.. very infrequently used..
     ctx->CSSetShader(NULL, NULL, 0); // In theory we should backup and restore this as well.. very infrequently used..
 
     // Setup blend state
     const float blend_factor[4] = { 0.f, 0.f, 0.f, 0.f };
-    ctx->OMSetBlendState(g_pBlendState, blend_factor, 0xffffffff);
-    ctx->OMSetDepthStencilState(g_pDepthStencilState, 0);
-    ctx->RSSetState(g_pRasterizerState);
+    if (!old || old->BlendState != g_pBlendState || memcmp(old->BlendFactor, blend_factor, sizeof(blend_factor)) != 0 || old->SampleMask != 0xffffffff)
+    {
+        ctx->OMSetBlendState(g_pBlendState, blend_factor, 0xffffffff);
+        set |= ImGui_ImplDX11_State_Blend;
+    }
+    if (!old || old->DepthStencilState != g_pDepthStencilState || old->StencilRef != 0)
+    {
+        ctx->OMSetDepthStencilState(g_pDepthStencilState, 0);
+        set |= ImGui_ImplDX11_State_DepthStencil;
+    }
+    if (!old || old->RS != g_pRasterizerState)
+    {
+        ctx->RSSetState(g_pRasterizerState);
+        set |= ImGui_ImplDX11_State_Rasterizer;
+    }
+
+    g_FrameStateCalls += ImGui_ImplDX11_CountStates(set) + 3;
+    return set;
+}
+
+static void ImGui_ImplDX11_BackupState(ID3D11DeviceContext* ctx, BACKUP_DX11_STATE* old)
+{
+    old->ScissorRectsCount = old->ViewportsCount = D3D11_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE;
+    ctx->RSGetScissorRects(&old->ScissorRectsCount, old->ScissorRects);
+    ctx->RSGetViewports(&old->ViewportsCount, old->Viewports);
+    ctx->RSGetState(&old->RS);
+    ctx->OMGetBlendState(&old->BlendState, old->BlendFactor, &old->SampleMask);
+    ctx->OMGetDepthStencilState(&old->DepthStencilState, &old->StencilRef);
+    ctx->PSGetShaderResources(0, 1, &old->PSShaderResource);
+    ctx->PSGetSamplers(0, 1, &old->PSSampler);
+    old->PSInstancesCount = old->VSInstancesCount = old->GSInstancesCount = 256;
+    ctx->PSGetShader(&old->PS, old->PSInstances, &old->PSInstancesCount);
+    ctx->VSGetShader(&old->VS, old->VSInstances, &old->VSInstancesCount);
+    ctx->VSGetConstantBuffers(0, 1, &old->VSConstantBuffer);
+    ctx->GSGetShader(&old->GS, old->GSInstances, &old->GSInstancesCount);
+
+    ctx->IAGetPrimitiveTopology(&old->PrimitiveTopology);
+    ctx->IAGetIndexBuffer(&old->IndexBuffer, &old->IndexBufferFormat, &old->IndexBufferOffset);
+    ctx->IAGetVertexBuffers(0, 1, &old->VertexBuffer, &old->VertexBufferStride, &old->VertexBufferOffset);
+    ctx->IAGetInputLayout(&old->InputLayout);
+    g_FrameStateCalls += 15;
+}
+
+// Restore the states in 'states', and release every reference the backup took (Get*() calls AddRef() even if we don't restore).
+static void ImGui_ImplDX11_RestoreState(ID3D11DeviceContext* ctx, BACKUP_DX11_STATE* old, unsigned int states)
+{
+    if (states & ImGui_ImplDX11_State_ScissorRects) ctx->RSSetScissorRects(old->ScissorRectsCount, old->ScissorRects);
+    if (states & ImGui_ImplDX11_State_Viewports) ctx->RSSetViewports(old->ViewportsCount, old->Viewports);
+    if (states & ImGui_ImplDX11_State_Rasterizer) ctx->RSSetState(old->RS);
+    if (old->RS) old->RS->Release();
+    if (states & ImGui_ImplDX11_State_Blend) ctx->OMSetBlendState(old->BlendState, old->BlendFactor, old->SampleMask);
+    if (old->BlendState) old->BlendState->Release();
+    if (states & ImGui_ImplDX11_State_DepthStencil) ctx->OMSetDepthStencilState(old->DepthStencilState, old->StencilRef);
+    if (old->DepthStencilState) old->DepthStencilState->Release();
+    if (states & ImGui_ImplDX11_State_PSShaderResource) ctx->PSSetShaderResources(0, 1, &old->PSShaderResource);
+    if (old->PSShaderResource) old->PSShaderResource->Release();
+    if (states & ImGui_ImplDX11_State_PSSampler) ctx->PSSetSamplers(0, 1, &old->PSSampler);
+    if (old->PSSampler) old->PSSampler->Release();
+    if (states & ImGui_ImplDX11_State_PS) ctx->PSSetShader(old->PS, old->PSInstances, old->PSInstancesCount);
+    if (old->PS) old->PS->Release();
+    for (UINT i = 0; i < old->PSInstancesCount; i++) if (old->PSInstances[i]) old->PSInstances[i]->Release();
+    if (states & ImGui_ImplDX11_State_VS) ctx->VSSetShader(old->VS, old->VSInstances, old->VSInstancesCount);
+    if (old->VS) old->VS->Release();
+    for (UINT i = 0; i < old->VSInstancesCount; i++) if (old->VSInstances[i]) old->VSInstances[i]->Release();
+    if (states & ImGui_ImplDX11_State_VSConstantBuffer) ctx->VSSetConstantBuffers(0, 1, &old->VSConstantBuffer);
+    if (old->VSConstantBuffer) old->VSConstantBuffer->Release();
+    if (states & ImGui_ImplDX11_State_GS) ctx->GSSetShader(old->GS, old->GSInstances, old->GSInstancesCount);
+    if (old->GS) old->GS->Release();
+    for (UINT i = 0; i < old->GSInstancesCount; i++) if (old->GSInstances[i]) old->GSInstances[i]->Release();
+    if (states & ImGui_ImplDX11_State_PrimitiveTopology) ctx->IASetPrimitiveTopology(old->PrimitiveTopology);
+    if (states & ImGui_ImplDX11_State_IndexBuffer) ctx->IASetIndexBuffer(old->IndexBuffer, old->IndexBufferFormat, old->IndexBufferOffset);
+    if (old->IndexBuffer) old->IndexBuffer->Release();
+    if (states & ImGui_ImplDX11_State_VertexBuffer) ctx->IASetVertexBuffers(0, 1, &old->VertexBuffer, &old->VertexBufferStride, &old->VertexBufferOffset);
+    if (old->VertexBuffer) old->VertexBuffer->Release();
+    if (states & ImGui_ImplDX11_State_InputLayout) ctx->IASetInputLayout(old->InputLayout);
+    if (old->InputLayout) old->InputLayout->Release();
+    g_FrameStateCalls += ImGui_ImplDX11_CountStates(states);
+}
+
+static bool ImGui_ImplDX11_HasUserCallbacks(ImDrawData* draw_data)
+{
+    for (int n = 0; n < draw_data->CmdListsCount; n++)
+    {
+        const ImDrawList* cmd_list = draw_data->CmdLists[n];
+        for (int cmd_i = 0; cmd_i < cmd_list->CmdBuffer.Size; cmd_i++)
+            if (cmd_list->CmdBuffer[cmd_i].UserCallback != NULL)
+                return true;
+    }
+    return false;
+}
+
+struct ImGui_ImplDX11_RingTarget
+{
+    ID3D11Buffer**  Buffer;
+    UINT            ElemSize;
+    UINT            BindFlags;
+};
+
+static bool ImGui_ImplDX11_CreateRingBuffer(int capacity, void* user_data)
+{
+    ImGui_ImplDX11_RingTarget* target = (ImGui_ImplDX11_RingTarget*)user_data;
+    if (*target->Buffer) { (*target->Buffer)->Release(); *target->Buffer = NULL; }
+    D3D11_BUFFER_DESC desc;
+    memset(&desc, 0, sizeof(D3D11_BUFFER_DESC));
+    desc.Usage = D3D11_USAGE_DYNAMIC;
+    desc.ByteWidth = capacity * target->ElemSize;
+    desc.BindFlags = target->BindFlags;
+    desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+    desc.MiscFlags = 0;
+    return g_pd3dDevice->CreateBuffer(&desc, NULL, target->Buffer) >= 0;
+}
+
+// Make room for 'count' elements in a dynamic ring buffer (see imgui_impl_dx11_ring.h), returning how it must be mapped
+static bool ImGui_ImplDX11_ReserveRing(ID3D11Buffer** buffer, ImGui_ImplDX11_Ring* ring, int count, UINT elem_size, UINT bind_flags, D3D11_MAP* out_map)
+{
+    ImGui_ImplDX11_RingTarget target = { buffer, elem_size, bind_flags };
+    ImGui_ImplDX11_RingResult result = ImGui_ImplDX11_RingReserve(ring, count, ImGui_ImplDX11_CreateRingBuffer, &target);
+    if (result == ImGui_ImplDX11_RingResult_Failed)
+        return false;
+    if (result == ImGui_ImplDX11_RingResult_Created)
+        g_Stats.BufferReallocations++;
+    if (result == ImGui_ImplDX11_RingResult_Wrapped)
+        g_Stats.RingWraps++;
+    *out_map = ImGui_ImplDX11_RingNeedsDiscard(result) ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE;
+    return true;
 }
 
 // Render function
@@ -104,45 +339,38 @@ void ImGui_ImplDX11_RenderDrawData(ImDrawData* draw_data)
     if (draw_data->DisplaySize.x <= 0.0f || draw_data->DisplaySize.y <= 0.0f)
         return;
 
-    ID3D11DeviceContext* ctx = g_pd3dDeviceContext;
-
-    // Create and grow vertex/index buffers if needed
-    if (!g_pVB || g_VertexBufferSize < draw_data->TotalVtxCount)
+    // Nothing to draw: leave the game's pipeline alone entirely (no upload, no backup, no restore)
+    if (draw_data->TotalIdxCount == 0 && !ImGui_ImplDX11_HasUserCallbacks(draw_data))
     {
-        if (g_pVB) { g_pVB->Release(); g_pVB = NULL; }
-        g_VertexBufferSize = draw_data->TotalVtxCount + 5000;
-        D3D11_BUFFER_DESC desc;
-        memset(&desc, 0, sizeof(D3D11_BUFFER_DESC));
-        desc.Usage = D3D11_USAGE_DYNAMIC;
-        desc.ByteWidth = g_VertexBufferSize * sizeof(ImDrawVert);
-        desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-        desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-        desc.MiscFlags = 0;
-        if (g_pd3dDevice->CreateBuffer(&desc, NULL, &g_pVB) < 0)
-            return;
-    }
-    if (!g_pIB || g_IndexBufferSize < draw_data->TotalIdxCount)
-    {
-        if (g_pIB) { g_pIB->Release(); g_pIB = NULL; }
-        g_IndexBufferSize = draw_data->TotalIdxCount + 10000;
-        D3D11_BUFFER_DESC desc;
-        memset(&desc, 0, sizeof(D3D11_BUFFER_DESC));
-        desc.Usage = D3D11_USAGE_DYNAMIC;
-        desc.ByteWidth = g_IndexBufferSize * sizeof(ImDrawIdx);
-        desc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-        desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-        if (g_pd3dDevice->CreateBuffer(&desc, NULL, &g_pIB) < 0)
-            return;
+        g_Stats.StateCallsLastFrame = 0;
+        g_Stats.FramesSkipped++;
+        return;
     }
 
-    // Upload vertex/index data into a single contiguous GPU buffer
+    ID3D11DeviceContext* ctx = g_pd3dDeviceContext;
+    g_FrameStateCalls = 0;
+
+    // Reserve this frame's vertices/indices in the rings (creating or growing the buffers if needed)
+    D3D11_MAP vtx_map, idx_map;
+    if (!ImGui_ImplDX11_ReserveRing(&g_pVB, &g_VertexRing, draw_data->TotalVtxCount, sizeof(ImDrawVert), D3D11_BIND_VERTEX_BUFFER, &vtx_map))
+        return;
+    if (!ImGui_ImplDX11_ReserveRing(&g_pIB, &g_IndexRing, draw_data->TotalIdxCount, sizeof(ImDrawIdx), D3D11_BIND_INDEX_BUFFER, &idx_map))
+        return;
+
+    // Upload vertex/index data after whatever previous frames wrote. NO_OVERWRITE tells the driver we don't touch
+    // data the GPU may still be reading, so this never waits on the GPU or renames the whole buffer.
     D3D11_MAPPED_SUBRESOURCE vtx_resource, idx_resource;
-    if (ctx->Map(g_pVB, 0, D3D11_MAP_WRITE_DISCARD, 0, &vtx_resource) != S_OK)
+    if (ctx->Map(g_pVB, 0, vtx_map, 0, &vtx_resource) != S_OK)
         return;
-    if (ctx->Map(g_pIB, 0, D3D11_MAP_WRITE_DISCARD, 0, &idx_resource) != S_OK)
+    if (ctx->Map(g_pIB, 0, idx_map, 0, &idx_resource) != S_OK)
+    {
+        ctx->Unmap(g_pVB, 0);
         return;
-    ImDrawVert* vtx_dst = (ImDrawVert*)vtx_resource.pData;
-    ImDrawIdx* idx_dst = (ImDrawIdx*)idx_resource.pData;
+    }
+    const int vtx_base = g_VertexRing.Head;
+    const int idx_base = g_IndexRing.Head;
+    ImDrawVert* vtx_dst = (ImDrawVert*)vtx_resource.pData + vtx_base;
+    ImDrawIdx* idx_dst = (ImDrawIdx*)idx_resource.pData + idx_base;
     for (int n = 0; n < draw_data->CmdListsCount; n++)
     {
         const ImDrawList* cmd_list = draw_data->CmdLists[n];
@@ -153,6 +381,13 @@ void ImGui_ImplDX11_RenderDrawData(ImDrawData* draw_data)
     }
     ctx->Unmap(g_pVB, 0);
     ctx->Unmap(g_pIB, 0);
+    ImGui_ImplDX11_RingCommit(&g_VertexRing, draw_data->TotalVtxCount);
+    ImGui_ImplDX11_RingCommit(&g_IndexRing, draw_data->TotalIdxCount);
+
+    const size_t uploaded = (size_t)draw_data->TotalVtxCount * sizeof(ImDrawVert) + (size_t)draw_data->TotalIdxCount * sizeof(ImDrawIdx);
+    g_Stats.BytesUploadedLastFrame = uploaded;
+    g_Stats.BytesUploadedTotal += uploaded;
+    g_Stats.FramesRendered++;
 
     // Setup orthographic projection matrix into our constant buffer
     // Our visible imgui space lies from draw_data->DisplayPos (top left) to draw_data->DisplayPos+data_data->DisplaySize (bottom right). DisplayPos is (0,0) for single viewport apps.
@@ -176,59 +411,21 @@ void ImGui_ImplDX11_RenderDrawData(ImDrawData* draw_data)
         ctx->Unmap(g_pVertexConstantBuffer, 0);
     }
 
-    // Backup DX state that will be modified to restore it afterwards (unfortunately this is very ugly looking and verbose. Close your eyes!)
-    struct BACKUP_DX11_STATE
-    {
-        UINT                        ScissorRectsCount, ViewportsCount;
-        D3D11_RECT                  ScissorRects[D3D11_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE];
-        D3D11_VIEWPORT              Viewports[D3D11_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE];
-        ID3D11RasterizerState* RS;
-        ID3D11BlendState* BlendState;
-        FLOAT                       BlendFactor[4];
-        UINT                        SampleMask;
-        UINT                        StencilRef;
-        ID3D11DepthStencilState* DepthStencilState;
-        ID3D11ShaderResourceView* PSShaderResource;
-        ID3D11SamplerState* PSSampler;
-        ID3D11PixelShader* PS;
-        ID3D11VertexShader* VS;
-        ID3D11GeometryShader* GS;
-        UINT                        PSInstancesCount, VSInstancesCount, GSInstancesCount;
-        ID3D11ClassInstance* PSInstances[256], * VSInstances[256], * GSInstances[256];   // 256 is max according to PSSetShader documentation
-        D3D11_PRIMITIVE_TOPOLOGY    PrimitiveTopology;
-        ID3D11Buffer* IndexBuffer, * VertexBuffer, * VSConstantBuffer;
-        UINT                        IndexBufferOffset, VertexBufferStride, VertexBufferOffset;
-        DXGI_FORMAT                 IndexBufferFormat;
-        ID3D11InputLayout* InputLayout;
-    };
+    // Backup DX state that will be modified to restore it afterwards
     BACKUP_DX11_STATE old;
-    old.ScissorRectsCount = old.ViewportsCount = D3D11_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE;
-    ctx->RSGetScissorRects(&old.ScissorRectsCount, old.ScissorRects);
-    ctx->RSGetViewports(&old.ViewportsCount, old.Viewports);
-    ctx->RSGetState(&old.RS);
-    ctx->OMGetBlendState(&old.BlendState, old.BlendFactor, &old.SampleMask);
-    ctx->OMGetDepthStencilState(&old.DepthStencilState, &old.StencilRef);
-    ctx->PSGetShaderResources(0, 1, &old.PSShaderResource);
-    ctx->PSGetSamplers(0, 1, &old.PSSampler);
-    old.PSInstancesCount = old.VSInstancesCount = old.GSInstancesCount = 256;
-    ctx->PSGetShader(&old.PS, old.PSInstances, &old.PSInstancesCount);
-    ctx->VSGetShader(&old.VS, old.VSInstances, &old.VSInstancesCount);
-    ctx->VSGetConstantBuffers(0, 1, &old.VSConstantBuffer);
-    ctx->GSGetShader(&old.GS, old.GSInstances, &old.GSInstancesCount);
-
-    ctx->IAGetPrimitiveTopology(&old.PrimitiveTopology);
-    ctx->IAGetIndexBuffer(&old.IndexBuffer, &old.IndexBufferFormat, &old.IndexBufferOffset);
-    ctx->IAGetVertexBuffers(0, 1, &old.VertexBuffer, &old.VertexBufferStride, &old.VertexBufferOffset);
-    ctx->IAGetInputLayout(&old.InputLayout);
+    ImGui_ImplDX11_BackupState(ctx, &old);
 
     // Setup desired DX state
-    ImGui_ImplDX11_SetupRenderState(draw_data, ctx);
+    unsigned int changed = ImGui_ImplDX11_SetupRenderState(draw_data, ctx, g_StateCacheEnabled ? &old : NULL);
 
     // Render command lists
-    // (Because we merged all buffers into a single one, we maintain our own offset into them)
-    int global_idx_offset = 0;
-    int global_vtx_offset = 0;
+    // (Because we merged all buffers into a single one, we maintain our own offset into them, starting at this frame's ring position)
+    int global_idx_offset = idx_base;
+    int global_vtx_offset = vtx_base;
     ImVec2 clip_off = draw_data->DisplayPos;
+    bool has_last_cmd_state = false;    // With the state cache, consecutive commands sharing a scissor rect or texture don't re-set it
+    D3D11_RECT last_scissor = {};
+    ID3D11ShaderResourceView* last_texture_srv = NULL;
     for (int n = 0; n < draw_data->CmdListsCount; n++)
     {
         const ImDrawList* cmd_list = draw_data->CmdLists[n];
@@ -239,20 +436,37 @@ void ImGui_ImplDX11_RenderDrawData(ImDrawData* draw_data)
             {
                 // User callback, registered via ImDrawList::AddCallback()
                 // (ImDrawCallback_ResetRenderState is a special callback value used by the user to request the renderer to reset render state.)
+                // A user callback may touch anything, so everything gets restored afterwards.
                 if (pcmd->UserCallback == ImDrawCallback_ResetRenderState)
-                    ImGui_ImplDX11_SetupRenderState(draw_data, ctx);
+                    changed |= ImGui_ImplDX11_SetupRenderState(draw_data, ctx, NULL);
                 else
+                {
                     pcmd->UserCallback(cmd_list, pcmd);
+                    changed = ImGui_ImplDX11_State_All;
+                }
+                has_last_cmd_state = false;
             }
             else
             {
                 // Apply scissor/clipping rectangle
                 const D3D11_RECT r = { (LONG)(pcmd->ClipRect.x - clip_off.x), (LONG)(pcmd->ClipRect.y - clip_off.y), (LONG)(pcmd->ClipRect.z - clip_off.x), (LONG)(pcmd->ClipRect.w - clip_off.y) };
-                ctx->RSSetScissorRects(1, &r);
+                if (!g_StateCacheEnabled || !has_last_cmd_state || memcmp(&r, &last_scissor, sizeof(r)) != 0)
+                {
+                    ctx->RSSetScissorRects(1, &r);
+                    g_FrameStateCalls++;
+                    last_scissor = r;
+                }
 
                 // Bind texture, Draw
                 ID3D11ShaderResourceView* texture_srv = (ID3D11ShaderResourceView*)pcmd->TextureId;
-                ctx->PSSetShaderResources(0, 1, &texture_srv);
+                if (!g_StateCacheEnabled || !has_last_cmd_state || texture_srv != last_texture_srv)
+                {
+                    ctx->PSSetShaderResources(0, 1, &texture_srv);
+                    g_FrameStateCalls++;
+                    last_texture_srv = texture_srv;
+                }
+                has_last_cmd_state = true;
+                changed |= ImGui_ImplDX11_State_ScissorRects | ImGui_ImplDX11_State_PSShaderResource;
                 ctx->DrawIndexed(pcmd->ElemCount, pcmd->IdxOffset + global_idx_offset, pcmd->VtxOffset + global_vtx_offset);
             }
         }
@@ -261,29 +475,16 @@ void ImGui_ImplDX11_RenderDrawData(ImDrawData* draw_data)
     }
 
     // Restore modified DX state
-    ctx->RSSetScissorRects(old.ScissorRectsCount, old.ScissorRects);
-    ctx->RSSetViewports(old.ViewportsCount, old.Viewports);
-    ctx->RSSetState(old.RS); if (old.RS) old.RS->Release();
-    ctx->OMSetBlendState(old.BlendState, old.BlendFactor, old.SampleMask); if (old.BlendState) old.BlendState->Release();
-    ctx->OMSetDepthStencilState(old.DepthStencilState, old.StencilRef); if (old.DepthStencilState) old.DepthStencilState->Release();
-    ctx->PSSetShaderResources(0, 1, &old.PSShaderResource); if (old.PSShaderResource) old.PSShaderResource->Release();
-    ctx->PSSetSamplers(0, 1, &old.PSSampler); if (old.PSSampler) old.PSSampler->Release();
-    ctx->PSSetShader(old.PS, old.PSInstances, old.PSInstancesCount); if (old.PS) old.PS->Release();
-    for (UINT i = 0; i < old.PSInstancesCount; i++) if (old.PSInstances[i]) old.PSInstances[i]->Release();
-    ctx->VSSetShader(old.VS, old.VSInstances, old.VSInstancesCount); if (old.VS) old.VS->Release();
-    ctx->VSSetConstantBuffers(0, 1, &old.VSConstantBuffer); if (old.VSConstantBuffer) old.VSConstantBuffer->Release();
-    ctx->GSSetShader(old.GS, old.GSInstances, old.GSInstancesCount); if (old.GS) old.GS->Release();
-    for (UINT i = 0; i < old.VSInstancesCount; i++) if (old.VSInstances[i]) old.VSInstances[i]->Release();
-    ctx->IASetPrimitiveTopology(old.PrimitiveTopology);
-    ctx->IASetIndexBuffer(old.IndexBuffer, old.IndexBufferFormat, old.IndexBufferOffset); if (old.IndexBuffer) old.IndexBuffer->Release();
-    ctx->IASetVertexBuffers(0, 1, &old.VertexBuffer, &old.VertexBufferStride, &old.VertexBufferOffset); if (old.VertexBuffer) old.VertexBuffer->Release();
-    ctx->IASetInputLayout(old.InputLayout); if (old.InputLayout) old.InputLayout->Release();
+    ImGui_ImplDX11_RestoreState(ctx, &old, g_StateCacheEnabled ? changed : (unsigned int)ImGui_ImplDX11_State_All);
+    g_Stats.StateCallsLastFrame = g_FrameStateCalls;
 }
 
 static void ImGui_ImplDX11_CreateFontsTexture()
 {
-    // Build texture atlas
+    // Build texture atlas, or read it back from the font cache
     ImGuiIO& io = ImGui::GetIO();
+    if (!io.Fonts->IsBuilt())
+        ImFontAtlasCache_LoadOrBuild(io.Fonts, g_FontCacheFilename.empty() ? NULL : g_FontCacheFilename.Data);
     unsigned char* pixels;
     int width, height;
     io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
@@ -490,6 +691,8 @@ void    ImGui_ImplDX11_InvalidateDeviceObjects()
     if (g_pFontTextureView) { g_pFontTextureView->Release(); g_pFontTextureView = NULL; ImGui::GetIO().Fonts->TexID = NULL; } // We copied g_pFontTextureView to io.Fonts->TexID so let's clear that as well.
     if (g_pIB) { g_pIB->Release(); g_pIB = NULL; }
     if (g_pVB) { g_pVB->Release(); g_pVB = NULL; }
+    ImGui_ImplDX11_RingReset(&g_IndexRing);
+    ImGui_ImplDX11_RingReset(&g_VertexRing);
 
     if (g_pBlendState) { g_pBlendState->Release(); g_pBlendState = NULL; }
     if (g_pDepthStencilState) { g_pDepthStencilState->Release(); g_pDepthStencilState = NULL; }
@@ -538,8 +741,54 @@ void ImGui_ImplDX11_Shutdown()
     if (g_pd3dDeviceContext) { g_pd3dDeviceContext->Release(); g_pd3dDeviceContext = NULL; }
 }
 
+const ImGui_ImplDX11_Stats& ImGui_ImplDX11_GetStats()
+{
+    return g_Stats;
+}
+
+void ImGui_ImplDX11_ResetStats()
+{
+    g_Stats = ImGui_ImplDX11_Stats();
+}
+
+void ImGui_ImplDX11_SetFontCacheFilename(const char* filename)
+{
+    g_FontCacheFilename.clear();
+    if (filename && filename[0])
+    {
+        const int len = (int)strlen(filename);
+        g_FontCacheFilename.resize(len + 1);
+        memcpy(g_FontCacheFilename.Data, filename, (size_t)len + 1);
+    }
+}
+
+void ImGui_ImplDX11_SetStateCacheEnabled(bool enabled)
+{
+    g_StateCacheEnabled = enabled;
+}
+
+// Upload glyphs rasterized on demand (imgui_fontdynamic). Only the dirty rectangle is sent, the atlas keeps its RGBA32 copy in sync.
+static void ImGui_ImplDX11_UpdateFontsTexture()
+{
+    ImGuiIO& io = ImGui::GetIO();
+    int x, y, w, h;
+    if (!g_pFontTextureView || ImFontAtlasDynamic_Update(io.Fonts, &x, &y, &w, &h) == 0)
+        return;
+
+    unsigned char* pixels;
+    int width, height;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+    ID3D11Resource* pTexture = NULL;
+    g_pFontTextureView->GetResource(&pTexture);
+    D3D11_BOX box = { (UINT)x, (UINT)y, 0, (UINT)(x + w), (UINT)(y + h), 1 };
+    g_pd3dDeviceContext->UpdateSubresource(pTexture, 0, &box, pixels + ((size_t)y * width + x) * 4, (UINT)width * 4, 0);
+    pTexture->Release();
+}
+
 void ImGui_ImplDX11_NewFrame()
 {
     if (!g_pFontSampler)
         ImGui_ImplDX11_CreateDeviceObjects();
+    else
+        ImGui_ImplDX11_UpdateFontsTexture();
 }
\ No newline at end of file
@@ -4,6 +4,14 @@
 // Implemented features:
 //  [X] Renderer: User texture binding. Use 'ID3D11ShaderResourceView*' as ImTextureID. Read the FAQ about ImTextureID!
 //  [X] Renderer: Support for large meshes (64k+ vertices) with 16-bit indices.
+//  [X] Renderer: Persistent vertex/index rings (MAP_WRITE_NO_OVERWRITE), upload counters in ImGui_ImplDX11_GetStats().
+//  [X] Renderer: Optional state cache to skip redundant state setup/restore.
+//  [X] Renderer: Optional on-disk font atlas cache (see imgui_fontcache.h), set with ImGui_ImplDX11_SetFontCacheFilename().
+//  [X] Renderer: Glyphs rasterized on demand (see imgui_fontdynamic.h) are uploaded as dirty sub-rectangles by ImGui_ImplDX11_NewFrame().
+
+// This plugin never calls ImGui_ImplDX11_Init(): BakkesMod renders the overlay with its own back-end, so the rings and counters
+// below only take effect in a host that initializes this file. The plugin's offscreen UI benchmark uses imgui_impl_softraster instead.
+// The ring offsets, wraps and growth (imgui_impl_dx11_ring.h) are covered by tests/Dx11RingTest.cpp with a fake buffer.
 
 // You can copy and use unmodified imgui_impl_* files in your project. See main.cpp for an example of using this.
 // If you are new to dear imgui, read examples/README.txt and read the documentation at the top of imgui.cpp.
@@ -21,4 +29,27 @@ IMGUI_IMPL_API void     ImGui_ImplDX11_RenderDrawData(ImDrawData* draw_data);
 
 // Use if you want to reset your rendering device without losing ImGui state.
 IMGUI_IMPL_API void     ImGui_ImplDX11_InvalidateDeviceObjects();
-IMGUI_IMPL_API bool     ImGui_ImplDX11_CreateDeviceObjects();
\ No newline at end of file
+IMGUI_IMPL_API bool     ImGui_ImplDX11_CreateDeviceObjects();
+
+// Upload and state counters, so buffer churn and state traffic can be measured. Nothing in the plugin reads them (see above).
+struct ImGui_ImplDX11_Stats
+{
+    int                 BufferReallocations;    // Vertex/index buffers created or grown
+    int                 RingWraps;              // Frames that restarted a ring with MAP_WRITE_DISCARD
+    int                 FramesRendered;
+    size_t              BytesUploadedLastFrame; // Vertex + index bytes written by the last ImGui_ImplDX11_RenderDrawData()
+    unsigned long long  BytesUploadedTotal;
+    int                 StateCallsLastFrame;    // Context Get*/Set* calls for state backup, setup, per-command binds and restore
+    int                 FramesSkipped;          // Frames with nothing to draw (pipeline state not touched at all)
+};
+
+IMGUI_IMPL_API const ImGui_ImplDX11_Stats& ImGui_ImplDX11_GetStats();
+IMGUI_IMPL_API void     ImGui_ImplDX11_ResetStats();
+
+// State cache (off by default): only set the state that differs from the game's, and only restore what was set.
+// The plugin does not enable it, as it does not drive this back-end. Its effect is unmeasured in game.
+IMGUI_IMPL_API void     ImGui_ImplDX11_SetStateCacheEnabled(bool enabled);
+
+// Font atlas cache: when set before the device objects are created, the baked atlas is read from / written to this file.
+// Timings end up in ImFontAtlasCache_GetLastProfile(). Pass NULL to always bake.
+IMGUI_IMPL_API void     ImGui_ImplDX11_SetFontCacheFilename(const char* filename);
@@ -0,0 +1,75 @@
+// dear imgui: ring arithmetic of the DirectX11 back-end's dynamic vertex/index buffers
+// Kept free of D3D types so it can be driven without a device: imgui_impl_dx11.cpp creates ID3D11Buffers through the callback and
+// maps them as the result says, tests use a fake buffer (tests/Dx11RingTest.cpp).
+
+// Per frame:
+//   switch (ImGui_ImplDX11_RingReserve(&ring, count, CreateBuffer, user_data))   // Where the frame goes, creating/growing the buffer
+//   Map(ImGui_ImplDX11_RingNeedsDiscard(result) ? WRITE_DISCARD : WRITE_NO_OVERWRITE), write 'count' elements at ring.Head, Unmap
+//   ImGui_ImplDX11_RingCommit(&ring, count);
+
+#pragma once
+
+struct ImGui_ImplDX11_Ring
+{
+    int     Capacity;       // Elements; before the buffer exists, the size it is first created with (grown if a frame needs more)
+    int     Head;           // Next free element
+    bool    HasBuffer;
+
+    ImGui_ImplDX11_Ring(int initial_capacity) { Capacity = initial_capacity; Head = 0; HasBuffer = false; }
+};
+
+enum ImGui_ImplDX11_RingResult
+{
+    ImGui_ImplDX11_RingResult_Failed,       // The buffer could not be created, the frame must not be drawn
+    ImGui_ImplDX11_RingResult_Created,      // New or grown buffer, the frame goes at 0 (WRITE_DISCARD)
+    ImGui_ImplDX11_RingResult_Wrapped,      // The frame did not fit after the head and restarts the ring at 0 (WRITE_DISCARD)
+    ImGui_ImplDX11_RingResult_Appended      // After the previous frames, which the GPU may still read (WRITE_NO_OVERWRITE)
+};
+
+// (Re)creates the buffer for 'capacity' elements, releasing the old one. Returns false on failure.
+typedef bool (*ImGui_ImplDX11_RingCreateFn)(int capacity, void* user_data);
+
+// Make room for 'count' elements.
+// - The buffer is (re)created with geometric growth when a frame doesn't fit, leaving room for a couple more frames.
+// - A frame that doesn't fit after the head restarts the ring at 0 with WRITE_DISCARD (the driver hands us fresh memory).
+// - Otherwise the frame is appended after the head with WRITE_NO_OVERWRITE.
+static inline ImGui_ImplDX11_RingResult ImGui_ImplDX11_RingReserve(ImGui_ImplDX11_Ring* ring, int count, ImGui_ImplDX11_RingCreateFn create, void* user_data)
+{
+    if (!ring->HasBuffer || ring->Capacity < count)
+    {
+        int new_capacity = (ring->Capacity > 0) ? ring->Capacity : 1;
+        while (new_capacity < count * 2)
+            new_capacity *= 2;
+        ring->HasBuffer = false;
+        if (!create(new_capacity, user_data))
+            return ImGui_ImplDX11_RingResult_Failed;
+        ring->HasBuffer = true;
+        ring->Capacity = new_capacity;
+        ring->Head = 0;
+        return ImGui_ImplDX11_RingResult_Created;
+    }
+    if (ring->Head + count > ring->Capacity)
+    {
+        ring->Head = 0;
+        return ImGui_ImplDX11_RingResult_Wrapped;
+    }
+    return ImGui_ImplDX11_RingResult_Appended;
+}
+
+static inline bool ImGui_ImplDX11_RingNeedsDiscard(ImGui_ImplDX11_RingResult result)
+{
+    return result != ImGui_ImplDX11_RingResult_Appended;
+}
+
+// After the frame's 'count' elements were written at ring->Head
+static inline void ImGui_ImplDX11_RingCommit(ImGui_ImplDX11_Ring* ring, int count)
+{
+    ring->Head += count;
+}
+
+// The buffer was released (device lost, shutdown): the next reserve creates it again at the current capacity
+static inline void ImGui_ImplDX11_RingReset(ImGui_ImplDX11_Ring* ring)
+{
+    ring->HasBuffer = false;
+    ring->Head = 0;
+}
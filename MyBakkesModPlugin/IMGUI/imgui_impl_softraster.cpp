@@ -0,0 +1,514 @@
+#include "pch.h"
+// dear imgui: Renderer for a CPU framebuffer (headless, no GPU or window required)
+// This is used for offscreen benchmarks and golden-image comparisons, e.g. on Linux CI where DirectX is not available.
+
+// Implemented features:
+//  [X] Renderer: User texture binding. Use 'ImGui_ImplSoftRaster_Texture*' as ImTextureID.
+//  [X] Renderer: Support for large meshes (64k+ vertices) with 16-bit indices.
+//  [X] Renderer: Optional multi-threaded rasterization, the framebuffer is split in horizontal bands (one per thread).
+
+// The rasterizer follows the same rules as the DX11 back-end where it matters for the output:
+//  - pixel centers are sampled at +0.5, with a top-left fill rule so shared edges (anti-aliased fringes) are never blended twice.
+//  - scissor rectangles are truncated to integers like the D3D11_RECT conversion in imgui_impl_dx11.cpp.
+//  - color = vertex color * texel, blended with SRC_ALPHA / INV_SRC_ALPHA.
+// Every pixel is owned by exactly one band and bands replay the command lists in order, so the output does not depend on the thread count.
+
+#include "imgui.h"
+#include "imgui_impl_softraster.h"
+#include "imgui_fontcache.h"
+#include "imgui_fontdynamic.h"
+#include "imgui_internal.h"  // ImMin/ImMax/ImSwap/ImFileOpen
+
+#include <stdio.h>
+#include <stdint.h>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+
+// Framebuffer data
+static ImVector<ImU32>                  g_Framebuffer;
+static int                              g_FramebufferWidth = 0, g_FramebufferHeight = 0;
+static ImU32                            g_ClearColor = IM_COL32(0, 0, 0, 255);
+static ImVector<ImU32>                  g_FontPixels;
+static ImGui_ImplSoftRaster_Texture     g_FontTexture = { 0, 0, NULL };
+static ImVector<char>                   g_FontCacheFilename;
+static ImGui_ImplSoftRaster_Stats       g_Stats = {};
+
+// Worker threads (band 0 is always rasterized by the calling thread)
+static std::vector<std::thread>         g_Workers;
+static std::mutex                       g_WorkMutex;
+static std::condition_variable          g_WorkCv, g_DoneCv;
+static ImDrawData*                      g_WorkDrawData = NULL;
+static int                              g_WorkBandCount = 1;
+static unsigned int                     g_WorkGeneration = 0;
+static int                              g_WorkPending = 0;
+static bool                             g_WorkQuit = false;
+
+static const int                        SUBPIXEL_BITS = 4;
+static const int64_t                    SUBPIXEL_ONE = 1 << SUBPIXEL_BITS;
+
+struct ImGui_ImplSoftRaster_ClipRect
+{
+    int     x0, y0, x1, y1; // Half-open: [x0,x1) x [y0,y1)
+};
+
+static inline ImU32 ImGui_ImplSoftRaster_Mul8(ImU32 a, ImU32 b)
+{
+    // Exact round(a * b / 255) for 8-bit inputs
+    ImU32 x = a * b + 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+static inline ImU32 ImGui_ImplSoftRaster_Modulate(ImU32 col, ImU32 texel)
+{
+    if (texel == 0xFFFFFFFF)
+        return col;
+    ImU32 r = ImGui_ImplSoftRaster_Mul8((col >> IM_COL32_R_SHIFT) & 0xFF, (texel >> IM_COL32_R_SHIFT) & 0xFF);
+    ImU32 g = ImGui_ImplSoftRaster_Mul8((col >> IM_COL32_G_SHIFT) & 0xFF, (texel >> IM_COL32_G_SHIFT) & 0xFF);
+    ImU32 b = ImGui_ImplSoftRaster_Mul8((col >> IM_COL32_B_SHIFT) & 0xFF, (texel >> IM_COL32_B_SHIFT) & 0xFF);
+    ImU32 a = ImGui_ImplSoftRaster_Mul8((col >> IM_COL32_A_SHIFT) & 0xFF, (texel >> IM_COL32_A_SHIFT) & 0xFF);
+    return (r << IM_COL32_R_SHIFT) | (g << IM_COL32_G_SHIFT) | (b << IM_COL32_B_SHIFT) | (a << IM_COL32_A_SHIFT);
+}
+
+static inline void ImGui_ImplSoftRaster_Blend(ImU32* dst, ImU32 src)
+{
+    ImU32 a = (src >> IM_COL32_A_SHIFT) & 0xFF;
+    if (a == 0)
+        return;
+    if (a == 255)
+    {
+        *dst = src;
+        return;
+    }
+    // Two channels per multiply (16-bit lanes), each lane is round((s * a + d * (255 - a)) / 255).
+    // The source alpha lane is forced to 255 so the destination alpha becomes a + d * (1 - a) (standard "over").
+    ImU32 d = *dst;
+    ImU32 ia = 255 - a;
+    ImU32 rb = (src & 0x00FF00FF) * a + (d & 0x00FF00FF) * ia + 0x00800080;
+    ImU32 ga = (((src >> 8) & 0x000000FF) | 0x00FF0000) * a + ((d >> 8) & 0x00FF00FF) * ia + 0x00800080;
+    rb = ((rb + ((rb >> 8) & 0x00FF00FF)) >> 8) & 0x00FF00FF;
+    ga = ((ga + ((ga >> 8) & 0x00FF00FF)) >> 8) & 0x00FF00FF;
+    *dst = rb | (ga << 8);
+}
+
+static inline ImU32 ImGui_ImplSoftRaster_Sample(const ImGui_ImplSoftRaster_Texture* tex, float u, float v)
+{
+    if (tex == NULL || tex->Pixels == NULL)
+        return 0xFFFFFFFF;
+    int x = (int)(u * tex->Width);
+    int y = (int)(v * tex->Height);
+    x = x < 0 ? 0 : (x >= tex->Width ? tex->Width - 1 : x);
+    y = y < 0 ? 0 : (y >= tex->Height ? tex->Height - 1 : y);
+    return tex->Pixels[y * tex->Width + x];
+}
+
+static inline ImU32 ImGui_ImplSoftRaster_LerpColor(ImU32 c0, ImU32 c1, ImU32 c2, float l0, float l1, float l2)
+{
+    ImU32 out = 0;
+    for (int shift = 0; shift < 32; shift += 8)
+    {
+        float v = ((c0 >> shift) & 0xFF) * l0 + ((c1 >> shift) & 0xFF) * l1 + ((c2 >> shift) & 0xFF) * l2;
+        int iv = (int)(v + 0.5f);
+        out |= (ImU32)(iv < 0 ? 0 : (iv > 255 ? 255 : iv)) << shift;
+    }
+    return out;
+}
+
+static inline int64_t ImGui_ImplSoftRaster_ToFixed(float v)
+{
+    return (int64_t)ImFloor(v * (float)SUBPIXEL_ONE + 0.5f);
+}
+
+static void ImGui_ImplSoftRaster_DrawTriangle(const ImDrawVert* va, const ImDrawVert* vb, const ImDrawVert* vc, const ImVec2& off, const ImGui_ImplSoftRaster_Texture* tex, const ImGui_ImplSoftRaster_ClipRect& clip)
+{
+    int64_t ax = ImGui_ImplSoftRaster_ToFixed(va->pos.x - off.x), ay = ImGui_ImplSoftRaster_ToFixed(va->pos.y - off.y);
+    int64_t bx = ImGui_ImplSoftRaster_ToFixed(vb->pos.x - off.x), by = ImGui_ImplSoftRaster_ToFixed(vb->pos.y - off.y);
+    int64_t cx = ImGui_ImplSoftRaster_ToFixed(vc->pos.x - off.x), cy = ImGui_ImplSoftRaster_ToFixed(vc->pos.y - off.y);
+
+    // Make the winding consistent (no culling, same as the DX11 rasterizer state)
+    int64_t area = (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
+    if (area == 0)
+        return;
+    if (area < 0)
+    {
+        ImSwap(vb, vc);
+        ImSwap(bx, cx);
+        ImSwap(by, cy);
+        area = -area;
+    }
+
+    // Bounding box in pixels, intersected with the clip rectangle
+    int min_x = (int)(ImMin(ax, ImMin(bx, cx)) >> SUBPIXEL_BITS);
+    int min_y = (int)(ImMin(ay, ImMin(by, cy)) >> SUBPIXEL_BITS);
+    int max_x = (int)((ImMax(ax, ImMax(bx, cx)) + SUBPIXEL_ONE - 1) >> SUBPIXEL_BITS);
+    int max_y = (int)((ImMax(ay, ImMax(by, cy)) + SUBPIXEL_ONE - 1) >> SUBPIXEL_BITS);
+    min_x = ImMax(min_x, clip.x0);
+    min_y = ImMax(min_y, clip.y0);
+    max_x = ImMin(max_x, clip.x1 - 1);
+    max_y = ImMin(max_y, clip.y1 - 1);
+    if (min_x > max_x || min_y > max_y)
+        return;
+
+    // Edge functions: w0 is the weight of 'a' (edge b->c), w1 of 'b' (edge c->a), w2 of 'c' (edge a->b).
+    // Top-left rule: pixels exactly on an edge are only kept for top or left edges.
+    const int64_t e0_dx = -(cy - by), e0_dy = (cx - bx);
+    const int64_t e1_dx = -(ay - cy), e1_dy = (ax - cx);
+    const int64_t e2_dx = -(by - ay), e2_dy = (bx - ax);
+    const int64_t bias0 = ((cy - by) < 0 || ((cy - by) == 0 && (cx - bx) > 0)) ? 0 : -1;
+    const int64_t bias1 = ((ay - cy) < 0 || ((ay - cy) == 0 && (ax - cx) > 0)) ? 0 : -1;
+    const int64_t bias2 = ((by - ay) < 0 || ((by - ay) == 0 && (bx - ax) > 0)) ? 0 : -1;
+
+    const int64_t px = (int64_t)min_x * SUBPIXEL_ONE + SUBPIXEL_ONE / 2;
+    const int64_t py = (int64_t)min_y * SUBPIXEL_ONE + SUBPIXEL_ONE / 2;
+    int64_t w0_row = (cx - bx) * (py - by) - (cy - by) * (px - bx) + bias0;
+    int64_t w1_row = (ax - cx) * (py - cy) - (ay - cy) * (px - cx) + bias1;
+    int64_t w2_row = (bx - ax) * (py - ay) - (by - ay) * (px - ax) + bias2;
+
+    // Most ImGui geometry is either flat colored (shapes) or textured with a single color (text), take the cheap paths when we can.
+    const bool flat_col = (va->col == vb->col && va->col == vc->col);
+    const bool flat_uv = (va->uv.x == vb->uv.x && va->uv.x == vc->uv.x && va->uv.y == vb->uv.y && va->uv.y == vc->uv.y);
+    const ImU32 flat_src = (flat_col && flat_uv) ? ImGui_ImplSoftRaster_Modulate(va->col, ImGui_ImplSoftRaster_Sample(tex, va->uv.x, va->uv.y)) : 0;
+    const float inv_area = 1.0f / (float)area;
+
+    for (int y = min_y; y <= max_y; y++)
+    {
+        int64_t w0 = w0_row, w1 = w1_row, w2 = w2_row;
+        ImU32* dst = g_Framebuffer.Data + (size_t)y * g_FramebufferWidth + min_x;
+        for (int x = min_x; x <= max_x; x++, dst++, w0 += e0_dx * SUBPIXEL_ONE, w1 += e1_dx * SUBPIXEL_ONE, w2 += e2_dx * SUBPIXEL_ONE)
+        {
+            if ((w0 | w1 | w2) < 0)
+                continue;
+            if (flat_col && flat_uv)
+            {
+                ImGui_ImplSoftRaster_Blend(dst, flat_src);
+                continue;
+            }
+            // Remove the fill-rule bias before interpolating
+            const float l0 = (float)(w0 - bias0) * inv_area;
+            const float l1 = (float)(w1 - bias1) * inv_area;
+            const float l2 = 1.0f - l0 - l1;
+            ImU32 texel = 0xFFFFFFFF;
+            if (!flat_uv)
+                texel = ImGui_ImplSoftRaster_Sample(tex, va->uv.x * l0 + vb->uv.x * l1 + vc->uv.x * l2, va->uv.y * l0 + vb->uv.y * l1 + vc->uv.y * l2);
+            else
+                texel = ImGui_ImplSoftRaster_Sample(tex, va->uv.x, va->uv.y);
+            const ImU32 col = flat_col ? va->col : ImGui_ImplSoftRaster_LerpColor(va->col, vb->col, vc->col, l0, l1, l2);
+            ImGui_ImplSoftRaster_Blend(dst, ImGui_ImplSoftRaster_Modulate(col, texel));
+        }
+        w0_row += e0_dy * SUBPIXEL_ONE;
+        w1_row += e1_dy * SUBPIXEL_ONE;
+        w2_row += e2_dy * SUBPIXEL_ONE;
+    }
+}
+
+static void ImGui_ImplSoftRaster_GetBand(int band, int band_count, int* out_y0, int* out_y1)
+{
+    *out_y0 = (int)((int64_t)g_FramebufferHeight * band / band_count);
+    *out_y1 = (int)((int64_t)g_FramebufferHeight * (band + 1) / band_count);
+}
+
+static void ImGui_ImplSoftRaster_RenderBand(ImDrawData* draw_data, int band_y0, int band_y1, bool run_callbacks)
+{
+    // Clear our rows
+    for (int y = band_y0; y < band_y1; y++)
+    {
+        ImU32* row = g_Framebuffer.Data + (size_t)y * g_FramebufferWidth;
+        for (int x = 0; x < g_FramebufferWidth; x++)
+            row[x] = g_ClearColor;
+    }
+
+    ImVec2 clip_off = draw_data->DisplayPos;
+    for (int n = 0; n < draw_data->CmdListsCount; n++)
+    {
+        const ImDrawList* cmd_list = draw_data->CmdLists[n];
+        for (int cmd_i = 0; cmd_i < cmd_list->CmdBuffer.Size; cmd_i++)
+        {
+            const ImDrawCmd* pcmd = &cmd_list->CmdBuffer[cmd_i];
+            if (pcmd->UserCallback != NULL)
+            {
+                // User callback, registered via ImDrawList::AddCallback()
+                // (ImDrawCallback_ResetRenderState is a no-op here: we have no render state to reset.)
+                if (run_callbacks && pcmd->UserCallback != ImDrawCallback_ResetRenderState)
+                    pcmd->UserCallback(cmd_list, pcmd);
+                continue;
+            }
+
+            // Apply scissor/clipping rectangle, then clip against our band
+            ImGui_ImplSoftRaster_ClipRect clip;
+            clip.x0 = ImMax((int)(pcmd->ClipRect.x - clip_off.x), 0);
+            clip.y0 = ImMax((int)(pcmd->ClipRect.y - clip_off.y), band_y0);
+            clip.x1 = ImMin((int)(pcmd->ClipRect.z - clip_off.x), g_FramebufferWidth);
+            clip.y1 = ImMin((int)(pcmd->ClipRect.w - clip_off.y), band_y1);
+            if (clip.x0 >= clip.x1 || clip.y0 >= clip.y1)
+                continue;
+
+            const ImGui_ImplSoftRaster_Texture* tex = (const ImGui_ImplSoftRaster_Texture*)pcmd->TextureId;
+            const ImDrawIdx* idx = cmd_list->IdxBuffer.Data + pcmd->IdxOffset;
+            const ImDrawVert* vtx = cmd_list->VtxBuffer.Data + pcmd->VtxOffset;
+            for (unsigned int i = 0; i + 2 < pcmd->ElemCount; i += 3)
+                ImGui_ImplSoftRaster_DrawTriangle(&vtx[idx[i]], &vtx[idx[i + 1]], &vtx[idx[i + 2]], clip_off, tex, clip);
+        }
+    }
+}
+
+static void ImGui_ImplSoftRaster_WorkerMain(int band)
+{
+    unsigned int seen_generation = 0;
+    for (;;)
+    {
+        ImDrawData* draw_data = NULL;
+        int band_count = 0;
+        {
+            std::unique_lock<std::mutex> lock(g_WorkMutex);
+            g_WorkCv.wait(lock, [&] { return g_WorkQuit || g_WorkGeneration != seen_generation; });
+            if (g_WorkQuit)
+                return;
+            seen_generation = g_WorkGeneration;
+            draw_data = g_WorkDrawData;
+            band_count = g_WorkBandCount;
+        }
+
+        int y0, y1;
+        ImGui_ImplSoftRaster_GetBand(band, band_count, &y0, &y1);
+        ImGui_ImplSoftRaster_RenderBand(draw_data, y0, y1, false);
+
+        {
+            std::lock_guard<std::mutex> lock(g_WorkMutex);
+            if (--g_WorkPending == 0)
+                g_DoneCv.notify_one();
+        }
+    }
+}
+
+static void ImGui_ImplSoftRaster_StopWorkers()
+{
+    {
+        std::lock_guard<std::mutex> lock(g_WorkMutex);
+        g_WorkQuit = true;
+    }
+    g_WorkCv.notify_all();
+    for (std::thread& worker : g_Workers)
+        worker.join();
+    g_Workers.clear();
+    g_WorkQuit = false;
+    g_WorkGeneration = 0;
+}
+
+// Render function
+void ImGui_ImplSoftRaster_RenderDrawData(ImDrawData* draw_data)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    g_Stats.DrawCmds = 0;
+    g_Stats.Triangles = 0;
+    for (int n = 0; n < draw_data->CmdListsCount; n++)
+    {
+        const ImDrawList* cmd_list = draw_data->CmdLists[n];
+        for (int cmd_i = 0; cmd_i < cmd_list->CmdBuffer.Size; cmd_i++)
+        {
+            const ImDrawCmd* pcmd = &cmd_list->CmdBuffer[cmd_i];
+            if (pcmd->UserCallback != NULL)
+                continue;
+            g_Stats.DrawCmds++;
+            g_Stats.Triangles += (int)(pcmd->ElemCount / 3);
+        }
+    }
+
+    const int band_count = (int)g_Workers.size() + 1;
+    g_Stats.Threads = band_count;
+    if (band_count == 1)
+    {
+        ImGui_ImplSoftRaster_RenderBand(draw_data, 0, g_FramebufferHeight, true);
+    }
+    else
+    {
+        {
+            std::lock_guard<std::mutex> lock(g_WorkMutex);
+            g_WorkDrawData = draw_data;
+            g_WorkBandCount = band_count;
+            g_WorkPending = band_count - 1;
+            g_WorkGeneration++;
+        }
+        g_WorkCv.notify_all();
+
+        int y0, y1;
+        ImGui_ImplSoftRaster_GetBand(0, band_count, &y0, &y1);
+        ImGui_ImplSoftRaster_RenderBand(draw_data, y0, y1, true);
+
+        std::unique_lock<std::mutex> lock(g_WorkMutex);
+        g_DoneCv.wait(lock, [] { return g_WorkPending == 0; });
+        g_WorkDrawData = NULL;
+    }
+
+    g_Stats.RasterMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void ImGui_ImplSoftRaster_Resize(int width, int height)
+{
+    g_FramebufferWidth = ImMax(width, 0);
+    g_FramebufferHeight = ImMax(height, 0);
+    g_Framebuffer.resize(g_FramebufferWidth * g_FramebufferHeight);
+    for (int i = 0; i < g_Framebuffer.Size; i++)
+        g_Framebuffer[i] = g_ClearColor;
+}
+
+void ImGui_ImplSoftRaster_SetClearColor(ImU32 col)
+{
+    g_ClearColor = col;
+}
+
+const ImU32* ImGui_ImplSoftRaster_GetFramebuffer(int* out_width, int* out_height)
+{
+    if (out_width) *out_width = g_FramebufferWidth;
+    if (out_height) *out_height = g_FramebufferHeight;
+    return g_Framebuffer.Data;
+}
+
+const ImGui_ImplSoftRaster_Stats& ImGui_ImplSoftRaster_GetStats()
+{
+    return g_Stats;
+}
+
+ImU32 ImGui_ImplSoftRaster_HashFramebuffer()
+{
+    ImU32 hash = 2166136261u;
+    const unsigned char* bytes = (const unsigned char*)g_Framebuffer.Data;
+    const size_t size = (size_t)g_Framebuffer.Size * sizeof(ImU32);
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+bool ImGui_ImplSoftRaster_WriteTGA(const char* filename)
+{
+    FILE* f = ImFileOpen(filename, "wb");
+    if (f == NULL)
+        return false;
+
+    // Uncompressed 32-bit true-color, top-left origin
+    unsigned char header[18] = {};
+    header[2] = 2;
+    header[12] = (unsigned char)(g_FramebufferWidth & 0xFF);
+    header[13] = (unsigned char)((g_FramebufferWidth >> 8) & 0xFF);
+    header[14] = (unsigned char)(g_FramebufferHeight & 0xFF);
+    header[15] = (unsigned char)((g_FramebufferHeight >> 8) & 0xFF);
+    header[16] = 32;
+    header[17] = 0x28;
+    bool ok = fwrite(header, 1, sizeof(header), f) == sizeof(header);
+
+    ImVector<unsigned char> row;
+    row.resize(g_FramebufferWidth * 4);
+    for (int y = 0; y < g_FramebufferHeight && ok; y++)
+    {
+        const ImU32* src = g_Framebuffer.Data + (size_t)y * g_FramebufferWidth;
+        for (int x = 0; x < g_FramebufferWidth; x++)
+        {
+            row[x * 4 + 0] = (unsigned char)((src[x] >> IM_COL32_B_SHIFT) & 0xFF);
+            row[x * 4 + 1] = (unsigned char)((src[x] >> IM_COL32_G_SHIFT) & 0xFF);
+            row[x * 4 + 2] = (unsigned char)((src[x] >> IM_COL32_R_SHIFT) & 0xFF);
+            row[x * 4 + 3] = (unsigned char)((src[x] >> IM_COL32_A_SHIFT) & 0xFF);
+        }
+        ok = fwrite(row.Data, 1, (size_t)row.Size, f) == (size_t)row.Size;
+    }
+    fclose(f);
+    return ok;
+}
+
+bool    ImGui_ImplSoftRaster_CreateDeviceObjects()
+{
+    if (g_FontTexture.Pixels)
+        ImGui_ImplSoftRaster_InvalidateDeviceObjects();
+
+    // Build texture atlas (or read it back from the font cache). We keep our own copy so the atlas is free to ClearTexData().
+    ImGuiIO& io = ImGui::GetIO();
+    if (!io.Fonts->IsBuilt())
+        ImFontAtlasCache_LoadOrBuild(io.Fonts, g_FontCacheFilename.empty() ? NULL : g_FontCacheFilename.Data);
+    unsigned char* pixels;
+    int width, height;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+    g_FontPixels.resize(width * height);
+    memcpy(g_FontPixels.Data, pixels, (size_t)width * height * 4);
+    g_FontTexture.Width = width;
+    g_FontTexture.Height = height;
+    g_FontTexture.Pixels = g_FontPixels.Data;
+
+    // Store our identifier
+    io.Fonts->TexID = (ImTextureID)&g_FontTexture;
+    return true;
+}
+
+void    ImGui_ImplSoftRaster_SetFontCacheFilename(const char* filename)
+{
+    g_FontCacheFilename.clear();
+    if (filename && filename[0])
+    {
+        const int len = (int)strlen(filename);
+        g_FontCacheFilename.resize(len + 1);
+        memcpy(g_FontCacheFilename.Data, filename, (size_t)len + 1);
+    }
+}
+
+void    ImGui_ImplSoftRaster_InvalidateDeviceObjects()
+{
+    if (g_FontTexture.Pixels)
+    {
+        g_FontPixels.clear();
+        g_FontTexture.Width = g_FontTexture.Height = 0;
+        g_FontTexture.Pixels = NULL;
+        ImGui::GetIO().Fonts->TexID = NULL; // We copied &g_FontTexture to io.Fonts->TexID so let's clear that as well.
+    }
+}
+
+bool    ImGui_ImplSoftRaster_Init(int width, int height, int thread_count)
+{
+    // Setup back-end capabilities flags
+    ImGuiIO& io = ImGui::GetIO();
+    io.BackendRendererName = "imgui_impl_softraster";
+    io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;  // We can honor the ImDrawCmd::VtxOffset field, allowing for large meshes.
+
+    ImGui_ImplSoftRaster_Resize(width, height);
+    g_Stats = ImGui_ImplSoftRaster_Stats();
+
+    ImGui_ImplSoftRaster_StopWorkers();
+    for (int band = 1; band < thread_count; band++)
+        g_Workers.emplace_back(ImGui_ImplSoftRaster_WorkerMain, band);
+
+    return true;
+}
+
+void ImGui_ImplSoftRaster_Shutdown()
+{
+    ImGui_ImplSoftRaster_StopWorkers();
+    ImGui_ImplSoftRaster_InvalidateDeviceObjects();
+    g_Framebuffer.clear();
+    g_FramebufferWidth = g_FramebufferHeight = 0;
+}
+
+// Copy glyphs rasterized on demand (imgui_fontdynamic) into our texture
+static void ImGui_ImplSoftRaster_UpdateFontsTexture()
+{
+    ImGuiIO& io = ImGui::GetIO();
+    int x, y, w, h;
+    if (ImFontAtlasDynamic_Update(io.Fonts, &x, &y, &w, &h) == 0)
+        return;
+
+    unsigned char* pixels;
+    int width, height;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+    IM_ASSERT(width == g_FontTexture.Width && height == g_FontTexture.Height);
+    for (int row = y; row < y + h; row++)
+        memcpy(g_FontPixels.Data + (size_t)row * width + x, pixels + ((size_t)row * width + x) * 4, (size_t)w * 4);
+}
+
+void ImGui_ImplSoftRaster_NewFrame()
+{
+    if (!g_FontTexture.Pixels)
+        ImGui_ImplSoftRaster_CreateDeviceObjects();
+    else
+        ImGui_ImplSoftRaster_UpdateFontsTexture();
+}
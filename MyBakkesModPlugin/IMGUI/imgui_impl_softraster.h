@@ -0,0 +1,53 @@
+// dear imgui: Renderer for a CPU framebuffer (headless, no GPU or window required)
+// This is used for offscreen benchmarks and golden-image comparisons, e.g. on Linux CI where DirectX is not available.
+
+// Implemented features:
+//  [X] Renderer: User texture binding. Use 'ImGui_ImplSoftRaster_Texture*' as ImTextureID.
+//  [X] Renderer: Support for large meshes (64k+ vertices) with 16-bit indices.
+//  [X] Renderer: Optional multi-threaded rasterization, the framebuffer is split in horizontal bands (one per thread).
+//  [X] Renderer: Optional on-disk font atlas cache (see imgui_fontcache.h), set with ImGui_ImplSoftRaster_SetFontCacheFilename().
+//  [X] Renderer: Glyphs rasterized on demand (see imgui_fontdynamic.h) are copied into the font texture by ImGui_ImplSoftRaster_NewFrame().
+// Missing features:
+//  [ ] Renderer: Texture filtering is nearest only (the DX11 back-end samples bilinear).
+//  [ ] Renderer: User callbacks are only invoked from the thread rasterizing the first band.
+
+#pragma once
+
+// Texture as seen by this back-end. Pixels are RGBA, 8-bit per channel, packed like IM_COL32().
+struct ImGui_ImplSoftRaster_Texture
+{
+    int             Width;
+    int             Height;
+    const ImU32*    Pixels;
+};
+
+// Per-frame counters, reset by ImGui_ImplSoftRaster_RenderDrawData().
+struct ImGui_ImplSoftRaster_Stats
+{
+    int             DrawCmds;           // Non-callback draw commands submitted
+    int             Triangles;          // Triangles submitted (before scissor rejection)
+    int             Threads;            // Threads that took part in the last frame
+    double          RasterMs;           // Wall time spent inside ImGui_ImplSoftRaster_RenderDrawData()
+};
+
+IMGUI_IMPL_API bool     ImGui_ImplSoftRaster_Init(int width, int height, int thread_count = 1);
+IMGUI_IMPL_API void     ImGui_ImplSoftRaster_Shutdown();
+IMGUI_IMPL_API void     ImGui_ImplSoftRaster_NewFrame();
+IMGUI_IMPL_API void     ImGui_ImplSoftRaster_RenderDrawData(ImDrawData* draw_data);
+
+// Framebuffer access. Resizing clears the framebuffer, the clear color is applied at the start of every RenderDrawData().
+IMGUI_IMPL_API void     ImGui_ImplSoftRaster_Resize(int width, int height);
+IMGUI_IMPL_API void     ImGui_ImplSoftRaster_SetClearColor(ImU32 col);
+IMGUI_IMPL_API const ImU32* ImGui_ImplSoftRaster_GetFramebuffer(int* out_width, int* out_height);
+IMGUI_IMPL_API const ImGui_ImplSoftRaster_Stats& ImGui_ImplSoftRaster_GetStats();
+
+// Golden-image helpers. The hash is FNV-1a over the framebuffer bytes, so it is stable across runs and thread counts.
+IMGUI_IMPL_API ImU32    ImGui_ImplSoftRaster_HashFramebuffer();
+IMGUI_IMPL_API bool     ImGui_ImplSoftRaster_WriteTGA(const char* filename);
+
+// Font atlas cache file, read from / written to when the font texture is created. Pass NULL to always bake.
+IMGUI_IMPL_API void     ImGui_ImplSoftRaster_SetFontCacheFilename(const char* filename);
+
+// Use if you want to reset the font texture without losing ImGui state.
+IMGUI_IMPL_API void     ImGui_ImplSoftRaster_InvalidateDeviceObjects();
+IMGUI_IMPL_API bool     ImGui_ImplSoftRaster_CreateDeviceObjects();
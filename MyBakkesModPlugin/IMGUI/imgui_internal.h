@@ -1875,6 +1875,10 @@ IMGUI_API void              ImFontAtlasBuildFinish(ImFontAtlas* atlas);
 IMGUI_API void              ImFontAtlasBuildMultiplyCalcLookupTable(unsigned char out_table[256], float in_multiply_factor);
 IMGUI_API void              ImFontAtlasBuildMultiplyRectAlpha8(const unsigned char table[256], unsigned char* pixels, int x, int y, int w, int h, int stride);
 
+// Called by ImFont::FindGlyph() for codepoints without a glyph, so they can be rasterized on first use (see imgui_fontdynamic.cpp)
+typedef void                (*ImFontGlyphMissHandler)(const ImFont* font, ImWchar c);
+extern IMGUI_API ImFontGlyphMissHandler GImFontGlyphMissHandler;
+
 // Debug Tools
 // Use 'Metrics->Tools->Item Picker' to break into the call-stack of a specific item.
 #ifndef IM_DEBUG_BREAK
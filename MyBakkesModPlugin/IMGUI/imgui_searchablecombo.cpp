@@ -2,6 +2,9 @@
 #include "imgui_searchablecombo.h"
 #include "imgui_internal.h"
 
+#include <chrono>
+#include <string.h>
+
 static float CalcMaxPopupHeightFromItemCount(int items_count)
 {
     ImGuiContext& g = *GImGui;
@@ -157,7 +160,7 @@ void ImGui::EndSearchableCombo()
 
 /* Modified version of Combo from imgui.cpp at line 9343,
  * to include a input field to be able to filter the combo values. */
-bool ImGui::SearchableCombo(const char* label, int* current_item, std::vector<std::string> items, const char* default_preview_text, const char* input_preview_value, int popup_max_height_in_items)
+bool ImGui::SearchableCombo(const char* label, int* current_item, const std::vector<std::string>& items, const char* default_preview_text, const char* input_preview_value, int popup_max_height_in_items)
 {
     ImGuiContext& g = *GImGui;
 
@@ -178,21 +181,22 @@ bool ImGui::SearchableCombo(const char* label, int* current_item, std::vector<st
     if (!BeginSearchableCombo(label, preview_text, input_buffer, input_size, input_preview_value, ImGuiComboFlags_None))
         return false;
 
+    // Lowercase the query once, not once per item
+    std::string input(input_buffer);
+    std::transform(input.begin(), input.end(), input.begin(),
+        [](unsigned char c) { return (unsigned char)std::tolower(c); });
+
     // Display items
     // FIXME-OPT: Use clipper (but we need to disable it on the appearing frame to make sure our call to SetItemDefaultFocus() is processed)
+    //            For large lists use the ImGuiSearchableComboIndex overload, which does.
     int matched_items = 0;
     bool value_changed = false;
+    std::string item;
     for (int i = 0; i < (int)items.size(); i++)
     {
-        char buffer[input_size] = "";
-        ImStrncpy(buffer, input_buffer, input_size);
-        std::string input(buffer);
-        std::string item = items[i];
-
+        item = items[i];
         std::transform(item.begin(), item.end(), item.begin(),
             [](unsigned char c) { return (unsigned char)std::tolower(c); });
-        std::transform(input.begin(), input.end(), input.begin(),
-            [](unsigned char c) { return (unsigned char)std::tolower(c); });
 
         if (item.find(input, 0) == std::string::npos)
             continue;
@@ -216,4 +220,173 @@ bool ImGui::SearchableCombo(const char* label, int* current_item, std::vector<st
     EndSearchableCombo();
 
     return value_changed;
-}
\ No newline at end of file
+}
+
+
+//-----------------------------------------------------------------------------
+// ImGuiSearchableComboIndex
+//-----------------------------------------------------------------------------
+
+static inline uint32_t TrigramKey(const char* p)
+{
+    return ((uint32_t)(unsigned char)p[0] << 16) | ((uint32_t)(unsigned char)p[1] << 8) | (uint32_t)(unsigned char)p[2];
+}
+
+static double ElapsedMs(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void ImGuiSearchableComboIndex::Build(std::span<const std::string> items)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    Items = items;
+    Lower.clear();
+    LowerOffsets.clear();
+    Trigrams.clear();
+
+    size_t total_size = 0;
+    for (const std::string& item : items)
+        total_size += item.size() + 1;
+    Lower.reserve(total_size);
+    LowerOffsets.reserve(items.size() + 1);
+
+    for (int i = 0; i < (int)items.size(); i++)
+    {
+        const int offset = (int)Lower.size();
+        LowerOffsets.push_back(offset);
+        for (unsigned char c : items[i])
+            Lower.push_back((char)std::tolower(c));
+        Lower.push_back('\0');
+
+        // Items are visited in order, so each posting list stays sorted and a trigram seen twice in the same item is only added once
+        const int len = (int)Lower.size() - 1 - offset;
+        for (int j = 0; j + 3 <= len; j++)
+        {
+            std::vector<int>& posting = Trigrams[TrigramKey(Lower.data() + offset + j)];
+            if (posting.empty() || posting.back() != i)
+                posting.push_back(i);
+        }
+    }
+    LowerOffsets.push_back((int)Lower.size());
+
+    // Matches always holds the result of LastQuery: the empty query matches everything
+    LastQuery.clear();
+    Matches.resize(items.size());
+    for (int i = 0; i < (int)items.size(); i++)
+        Matches[i] = i;
+    LastCandidates = (int)items.size();
+    BuildMs = ElapsedMs(start);
+}
+
+const std::vector<int>& ImGuiSearchableComboIndex::Filter(const char* query)
+{
+    std::string q(query ? query : "");
+    std::transform(q.begin(), q.end(), q.begin(),
+        [](unsigned char c) { return (unsigned char)std::tolower(c); });
+    if (q == LastQuery)
+        return Matches;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    // Candidates: the previous matches when the new query contains the previous one (every match must still contain it),
+    // or the shortest posting list among the query's trigrams, whichever is smaller.
+    const std::vector<int>* candidates = NULL;
+    if (q.find(LastQuery) != std::string::npos)
+        candidates = &Matches;
+    static const std::vector<int> no_candidates;
+    for (int j = 0; j + 3 <= (int)q.size(); j++)
+    {
+        auto it = Trigrams.find(TrigramKey(q.data() + j));
+        if (it == Trigrams.end())
+        {
+            candidates = &no_candidates;
+            break;
+        }
+        if (candidates == NULL || it->second.size() < candidates->size())
+            candidates = &it->second;
+    }
+
+    std::vector<int> matches;
+    if (candidates == NULL)
+    {
+        // Short query unrelated to the previous one: scan everything
+        LastCandidates = (int)Items.size();
+        for (int i = 0; i < (int)Items.size(); i++)
+            if (strstr(GetLower(i), q.c_str()) != NULL)
+                matches.push_back(i);
+    }
+    else
+    {
+        LastCandidates = (int)candidates->size();
+        matches.reserve(candidates->size());
+        for (int i : *candidates)
+            if (strstr(GetLower(i), q.c_str()) != NULL)
+                matches.push_back(i);
+    }
+
+    Matches.swap(matches);
+    LastQuery.swap(q);
+    LastFilterMs = ElapsedMs(start);
+    return Matches;
+}
+
+// Same widget as above, over an ImGuiSearchableComboIndex: only the matches are visited, and only the visible ones are submitted.
+bool ImGui::SearchableCombo(const char* label, int* current_item, ImGuiSearchableComboIndex& index, const char* default_preview_text, const char* input_preview_value, int popup_max_height_in_items)
+{
+    ImGuiContext& g = *GImGui;
+    const int items_count = (int)index.Items.size();
+
+    const char* preview_text = NULL;
+    if (*current_item >= items_count)
+        *current_item = 0;
+    if (*current_item >= 0 && *current_item < items_count)
+        preview_text = index.Items[*current_item].c_str();
+    else
+        preview_text = default_preview_text;
+
+    if (popup_max_height_in_items != -1 && !(g.NextWindowData.Flags & ImGuiNextWindowDataFlags_HasSizeConstraint))
+        SetNextWindowSizeConstraints(ImVec2(0, 0), ImVec2(FLT_MAX, CalcMaxPopupHeightFromItemCount(popup_max_height_in_items)));
+
+    if (!BeginSearchableCombo(label, preview_text, index.Query, IM_ARRAYSIZE(index.Query), input_preview_value, ImGuiComboFlags_None))
+        return false;
+
+    const std::string previous_query = index.LastQuery;
+    const std::vector<int>& matches = index.Filter(index.Query);
+    const float line_height = GetTextLineHeightWithSpacing();
+    if (index.LastQuery != previous_query)
+        SetScrollY(0.0f);
+
+    // The clipper skips the selected item when it is out of view, so scroll to it instead of relying on SetItemDefaultFocus()
+    if (IsWindowAppearing() && *current_item >= 0)
+    {
+        std::vector<int>::const_iterator it = std::lower_bound(matches.begin(), matches.end(), *current_item);
+        if (it != matches.end() && *it == *current_item)
+            SetScrollY((float)(it - matches.begin()) * line_height);
+    }
+
+    bool value_changed = false;
+    ImGuiListClipper clipper((int)matches.size(), line_height);
+    while (clipper.Step())
+        for (int n = clipper.DisplayStart; n < clipper.DisplayEnd; n++)
+        {
+            const int i = matches[n];
+            PushID((void*)(intptr_t)i);
+            const bool item_selected = (i == *current_item);
+            if (Selectable(index.Items[i].c_str(), item_selected))
+            {
+                value_changed = true;
+                *current_item = i;
+            }
+            if (item_selected)
+                SetItemDefaultFocus();
+            PopID();
+        }
+    if (matches.empty())
+        ImGui::Selectable("No maps found", false, ImGuiSelectableFlags_Disabled);
+
+    EndSearchableCombo();
+
+    return value_changed;
+}
@@ -5,10 +5,39 @@
 #include <vector>       // vector<>
 #include <string>       // string
 #include <algorithm>    // transform
+#include <span>         // span<>
+#include <unordered_map>// unordered_map<>
+#include <stdint.h>     // uint32_t
+
+// Prebuilt search index for SearchableCombo() over large lists (e.g. a full anthem library).
+// Items are borrowed, not copied: the span must stay valid and unchanged until the next Build().
+// Names are lowercased once, and every distinct trigram maps to the (sorted) items containing it.
+// Filter() narrows the previous result set when the query extends the previous query, so typing
+// one more character only rescans what still matched; other queries start from the shortest trigram list.
+struct ImGuiSearchableComboIndex
+{
+    std::span<const std::string>                    Items;
+    std::string                                     Lower;          // All lowercased names, '\0' separated
+    std::vector<int>                                LowerOffsets;   // Start of each item in Lower, plus one end entry
+    std::unordered_map<uint32_t, std::vector<int>>  Trigrams;
+    char                                            Query[64];      // Input buffer of the combo, kept across frames
+    std::string                                     LastQuery;      // Lowercased query that produced Matches
+    std::vector<int>                                Matches;        // Indices into Items, in item order
+    int                                             LastCandidates; // Items tested by the last Filter() that ran
+    double                                          LastFilterMs;
+    double                                          BuildMs;
+
+    ImGuiSearchableComboIndex()                     { Query[0] = 0; LastCandidates = 0; LastFilterMs = BuildMs = 0.0; }
+
+    IMGUI_API void                                  Build(std::span<const std::string> items);
+    IMGUI_API const std::vector<int>&               Filter(const char* query);
+    const char*                                     GetLower(int i) const { return Lower.data() + LowerOffsets[i]; }
+};
 
 namespace ImGui
 {
     IMGUI_API bool          BeginSearchableCombo(const char* label, const char* preview_value, char* input, int input_size, const char* input_preview_value, ImGuiComboFlags flags = 0);
     IMGUI_API void          EndSearchableCombo();
-    IMGUI_API bool          SearchableCombo(const char* label, int* current_item, std::vector<std::string> items, const char* default_preview_text, const char* input_preview_value, int popup_max_height_in_items = -1);
+    IMGUI_API bool          SearchableCombo(const char* label, int* current_item, const std::vector<std::string>& items, const char* default_preview_text, const char* input_preview_value, int popup_max_height_in_items = -1);
+    IMGUI_API bool          SearchableCombo(const char* label, int* current_item, ImGuiSearchableComboIndex& index, const char* default_preview_text, const char* input_preview_value, int popup_max_height_in_items = -1);
 } // namespace ImGui
\ No newline at end of file
@@ -10,14 +10,26 @@ namespace ImGui {
 	static float s_max_timeline_value;
 
 
-	bool BeginTimeline(const char* str_id, float max_time)
+	bool BeginTimeline(const char* str_id, float max_time, const ImVec2& size)
 	{
 		s_max_timeline_value = max_time;
-		return BeginChild(str_id);
+		return BeginChild(str_id, size);
 	}
 
 
 	static const float TIMELINE_RADIUS = 6;
+	static const float TIMELINE_LABEL_WIDTH = 120;
+
+	// Events and the time axis share one track, to the right of the event labels
+	static float TimelineTrackOffset()
+	{
+		return TIMELINE_LABEL_WIDTH + GImGui->Style.ItemSpacing.x;
+	}
+
+	static float TimelineTrackWidth()
+	{
+		return ImMax(GetWindowContentRegionWidth() - TimelineTrackOffset() - 2 * TIMELINE_RADIUS, 1.0f);
+	}
 
 
 	bool TimelineEvent(const char* str_id, float values[2])
@@ -30,15 +42,17 @@ namespace ImGui {
 		ImVec2 cursor_pos = win->DC.CursorPos;
 
 		// @r-lyeh {
-		Button(str_id, ImVec2(120, 0)); // @todo: enable/disable track channel here
+		Button(str_id, ImVec2(TIMELINE_LABEL_WIDTH, 0)); // @todo: enable/disable track channel here
 		SameLine();
 		cursor_pos += ImVec2(0, GetTextLineHeightWithSpacing() / 3);
 		// }
+		const float track_x = cursor_pos.x + TimelineTrackOffset();
+		const float track_width = TimelineTrackWidth();
 
 		for (int i = 0; i < 2; ++i)
 		{
 			ImVec2 pos = cursor_pos;
-			pos.x += win->Size.x * values[i] / s_max_timeline_value + TIMELINE_RADIUS;
+			pos.x = track_x + track_width * values[i] / s_max_timeline_value + TIMELINE_RADIUS;
 			pos.y += TIMELINE_RADIUS;
 
 			SetCursorScreenPos(pos - ImVec2(TIMELINE_RADIUS, TIMELINE_RADIUS));
@@ -53,7 +67,7 @@ namespace ImGui {
 			}
 			if (IsItemActive() && IsMouseDragging(0))
 			{
-				values[i] += GetIO().MouseDelta.x / win->Size.x * s_max_timeline_value;
+				values[i] += GetIO().MouseDelta.x / track_width * s_max_timeline_value;
 				changed = true;
 			}
 			PopID();
@@ -62,9 +76,9 @@ namespace ImGui {
 		}
 
 		ImVec2 start = cursor_pos;
-		start.x += win->Size.x * values[0] / s_max_timeline_value + 2 * TIMELINE_RADIUS;
+		start.x = track_x + track_width * values[0] / s_max_timeline_value + 2 * TIMELINE_RADIUS;
 		start.y += TIMELINE_RADIUS * 0.5f;
-		ImVec2 end = start + ImVec2(win->Size.x * (values[1] - values[0]) / s_max_timeline_value - 2 * TIMELINE_RADIUS,
+		ImVec2 end = start + ImVec2(track_width * (values[1] - values[0]) / s_max_timeline_value - 2 * TIMELINE_RADIUS,
 			TIMELINE_RADIUS);
 
 		PushID(-1);
@@ -72,8 +86,8 @@ namespace ImGui {
 		InvisibleButton(str_id, end - start);
 		if (IsItemActive() && IsMouseDragging(0))
 		{
-			values[0] += GetIO().MouseDelta.x / win->Size.x * s_max_timeline_value;
-			values[1] += GetIO().MouseDelta.x / win->Size.x * s_max_timeline_value;
+			values[0] += GetIO().MouseDelta.x / track_width * s_max_timeline_value;
+			values[1] += GetIO().MouseDelta.x / track_width * s_max_timeline_value;
 			changed = true;
 		}
 		PopID();
@@ -102,8 +116,9 @@ namespace ImGui {
 		if (t >= 0) {
 			if (t > s_max_timeline_value) t = s_max_timeline_value; t /= s_max_timeline_value;
 			const ImU32 line_color = ColorConvertFloat4ToU32(GImGui->Style.Colors[ImGuiCol_SeparatorActive]);
-			ImVec2 a(win->Pos.x + GetWindowContentRegionMin().x + t * GetWindowContentRegionWidth(), GetWindowContentRegionMin().y + win->Pos.y + win->Scroll.y);
-			ImVec2 b(win->Pos.x + GetWindowContentRegionMin().x + t * GetWindowContentRegionWidth(), GetWindowContentRegionMax().y + win->Pos.y + win->Scroll.y);
+			const float x = win->Pos.x + GetWindowContentRegionMin().x + TimelineTrackOffset() + TIMELINE_RADIUS + t * TimelineTrackWidth();
+			ImVec2 a(x, GetWindowContentRegionMin().y + win->Pos.y + win->Scroll.y);
+			ImVec2 b(x, GetWindowContentRegionMax().y + win->Pos.y + win->Scroll.y);
 			win->DrawList->AddLine(a, b, line_color);
 		}
 		// }
@@ -123,7 +138,7 @@ namespace ImGui {
 		for (int i = 0; i <= LINE_COUNT; ++i)
 		{
 			ImVec2 a = GetWindowContentRegionMin() + win->Pos; // @r-lyeh: - ImVec2(TIMELINE_RADIUS, 0);
-			a.x += i * (GetWindowContentRegionWidth() - 1) / LINE_COUNT; // @r-lyeh: -1
+			a.x += TimelineTrackOffset() + TIMELINE_RADIUS + i * (TimelineTrackWidth() - 1) / LINE_COUNT; // @r-lyeh: -1
 			ImVec2 b = a;
 			b.y = start.y;
 			win->DrawList->AddLine(a, b, line_color);
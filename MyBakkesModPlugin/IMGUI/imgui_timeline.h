@@ -1,7 +1,9 @@
 #pragma once
+#include "imgui.h"
+
 namespace ImGui {
 
-	bool BeginTimeline(const char* str_id, float max_time);
+	bool BeginTimeline(const char* str_id, float max_time, const ImVec2& size = ImVec2(0, 0));
 	bool TimelineEvent(const char* str_id, float times[2]);
 	void EndTimeline(float current_time = -1);
 
@@ -0,0 +1,237 @@
+#include "pch.h"
+#include "imgui_virtuallist.h"
+#include "imgui_internal.h"
+
+#include <algorithm>
+
+//-----------------------------------------------------------------------------
+// ImGuiVirtualList
+//-----------------------------------------------------------------------------
+
+static void ResizeSelection(ImGuiVirtualList* list, int count)
+{
+    if (count == list->ItemsCount && list->SelectionBits.Size == (count + 31) / 32)
+        return;
+    list->SelectionBits.resize((count + 31) / 32);
+    if (list->SelectionBits.Size > 0)
+        memset(list->SelectionBits.Data, 0, (size_t)list->SelectionBits.size_in_bytes());
+    list->SelectedCount = 0;
+    list->NavIndex = list->AnchorIndex = -1;
+}
+
+void ImGuiVirtualList::SetItems(int count, float items_height)
+{
+    IM_ASSERT(count >= 0 && items_height > 0.0f);
+    ResizeSelection(this, count);
+    ItemsCount = count;
+    ItemsHeight = items_height;
+    RowOffsets.clear();
+}
+
+void ImGuiVirtualList::SetItems(int count, ImGuiVirtualListHeightCallback height_callback, void* user_data)
+{
+    IM_ASSERT(count >= 0 && height_callback != NULL);
+    ResizeSelection(this, count);
+    ItemsCount = count;
+    ItemsHeight = 0.0f;
+    RowOffsets.resize(count + 1);
+    float y = 0.0f;
+    for (int i = 0; i < count; i++)
+    {
+        RowOffsets[i] = y;
+        y += ImMax(height_callback(user_data, i), 1.0f);
+    }
+    RowOffsets[count] = y;
+}
+
+void ImGuiVirtualList::SetSelected(int idx, bool selected)
+{
+    IM_ASSERT(idx >= 0 && idx < ItemsCount);
+    ImU32& bits = SelectionBits[idx >> 5];
+    const ImU32 mask = 1u << (idx & 31);
+    if (((bits & mask) != 0) == selected)
+        return;
+    bits ^= mask;
+    SelectedCount += selected ? 1 : -1;
+}
+
+void ImGuiVirtualList::SelectRange(int a, int b)
+{
+    if (a > b)
+        ImSwap(a, b);
+    a = ImMax(a, 0);
+    b = ImMin(b, ItemsCount - 1);
+    for (int i = a; i <= b; i++)
+        SetSelected(i, true);
+}
+
+void ImGuiVirtualList::ClearSelection()
+{
+    if (SelectedCount == 0)
+        return;
+    memset(SelectionBits.Data, 0, (size_t)SelectionBits.size_in_bytes());
+    SelectedCount = 0;
+}
+
+void ImGuiVirtualList::SelectAll()
+{
+    if (ItemsCount == 0)
+        return;
+    memset(SelectionBits.Data, 0xFF, (size_t)SelectionBits.size_in_bytes());
+    if (ItemsCount & 31)
+        SelectionBits.back() = (1u << (ItemsCount & 31)) - 1;
+    SelectedCount = ItemsCount;
+}
+
+//-----------------------------------------------------------------------------
+// Widgets
+//-----------------------------------------------------------------------------
+
+// Keyboard cursor movement, with the same selection rules as clicks
+static void VirtualListMoveNav(ImGuiVirtualList* list, int idx, bool extend)
+{
+    idx = ImClamp(idx, 0, list->ItemsCount - 1);
+    if (extend && list->AnchorIndex >= 0)
+    {
+        list->ClearSelection();
+        list->SelectRange(list->AnchorIndex, idx);
+    }
+    else
+    {
+        list->ClearSelection();
+        list->SetSelected(idx, true);
+        list->AnchorIndex = idx;
+    }
+    list->NavIndex = idx;
+    list->NavScrollPending = true;
+    list->SelectionChanged = true;
+}
+
+static void VirtualListHandleKeyboard(ImGuiVirtualList* list, int page)
+{
+    ImGuiContext& g = *GImGui;
+    if (list->ItemsCount == 0 || !ImGui::IsWindowFocused() || g.ActiveId != 0)
+        return;
+
+    const bool shift = g.IO.KeyShift;
+    const int nav = list->NavIndex;
+    if (g.IO.KeyCtrl && ImGui::IsKeyPressed(ImGui::GetKeyIndex(ImGuiKey_A)))
+    {
+        list->SelectAll();
+        list->SelectionChanged = true;
+    }
+    else if (ImGui::IsKeyPressed(ImGui::GetKeyIndex(ImGuiKey_UpArrow)))
+        VirtualListMoveNav(list, nav < 0 ? 0 : nav - 1, shift);
+    else if (ImGui::IsKeyPressed(ImGui::GetKeyIndex(ImGuiKey_DownArrow)))
+        VirtualListMoveNav(list, nav < 0 ? 0 : nav + 1, shift);
+    else if (ImGui::IsKeyPressed(ImGui::GetKeyIndex(ImGuiKey_PageUp)))
+        VirtualListMoveNav(list, nav < 0 ? 0 : nav - page, shift);
+    else if (ImGui::IsKeyPressed(ImGui::GetKeyIndex(ImGuiKey_PageDown)))
+        VirtualListMoveNav(list, nav < 0 ? 0 : nav + page, shift);
+    else if (ImGui::IsKeyPressed(ImGui::GetKeyIndex(ImGuiKey_Home)))
+        VirtualListMoveNav(list, 0, shift);
+    else if (ImGui::IsKeyPressed(ImGui::GetKeyIndex(ImGuiKey_End)))
+        VirtualListMoveNav(list, list->ItemsCount - 1, shift);
+}
+
+bool ImGui::BeginVirtualList(const char* str_id, ImGuiVirtualList* list, const ImVec2& size, bool border)
+{
+    const int page = ImMax(list->DisplayEnd - list->DisplayStart - 2, 1);    // Last frame's visible rows, minus the partially visible ones
+    list->DisplayStart = list->DisplayEnd = 0;
+    list->SelectionChanged = false;
+    if (!BeginChild(str_id, size, border))
+        return false;
+
+    ImGuiContext& g = *GImGui;
+    ImGuiWindow* window = g.CurrentWindow;
+    list->StartPosY = GetCursorPosY();
+    if (list->ItemsCount == 0)
+        return true;
+
+    VirtualListHandleKeyboard(list, page);
+    if (list->NavScrollPending && list->NavIndex >= 0)
+    {
+        // Applied on the next frame, like every SetScrollY()
+        const float row_min = list->StartPosY + list->GetRowY(list->NavIndex);
+        const float row_max = row_min + list->GetRowHeight(list->NavIndex);
+        const float view_h = window->InnerRect.GetHeight();
+        if (row_min < window->Scroll.y)
+            SetScrollY(row_min - list->StartPosY);
+        else if (row_max > window->Scroll.y + view_h)
+            SetScrollY(row_max - view_h);
+        list->NavScrollPending = false;
+    }
+
+    if (list->ItemsHeight > 0.0f)
+    {
+        CalcListClipping(list->ItemsCount, list->ItemsHeight, &list->DisplayStart, &list->DisplayEnd);
+        return true;
+    }
+
+    // Same coarse clipping as CalcListClipping(), over the row offsets
+    if (g.LogEnabled)
+    {
+        list->DisplayEnd = list->ItemsCount;
+        return true;
+    }
+    if (window->SkipItems)
+        return true;
+    ImRect unclipped_rect = window->ClipRect;
+    if (g.NavMoveRequest)
+        unclipped_rect.Add(g.NavScoringRectScreen);
+    const float y_min = unclipped_rect.Min.y - window->DC.CursorPos.y;
+    const float y_max = unclipped_rect.Max.y - window->DC.CursorPos.y;
+
+    // First row whose bottom is below y_min, first row whose top is at or below y_max
+    const float* offsets = list->RowOffsets.Data;
+    int start = (int)(std::upper_bound(offsets + 1, offsets + list->ItemsCount + 1, y_min) - (offsets + 1));
+    int end = (int)(std::lower_bound(offsets, offsets + list->ItemsCount, y_max) - offsets);
+    if (g.NavMoveRequest && g.NavMoveClipDir == ImGuiDir_Up)
+        start--;
+    if (g.NavMoveRequest && g.NavMoveClipDir == ImGuiDir_Down)
+        end++;
+    list->DisplayStart = ImClamp(start, 0, list->ItemsCount);
+    list->DisplayEnd = ImClamp(end, list->DisplayStart, list->ItemsCount);
+    return true;
+}
+
+void ImGui::EndVirtualList(ImGuiVirtualList* list)
+{
+    // Extend the content to the full list height so the scrollbar covers the rows that were skipped
+    if (list->ItemsCount > 0 && !GetCurrentWindowRead()->SkipItems)
+        SetCursorPosY(list->StartPosY + list->GetTotalHeight());
+    EndChild();
+}
+
+bool ImGui::VirtualListSelectable(ImGuiVirtualList* list, int idx, const char* label, ImGuiSelectableFlags flags)
+{
+    ImGuiContext& g = *GImGui;
+    IM_ASSERT(idx >= 0 && idx < list->ItemsCount);
+
+    SetCursorPosY(list->StartPosY + list->GetRowY(idx));
+    PushID(idx);
+    const bool pressed = Selectable(label, list->IsSelected(idx), flags, ImVec2(0.0f, list->GetRowHeight(idx) - g.Style.ItemSpacing.y));
+    PopID();
+    if (!pressed)
+        return false;
+
+    if (g.IO.KeyCtrl)
+    {
+        list->SetSelected(idx, !list->IsSelected(idx));
+        list->AnchorIndex = idx;
+    }
+    else if (g.IO.KeyShift && list->AnchorIndex >= 0)
+    {
+        list->ClearSelection();
+        list->SelectRange(list->AnchorIndex, idx);
+    }
+    else
+    {
+        list->ClearSelection();
+        list->SetSelected(idx, true);
+        list->AnchorIndex = idx;
+    }
+    list->NavIndex = idx;
+    list->SelectionChanged = true;
+    return true;
+}
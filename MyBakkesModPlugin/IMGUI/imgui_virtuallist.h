@@ -0,0 +1,71 @@
+// dear imgui: virtualized list for large item counts (e.g. a full anthem library)
+// A plain Selectable() loop submits every row each frame, so its cost grows with the item count even though ImGui clips most of them.
+// This list only submits the rows overlapping the visible region: the per-frame cost depends on the list height, not on the item count.
+// Rows of equal height use the coarse clipping of ImGuiListClipper (ImGui::CalcListClipping()). Rows of varying height keep a prefix
+// sum of the heights and binary search the visible range.
+// Selection and keyboard navigation are handled by the list itself, since ImGui's own navigation cannot reach rows that were never submitted:
+// - Click selects a row, Ctrl+Click toggles it, Shift+Click selects the range from the last clicked row.
+// - Up/Down, Page Up/Page Down, Home/End move the cursor (Shift extends the selection), Ctrl+A selects all.
+
+// Usage:
+//   static ImGuiVirtualList list;
+//   list.SetItems(names.size(), ImGui::GetTextLineHeightWithSpacing());    // Or SetItems(count, height_callback, user_data)
+//   if (ImGui::BeginVirtualList("##anthems", &list, ImVec2(0, 300)))
+//       for (int i = list.DisplayStart; i < list.DisplayEnd; i++)
+//           ImGui::VirtualListSelectable(&list, i, names[i].c_str());
+//   ImGui::EndVirtualList(&list);                                           // Always, like EndChild()
+
+// Changelog:
+// - v0.10: Initial version.
+
+#pragma once
+
+#include "imgui.h"
+
+// Height of row 'idx' including the vertical item spacing, e.g. GetTextLineHeightWithSpacing() * lines.
+typedef float (*ImGuiVirtualListHeightCallback)(void* user_data, int idx);
+
+struct ImGuiVirtualList
+{
+    int             ItemsCount;
+    float           ItemsHeight;        // Uniform row height including spacing, 0.0f when rows have their own height
+    ImVector<float> RowOffsets;         // Varying heights: top of each row relative to the first one, plus the total height (ItemsCount + 1 entries)
+    ImVector<ImU32> SelectionBits;
+    int             SelectedCount;
+    int             NavIndex;           // Keyboard cursor / last clicked row, -1 if none
+    int             AnchorIndex;        // Start of Shift ranges
+    bool            NavScrollPending;   // NavIndex was moved by the keyboard and is scrolled into view
+    bool            SelectionChanged;   // Selection was changed by this frame's input
+
+    // Set by BeginVirtualList(): rows to submit this frame
+    int             DisplayStart;
+    int             DisplayEnd;
+    float           StartPosY;          // Local cursor position of the first row
+
+    ImGuiVirtualList()                  { ItemsCount = 0; ItemsHeight = 0.0f; SelectedCount = 0; NavIndex = AnchorIndex = -1; NavScrollPending = SelectionChanged = false; DisplayStart = DisplayEnd = 0; StartPosY = 0.0f; }
+
+    // Uniform heights are cheap to set every frame. Varying heights are summed up front (O(N)): call again only when the items or their heights change.
+    // The selection is kept as long as the item count does not change.
+    IMGUI_API void  SetItems(int count, float items_height);
+    IMGUI_API void  SetItems(int count, ImGuiVirtualListHeightCallback height_callback, void* user_data);
+
+    float           GetRowY(int idx) const      { return ItemsHeight > 0.0f ? ItemsHeight * idx : RowOffsets[idx]; }
+    float           GetRowHeight(int idx) const { return ItemsHeight > 0.0f ? ItemsHeight : RowOffsets[idx + 1] - RowOffsets[idx]; }
+    float           GetTotalHeight() const      { return ItemsCount > 0 ? GetRowY(ItemsCount) : 0.0f; }
+
+    bool            IsSelected(int idx) const   { return (SelectionBits[idx >> 5] & (1u << (idx & 31))) != 0; }
+    IMGUI_API void  SetSelected(int idx, bool selected);
+    IMGUI_API void  SelectRange(int a, int b);  // Inclusive, in either order
+    IMGUI_API void  ClearSelection();
+    IMGUI_API void  SelectAll();
+};
+
+namespace ImGui
+{
+    // Begins a child window, applies keyboard input and computes [DisplayStart, DisplayEnd). Call EndVirtualList() whatever it returns.
+    IMGUI_API bool          BeginVirtualList(const char* str_id, ImGuiVirtualList* list, const ImVec2& size = ImVec2(0, 0), bool border = false);
+    IMGUI_API void          EndVirtualList(ImGuiVirtualList* list);
+
+    // Row 'idx' as a Selectable() spanning the row height; handles click selection. Other widgets can follow with SameLine().
+    IMGUI_API bool          VirtualListSelectable(ImGuiVirtualList* list, int idx, const char* label, ImGuiSelectableFlags flags = 0);
+} // namespace ImGui
@@ -0,0 +1,59 @@
+#include "pch.h"
+#include "imgui_waveform.h"
+#include "imgui_internal.h"
+
+int ImGui::PlotWaveform(const char* label, const float* mins, const float* maxs, int count, const ImVec2& graph_size)
+{
+    ImGuiWindow* window = GetCurrentWindow();
+    if (window->SkipItems)
+        return -1;
+
+    ImGuiContext& g = *GImGui;
+    const ImGuiStyle& style = g.Style;
+    const ImGuiID id = window->GetID(label);
+
+    const ImVec2 label_size = CalcTextSize(label, NULL, true);
+    ImVec2 frame_size = graph_size;
+    if (frame_size.x <= 0.0f)
+        frame_size.x = (float)count + style.FramePadding.x * 2.0f;
+    if (frame_size.y <= 0.0f)
+        frame_size.y = label_size.y * 3.0f + style.FramePadding.y * 2.0f;
+
+    const ImRect frame_bb(window->DC.CursorPos, window->DC.CursorPos + frame_size);
+    const ImRect inner_bb(frame_bb.Min + style.FramePadding, frame_bb.Max - style.FramePadding);
+    const ImRect total_bb(frame_bb.Min, frame_bb.Max + ImVec2(label_size.x > 0.0f ? style.ItemInnerSpacing.x + label_size.x : 0.0f, 0));
+    ItemSize(total_bb, style.FramePadding.y);
+    if (!ItemAdd(total_bb, 0, &frame_bb))
+        return -1;
+    const bool hovered = ItemHoverable(frame_bb, id);
+
+    RenderFrame(frame_bb.Min, frame_bb.Max, GetColorU32(ImGuiCol_FrameBg), true, style.FrameRounding);
+
+    int hovered_idx = -1;
+    if (count > 0)
+    {
+        const float center_y = (inner_bb.Min.y + inner_bb.Max.y) * 0.5f;
+        const float half_height = inner_bb.GetHeight() * 0.5f;
+        const float column_width = inner_bb.GetWidth() / count;
+        if (hovered && inner_bb.Contains(g.IO.MousePos))
+            hovered_idx = ImClamp((int)((g.IO.MousePos.x - inner_bb.Min.x) / column_width), 0, count - 1);
+
+        const ImU32 col_base = GetColorU32(ImGuiCol_PlotLines);
+        const ImU32 col_hovered = GetColorU32(ImGuiCol_PlotLinesHovered);
+        window->DrawList->AddLine(ImVec2(inner_bb.Min.x, center_y), ImVec2(inner_bb.Max.x, center_y), GetColorU32(ImGuiCol_Border));
+        for (int i = 0; i < count; i++)
+        {
+            // At least one pixel tall so silence still shows as a line
+            const float x0 = inner_bb.Min.x + column_width * i;
+            const float y0 = center_y - ImClamp(maxs[i], -1.0f, 1.0f) * half_height;
+            const float y1 = center_y - ImClamp(mins[i], -1.0f, 1.0f) * half_height;
+            window->DrawList->AddRectFilled(ImVec2(x0, ImMin(y0, center_y - 0.5f)), ImVec2(x0 + ImMax(column_width, 1.0f), ImMax(y1, center_y + 0.5f)),
+                i == hovered_idx ? col_hovered : col_base);
+        }
+    }
+
+    if (label_size.x > 0.0f)
+        RenderText(ImVec2(frame_bb.Max.x + style.ItemInnerSpacing.x, inner_bb.Min.y), label);
+
+    return hovered_idx;
+}
@@ -0,0 +1,23 @@
+// dear imgui: audio waveform plot from precomputed min/max columns
+// PlotLines()/PlotHistogram() draw one value per sample and connect them, which both costs O(samples) and aliases badly once a column
+// covers thousands of samples. This widget draws one vertical min..max span per column, the way audio editors do: the caller reduces the
+// audio to exactly one (min, max) pair per pixel column (e.g. from a peak pyramid) and the draw cost is O(width).
+
+// Usage:
+//   int columns = (int)ImGui::GetContentRegionAvail().x;
+//   mins.resize(columns); maxs.resize(columns);
+//   ...fill mins/maxs for the visible time range...
+//   int hovered = ImGui::PlotWaveform("##wave", mins.data(), maxs.data(), columns, ImVec2((float)columns, 60.0f));
+
+// Changelog:
+// - v0.10: Initial version.
+
+#pragma once
+
+#include "imgui.h"
+
+namespace ImGui
+{
+    // Values are in [-1, 1] (clipped). Returns the hovered column, or -1. graph_size.x <= 0 uses one pixel per column.
+    IMGUI_API int PlotWaveform(const char* label, const float* mins, const float* maxs, int count, const ImVec2& graph_size = ImVec2(0, 0));
+}
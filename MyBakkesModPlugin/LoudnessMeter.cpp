@@ -0,0 +1,265 @@
+#include "pch.h"
+#include "LoudnessMeter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define LOUDNESS_SSE2 1
+#endif
+
+namespace
+{
+    constexpr double pi = 3.14159265358979323846;
+
+    struct Biquad
+    {
+        double b0 = 1.0, b1 = 0.0, b2 = 0.0, a1 = 0.0, a2 = 0.0;
+    };
+
+    // K-weighting (BS.1770 annex 1): high shelf modelling the head, then the RLB high-pass, derived for any sample rate
+    void GetKWeighting(uint32_t sampleRate, Biquad& shelf, Biquad& highPass)
+    {
+        double f0 = 1681.974450955533, gainDb = 3.999843853973347, q = 0.7071752369554196;
+        double k = std::tan(pi * f0 / sampleRate);
+        double vh = std::pow(10.0, gainDb / 20.0);
+        double vb = std::pow(vh, 0.4996667741545416);
+        double a0 = 1.0 + k / q + k * k;
+        shelf.b0 = (vh + vb * k / q + k * k) / a0;
+        shelf.b1 = 2.0 * (k * k - vh) / a0;
+        shelf.b2 = (vh - vb * k / q + k * k) / a0;
+        shelf.a1 = 2.0 * (k * k - 1.0) / a0;
+        shelf.a2 = (1.0 - k / q + k * k) / a0;
+
+        f0 = 38.13547087602444;
+        q = 0.5003270373238773;
+        k = std::tan(pi * f0 / sampleRate);
+        a0 = 1.0 + k / q + k * k;
+        highPass.b0 = 1.0;
+        highPass.b1 = -2.0;
+        highPass.b2 = 1.0;
+        highPass.a1 = 2.0 * (k * k - 1.0) / a0;
+        highPass.a2 = (1.0 - k / q + k * k) / a0;
+    }
+
+    // 4x interpolator: 48-tap windowed sinc split in 4 phases of 12 taps, stored tap-major so one load gives a tap of all 4 phases
+    constexpr int truePeakTaps = 12;
+    constexpr int truePeakPhases = 4;
+
+    void GetTruePeakFilter(float (&coefficients)[truePeakTaps][truePeakPhases])
+    {
+        const int length = truePeakTaps * truePeakPhases;
+        for (int phase = 0; phase < truePeakPhases; phase++) {
+            double sum = 0.0;
+            for (int tap = 0; tap < truePeakTaps; tap++) {
+                double n = tap * truePeakPhases + phase - (length - 1) / 2.0;
+                double x = n / truePeakPhases;
+                double sinc = x == 0.0 ? 1.0 : std::sin(pi * x) / (pi * x);
+                double window = 0.5 - 0.5 * std::cos(2.0 * pi * (tap * truePeakPhases + phase + 0.5) / length);
+                coefficients[tap][phase] = (float)(sinc * window);
+                sum += coefficients[tap][phase];
+            }
+            // Unity gain at DC for every phase
+            for (int tap = 0; tap < truePeakTaps; tap++) {
+                coefficients[tap][phase] = (float)(coefficients[tap][phase] / sum);
+            }
+        }
+    }
+
+    struct ChannelState
+    {
+        double z1 = 0.0, z2 = 0.0;      // Shelf, transposed direct form II
+        double w1 = 0.0, w2 = 0.0;      // High-pass
+        double energy = 0.0;            // Sum of squares of the current 100 ms step
+        float history[truePeakTaps * 2] = {};  // Last samples, written twice so reads never wrap
+        int historyPos = 0;
+        float peak = 0.0f;
+    };
+
+    double ChannelWeight(int channel, int channels)
+    {
+        // 5.1: LFE excluded, surrounds +1.5 dB
+        if (channels == 6) {
+            return channel == 3 ? 0.0 : channel >= 4 ? 1.41 : 1.0;
+        }
+        return 1.0;
+    }
+
+    bool Analyze(const float* samples, size_t frames, int channels, uint32_t sampleRate, LoudnessInfo& out, bool simd)
+    {
+        auto start = std::chrono::steady_clock::now();
+        if (frames == 0 || channels <= 0 || sampleRate == 0) {
+            return false;
+        }
+
+        Biquad shelf, highPass;
+        GetKWeighting(sampleRate, shelf, highPass);
+        alignas(16) float coefficients[truePeakTaps][truePeakPhases];
+        GetTruePeakFilter(coefficients);
+        // Oversampling only matters below 96 kHz; above, the sample peak is close enough
+        const bool oversample = sampleRate < 96000;
+
+        std::vector<ChannelState> state(channels);
+        const size_t stepFrames = std::max<size_t>(1, sampleRate / 10);
+        std::vector<double> steps;      // Weighted energy per 100 ms step
+        steps.reserve(frames / stepFrames + 1);
+        size_t inStep = 0;
+
+        for (size_t f = 0; f < frames; f++) {
+            const float* frame = samples + f * channels;
+            for (int c = 0; c < channels; c++) {
+                ChannelState& s = state[c];
+                const double x = frame[c];
+
+                double y = shelf.b0 * x + s.z1;
+                s.z1 = shelf.b1 * x - shelf.a1 * y + s.z2;
+                s.z2 = shelf.b2 * x - shelf.a2 * y;
+                double k = highPass.b0 * y + s.w1;
+                s.w1 = highPass.b1 * y - highPass.a1 * k + s.w2;
+                s.w2 = highPass.b2 * y - highPass.a2 * k;
+                s.energy += k * k;
+
+                if (!oversample) {
+                    s.peak = std::max(s.peak, std::fabs(frame[c]));
+                    continue;
+                }
+                s.historyPos = s.historyPos == 0 ? truePeakTaps - 1 : s.historyPos - 1;
+                s.history[s.historyPos] = s.history[s.historyPos + truePeakTaps] = frame[c];
+                const float* h = s.history + s.historyPos;  // h[0] is the newest sample
+#ifdef LOUDNESS_SSE2
+                if (simd) {
+                    __m128 acc = _mm_setzero_ps();
+                    for (int tap = 0; tap < truePeakTaps; tap++) {
+                        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(h[tap]), _mm_load_ps(coefficients[tap])));
+                    }
+                    acc = _mm_and_ps(acc, _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff)));
+                    acc = _mm_max_ps(acc, _mm_shuffle_ps(acc, acc, _MM_SHUFFLE(1, 0, 3, 2)));
+                    acc = _mm_max_ps(acc, _mm_shuffle_ps(acc, acc, _MM_SHUFFLE(2, 3, 0, 1)));
+                    s.peak = std::max(s.peak, _mm_cvtss_f32(acc));
+                    continue;
+                }
+#endif
+                for (int phase = 0; phase < truePeakPhases; phase++) {
+                    float acc = 0.0f;
+                    for (int tap = 0; tap < truePeakTaps; tap++) {
+                        acc += h[tap] * coefficients[tap][phase];
+                    }
+                    s.peak = std::max(s.peak, std::fabs(acc));
+                }
+            }
+
+            if (++inStep == stepFrames || f + 1 == frames) {
+                double weighted = 0.0;
+                for (int c = 0; c < channels; c++) {
+                    weighted += ChannelWeight(c, channels) * state[c].energy;
+                    state[c].energy = 0.0;
+                }
+                steps.push_back(weighted / inStep);
+                inStep = 0;
+            }
+        }
+
+        // Gating blocks: 400 ms windows (4 steps) every 100 ms; a file shorter than that is one block
+        std::vector<double> blocks;
+        if (steps.size() < 4) {
+            double sum = 0.0;
+            for (double step : steps) {
+                sum += step;
+            }
+            blocks.push_back(sum / steps.size());
+        }
+        else {
+            blocks.reserve(steps.size() - 3);
+            for (size_t i = 0; i + 4 <= steps.size(); i++) {
+                blocks.push_back((steps[i] + steps[i + 1] + steps[i + 2] + steps[i + 3]) / 4.0);
+            }
+        }
+        auto toLufs = [](double energy) { return energy > 0.0 ? -0.691 + 10.0 * std::log10(energy) : -200.0; };
+        auto gatedMean = [&](double gateLufs, double& mean) {
+            double sum = 0.0;
+            size_t count = 0;
+            for (double block : blocks) {
+                if (toLufs(block) > gateLufs) {
+                    sum += block;
+                    count++;
+                }
+            }
+            mean = count ? sum / count : 0.0;
+            return count > 0;
+        };
+        double absoluteMean = 0.0, relativeMean = 0.0;
+        if (gatedMean(-70.0, absoluteMean) && gatedMean(toLufs(absoluteMean) - 10.0, relativeMean)) {
+            out.integratedLufs = toLufs(relativeMean);
+        }
+        else {
+            out.integratedLufs = -70.0;     // Silence
+        }
+
+        float peak = 0.0f;
+        for (const ChannelState& s : state) {
+            peak = std::max(peak, s.peak);
+        }
+        out.truePeakDbtp = peak > 0.0f ? 20.0 * std::log10(peak) : -120.0;
+        out.valid = true;
+        out.gainDb = GetNormalizationGainDb(out, loudnessTargetLufs, loudnessCeilingDbtp);
+        out.gain = std::pow(10.0f, out.gainDb / 20.0f);
+        out.analysisMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return true;
+    }
+}
+
+bool AnalyzeLoudness(const float* samples, size_t frames, int channels, uint32_t sampleRate, LoudnessInfo& out)
+{
+    return Analyze(samples, frames, channels, sampleRate, out, true);
+}
+
+float GetNormalizationGainDb(const LoudnessInfo& info, float targetLufs, float ceilingDbtp)
+{
+    if (!info.valid || info.integratedLufs <= -70.0) {
+        return 0.0f;
+    }
+    // Quiet anthems are raised only as far as their peaks allow
+    double gainDb = std::min((double)targetLufs - info.integratedLufs, (double)ceilingDbtp - info.truePeakDbtp);
+    return (float)std::min(gainDb, (double)loudnessMaxGainDb);
+}
+
+LoudnessBenchmarkResult RunLoudnessBenchmark(double audioSeconds)
+{
+    LoudnessBenchmarkResult result;
+    const uint32_t sampleRate = 48000;
+    const size_t frames = (size_t)(audioSeconds * sampleRate);
+    result.audioSeconds = (double)frames / sampleRate;
+
+    // Music-like signal: a few tones over noise, with a slow envelope
+    std::vector<float> samples(frames * 2);
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+    for (size_t f = 0; f < frames; f++) {
+        double t = (double)f / sampleRate;
+        float envelope = (float)(0.5 + 0.5 * std::sin(2.0 * pi * 0.25 * t));
+        float tone = (float)(0.3 * std::sin(2.0 * pi * 220.0 * t) + 0.2 * std::sin(2.0 * pi * 1760.0 * t));
+        samples[f * 2] = envelope * (tone + 0.1f * noise(rng));
+        samples[f * 2 + 1] = envelope * (tone + 0.1f * noise(rng));
+    }
+
+    LoudnessInfo info;
+    Analyze(samples.data(), frames, 2, sampleRate, info, true);
+    result.simdMs = info.analysisMs;
+    Analyze(samples.data(), frames, 2, sampleRate, info, false);
+    result.scalarMs = info.analysisMs;
+
+    // Reference: a 997 Hz sine at -20 dBFS on both channels reads -20 LUFS (within a few hundredths)
+    const size_t sineFrames = std::min<size_t>(frames, sampleRate * 10);
+    const double amplitude = std::pow(10.0, -20.0 / 20.0);
+    for (size_t f = 0; f < sineFrames; f++) {
+        samples[f * 2] = samples[f * 2 + 1] = (float)(amplitude * std::sin(2.0 * pi * 997.0 * f / sampleRate));
+    }
+    Analyze(samples.data(), sineFrames, 2, sampleRate, info, true);
+    result.sineLufs = info.integratedLufs;
+    result.sineTruePeakDbtp = info.truePeakDbtp;
+    return result;
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Loudness of a whole anthem per ITU-R BS.1770-4 / EBU R128
+struct LoudnessInfo
+{
+    bool valid = false;
+    double integratedLufs = -70.0;  // Gated integrated loudness
+    double truePeakDbtp = -120.0;   // 4x oversampled peak
+    float gainDb = 0.0f;            // Normalization gain, see GetNormalizationGainDb()
+    float gain = 1.0f;              // Same, linear
+    double analysisMs = 0.0;
+};
+
+// Target of the normalization: anthems are brought to the same loudness, without pushing their true peak over the ceiling
+constexpr float loudnessTargetLufs = -16.0f;
+constexpr float loudnessCeilingDbtp = -1.0f;
+constexpr float loudnessMaxGainDb = 12.0f;
+
+// One pass over interleaved samples: K-weighting and 400 ms gating blocks for the integrated loudness, and a 4x polyphase interpolator
+// (SSE2, the four phases in one register) for the true peak. Also fills gainDb/gain for loudnessTargetLufs.
+bool AnalyzeLoudness(const float* samples, size_t frames, int channels, uint32_t sampleRate, LoudnessInfo& out);
+
+float GetNormalizationGainDb(const LoudnessInfo& info, float targetLufs, float ceilingDbtp);
+
+// Analysis throughput over synthetic stereo audio, with and without SSE2
+struct LoudnessBenchmarkResult
+{
+    double audioSeconds = 0.0;
+    double simdMs = 0.0;
+    double scalarMs = 0.0;
+    double sineLufs = 0.0;          // 1 kHz sine at -20 dBFS on both channels: reads about -20 LUFS
+    double sineTruePeakDbtp = 0.0;
+};
+
+LoudnessBenchmarkResult RunLoudnessBenchmark(double audioSeconds);
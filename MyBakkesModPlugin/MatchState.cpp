@@ -0,0 +1,51 @@
+#include "pch.h"
+#include "MatchState.h"
+
+bool MatchState::SetMatch(const std::string& id)
+{
+    if (id == matchId) {
+        return false;
+    }
+    Reset();
+    matchId = id;
+    return true;
+}
+
+void MatchState::Reset()
+{
+    matchId.clear();
+    players.clear();
+    totalGoals = 0;
+    revision++;
+}
+
+int MatchState::AddGoal(const std::string& playerId, const std::string& name, int team)
+{
+    PlayerMatchStats& player = players[playerId];
+    player.name = name;
+    player.team = team;
+    player.goals++;
+    totalGoals++;
+    revision++;
+    return player.goals;
+}
+
+int MatchState::GetGoals(const std::string& playerId) const
+{
+    auto it = players.find(playerId);
+    return it != players.end() ? it->second.goals : 0;
+}
+
+void MatchState::SetReportedGoals(const std::string& playerId, const std::string& name, int team, int goals)
+{
+    PlayerMatchStats& player = players[playerId];
+    player.name = name;
+    player.team = team;
+    player.reportedGoals = goals;
+}
+
+int MatchState::GetReportedGoals(const std::string& playerId) const
+{
+    auto it = players.find(playerId);
+    return it != players.end() ? it->second.reportedGoals : 0;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+struct PlayerMatchStats
+{
+    std::string name;
+    int team = 0;
+    int goals = 0;
+    int reportedGoals = 0;          // The game's own count (PriWrapper::GetMatchGoals) when last seen
+};
+
+// Counters of the current match, kept from the goals the plugin sees. A goal from another match (different match id) starts them over.
+class MatchState
+{
+public:
+    // Clears the counters if 'matchId' is not the current match. Returns whether it did.
+    bool SetMatch(const std::string& matchId);
+    void Reset();
+
+    // Counts a goal for the player with unique id 'playerId'. Returns the player's goals in this match, this one included.
+    int AddGoal(const std::string& playerId, const std::string& name, int team);
+
+    int GetGoals(const std::string& playerId) const;
+    int GetTotalGoals() const { return totalGoals; }
+    const std::string& GetMatchId() const { return matchId; }
+    const std::unordered_map<std::string, PlayerMatchStats>& GetPlayers() const { return players; }
+    // Bumped by every change to the counted goals, so views can tell whether to rebuild what they show
+    uint64_t GetRevision() const { return revision; }
+
+    // The game's goal count of each player, kept to tell who scored: the player whose count moved since it was last seen
+    void SetReportedGoals(const std::string& playerId, const std::string& name, int team, int goals);
+    int GetReportedGoals(const std::string& playerId) const;
+
+private:
+    std::string matchId;
+    std::unordered_map<std::string, PlayerMatchStats> players;     // By unique id
+    int totalGoals = 0;
+    uint64_t revision = 0;
+};
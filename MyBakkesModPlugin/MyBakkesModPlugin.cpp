@@ -1,47 +1,200 @@
 #include "pch.h"
 #include "MyBakkesModPlugin.h"
+#include "UiBenchmark.h"
+#include "AudioDecoder.h"
+#include "IMGUI/imgui_fontcache.h"
+#include "IMGUI/imgui_waveform.h"
+#include "IMGUI/imgui_timeline.h"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
 
 BAKKESMOD_PLUGIN(CustomPlayerAnthems, "Custom Player Anthems", plugin_version, PLUGINTYPE_FREEPLAY | PLUGINTYPE_CUSTOM_TRAINING | PLUGINTYPE_SPECTATOR | PLUGINTYPE_REPLAY)
 
 std::shared_ptr<CVarManagerWrapper> _globalCvarManager;
 
+// Settings go to disk (and keybinds to the game) once nothing changed for this long
+static const double settingsIdleSeconds = 0.5;
+// Saved to settings.cfg only: they are registered with saveToCfg false, so BakkesMod's config.cfg holds no second copy that could
+// override it. BakkesMod writes config.cfg when it shuts down, and a crash lost the session's changes; settings.cfg is written
+// within a second of the last change.
+static const char* persistedCvars[] = {
+    "helloworld_enabled", "helloworld_fade_out", "helloworld_normalize", "helloworld_duck_enabled", "helloworld_duck_depth",
+    "helloworld_duck_threshold", "helloworld_duck_attack", "helloworld_duck_hold", "helloworld_duck_release", "helloworld_stream_seconds",
+    "helloworld_resident_format", "helloworld_playlist_mode", "helloworld_playlist_norepeat", "helloworld_goal_replay",
+    "helloworld_limiter_ceiling", "helloworld_limiter_release", "helloworld_library_folders", "helloworld_library_watch", "helloworld_keybind"
+};
+
 void CustomPlayerAnthems::onLoad()
 {
     _globalCvarManager = cvarManager;
+    auto loadStart = std::chrono::steady_clock::now();
     
     // Log plugin load
     LOG("Custom Player Anthems v{} loaded successfully!", plugin_version);
+    SetStatus("Plugin loaded successfully!");
     
     // Register CVars for configuration (PRD requirements)
-    cvarManager->registerCvar("helloworld_enabled", "1", "Enable/disable Custom Player Anthems", true, true, 0, true, 1);
+    auto enabledCvar = cvarManager->registerCvar("helloworld_enabled", "1", "Enable/disable Custom Player Anthems", true, true, 0, true, 1, false);
+    enabledCvar.addOnValueChanged([this](std::string oldValue, CVarWrapper cvar) {
+        const bool enabled = cvar.getBoolValue();
+        config.Update([enabled](RuntimeConfig& settings) { settings.anthemsEnabled = enabled; });
+    });
+    // Ducking of the other plugin sounds while an anthem plays, applied to the audio engine once it exists
+    auto applyDucking = [this](std::string oldValue, CVarWrapper cvar) {
+        ApplyDucking();
+    };
+    cvarManager->registerCvar("helloworld_duck_enabled", "1", "Lower the other plugin sounds while an anthem plays", true, true, 0, true, 1, false).addOnValueChanged(applyDucking);
+    cvarManager->registerCvar("helloworld_duck_depth", "-12", "Ducking depth in dB", true, true, -40.0f, true, 0.0f, false).addOnValueChanged(applyDucking);
+    cvarManager->registerCvar("helloworld_duck_threshold", "-40", "Anthem level in dBFS that starts the ducking", true, true, -80.0f, true, 0.0f, false).addOnValueChanged(applyDucking);
+    cvarManager->registerCvar("helloworld_duck_attack", "20", "Ducking attack time in ms", true, true, 1.0f, true, 1000.0f, false).addOnValueChanged(applyDucking);
+    cvarManager->registerCvar("helloworld_duck_hold", "300", "Time in ms the ducking holds after the anthem goes quiet", true, true, 0.0f, true, 5000.0f, false).addOnValueChanged(applyDucking);
+    cvarManager->registerCvar("helloworld_duck_release", "600", "Ducking release time in ms", true, true, 10.0f, true, 5000.0f, false).addOnValueChanged(applyDucking);
     cvarManager->registerCvar("helloworld_show_window", "0", "Show Custom Player Anthems window", true, true, 0, true, 1);
+    auto normalizeCvar = cvarManager->registerCvar("helloworld_normalize", "1", "Play anthems at the same loudness (EBU R128)", true, true, 0, true, 1, false);
+    normalizeCvar.addOnValueChanged([this](std::string oldValue, CVarWrapper cvar) {
+        const bool normalize = cvar.getBoolValue();
+        config.Update([normalize](RuntimeConfig& settings) { settings.normalize = normalize; });
+    });
+    auto fadeOutCvar = cvarManager->registerCvar("helloworld_fade_out", "1", "Fade the anthem out at the end", true, true, 0, true, 1, false);
+    fadeOutCvar.addOnValueChanged([this](std::string oldValue, CVarWrapper cvar) {
+        const bool fadeOut = cvar.getBoolValue();
+        config.Update([fadeOut](RuntimeConfig& settings) { settings.fadeOut = fadeOut; });
+    });
+    cvarManager->registerCvar("helloworld_stream_seconds", "180", "Anthems longer than this (seconds) are streamed from disk instead of decoded, 0: never",
+        true, true, 0.0f, true, 3600.0f, false);
+    
+    // Anthem library: the last index is published right away, then refreshed by a background scan
+    std::filesystem::path dataFolder = gameWrapper->GetDataFolder() / "CustomPlayerAnthems";
+    std::error_code ec;
+    std::filesystem::create_directories(dataFolder / "anthems", ec);
+    settingsWriter = std::make_shared<SettingsWriter>(dataFolder / "settings.cfg", settingsIdleSeconds);
+    anthemCache = std::make_unique<AnthemCache>();
+    anthemCache->SetOnDecoded([this](const std::string& path, std::shared_ptr<const DecodedAnthem> anthem, bool reload) {
+        // Runs on the decode thread, log from the game thread
+        gameWrapper->Execute([path, anthem, reload](GameWrapper*) {
+            if (!anthem) {
+                LOG("Could not decode anthem: {}", path);
+            }
+            else {
+                LOG("{} anthem: {} ({:.1f} s, {} Hz, {} ch, decoded in {:.1f} ms, peaks in {:.2f} ms, version {})", reload ? "Reloaded" : "Decoded", path,
+                    anthem->GetDurationSeconds(), anthem->sampleRate, anthem->channels, anthem->decodeMs, anthem->peaks.buildMs, anthem->version);
+                LOG("Anthem loudness: {:.1f} LUFS, true peak {:.1f} dBTP, normalization gain {:+.1f} dB (analyzed in {:.1f} ms)",
+                    anthem->loudness.integratedLufs, anthem->loudness.truePeakDbtp, anthem->loudness.gainDb, anthem->loudness.analysisMs);
+            }
+        });
+    });
+    auto residentCvar = cvarManager->registerCvar("helloworld_resident_format", "0",
+        "How decoded anthems are kept in memory: 0 float, 1 int16, 2 IMA-ADPCM (decoded by the mixer while it plays)", true, true, 0, true, 2, false);
+    residentCvar.addOnValueChanged([this](std::string oldValue, CVarWrapper cvar) {
+        anthemCache->SetResidentFormat((ResidentFormat)cvar.getIntValue());
+        // The selected anthem and the playlist are decoded again in the new format
+        std::shared_ptr<const RuntimeConfig> settings = config.Get();
+        if (!settings->anthemPath.empty() && !settings->anthemStreamed) {
+            anthemCache->Evict(settings->anthemPath);
+            anthemCache->Request(settings->anthemPath);
+        }
+        for (const PlaylistEntry& entry : playlist->GetEntries()) {
+            if (!entry.streamed && entry.path != settings->anthemPath) {
+                anthemCache->Evict(entry.path);
+                anthemCache->Request(entry.path);
+            }
+        }
+        for (const AnthemRule& rule : rules.GetRules()) {
+            if (!rule.streamed && rule.path != settings->anthemPath && !playlist->Contains(rule.path)) {
+                anthemCache->Evict(rule.path);
+                anthemCache->Request(rule.path);
+            }
+        }
+    });
+    anthemCache->SetResidentFormat((ResidentFormat)residentCvar.getIntValue());
+    
+    // Every playlist entry is decoded up front, so a goal never waits for a file
+    playlist = std::make_unique<AnthemPlaylist>(dataFolder / "playlist.txt");
+    auto playlistModeCvar = cvarManager->registerCvar("helloworld_playlist_mode", "0",
+        "How goals pick from the playlist: 0 weighted random, 1 round robin, 2 weighted without repeating the last helloworld_playlist_norepeat", true, true, 0, true, 2, false);
+    playlistModeCvar.addOnValueChanged([this](std::string oldValue, CVarWrapper cvar) {
+        playlist->SetMode((PlaylistMode)cvar.getIntValue());
+    });
+    auto noRepeatCvar = cvarManager->registerCvar("helloworld_playlist_norepeat", "2", "Playlist picks never repeat one of this many last anthems (mode 2)",
+        true, true, 0, true, 100, false);
+    noRepeatCvar.addOnValueChanged([this](std::string oldValue, CVarWrapper cvar) {
+        playlist->SetNoRepeatCount(cvar.getIntValue());
+    });
+    playlist->Load();
+    for (int i = 0; i < (int)playlist->GetEntries().size(); i++) {
+        WavInfo wav;
+        const bool streamed = PrepareAnthem(playlist->GetEntries()[i].path, wav);
+        playlist->SetProbe(i, wav, streamed);
+    }
+    playlist->SetMode((PlaylistMode)playlistModeCvar.getIntValue());
+    playlist->SetNoRepeatCount(noRepeatCvar.getIntValue());
+    PublishPlaylist();
+    rulesPath = dataFolder / "rules.txt";
+    LoadRules();
+    playerAnthems = std::make_unique<PlayerAnthems>(dataFolder / "player_anthems.txt");
+    playerAnthems->Load();
+    playerAnthemsView.store(std::make_shared<const std::vector<PlayerAnthem>>(playerAnthems->GetEntries()));
+    PublishGoalCounters();
+    auto goalReplayCvar = cvarManager->registerCvar("helloworld_goal_replay", "0",
+        "What goal replays do to the anthem: 0 keep playing, 1 restart it when the replay reaches the goal", true, true, 0, true, 1, false);
+    goalReplayCvar.addOnValueChanged([this](std::string oldValue, CVarWrapper cvar) {
+        const GoalReplayMode mode = (GoalReplayMode)cvar.getIntValue();
+        config.Update([mode](RuntimeConfig& settings) { settings.goalReplay = mode; });
+    });
+    config.Update([&](RuntimeConfig& settings) {
+        settings.anthemsEnabled = enabledCvar.getBoolValue();
+        settings.normalize = normalizeCvar.getBoolValue();
+        settings.fadeOut = fadeOutCvar.getBoolValue();
+        settings.goalReplay = (GoalReplayMode)goalReplayCvar.getIntValue();
+    });
+    audioEngine = std::make_unique<AudioEngine>();
+    audioInitialized = audioEngine->Start();
+    LOG("Audio output: {}", audioInitialized ? "waveOut, 48000 Hz stereo" : "no device, mixing without output");
+    auto limiterCeiling = cvarManager->registerCvar("helloworld_limiter_ceiling", "-1.0", "Output limiter ceiling in dBFS", true, true, -12.0f, true, 0.0f, false);
+    auto limiterRelease = cvarManager->registerCvar("helloworld_limiter_release", "100", "Output limiter release time in ms", true, true, 10.0f, true, 1000.0f, false);
+    auto applyLimiter = [this](std::string oldValue, CVarWrapper cvar) {
+        audioEngine->SetLimiter(true, cvarManager->getCvar("helloworld_limiter_ceiling").getFloatValue(),
+            cvarManager->getCvar("helloworld_limiter_release").getFloatValue());
+    };
+    limiterCeiling.addOnValueChanged(applyLimiter);
+    limiterRelease.addOnValueChanged(applyLimiter);
+    audioEngine->SetLimiter(true, limiterCeiling.getFloatValue(), limiterRelease.getFloatValue());
+    ApplyDucking();
+    library = std::make_unique<AnthemLibrary>(dataFolder / "library.index");
+    library->LoadIndex();
+    auto foldersCvar = cvarManager->registerCvar("helloworld_library_folders", PathToUtf8(dataFolder / "anthems"),
+        "Folders scanned for anthem files (WAV, FLAC, Ogg Vorbis), separated by ';'", true, false, 0, false, 0, false);
+    foldersCvar.addOnValueChanged([this](std::string oldValue, CVarWrapper cvar) {
+        SetLibraryFolders(cvar.getStringValue());
+        StartLibraryScan();
+    });
+    SetLibraryFolders(foldersCvar.getStringValue());
+    StartLibraryScan();
+    auto watchCvar = cvarManager->registerCvar("helloworld_library_watch", "1", "Update the anthem library and reload the selected anthem when files change",
+        true, true, 0, true, 1, false);
+    watchCvar.addOnValueChanged([this](std::string oldValue, CVarWrapper cvar) {
+        SetLibraryWatch(cvar.getBoolValue());
+    });
+    SetLibraryWatch(watchCvar.getBoolValue());
     
     // Register F-key binding CVar (Deja-Vu pattern)
-    auto cvar = cvarManager->registerCvar("helloworld_keybind", "None", "F-key to toggle Custom Player Anthems window", true, true);
+    auto cvar = cvarManager->registerCvar("helloworld_keybind", "None", "F-key to toggle Custom Player Anthems window", true, true, 0, false, 0, false);
     keybindCVar = std::make_shared<CVarWrapper>(cvar);
     currentKeybind = keybindCVar->getStringValue();
     
-    // Add callback for keybind changes (following Deja-Vu implementation)
+    // Add callback for keybind changes (following Deja-Vu implementation), bound by ApplyKeybind() once the settings go idle
     keybindCVar->addOnValueChanged([this](std::string oldValue, CVarWrapper cvar) {
-        std::string newBind = cvar.getStringValue();
-        
-        // Unbind old key if it exists and isn't "None"
-        if (!oldValue.empty() && oldValue != "None") {
-            cvarManager->executeCommand("unbind " + oldValue, false);
-            LOG("Unbound old Custom Player Anthems keybind: " + oldValue);
+        if (!keybindPending) {
+            keybindFrom = oldValue;
+            keybindPending = true;
         }
-        
-        // Set new keybind if it's not "None"
-        if (newBind != "None") {
-            cvarManager->setBind(newBind, "togglemenu " + GetMenuName());
-            LOG("Set Custom Player Anthems keybind: " + newBind + " -> togglemenu " + GetMenuName());
-            statusMessage = "Custom Player Anthems keybind set to " + newBind;
-        } else {
-            statusMessage = "Custom Player Anthems keybind cleared";
-        }
-        
-        currentKeybind = newBind;
+        keybindChanged = std::chrono::steady_clock::now();
+        currentKeybind = cvar.getStringValue();
+        ScheduleSettingsWrite();
     });
+    LoadSettings();
     
     // Register console commands with PERMISSION_ALL to work everywhere
     cvarManager->registerNotifier("helloworld_toggle", [this](std::vector<std::string> args) {
@@ -63,9 +216,95 @@ void CustomPlayerAnthems::onLoad()
         LOG("Custom Player Anthems window hide command executed");
     }, "Hide Custom Player Anthems window", PERMISSION_ALL);
     
+    cvarManager->registerNotifier("helloworld_bench_ui", [this](std::vector<std::string> args) {
+        std::lock_guard<std::mutex> lock(uiBenchMutex);
+        uiBenchArgs = args;
+        uiBenchPending = true;
+        LOG("UI bench: runs the next time the plugin window or its settings are drawn");
+    }, "Benchmark the plugin UI offscreen: helloworld_bench_ui [frames] [threads] [fixture_hash]", PERMISSION_ALL);
+    
+    cvarManager->registerNotifier("helloworld_bench_fonts", [this](std::vector<std::string> args) {
+        RunFontBenchmarkCommand(args);
+    }, "Compare full font atlas bake vs lazy glyphs: helloworld_bench_fonts [font_path] [size] [sample_glyphs]", PERMISSION_ALL);
+    
+    cvarManager->registerNotifier("helloworld_bench_search", [this](std::vector<std::string> args) {
+        RunSearchBenchmarkCommand(args);
+    }, "Measure anthem search filtering at 1k/10k/50k items: helloworld_bench_search [query]", PERMISSION_ALL);
+    
+    cvarManager->registerNotifier("helloworld_bench_list", [this](std::vector<std::string> args) {
+        RunListBenchmarkCommand(args);
+    }, "Measure list frame cost at 1k/10k/100k rows, plain vs virtualized: helloworld_bench_list [frames]", PERMISSION_ALL);
+    
+    cvarManager->registerNotifier("helloworld_bench_library", [this](std::vector<std::string> args) {
+        RunLibraryBenchmarkCommand(args);
+    }, "Cold vs incremental anthem library scans over a synthetic tree: helloworld_bench_library [files] [threads]", PERMISSION_ALL);
+    
+    cvarManager->registerNotifier("helloworld_bench_loudness", [this](std::vector<std::string> args) {
+        RunLoudnessBenchmarkCommand(args);
+    }, "Measure loudness analysis throughput in seconds of audio per ms: helloworld_bench_loudness [seconds]", PERMISSION_ALL);
+    
+    cvarManager->registerNotifier("helloworld_bench_ducking", [this](std::vector<std::string> args) {
+        RunDuckingBenchmarkCommand(args);
+    }, "Measure the ducking bus cost per block and its largest gain step: helloworld_bench_ducking [seconds]", PERMISSION_ALL);
+    
+    cvarManager->registerNotifier("helloworld_bench_resident", [this](std::vector<std::string> args) {
+        RunResidentBenchmarkCommand(args);
+    }, "Memory and mixer cost of the resident formats at 1/8/32 anthems: helloworld_bench_resident [seconds] [blocks]", PERMISSION_ALL);
+    
+    cvarManager->registerNotifier("helloworld_bench_codecs", [this](std::vector<std::string> args) {
+        RunCodecBenchmarkCommand(args);
+    }, "Measure anthem decode speed in multiples of real time: helloworld_bench_codecs [file...] (default: the selected anthem)", PERMISSION_ALL);
+    
+    cvarManager->registerNotifier("helloworld_bench_goal_dedup", [this](std::vector<std::string> args) {
+        RunGoalDedupBenchmarkCommand(args);
+    }, "Replay synthetic duplicate goal traces through the goal de-duplication and time it: [events]", PERMISSION_ALL);
+    
+    cvarManager->registerNotifier("helloworld_rules_reload", [this](std::vector<std::string> args) {
+        LoadRules();
+    }, "Reload the goal anthem rules from rules.txt", PERMISSION_ALL);
+    
+    cvarManager->registerNotifier("helloworld_library_rescan", [this](std::vector<std::string> args) {
+        StartLibraryScan();
+    }, "Rescan the anthem library folders in the background", PERMISSION_ALL);
+    
+    cvarManager->registerNotifier("helloworld_ui_stats", [this](std::vector<std::string> args) {
+        const FrameTimeStats frameTime = GetUiFrameTime();
+        LOG("UI frame time: last {:.3f} ms, avg {:.3f} ms, max {:.3f} ms over {} frames (visible: {})",
+            frameTime.lastMs, frameTime.avgMs, frameTime.maxMs, frameTime.samples, IsUiVisible() ? "yes" : "no");
+        if (args.size() > 1 && args[1] == "reset") {
+            // Applied by the render thread before its next UI frame
+            uiFrameTimeReset = true;
+        }
+    }, "Log plugin UI frame time: helloworld_ui_stats [reset]", PERMISSION_ALL);
+    
+    cvarManager->registerNotifier("helloworld_startup_profile", [this](std::vector<std::string> args) {
+        LogStartupProfile();
+    }, "Log plugin load time, and the font atlas bake/cache timings of the last UI benchmark", PERMISSION_ALL);
+    
     // Hook goal scored event (PRD requirement)
     gameWrapper->HookEvent("Function TAGame.GameEvent_Soccar_TA.EventGoalScored", [this](std::string eventName) {
-        OnGoalScored(eventName);
+        OnGoalScored();
+    });
+    
+    // Each kickoff countdown: a new match, or players who joined, rebuild the player anthem lookup before the next goal
+    gameWrapper->HookEvent("Function GameEvent_TA.Countdown.BeginState", [this](std::string eventName) {
+        ServerWrapper server = GetMatchServer();
+        if (!server.IsNull()) {
+            RefreshRoster(server);
+        }
+    });
+    
+    // Goal replays. The ball explodes again when the replay reaches the goal, which is where a restarted anthem lines up.
+    gameWrapper->HookEvent("Function GameEvent_Soccar_TA.ReplayPlayback.BeginState", [this](std::string eventName) {
+        goalReplay.Begin();
+    });
+    gameWrapper->HookEvent("Function GameEvent_Soccar_TA.ReplayPlayback.EndState", [this](std::string eventName) {
+        goalReplay.End();
+    });
+    gameWrapper->HookEvent("Function TAGame.Ball_TA.Explode", [this](std::string eventName) {
+        if (goalReplay.IsActive()) {
+            OnGoalReplayMoment();
+        }
     });
     
     gameWrapper->HookEvent("Function TAGame.Car_TA.OnHitBall", [this](std::string eventName) {
@@ -73,110 +312,1421 @@ void CustomPlayerAnthems::onLoad()
     });
     
     LOG("Custom Player Anthems: Event hooks and commands registered");
-    statusMessage = "Custom Player Anthems ready! Use 'helloworld_toggle' to open window or set WAV file.";
+    SetStatus("Custom Player Anthems ready! Use 'helloworld_toggle' to open window or set WAV file.");
+    
+    onLoadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStart).count();
 }
 
 void CustomPlayerAnthems::onUnload()
 {
+    // Whatever the idle timer has not written yet
+    if (keybindPending) {
+        ApplyKeybind();
+    }
+    settingsWriter->Flush(std::chrono::steady_clock::now());
+    settingsWriter.reset();
+    // Stops the watcher and a running scan and waits for their threads, before the cache they feed goes away
+    library.reset();
+    audioEngine.reset();
+    anthemCache.reset();
     LOG("Custom Player Anthems unloaded");
 }
 
+void CustomPlayerAnthems::LoadSettings()
+{
+    // Saved values first, then the hooks that save changes. A config.cfg written before these cvars left it still sets them once
+    // after the plugin loads; the hooks move what it sets into settings.cfg.
+    for (const auto& [name, value] : settingsWriter->Load()) {
+        const bool persisted = std::find_if(std::begin(persistedCvars), std::end(persistedCvars),
+            [&name](const char* cvarName) { return name == cvarName; }) != std::end(persistedCvars);
+        CVarWrapper cvar = cvarManager->getCvar(name);
+        if (persisted && !cvar.IsNull() && cvar.getStringValue() != value) {
+            cvar.setValue(value);
+        }
+    }
+    for (const char* name : persistedCvars) {
+        const std::string cvarName = name;
+        cvarManager->getCvar(cvarName).addOnValueChanged([this, cvarName](std::string oldValue, CVarWrapper cvar) {
+            PersistCvar(cvarName, cvar.getStringValue());
+        });
+    }
+}
+
+void CustomPlayerAnthems::PersistCvar(const std::string& name, const std::string& value)
+{
+    if (settingsWriter->Set(name, value, std::chrono::steady_clock::now())) {
+        ScheduleSettingsWrite();
+    }
+}
+
+void CustomPlayerAnthems::ScheduleSettingsWrite()
+{
+    if (settingsTimerSet || !settingsWriter) {
+        return;
+    }
+    const auto now = std::chrono::steady_clock::now();
+    double delay = settingsWriter->SecondsUntilDue(now);
+    if (keybindPending) {
+        const double bindDelay = std::max(0.0, settingsIdleSeconds - std::chrono::duration<double>(now - keybindChanged).count());
+        delay = delay < 0.0 ? bindDelay : std::min(delay, bindDelay);
+    }
+    if (delay < 0.0) {
+        return;
+    }
+    settingsTimerSet = true;
+    std::weak_ptr<SettingsWriter> writer = settingsWriter;
+    gameWrapper->SetTimeout([this, writer](GameWrapper*) {
+        // Unloaded since: onUnload already wrote everything
+        if (writer.expired()) {
+            return;
+        }
+        settingsTimerSet = false;
+        RunSettingsBatch();
+    }, (float)delay);
+}
+
+void CustomPlayerAnthems::RunSettingsBatch()
+{
+    const auto now = std::chrono::steady_clock::now();
+    if (keybindPending && std::chrono::duration<double>(now - keybindChanged).count() >= settingsIdleSeconds) {
+        ApplyKeybind();
+    }
+    settingsWriter->Update(now);
+    // Changed again since, or held back by the writes per minute cap
+    ScheduleSettingsWrite();
+}
+
+void CustomPlayerAnthems::ApplyKeybind()
+{
+    keybindPending = false;
+    const std::string newBind = currentKeybind;
+    if (newBind == keybindFrom) {
+        return;
+    }
+    
+    // Unbind old key if it exists and isn't "None"
+    if (!keybindFrom.empty() && keybindFrom != "None") {
+        cvarManager->executeCommand("unbind " + keybindFrom, false);
+        LOG("Unbound old Custom Player Anthems keybind: " + keybindFrom);
+    }
+    
+    // Set new keybind if it's not "None"
+    if (newBind != "None") {
+        cvarManager->setBind(newBind, "togglemenu " + GetMenuName());
+        LOG("Set Custom Player Anthems keybind: " + newBind + " -> togglemenu " + GetMenuName());
+        SetStatus("Custom Player Anthems keybind set to " + newBind);
+    } else {
+        SetStatus("Custom Player Anthems keybind cleared");
+    }
+}
+
+void CustomPlayerAnthems::QueueCvar(const std::string& name, const std::string& value)
+{
+    std::lock_guard<std::mutex> lock(queuedCvarMutex);
+    queuedCvars[name] = value;
+    if (queuedCvarBatch) {
+        return;
+    }
+    queuedCvarBatch = true;
+    gameWrapper->Execute([this](GameWrapper*) {
+        std::map<std::string, std::string> batch;
+        {
+            std::lock_guard<std::mutex> lock(queuedCvarMutex);
+            batch.swap(queuedCvars);
+            queuedCvarBatch = false;
+        }
+        for (const auto& [name, value] : batch) {
+            cvarManager->getCvar(name).setValue(value);
+        }
+    });
+}
+
 void CustomPlayerAnthems::OnBallHit(std::string eventName)
 {
-    if (!customAnthemsEnabled) return;
+    if (!config.Get()->anthemsEnabled) return;
     
     // Example: Log when ball is hit
     LOG("Ball hit detected!");
-    statusMessage = "Ball hit at " + std::to_string(std::time(nullptr));
+    // Only shown by the UI: not formatted on every touch while nothing is visible
+    if (IsUiVisible()) {
+        SetStatus("Ball hit at " + std::to_string(std::time(nullptr)));
+    }
+}
+
+static void GetScores(ServerWrapper server, int scores[2])
+{
+    ArrayWrapper<TeamWrapper> teams = server.GetTeams();
+    for (int i = 0; i < teams.Count(); i++) {
+        TeamWrapper team = teams.Get(i);
+        if (!team.IsNull()) {
+            scores[team.GetTeamNum() & 1] = team.GetScore();
+        }
+    }
 }
 
-void CustomPlayerAnthems::OnGoalScored(std::string eventName)
+void CustomPlayerAnthems::OnGoalScored()
 {
-    if (!customAnthemsEnabled) return;
+    if (!config.Get()->anthemsEnabled) return;
+    
+    ServerWrapper server = GetMatchServer();
+    if (server.IsNull()) {
+        return;
+    }
+    
+    // The same goal can be reported again (network resync, replay transitions): it must not count or play twice.
+    // Freeplay has no resyncs, and its score may not move between goals, so only immediate repeats are dropped there.
+    int scores[2] = {};
+    GetScores(server, scores);
+    const std::string matchId = server.GetMatchGUID();
+    goalDedup.SetWindow(gameWrapper->IsInFreeplay() ? 0.5 : 10.0);
+    if (!goalDedup.Accept(GoalDedup::HashMatchId(matchId), scores[0], scores[1], GoalDedup::Clock::now())) {
+        LOG("Duplicate goal event dropped ({}-{})", scores[0], scores[1]);
+        return;
+    }
     
-    LOG("Goal scored! Checking if local player scored...");
+    // Normally done at the kickoff; also catches the plugin being loaded mid-match (the scorer of that goal is not known then)
+    if (matchState.GetMatchId() != matchId) {
+        RefreshRoster(server);
+    }
+    
+    // Freeplay and custom training only have the local player, who may not be credited with the goal
+    PriWrapper scorer = FindScorer(server);
+    if (scorer.IsNull() && (gameWrapper->IsInFreeplay() || gameWrapper->IsInCustomTraining())) {
+        scorer = gameWrapper->GetPlayerController().GetPRI();
+    }
+    if (!scorer.IsNull()) {
+        ScoreGoal(server, scorer);
+        return;
+    }
+    
+    // The event may come before the game credits the scorer: look again a moment later
+    gameWrapper->SetTimeout([this, matchId](GameWrapper*) {
+        ServerWrapper server = GetMatchServer();
+        if (server.IsNull() || server.GetMatchGUID() != matchId) {
+            return;
+        }
+        PriWrapper scorer = FindScorer(server);
+        if (scorer.IsNull()) {
+            LOG("Goal scored, no player credited (own goal?)");
+            return;
+        }
+        ScoreGoal(server, scorer);
+    }, 0.2f);
+}
+
+PriWrapper CustomPlayerAnthems::FindScorer(ServerWrapper server)
+{
+    ArrayWrapper<PriWrapper> pris = server.GetPRIs();
+    for (int i = 0; i < pris.Count(); i++) {
+        PriWrapper pri = pris.Get(i);
+        if (!pri.IsNull() && pri.GetMatchGoals() > matchState.GetReportedGoals(pri.GetUniqueIdWrapper().GetIdString())) {
+            return pri;
+        }
+    }
+    return PriWrapper(0);
+}
+
+void CustomPlayerAnthems::ScoreGoal(ServerWrapper server, PriWrapper scorer)
+{
+    const int previousVoice = anthemVoice;
+    int scores[2] = {};
+    GetScores(server, scores);
+    
+    // Players who joined since the kickoff
+    const std::string scorerId = scorer.GetUniqueIdWrapper().GetIdString();
+    if (!playerAnthems->IsInRoster(scorerId)) {
+        RefreshRoster(server);
+    }
+    
+    // The PRI's own count covers goals scored before the plugin was loaded
+    const std::string scorerName = scorer.GetPlayerName().ToString();
+    const int team = scorer.GetTeamNum() & 1;
+    GoalFacts facts;
+    facts.scorerGoals = std::max(matchState.AddGoal(scorerId, scorerName, team), scorer.GetMatchGoals());
+    matchState.SetReportedGoals(scorerId, scorerName, team, scorer.GetMatchGoals());
+    PublishGoalCounters();
+    facts.overtime = server.GetbOverTime() != 0;
+    facts.secondsRemaining = server.GetSecondsRemaining();
+    facts.teamScore = scores[team];
+    facts.opponentScore = scores[1 - team];
     
     // Check if local player scored the goal (PRD requirement)
-    if (IsLocalPlayerGoal()) {
-        LOG("Local player scored! Playing custom anthem...");
-        PlayCustomAnthem();
-        statusMessage = "Custom anthem played for your goal!";
-    } else {
+    if (!IsLocalPlayerGoal(scorer)) {
+        const int mapped = IsWatching() ? playerAnthems->FindInMatch(scorerId) : -1;
+        if (mapped >= 0) {
+            const PlayerAnthem& anthem = playerAnthems->GetEntries()[mapped];
+            LOG("{} scored, playing their anthem", scorerName);
+            PlayAnthem(anthem.path, anthem.streamed, anthem.wav, 0.0f, 0.0f);
+            RememberGoalAnthem(previousVoice);
+            SetStatus("Played " + scorerName + "'s anthem");
+            return;
+        }
         LOG("Goal scored by other player, no custom anthem");
-        statusMessage = "Goal scored by other player";
+        SetStatus("Goal scored by other player");
+        return;
     }
     
-    goalCounter++; // Increment counter when goal is scored
+    // The rules were compiled when loaded: a few tests and one table read
+    const int rule = rules.Evaluate(facts);
+    if (rule < 0) {
+        LOG("Local player scored! Playing custom anthem...");
+        PlayCustomAnthem();
+        RememberGoalAnthem(previousVoice);
+        SetStatus("Custom anthem played for your goal!");
+        return;
+    }
+    const AnthemRule& match = rules.GetRules()[rule];
+    LOG("Local player scored (goal {}, {}-{}{}), rule '{}' on line {}", facts.scorerGoals, facts.teamScore, facts.opponentScore,
+        facts.overtime ? ", overtime" : "", match.text, match.line);
+    const int entry = playlist->Find(match.path);
+    const float trimStart = entry >= 0 ? playlist->GetEntries()[entry].trimStart : 0.0f;
+    const float trimEnd = entry >= 0 ? playlist->GetEntries()[entry].trimEnd : 0.0f;
+    PlayAnthem(match.path, match.streamed, match.wav, trimStart, trimEnd);
+    RememberGoalAnthem(previousVoice);
+    SetStatus("Custom anthem played for your goal!");
+}
+
+void CustomPlayerAnthems::RememberGoalAnthem(int previousVoice)
+{
+    if (anthemVoice != previousVoice) {
+        goalVoice = anthemVoice;
+        goalClip = anthemClip;
+        goalPath = anthemVoicePath;
+    }
+}
+
+void CustomPlayerAnthems::OnGoalReplayMoment()
+{
+    // Streamed anthems keep playing: moving them would mean decoding from the file again
+    if (config.Get()->goalReplay != GoalReplayMode::Restart || goalVoice == 0 || !goalClip.anthem) {
+        return;
+    }
+    if (!goalReplay.TrySync(GoalReplayTracker::Clock::now())) {
+        return;
+    }
+    if (audioEngine->GetVoicePosition(goalVoice) >= 0.0) {
+        audioEngine->SeekVoice(goalVoice, (double)goalClip.offset / goalClip.anthem->sampleRate);
+        LOG("Goal replay: anthem restarted at the goal");
+        return;
+    }
+    // It ended before the replay got there: play the clip again, its samples are still held by the clip
+    audioEngine->StopVoice(anthemVoice);
+    goalVoice = audioEngine->Play(goalClip);
+    SetAnthemVoice(goalVoice, goalPath);
+    anthemClip = goalClip;
+    LOG("Goal replay: anthem played again at the goal");
+}
+
+// Length of the fade-out before the end of the (trimmed) anthem
+static const float anthemFadeOutSeconds = 2.0f;
+
+static std::string GetFileName(const std::string& path)
+{
+    size_t lastSlash = path.find_last_of("/\\");
+    return lastSlash != std::string::npos ? path.substr(lastSlash + 1) : path;
 }
 
 // Custom Player Anthems Audio Implementation (PRD functionality)
 void CustomPlayerAnthems::PlayCustomAnthem()
 {
-    if (wavFilePath.empty()) {
+    // A pick is one alias table lookup (a few bounded retries in no-repeat mode) and every entry is already decoded (or opened for
+    // streaming right here), so the goal never waits
+    const int next = playlist->Next();
+    if (next < 0) {
+        PlaySelectedAnthem();
+        return;
+    }
+    const PlaylistEntry& entry = playlist->GetEntries()[next];
+    PlayAnthem(entry.path, entry.streamed, entry.wav, entry.trimStart, entry.trimEnd);
+}
+
+void CustomPlayerAnthems::PlaySelectedAnthem()
+{
+    std::shared_ptr<const RuntimeConfig> settings = config.Get();
+    if (settings->anthemPath.empty()) {
         LOG("No custom anthem file selected");
-        statusMessage = "No custom anthem file selected";
+        SetStatus("No custom anthem file selected");
+        return;
+    }
+    PlayAnthem(settings->anthemPath, settings->anthemStreamed, settings->anthemWav, settings->trimStart, settings->trimEnd);
+}
+
+void CustomPlayerAnthems::PublishSelection()
+{
+    const bool trimmed = !wavFilePath.empty() && trimPath == wavFilePath && trimTimes[1] > trimTimes[0];
+    config.Update([this, trimmed](RuntimeConfig& settings) {
+        settings.anthemPath = wavFilePath;
+        settings.anthemStreamed = anthemStreamed;
+        settings.anthemWav = anthemStreamed ? selectedWav : WavInfo();
+        settings.trimStart = trimmed ? trimTimes[0] : 0.0f;
+        settings.trimEnd = trimmed ? trimTimes[1] : 0.0f;
+    });
+}
+
+void CustomPlayerAnthems::PlayAnthem(const std::string& path, bool streamed, const WavInfo& wav, float trimStart, float trimEnd)
+{
+    std::shared_ptr<const RuntimeConfig> settings = config.Get();
+    const bool fadeOutEnabled = settings->fadeOut;
+    const bool normalizeEnabled = settings->normalize;
+    const bool trimmed = trimEnd > trimStart;
+    const std::string name = GetFileName(path);
+    if (streamed) {
+        // Read ahead from disk by the engine's I/O thread. Nothing was decoded up front, so there is no loudness measurement to normalize with.
+        const double rate = wav.sampleRate;
+        size_t offset = trimmed ? (size_t)(trimStart * rate) : 0;
+        size_t end = trimmed ? (size_t)(trimEnd * rate) : SIZE_MAX;
+        std::shared_ptr<AnthemStream> stream = AnthemStream::Open(Utf8ToPath(path), offset, end > offset ? end - offset : 0);
+        if (!stream) {
+            LOG("Could not open anthem for streaming: {}", path);
+            SetStatus("Could not open custom anthem");
+            return;
+        }
+        AnthemClip clip = AnthemClip::FromStream(stream, fadeOutEnabled ? anthemFadeOutSeconds : 0.0f);
+        audioEngine->StopVoice(anthemVoice);
+        SetAnthemVoice(audioEngine->Play(clip), path);
+        anthemClip = AnthemClip();      // Not kept: it would hold the file and the ring open, and goal replays cannot move a stream
+        LOG("Streaming custom anthem: {} ({:.2f} s - {:.2f} s{})", path, clip.offset / rate, (clip.offset + clip.length) / rate,
+            fadeOutEnabled ? ", fade-out" : "");
+        SetStatus("Playing custom anthem: " + name);
         return;
     }
     
-    // TODO: Implement actual WAV file playback
-    // For now, log the attempt and show status
-    LOG("Playing custom anthem: " + wavFilePath);
-    statusMessage = "Playing custom anthem: " + selectedFileName;
+    std::shared_ptr<const DecodedAnthem> anthem = anthemCache->Get(path);
+    if (!anthem) {
+        LOG("Custom anthem not decoded yet: {}", path);
+        SetStatus("Custom anthem is still loading");
+        return;
+    }
     
-    // TODO: Add fade-out support based on fadeOutEnabled setting
-    if (fadeOutEnabled) {
-        LOG("Fade-out enabled for custom anthem");
+    // The voice reads the trimmed range of the cached samples in place; the fade ends at the trim end
+    AnthemClip clip = AnthemClip::FromSeconds(anthem, trimmed ? trimStart : 0.0, trimmed ? trimEnd : 0.0, fadeOutEnabled ? anthemFadeOutSeconds : 0.0f);
+    clip.gain = normalizeEnabled ? anthem->loudness.gain : 1.0f;
+    audioEngine->StopVoice(anthemVoice);
+    SetAnthemVoice(audioEngine->Play(clip), path);
+    anthemClip = clip;
+    LOG("Playing custom anthem: {} ({:.2f} s - {:.2f} s, gain {:+.1f} dB{})", path, (double)clip.offset / anthem->sampleRate,
+        (double)(clip.offset + clip.length) / anthem->sampleRate, normalizeEnabled ? anthem->loudness.gainDb : 0.0f, fadeOutEnabled ? ", fade-out" : "");
+    SetStatus("Playing custom anthem: " + name);
+}
+
+void CustomPlayerAnthems::SetAnthemVoice(int voice, const std::string& path)
+{
+    anthemVoice = voice;
+    anthemVoicePath = path;
+    auto playing = std::make_shared<PlayingAnthem>();
+    playing->voice = voice;
+    playing->path = path;
+    playingAnthem.store(playing);
+}
+
+bool CustomPlayerAnthems::IsAnthemKept(const std::string& path) const
+{
+    return path == config.Get()->anthemPath || playlist->Contains(path) || rules.Uses(path) || playerAnthems->UsesInMatch(path);
+}
+
+bool CustomPlayerAnthems::PrepareAnthem(const std::string& path, WavInfo& wav)
+{
+    if (!ProbeAudioHeader(Utf8ToPath(path), wav)) {
+        wav = WavInfo{};
     }
+    return QueueAnthem(path, wav);
 }
 
-void CustomPlayerAnthems::LoadWAVFile(const std::string& filePath)
+bool CustomPlayerAnthems::QueueAnthem(const std::string& path, const WavInfo& wav)
 {
+    const float streamSeconds = cvarManager->getCvar("helloworld_stream_seconds").getFloatValue();
+    if (streamSeconds > 0.0f && wav.GetDurationSeconds() > streamSeconds) {
+        return true;
+    }
+    anthemCache->Request(path);
+    return false;
+}
+
+void CustomPlayerAnthems::LoadWAVFile(const std::string& filePath, const WavInfo& wav)
+{
+    const std::string previous = wavFilePath;
+    anthemStreamed = QueueAnthem(filePath, wav);
+    selectedWav = wav;
+    if (anthemStreamed) {
+        LOG("Anthem is {:.0f} s long, it will be streamed from disk", wav.GetDurationSeconds());
+    }
     wavFilePath = filePath;
-    // Extract filename from full path for display
-    size_t lastSlash = filePath.find_last_of("/\\");
-    if (lastSlash != std::string::npos) {
-        selectedFileName = filePath.substr(lastSlash + 1);
-    } else {
-        selectedFileName = filePath;
+    selectedFileName = GetFileName(filePath);
+    
+    // A playlist entry brings its trim along
+    std::shared_ptr<const std::vector<PlaylistEntry>> entries = playlistView.load();
+    for (const PlaylistEntry& entry : *entries) {
+        if (entry.path == filePath && entry.trimEnd > entry.trimStart) {
+            trimPath = filePath;
+            trimTimes[0] = entry.trimStart;
+            trimTimes[1] = entry.trimEnd;
+        }
+    }
+    PublishSelection();
+    
+    // Only the selected anthem, the playlist, the rules and the players in the match stay decoded
+    if (!previous.empty() && previous != filePath) {
+        EvictUnlessKept(previous);
+    }
+    
+    LOG("Loaded anthem file: " + filePath);
+    SetStatus("Loaded custom anthem: " + selectedFileName);
+}
+
+void CustomPlayerAnthems::AddSelectedToPlaylist()
+{
+    PlaylistEntry entry;
+    entry.path = wavFilePath;
+    if (trimPath == wavFilePath && trimTimes[1] > trimTimes[0]) {
+        entry.trimStart = trimTimes[0];
+        entry.trimEnd = trimTimes[1];
+    }
+    entry.wav = selectedWav;
+    entry.streamed = anthemStreamed;
+    const std::string name = selectedFileName;
+    gameWrapper->Execute([this, entry, name](GameWrapper*) {
+        if (playlist->Add(entry)) {
+            playlist->Save();
+            PublishPlaylist();
+            SetStatus("Added to playlist: " + name);
+        }
+    });
+}
+
+void CustomPlayerAnthems::RemoveFromPlaylist(const std::string& path)
+{
+    gameWrapper->Execute([this, path](GameWrapper*) {
+        const int index = playlist->Find(path);
+        if (index < 0) {
+            return;
+        }
+        playlist->Remove(index);
+        playlist->Save();
+        PublishPlaylist();
+        if (!IsAnthemKept(path)) {
+            anthemCache->Evict(path);
+        }
+    });
+}
+
+void CustomPlayerAnthems::SetPlaylistWeight(const std::string& path, float weight)
+{
+    gameWrapper->Execute([this, path, weight](GameWrapper*) {
+        const int index = playlist->Find(path);
+        if (index >= 0) {
+            playlist->SetWeight(index, weight);
+            playlist->Save();
+            PublishPlaylist();
+        }
+    });
+}
+
+void CustomPlayerAnthems::SetPlaylistTrim(const std::string& path, float start, float end)
+{
+    gameWrapper->Execute([this, path, start, end](GameWrapper*) {
+        const int index = playlist->Find(path);
+        if (index >= 0) {
+            playlist->SetTrim(index, start, end);
+            playlist->Save();
+            PublishPlaylist();
+        }
+    });
+}
+
+void CustomPlayerAnthems::PublishPlaylist()
+{
+    playlistView.store(std::make_shared<const std::vector<PlaylistEntry>>(playlist->GetEntries()));
+}
+
+void CustomPlayerAnthems::EvictUnlessKept(const std::string& path)
+{
+    // For the UI: what is kept depends on the playlist, the rules and the player anthems, which the game thread edits
+    gameWrapper->Execute([this, path](GameWrapper*) {
+        if (!IsAnthemKept(path)) {
+            anthemCache->Evict(path);
+        }
+    });
+}
+
+bool CustomPlayerAnthems::IsLocalPlayerGoal(PriWrapper scorer)
+{
+    // In freeplay/training, the local player always scores
+    if (gameWrapper->IsInFreeplay() || gameWrapper->IsInCustomTraining()) {
+        return true;
+    }
+    if (!gameWrapper->IsInGame() && !gameWrapper->IsInOnlineGame()) {
+        return false;
+    }
+    return scorer.GetUniqueIdWrapper().GetIdString() == gameWrapper->GetUniqueID().GetIdString();
+}
+
+void CustomPlayerAnthems::SetStatus(std::string text)
+{
+    auto status = std::make_shared<StatusMessage>();
+    status->revision = ++statusRevision;
+    status->text = std::move(text);
+    statusMessage.store(status);
+}
+
+void CustomPlayerAnthems::PublishGoalCounters()
+{
+    auto counters = std::make_shared<GoalCounters>();
+    counters->revision = matchState.GetRevision();
+    counters->totalGoals = matchState.GetTotalGoals();
+    counters->localGoals = matchState.GetGoals(gameWrapper->GetUniqueID().GetIdString());
+    goalCounters.store(counters);
+}
+
+void CustomPlayerAnthems::ResetGoalCounters()
+{
+    // From the UI: the counters belong to the game thread, which counts the goals
+    gameWrapper->Execute([this](GameWrapper*) {
+        matchState.Reset();
+        PublishGoalCounters();
+        LOG("Goal counter reset");
+    });
+}
+
+ServerWrapper CustomPlayerAnthems::GetMatchServer()
+{
+    if (gameWrapper->IsInReplay()) {
+        return gameWrapper->GetGameEventAsReplay();
+    }
+    return gameWrapper->GetCurrentGameState();
+}
+
+bool CustomPlayerAnthems::IsWatching()
+{
+    // Spectators of an online match have no car
+    return gameWrapper->IsInReplay() || (gameWrapper->IsInOnlineGame() && gameWrapper->GetLocalCar().IsNull());
+}
+
+void CustomPlayerAnthems::RefreshRoster(ServerWrapper server)
+{
+    if (matchState.SetMatch(server.GetMatchGUID())) {
+        PublishGoalCounters();
+    }
+    
+    auto roster = std::make_shared<std::vector<RosterPlayer>>();
+    std::vector<std::string> ids;
+    ArrayWrapper<PriWrapper> pris = server.GetPRIs();
+    for (int i = 0; i < pris.Count(); i++) {
+        PriWrapper pri = pris.Get(i);
+        if (pri.IsNull()) {
+            continue;
+        }
+        roster->push_back({ pri.GetUniqueIdWrapper().GetIdString(), pri.GetPlayerName().ToString() });
+        ids.push_back(roster->back().id);
+        matchState.SetReportedGoals(roster->back().id, roster->back().name, pri.GetTeamNum() & 1, pri.GetMatchGoals());
+    }
+    matchRoster.store(roster);
+    
+    std::vector<std::string> previous;
+    for (const PlayerAnthem& entry : playerAnthems->GetEntries()) {
+        if (playerAnthems->FindInMatch(entry.id) >= 0) {
+            previous.push_back(entry.path);
+        }
+    }
+    if (playerAnthems->BeginMatch(std::move(ids))) {
+        PreparePlayerAnthems(previous);
+    }
+}
+
+void CustomPlayerAnthems::PreparePlayerAnthems(const std::vector<std::string>& previous)
+{
+    // Only the anthems of the players in this match are decoded
+    int mapped = 0;
+    for (int i = 0; i < (int)playerAnthems->GetEntries().size(); i++) {
+        const PlayerAnthem& entry = playerAnthems->GetEntries()[i];
+        if (playerAnthems->FindInMatch(entry.id) == i) {
+            WavInfo wav;
+            const bool streamed = PrepareAnthem(entry.path, wav);
+            playerAnthems->SetProbe(i, wav, streamed);
+            mapped++;
+        }
+    }
+    for (const std::string& path : previous) {
+        if (!IsAnthemKept(path)) {
+            anthemCache->Evict(path);
+        }
+    }
+    LOG("Player anthems: {} of {} mapped players in this match", mapped, playerAnthems->GetEntries().size());
+}
+
+void CustomPlayerAnthems::MapPlayerAnthem(const std::string& id, const std::string& name, const std::string& path)
+{
+    std::vector<std::string> previous;
+    const int index = playerAnthems->Find(id);
+    if (index >= 0) {
+        previous.push_back(playerAnthems->GetEntries()[index].path);
+    }
+    if (path.empty()) {
+        playerAnthems->Remove(index);
+    }
+    else {
+        playerAnthems->Set(id, name, path);
+    }
+    playerAnthems->Save();
+    playerAnthemsView.store(std::make_shared<const std::vector<PlayerAnthem>>(playerAnthems->GetEntries()));
+    PreparePlayerAnthems(previous);
+}
+
+void CustomPlayerAnthems::LoadRules()
+{
+    std::vector<std::string> previous;
+    for (const AnthemRule& rule : rules.GetRules()) {
+        previous.push_back(rule.path);
+    }
+    
+    std::vector<std::string> errors;
+    auto start = std::chrono::steady_clock::now();
+    const bool found = rules.Load(rulesPath, rulesPath.parent_path() / "anthems", errors);
+    const double compileMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    for (const std::string& error : errors) {
+        LOG("rules.txt {}", error);
+    }
+    
+    // Rule anthems are decoded up front like the playlist; the ones no rule uses any more are dropped
+    for (int i = 0; i < (int)rules.GetRules().size(); i++) {
+        WavInfo wav;
+        const bool streamed = PrepareAnthem(rules.GetRules()[i].path, wav);
+        rules.SetProbe(i, wav, streamed);
+    }
+    for (const std::string& path : previous) {
+        if (!IsAnthemKept(path)) {
+            anthemCache->Evict(path);
+        }
+    }
+    if (found) {
+        LOG("Anthem rules: {} rules, {} conditions, compiled in {:.2f} ms", rules.GetRules().size(), rules.GetConditionCount(), compileMs);
+    }
+}
+
+void CustomPlayerAnthems::ToggleLibraryView()
+{
+    showLibrary = !showLibrary;
+    SetStatus(showLibrary ? "Pick an anthem from the library" : "Library closed");
+}
+
+void CustomPlayerAnthems::SetLibraryFolders(const std::string& folderList)
+{
+    std::vector<std::filesystem::path> folders;
+    size_t start = 0;
+    while (start <= folderList.size()) {
+        size_t end = folderList.find(';', start);
+        if (end == std::string::npos) {
+            end = folderList.size();
+        }
+        std::string folder = folderList.substr(start, end - start);
+        folder.erase(0, folder.find_first_not_of(" \t"));
+        folder.erase(folder.find_last_not_of(" \t") + 1);
+        if (!folder.empty()) {
+            folders.push_back(Utf8ToPath(folder));
+        }
+        start = end + 1;
+    }
+    library->SetFolders(std::move(folders));
+}
+
+// Half the cores at most: the game keeps running while the library is indexed
+static int GetLibraryThreads()
+{
+    return std::clamp((int)std::thread::hardware_concurrency() / 2, 1, 4);
+}
+
+void CustomPlayerAnthems::StartLibraryScan()
+{
+    library->StartScan(GetLibraryThreads(), [this](const LibraryScanStats& stats) {
+        // Runs on the scan thread, log from the game thread
+        gameWrapper->Execute([stats](GameWrapper*) {
+            LOG("Anthem library: {} files in {} folders, {} probed, {} unchanged, {} invalid, {} removed, {:.1f} ms on {} threads{}",
+                stats.files, stats.directories, stats.probed, stats.reused, stats.invalid, stats.removed, stats.scanMs, stats.threads,
+                stats.cancelled ? " (cancelled)" : "");
+        });
+    });
+}
+
+DuckingParameters CustomPlayerAnthems::GetDuckingParameters()
+{
+    DuckingParameters parameters;
+    parameters.enabled = cvarManager->getCvar("helloworld_duck_enabled").getBoolValue();
+    parameters.depthDb = cvarManager->getCvar("helloworld_duck_depth").getFloatValue();
+    parameters.thresholdDb = cvarManager->getCvar("helloworld_duck_threshold").getFloatValue();
+    parameters.attackMs = cvarManager->getCvar("helloworld_duck_attack").getFloatValue();
+    parameters.holdMs = cvarManager->getCvar("helloworld_duck_hold").getFloatValue();
+    parameters.releaseMs = cvarManager->getCvar("helloworld_duck_release").getFloatValue();
+    return parameters;
+}
+
+void CustomPlayerAnthems::ApplyDucking()
+{
+    if (audioEngine) {
+        audioEngine->SetDucking(GetDuckingParameters());
+    }
+}
+
+void CustomPlayerAnthems::SetLibraryWatch(bool enabled)
+{
+    if (!enabled) {
+        library->StopWatching();
+        return;
+    }
+    library->StartWatching(GetLibraryThreads(), [this](const std::vector<std::string>& changedPaths) {
+        // Runs on the watcher thread: the cache only holds the selected anthem, so this reloads it if it was touched.
+        // The decode happens on the cache thread and the new samples replace the old ones when complete.
+        int reloads = anthemCache->Reload(changedPaths);
+        size_t changes = changedPaths.size();
+        gameWrapper->Execute([changes, reloads](GameWrapper*) {
+            LOG("Anthem library: {} file(s) changed on disk{}", changes, reloads > 0 ? ", reloading the selected anthem" : "");
+        });
+    });
+    if (!library->IsWatching()) {
+        LOG("Anthem library: file watching is not available for these folders");
+    }
+}
+
+void CustomPlayerAnthems::RenderWaveform()
+{
+    std::shared_ptr<const DecodedAnthem> anthem = wavFilePath.empty() ? nullptr : anthemCache->Get(wavFilePath);
+    if (!anthem || anthem->peaks.levels.empty()) {
+        waveformAnthem.reset();
+        if (anthemStreamed && !wavFilePath.empty()) {
+            ImGui::TextDisabled("%.2f s, streamed from disk: no waveform preview or loudness normalization", selectedWav.GetDurationSeconds());
+        }
+        return;
+    }
+    const double frames = (double)anthem->GetFrameCount();
+    if (anthem != waveformAnthem) {
+        // New selection or hot reload: show the whole anthem
+        waveformAnthem = anthem;
+        waveformBegin = 0.0;
+        waveformEnd = frames;
+    }
+    
+    // One (min, max) pair per pixel column, read from the peak pyramid: the cost depends on the width, not the anthem length
+    const ImGuiStyle& style = ImGui::GetStyle();
+    float width = ImGui::GetContentRegionAvail().x;
+    int columns = std::max(1, (int)(width - style.FramePadding.x * 2.0f));
+    waveformMin.resize(columns);
+    waveformMax.resize(columns);
+    // Compact anthems have no float samples: the finest zoom levels show the level 0 peaks
+    anthem->peaks.Resample(anthem->samples.empty() ? nullptr : anthem->samples.data(), waveformBegin, waveformEnd, columns, waveformMin.data(), waveformMax.data());
+    int hovered = ImGui::PlotWaveform("##Waveform", waveformMin.data(), waveformMax.data(), columns,
+        ImVec2(width, ImGui::GetTextLineHeight() * 4.0f + style.FramePadding.y * 2.0f));
+    
+    // Wheel zooms around the mouse, drag pans, double-click shows everything again
+    if (hovered >= 0) {
+        const double span = waveformEnd - waveformBegin;
+        const double anchor = waveformBegin + span * (hovered + 0.5) / columns;
+        const ImGuiIO& io = ImGui::GetIO();
+        if (io.MouseWheel != 0.0f) {
+            double newSpan = std::clamp(span * std::pow(0.8, (double)io.MouseWheel), std::min((double)columns, frames), frames);
+            waveformBegin = anchor - (anchor - waveformBegin) * newSpan / span;
+            waveformEnd = waveformBegin + newSpan;
+        }
+        if (ImGui::IsMouseDragging(ImGuiMouseButton_Left)) {
+            double shift = -(double)io.MouseDelta.x * span / columns;
+            waveformBegin += shift;
+            waveformEnd += shift;
+        }
+        if (ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left)) {
+            waveformBegin = 0.0;
+            waveformEnd = frames;
+        }
+        double shift = std::max(0.0, -waveformBegin) - std::max(0.0, waveformEnd - frames);
+        waveformBegin += shift;
+        waveformEnd += shift;
+        ImGui::SetTooltip("%.2f s", anchor / anthem->sampleRate);
+    }
+    ImGui::Text("%.2f s - %.2f s of %.2f s, %.1f LUFS, %.1f dBTP, gain %+.1f dB", waveformBegin / anthem->sampleRate, waveformEnd / anthem->sampleRate,
+        anthem->GetDurationSeconds(), anthem->loudness.integratedLufs, anthem->loudness.truePeakDbtp, anthem->loudness.gainDb);
+}
+
+void CustomPlayerAnthems::RenderTrim()
+{
+    // Same anthem as the waveform drawn just above, or the streamed file's length
+    float duration;
+    if (waveformAnthem) {
+        duration = (float)waveformAnthem->GetDurationSeconds();
+    }
+    else if (anthemStreamed && !wavFilePath.empty()) {
+        duration = (float)selectedWav.GetDurationSeconds();
+    }
+    else {
+        return;
+    }
+    if (trimPath != wavFilePath) {
+        trimPath = wavFilePath;
+        trimTimes[0] = 0.0f;
+        trimTimes[1] = duration;
+    }
+    trimTimes[1] = std::min(trimTimes[1], duration);    // A hot reload may have shortened the file
+    trimTimes[0] = std::min(trimTimes[0], trimTimes[1]);
+    
+    const ImGuiStyle& style = ImGui::GetStyle();
+    if (ImGui::BeginTimeline("##AnthemTrim", duration, ImVec2(0.0f, ImGui::GetTextLineHeightWithSpacing() * 2.0f + style.WindowPadding.y * 2.0f))) {
+        ImGui::TimelineEvent("Trim", trimTimes);
+    }
+    // The voice is started on the game thread: only its published snapshot is read here
+    std::shared_ptr<const PlayingAnthem> playing = playingAnthem.load();
+    ImGui::EndTimeline(playing && playing->path == wavFilePath ? (float)audioEngine->GetVoicePosition(playing->voice) : -1.0f);
+    
+    ImGui::Text("Plays %.2f s - %.2f s (%.2f s)", trimTimes[0], trimTimes[1], trimTimes[1] - trimTimes[0]);
+    ImGui::SameLine();
+    // The anthem voice belongs to the game thread, which starts the goal anthems
+    if (ImGui::SmallButton("Preview")) {
+        gameWrapper->Execute([this](GameWrapper*) { PlaySelectedAnthem(); });
+    }
+    ImGui::SameLine();
+    if (ImGui::SmallButton("Stop")) {
+        gameWrapper->Execute([this](GameWrapper*) { audioEngine->StopVoice(anthemVoice); });
+    }
+    ImGui::SameLine();
+    if (ImGui::SmallButton("Reset trim")) {
+        trimTimes[0] = 0.0f;
+        trimTimes[1] = duration;
+    }
+    
+    std::shared_ptr<const RuntimeConfig> settings = config.Get();
+    if (settings->trimStart != trimTimes[0] || settings->trimEnd != trimTimes[1]) {
+        trimChanged = true;
+    }
+    // Not a snapshot per frame while a handle is dragged
+    if (trimChanged && !ImGui::IsMouseDown(ImGuiMouseButton_Left)) {
+        PublishSelection();
+        trimChanged = false;
+        
+        // The playlist entry of the selected anthem plays the same range
+        const bool whole = trimTimes[0] <= 0.0f && trimTimes[1] >= duration;
+        const float start = whole ? 0.0f : trimTimes[0];
+        const float end = whole ? 0.0f : trimTimes[1];
+        std::shared_ptr<const std::vector<PlaylistEntry>> entries = playlistView.load();
+        for (const PlaylistEntry& entry : *entries) {
+            if (entry.path == wavFilePath && (entry.trimStart != start || entry.trimEnd != end)) {
+                SetPlaylistTrim(entry.path, start, end);
+            }
+        }
+    }
+}
+
+void CustomPlayerAnthems::RefreshLibrarySnapshot()
+{
+    bool scanning = library->IsScanning();
+    uint64_t generation = library->GetGeneration();
+    if (generation == libraryGeneration && scanning == libraryWasScanning && libraryEntries) {
+        return;
+    }
+    
+    if (generation != libraryGeneration || !libraryEntries) {
+        libraryEntries = library->GetEntries();
+        libraryNames.clear();
+        libraryNames.reserve(libraryEntries->size());
+        for (const LibraryEntry& entry : *libraryEntries) {
+            libraryNames.push_back(entry.name);
+        }
+        // Keep the typed filter across rebuilds
+        std::string query = librarySearch.Query;
+        librarySearch.Build(libraryNames);
+        snprintf(librarySearch.Query, sizeof(librarySearch.Query), "%s", query.c_str());
+        libraryList.ClearSelection();
+        libraryGeneration = generation;
+    }
+    libraryWasScanning = scanning;
+    libraryStatusLine = std::to_string(libraryEntries->size()) + " anthems in " + std::to_string(library->GetFolders().size()) + " folder(s)"
+        + (scanning ? ", scanning..." : "");
+}
+
+void CustomPlayerAnthems::RenderLibraryView()
+{
+    if (!showLibrary) {
+        return;
+    }
+    RefreshLibrarySnapshot();
+    
+    ImGui::TextUnformatted(libraryStatusLine.c_str());
+    ImGui::SameLine();
+    if (ImGui::Button("Rescan")) {
+        StartLibraryScan();
+    }
+    
+    ImGui::InputTextWithHint("##LibraryFilter", "Search anthems", librarySearch.Query, IM_ARRAYSIZE(librarySearch.Query));
+    std::string previousQuery = librarySearch.LastQuery;
+    const std::vector<int>& matches = librarySearch.Filter(librarySearch.Query);
+    if (librarySearch.LastQuery != previousQuery) {
+        libraryList.ClearSelection();
+    }
+    
+    // Only the visible rows are formatted and submitted, whatever the library size
+    libraryList.SetItems((int)matches.size(), ImGui::GetTextLineHeightWithSpacing());
+    if (ImGui::BeginVirtualList("##AnthemLibrary", &libraryList, ImVec2(0.0f, ImGui::GetTextLineHeightWithSpacing() * 10.0f), true)) {
+        char label[512];
+        for (int i = libraryList.DisplayStart; i < libraryList.DisplayEnd; i++) {
+            const LibraryEntry& entry = (*libraryEntries)[matches[i]];
+            if (!entry.valid) {
+                snprintf(label, sizeof(label), "%s  (unsupported file)", entry.name.c_str());
+                ImGui::PushStyleColor(ImGuiCol_Text, ImGui::GetStyleColorVec4(ImGuiCol_TextDisabled));
+                ImGui::VirtualListSelectable(&libraryList, i, label);
+                ImGui::PopStyleColor();
+                continue;
+            }
+            int seconds = (int)entry.wav.GetDurationSeconds();
+            snprintf(label, sizeof(label), "%s  (%.1f kHz, %d ch, %d-bit, %d:%02d)", entry.name.c_str(), entry.wav.sampleRate / 1000.0,
+                entry.wav.channels, entry.wav.bitsPerSample, seconds / 60, seconds % 60);
+            if (ImGui::VirtualListSelectable(&libraryList, i, label)) {
+                LoadWAVFile(entry.path, entry.wav);
+            }
+        }
+    }
+    ImGui::EndVirtualList(&libraryList);
+}
+
+void CustomPlayerAnthems::RenderPlaylist()
+{
+    ImGui::Spacing();
+    std::shared_ptr<const std::vector<PlaylistEntry>> view = playlistView.load();
+    if (weightEditView && weightEditView != view) {
+        weightEdit = -1;    // The released weight was published
+        weightEditView.reset();
+    }
+    const std::vector<PlaylistEntry>& entries = *view;
+    ImGui::Text("Playlist: %d anthem(s)", (int)entries.size());
+    ImGui::SameLine();
+    ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1.0f), "(goals pick from it, or play the selected anthem while it is empty)");
+    
+    const bool listed = std::any_of(entries.begin(), entries.end(), [this](const PlaylistEntry& entry) { return entry.path == wavFilePath; });
+    if (!wavFilePath.empty() && !listed) {
+        if (ImGui::Button("Add Selected to Playlist")) {
+            AddSelectedToPlaylist();
+        }
+        ImGui::SameLine();
+    }
+    int mode = cvarManager->getCvar("helloworld_playlist_mode").getIntValue();
+    ImGui::PushItemWidth(160.0f);
+    if (ImGui::Combo("##PlaylistMode", &mode, "Weighted random\0Round robin\0No repeat\0")) {
+        QueueCvar("helloworld_playlist_mode", std::to_string(mode));
+    }
+    if (mode == (int)PlaylistMode::NoRepeat) {
+        ImGui::SameLine();
+        int noRepeat = cvarManager->getCvar("helloworld_playlist_norepeat").getIntValue();
+        if (ImGui::InputInt("last picks", &noRepeat)) {
+            QueueCvar("helloworld_playlist_norepeat", std::to_string(std::clamp(noRepeat, 0, 100)));
+        }
+    }
+    ImGui::PopItemWidth();
+    
+    // The dragged weight shows in the shares right away; the game thread gets it once it is released
+    auto weightOf = [this, &entries](int i) { return i == weightEdit ? weightEditValue : entries[i].weight; };
+    double totalWeight = 0.0;
+    for (int i = 0; i < (int)entries.size(); i++) {
+        totalWeight += weightOf(i);
+    }
+    char label[512];
+    for (int i = 0; i < (int)entries.size(); i++) {
+        const PlaylistEntry& entry = entries[i];
+        ImGui::PushID(i);
+        float weight = weightOf(i);
+        ImGui::PushItemWidth(60.0f);
+        if (ImGui::DragFloat("##Weight", &weight, 0.05f, 0.0f, 100.0f, "%.2f")) {
+            weightEdit = i;
+            weightEditValue = weight;
+            weightEditView.reset();
+        }
+        if (ImGui::IsItemDeactivatedAfterEdit() && weightEdit == i) {
+            SetPlaylistWeight(entry.path, weightEditValue);
+            weightEditView = view;
+        }
+        ImGui::PopItemWidth();
+        ImGui::SameLine();
+        const char* state = entry.streamed ? "streamed" : anthemCache->Get(entry.path) ? "ready" : "loading";
+        const double share = totalWeight > 0.0 ? weight / totalWeight * 100.0 : 100.0 / entries.size();
+        snprintf(label, sizeof(label), "%s  (%s, %.0f%%)", GetFileName(entry.path).c_str(), state, share);
+        if (ImGui::Selectable(label, entry.path == wavFilePath, 0, ImVec2(ImGui::GetContentRegionAvail().x - 70.0f, 0.0f))) {
+            LoadWAVFile(entry.path, entry.wav);
+        }
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Remove")) {
+            RemoveFromPlaylist(entry.path);     // Applied on the game thread, the list drawn here stays as it is
+        }
+        ImGui::PopID();
     }
+}
+
+void CustomPlayerAnthems::RenderPlayerAnthems()
+{
+    ImGui::Spacing();
+    std::shared_ptr<const std::vector<PlayerAnthem>> view = playerAnthemsView.load();
+    const std::vector<PlayerAnthem>& entries = *view;
+    ImGui::Text("Player anthems: %d player(s)", (int)entries.size());
+    ImGui::SameLine();
+    ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1.0f), "(played for their goals while spectating or in replays)");
     
-    LOG("Loaded WAV file: " + filePath);
-    statusMessage = "Loaded custom anthem: " + selectedFileName;
+    // Edits go through the game thread, which reads the mapping on goals
+    auto map = [this](std::string id, std::string name, std::string path) {
+        gameWrapper->Execute([this, id, name, path](GameWrapper*) {
+            MapPlayerAnthem(id, name, path);
+        });
+    };
+    std::shared_ptr<const std::vector<RosterPlayer>> roster = matchRoster.load();
+    auto isMapped = [&entries](const std::string& id) {
+        return std::any_of(entries.begin(), entries.end(), [&id](const PlayerAnthem& entry) { return entry.id == id; });
+    };
+    auto isInMatch = [&roster](const std::string& id) {
+        return roster && std::any_of(roster->begin(), roster->end(), [&id](const RosterPlayer& player) { return player.id == id; });
+    };
+    char label[512];
+    if (roster) {
+        for (const RosterPlayer& player : *roster) {
+            if (isMapped(player.id)) {
+                continue;
+            }
+            ImGui::PushID(player.id.c_str());
+            ImGui::TextUnformatted(player.name.c_str());
+            if (!wavFilePath.empty()) {
+                ImGui::SameLine();
+                if (ImGui::SmallButton("Use Selected Anthem")) {
+                    map(player.id, player.name, wavFilePath);
+                }
+            }
+            ImGui::PopID();
+        }
+    }
+    for (const PlayerAnthem& entry : entries) {
+        ImGui::PushID(entry.id.c_str());
+        const bool inMatch = isInMatch(entry.id);
+        snprintf(label, sizeof(label), "%s: %s%s", entry.name.c_str(), GetFileName(entry.path).c_str(), inMatch ? "  (in this match)" : "");
+        ImGui::TextUnformatted(label);
+        if (!wavFilePath.empty() && wavFilePath != entry.path) {
+            ImGui::SameLine();
+            if (ImGui::SmallButton("Use Selected Anthem")) {
+                map(entry.id, entry.name, wavFilePath);
+            }
+        }
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Remove")) {
+            map(entry.id, entry.name, "");
+        }
+        ImGui::PopID();
+    }
+}
+
+static void LogUiBenchmark(const char* name, const UiBenchmarkResult& result, unsigned long goldenHash = 0)
+{
+    LOG("UI bench {}: {} frames, build {:.3f} ms, raster {:.3f} ms, worst frame {:.3f} ms, {} triangles, hash {:08x}",
+        name, result.frames, result.avgBuildMs, result.avgRasterMs, result.maxFrameMs, result.triangles, result.framebufferHash);
+    LOG("UI bench {}: font atlas {:.3f} ms ({})", name, result.fontAtlasMs, result.fontCacheHit ? "cache hit" : "baked");
+    if (goldenHash != 0) {
+        LOG("UI bench {}: golden {:08x} {}", name, goldenHash, goldenHash == result.framebufferHash ? "MATCH" : "MISMATCH");
+    }
+}
+
+void CustomPlayerAnthems::RunPendingUiBenchmark()
+{
+    std::vector<std::string> args;
+    {
+        std::lock_guard<std::mutex> lock(uiBenchMutex);
+        if (!uiBenchPending) {
+            return;
+        }
+        args = std::move(uiBenchArgs);
+        uiBenchPending = false;
+    }
+    // The bench frames are not frames of the overlay
+    const FrameTimeStats frameTime = uiFrameTime;
+    RunUiBenchmarkCommand(args);
+    uiFrameTime = frameTime;
+    PublishUiFrameTime();
 }
 
-bool CustomPlayerAnthems::IsLocalPlayerGoal()
+void CustomPlayerAnthems::RunUiBenchmarkCommand(std::vector<std::string> args)
 {
-    // TODO: Implement proper local player goal detection
-    // This requires checking the game state to determine if the local player scored
-    // For now, return true for testing (will be refined later)
+    UiBenchmarkOptions options;
+    if (args.size() > 1) options.frames = std::max(1, std::atoi(args[1].c_str()));
+    if (args.size() > 2) options.threads = std::max(1, std::atoi(args[2].c_str()));
+    unsigned long goldenFixture = args.size() > 3 ? std::strtoul(args[3].c_str(), nullptr, 16) : 0;
+
+    // Last frames are dumped next to the plugin data so a golden mismatch can be inspected
+    std::filesystem::path benchFolder = gameWrapper->GetDataFolder() / "CustomPlayerAnthems";
+    std::error_code ec;
+    std::filesystem::create_directories(benchFolder, ec);
+    options.fontCachePath = (benchFolder / "fonts.cache").string();
+
+    // Settings tab: BakkesMod hosts RenderSettings inside its own window, so we provide one
+    options.dumpPath = (benchFolder / "bench_settings.tga").string();
+    UiBenchmarkResult settings = RunUiBenchmark([this]() {
+        ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f));
+        ImGui::SetNextWindowSize(ImGui::GetIO().DisplaySize);
+        ImGui::Begin("##SettingsBench", nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoSavedSettings);
+        RenderSettings();
+        ImGui::End();
+    }, options);
+    LogUiBenchmark("RenderSettings", settings);
+
+    // Standalone window: Render() toggles the menu when closed, so keep it open for the duration
+    bool wasWindowOpen = this->isWindowOpen;
+    this->isWindowOpen = true;
+    options.dumpPath = (benchFolder / "bench_window.tga").string();
+    UiBenchmarkResult window = RunUiBenchmark([this]() {
+        Render();
+    }, options);
+    this->isWindowOpen = wasWindowOpen;
+    LogUiBenchmark("Render", window);
     
-    if (!gameWrapper->IsInGame()) {
+    options.dumpPath = (benchFolder / "bench_fixture.tga").string();
+    UiBenchmarkResult fixture = RunUiBenchmark(DrawUiBenchmarkFixture, options);
+    LogUiBenchmark("fixture", fixture, goldenFixture);
+}
+
+void CustomPlayerAnthems::RunFontBenchmarkCommand(std::vector<std::string> args)
+{
+    // Any CJK-capable font works, Microsoft YaHei ships with every Windows install that has East Asian support
+    std::string fontPath = args.size() > 1 ? args[1] : "C:\\Windows\\Fonts\\msyh.ttc";
+    float sizePixels = args.size() > 2 ? (float)std::atof(args[2].c_str()) : 16.0f;
+    int sampleGlyphs = args.size() > 3 ? std::max(1, std::atoi(args[3].c_str())) : 200;
+    if (!std::filesystem::exists(fontPath)) {
+        LOG("Font bench: {} not found, pass a .ttf/.ttc path", fontPath);
+        return;
+    }
+
+    FontBenchmarkResult result = RunFontBenchmark(fontPath, sizePixels, sampleGlyphs);
+    if (!result.loaded) {
+        LOG("Font bench: failed to load {}", fontPath);
+        return;
+    }
+    LOG("Font bench full bake: {:.2f} ms, {} glyphs, atlas {}x{} ({:.1f} MB RGBA)", result.fullBakeMs, result.fullGlyphs,
+        result.fullTexWidth, result.fullTexHeight, result.fullTexWidth * (double)result.fullTexHeight * 4.0 / (1024.0 * 1024.0));
+    LOG("Font bench lazy build: {:.2f} ms, {} resident glyphs, atlas {}x{} ({:.1f} MB RGBA)", result.lazyBuildMs, result.lazyGlyphs,
+        result.lazyTexWidth, result.lazyTexHeight, result.lazyTexWidth * (double)result.lazyTexHeight * 4.0 / (1024.0 * 1024.0));
+    LOG("Font bench on demand: {} glyphs in {:.2f} ms ({:.3f} ms/glyph)", result.onDemandGlyphs, result.onDemandMs,
+        result.onDemandGlyphs > 0 ? result.onDemandMs / result.onDemandGlyphs : 0.0);
+}
+
+void CustomPlayerAnthems::RunSearchBenchmarkCommand(std::vector<std::string> args)
+{
+    std::string query = args.size() > 1 ? args[1] : "octane - goal";
+    for (int itemCount : { 1000, 10000, 50000 }) {
+        SearchBenchmarkResult result = RunSearchBenchmark(itemCount, query);
+        LOG("Search bench {} items: index build {:.2f} ms ({} trigrams), legacy scan {:.3f} ms/keystroke, "
+            "indexed {:.3f} ms/keystroke (max {:.3f}), fresh query {:.3f} ms, {} matches for '{}'",
+            result.items, result.indexBuildMs, result.trigrams, result.legacyKeystrokeMs,
+            result.indexKeystrokeMs, result.indexKeystrokeMaxMs, result.indexFreshQueryMs, result.matches, query);
+    }
+}
+
+void CustomPlayerAnthems::RunListBenchmarkCommand(std::vector<std::string> args)
+{
+    int frames = args.size() > 1 ? std::max(1, std::atoi(args[1].c_str())) : 30;
+    for (int rows : { 1000, 10000, 100000 }) {
+        ListBenchmarkResult result = RunListBenchmark(rows, frames);
+        LOG("List bench {} rows: plain {:.3f} ms/frame, virtualized {:.3f} ms/frame ({} rows submitted), varying heights {:.3f} ms/frame",
+            result.rows, result.plainMs, result.virtualMs, result.rowsSubmitted, result.variableMs);
+    }
+}
+
+void CustomPlayerAnthems::RunLoudnessBenchmarkCommand(std::vector<std::string> args)
+{
+    double seconds = args.size() > 1 ? std::max(1.0, std::atof(args[1].c_str())) : 300.0;
+    LoudnessBenchmarkResult result = RunLoudnessBenchmark(seconds);
+    LOG("Loudness bench: {:.0f} s of stereo 48 kHz, SSE2 {:.1f} ms ({:.2f} s/ms), scalar {:.1f} ms ({:.2f} s/ms)", result.audioSeconds,
+        result.simdMs, result.audioSeconds / result.simdMs, result.scalarMs, result.audioSeconds / result.scalarMs);
+    LOG("Loudness bench: -20 dBFS 997 Hz reference reads {:.2f} LUFS, {:.2f} dBTP", result.sineLufs, result.sineTruePeakDbtp);
+}
+
+void CustomPlayerAnthems::RunDuckingBenchmarkCommand(std::vector<std::string> args)
+{
+    double seconds = args.size() > 1 ? std::max(1.0, std::atof(args[1].c_str())) : 60.0;
+    DuckingParameters parameters = GetDuckingParameters();
+    parameters.enabled = true;
+    DuckingBenchmarkResult result = RunDuckingBenchmark(seconds, parameters);
+    LOG("Ducking bench: {} blocks of 480 frames, SSE2 {:.2f} us/block, scalar {:.2f} us/block", result.blocks, result.simdUsPerBlock, result.scalarUsPerBlock);
+    LOG("Ducking bench: ducked to {:.1f} dB (depth {:.1f} dB), largest step between two samples {:.4f} dB", result.duckedGainDb,
+        parameters.depthDb, result.maxStepDb);
+}
+
+void CustomPlayerAnthems::RunGoalDedupBenchmarkCommand(std::vector<std::string> args)
+{
+    int events = args.size() > 1 ? std::max(1000, std::atoi(args[1].c_str())) : 1000000;
+    GoalDedupBenchmarkResult result = RunGoalDedupBenchmark(events);
+    int failed = 0;
+    for (const GoalDedupBenchmarkResult::Trace& trace : result.traces) {
+        const bool pass = trace.dropped == trace.expectedDropped;
+        failed += pass ? 0 : 1;
+        LOG("Goal dedup trace {}: {} events, dropped {} (expected {}) {}", trace.name, trace.events, trace.dropped, trace.expectedDropped,
+            pass ? "PASS" : "FAIL");
+    }
+    LOG("Goal dedup bench: {} events, {:.1f} ns per event, {} of {} traces failed", result.events, result.nsPerEvent, failed, result.traces.size());
+    LOG("Goal dedup: {} goals accepted, {} duplicates dropped this session", goalDedup.GetAccepted(), goalDedup.GetDropped());
+}
+
+void CustomPlayerAnthems::RunResidentBenchmarkCommand(std::vector<std::string> args)
+{
+    double seconds = args.size() > 1 ? std::max(1.0, std::atof(args[1].c_str())) : 8.0;
+    int blocks = args.size() > 2 ? std::max(100, std::atoi(args[2].c_str())) : 2000;
+    ResidentBenchmarkResult result = RunResidentBenchmark(seconds, blocks);
+    LOG("Resident bench: {:.0f} s stereo 48 kHz anthems, {} blocks of 480 frames, up to {} voices", result.anthemSeconds, result.blocks,
+        AudioEngine::maxVoices);
+    for (const ResidentBenchmarkResult::Format& format : result.formats) {
+        const double megabytesPerMinute = format.bytes[0] / (1024.0 * 1024.0) * 60.0 / result.anthemSeconds;
+        LOG("Resident bench {}: {:.2f} MB per stereo minute, SNR {:.1f} dB", GetResidentFormatName(format.format), megabytesPerMinute, format.snrDb);
+        for (int i = 0; i < 3; i++) {
+            LOG("Resident bench {} x{}: {:.1f} MB, render {:.1f} us avg ({:.1f} us max) per block", GetResidentFormatName(format.format),
+                ResidentBenchmarkResult::anthemCounts[i], format.bytes[i] / (1024.0 * 1024.0), format.renderUsPerBlock[i], format.maxRenderUs[i]);
+        }
+    }
+    LOG("Resident bench: ADPCM decode of a stereo minute, SSE2 {:.2f} ms, scalar {:.2f} ms", result.adpcmSimdMsPerMinute, result.adpcmScalarMsPerMinute);
+}
+
+static const char* GetFormatName(uint16_t formatTag)
+{
+    switch (formatTag) {
+    case formatTagFlac:
+        return "FLAC";
+    case formatTagVorbis:
+        return "Vorbis";
+    default:
+        return "WAV";
+    }
+}
+
+void CustomPlayerAnthems::RunCodecBenchmarkCommand(std::vector<std::string> args)
+{
+    std::vector<std::string> files(args.begin() + std::min<size_t>(args.size(), 1), args.end());
+    if (files.empty() && !wavFilePath.empty()) {
+        files.push_back(wavFilePath);
+    }
+    if (files.empty()) {
+        LOG("Codec bench: no file given and no anthem selected");
+        return;
+    }
+    for (const std::string& file : files) {
+        CodecBenchmarkResult result = RunCodecBenchmark(Utf8ToPath(file), 100);
+        if (!result.ok) {
+            LOG("Codec bench: could not decode {}", file);
+            continue;
+        }
+        const double audioMs = result.audioSeconds * 1000.0;
+        LOG("Codec bench: {} ({}, {:.1f} s): full decode {:.1f} ms ({:.0f}x real time), streamed {:.1f} ms ({:.0f}x), seek {:.3f} ms",
+            file, GetFormatName(result.formatTag), result.audioSeconds, result.fullMs, audioMs / std::max(result.fullMs, 0.001),
+            result.streamMs, audioMs / std::max(result.streamMs, 0.001), result.seekMs);
+    }
+}
+
+void CustomPlayerAnthems::RunLibraryBenchmarkCommand(std::vector<std::string> args)
+{
+    int files = args.size() > 1 ? std::max(100, std::atoi(args[1].c_str())) : 100000;
+    int threads = args.size() > 2 ? std::max(1, std::atoi(args[2].c_str())) : std::max(1, (int)std::thread::hardware_concurrency());
+    std::filesystem::path root = gameWrapper->GetDataFolder() / "CustomPlayerAnthems" / "library_bench";
+    
+    LibraryBenchmarkResult result = RunLibraryBenchmark(root, files, threads);
+    if (result.created) {
+        LOG("Library bench: created {} synthetic WAV files in {:.0f} ms", files, result.createMs);
+    }
+    auto logScan = [](const char* name, const LibraryScanStats& stats) {
+        LOG("Library bench {}: {:.1f} ms, {} files in {} folders, {} probed, {} unchanged, index write {:.1f} ms, {} threads, {} steals",
+            name, stats.scanMs, stats.files, stats.directories, stats.probed, stats.reused, stats.saveIndexMs, stats.threads, stats.steals);
+    };
+    logScan("cold", result.cold);
+    logScan("unchanged", result.unchanged);
+    logScan("1% touched", result.touched);
+}
+
+void CustomPlayerAnthems::LogStartupProfile()
+{
+    LOG("Startup: onLoad {:.3f} ms", onLoadMs);
+    
+    // onLoad builds no fonts (BakkesMod bakes the overlay atlas): the only atlas this plugin builds is the offscreen benchmark's
+    const ImFontAtlasCacheProfile& font = ImFontAtlasCache_GetLastProfile();
+    if (font.TexWidth == 0) {
+        LOG("Benchmark: no font atlas built yet (run helloworld_bench_ui)");
+        return;
+    }
+    LOG("Benchmark: font atlas {}x{} {}, hash {:.3f} ms, cache read {:.3f} ms, bake {:.3f} ms, cache write {:.3f} ms (key {:016x})",
+        font.TexWidth, font.TexHeight, font.CacheHit ? "from cache" : (font.CacheWritten ? "baked and cached" : "baked"),
+        font.HashMs, font.LoadMs, font.BakeMs, font.SaveMs, font.Key);
+}
+
+// Available F-keys (from Deja-Vu implementation)
+static const char* keybindOptions[] = { "None", "F1", "F3", "F4", "F5", "F7", "F8", "F9", "F10", "F11", "F12" };
+
+bool CustomPlayerAnthems::RefreshUiText()
+{
+    // Cheap "anything changed?" check: a few scalar compares and short string compares per frame
+    std::shared_ptr<const RuntimeConfig> settings = config.Get();
+    std::shared_ptr<const GoalCounters> counters = goalCounters.load();
+    std::shared_ptr<const StatusMessage> status = statusMessage.load();
+    if (uiText.matchRevision == counters->revision && uiText.anthemsEnabled == settings->anthemsEnabled && uiText.fadeOutEnabled == settings->fadeOut
+        && uiText.windowOpen == isWindowOpen && uiText.statusRevision == status->revision && uiText.fileName == selectedFileName && uiText.keybind == currentKeybind) {
         return false;
     }
     
-    // Basic implementation - will need refinement for accurate detection
-    auto server = gameWrapper->GetOnlineGame();
-    if (!server.IsNull()) {
-        // In online game - need to check if local player scored
-        // This is a simplified version - actual implementation needs more game state checking
-        return true; // Placeholder for testing
+    uiText.matchRevision = counters->revision;
+    uiText.anthemsEnabled = settings->anthemsEnabled;
+    uiText.fadeOutEnabled = settings->fadeOut;
+    uiText.windowOpen = isWindowOpen;
+    uiText.statusRevision = status->revision;
+    uiText.fileName = selectedFileName;
+    uiText.keybind = currentKeybind;
+    
+    uiText.keybindIndex = 0;
+    for (int i = 0; i < IM_ARRAYSIZE(keybindOptions); i++) {
+        if (currentKeybind == keybindOptions[i]) {
+            uiText.keybindIndex = i;
+            break;
+        }
     }
     
-    // In freeplay/training, assume local player always scores
+    uiText.selectedFileLine = "Selected WAV File: " + selectedFileName;
+    uiText.goalCounterLine = "Goals this match: " + std::to_string(counters->totalGoals) + " (yours: " + std::to_string(counters->localGoals) + ")";
+    uiText.anthemsLine = std::string("Custom Anthems: ") + (settings->anthemsEnabled ? "Enabled" : "Disabled");
+    uiText.fadeOutLine = std::string("Fade Out: ") + (settings->fadeOut ? "Enabled" : "Disabled");
+    uiText.statusLine = "Status: " + status->text;
+    uiText.currentStatusLine = "Current Status: " + status->text;
+    uiText.windowStatusLine = std::string("Window Status: ") + (isWindowOpen ? "OPEN" : "CLOSED");
+    uiText.currentKeybindLine = "Current Keybind: " + currentKeybind;
+    uiText.boundToLine = "Bound to: " + currentKeybind;
+    uiText.pressKeyLine = "Press " + currentKeybind + " to toggle this window!";
+    uiText.toggleKeyLine = "Press " + currentKeybind + " to toggle Custom Anthems window!";
+    uiText.versionLine = std::string("Plugin Version: ") + plugin_version;
     return true;
 }
 
-void CustomPlayerAnthems::OpenFileDialog()
+// Render thread, first thing in each UI callback
+void CustomPlayerAnthems::BeginUiFrame()
+{
+    lastUiFrame = std::chrono::steady_clock::now().time_since_epoch().count();
+    if (uiFrameTimeReset.exchange(false)) {
+        uiFrameTime.Reset();
+    }
+    PublishUiFrameTime();
+}
+
+void CustomPlayerAnthems::PublishUiFrameTime()
+{
+    std::lock_guard<std::mutex> lock(uiFrameTimeMutex);
+    uiFrameTimeView = uiFrameTime;
+}
+
+FrameTimeStats CustomPlayerAnthems::GetUiFrameTime() const
 {
-    // TODO: Implement file dialog for WAV file selection
-    // This would typically use Windows file dialog or similar cross-platform solution
-    LOG("File dialog would open here for WAV file selection");
-    statusMessage = "File dialog functionality to be implemented";
+    std::lock_guard<std::mutex> lock(uiFrameTimeMutex);
+    return uiFrameTimeView;
+}
+
+bool CustomPlayerAnthems::IsUiVisible() const
+{
+    // Render and RenderSettings only run while the window or the settings tab is shown, so a recent call means it is visible.
+    // Safe from any thread: no ImGui state is read.
+    const auto last = std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(lastUiFrame.load()));
+    return last.time_since_epoch().count() != 0 && std::chrono::steady_clock::now() - last < std::chrono::milliseconds(250);
 }
 
 // PluginSettingsWindow Implementation
 void CustomPlayerAnthems::RenderSettings()
 {
+    BeginUiFrame();
+    RunPendingUiBenchmark();
+    ScopeTimer timer(uiFrameTime);
+    RefreshUiText();
+    
     // Custom Player Anthems Header (PRD Implementation)
     ImGui::TextColored(ImVec4(1.0f, 0.5f, 0.0f, 1.0f), "Custom Player Anthems");
     ImGui::Separator();
@@ -190,10 +1740,16 @@ void CustomPlayerAnthems::RenderSettings()
     ImGui::Text("Custom Player Anthems Settings");
     ImGui::Separator();
     
+    // Edited copies: a change is queued for the cvar, which publishes a new config snapshot
+    std::shared_ptr<const RuntimeConfig> settings = config.Get();
+    bool customAnthemsEnabled = settings->anthemsEnabled;
+    bool fadeOutEnabled = settings->fadeOut;
+    bool normalizeEnabled = settings->normalize;
+    
     // PRD Requirement 1: [✓] Enable Custom Anthems
     if (ImGui::Checkbox("Enable Custom Anthems", &customAnthemsEnabled)) {
-        cvarManager->getCvar("helloworld_enabled").setValue(customAnthemsEnabled);
-        statusMessage = customAnthemsEnabled ? "Custom anthems enabled" : "Custom anthems disabled";
+        QueueCvar("helloworld_enabled", customAnthemsEnabled ? "1" : "0");
+        SetStatus(customAnthemsEnabled ? "Custom anthems enabled" : "Custom anthems disabled");
         LOG("Custom anthems " + std::string(customAnthemsEnabled ? "enabled" : "disabled"));
     }
     
@@ -202,47 +1758,64 @@ void CustomPlayerAnthems::RenderSettings()
     // PRD Requirement 2: [Browse Button] WAV File Selector
     ImGui::Text("Selected WAV File:");
     ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.0f, 1.0f), "%s", selectedFileName.c_str());
+    RenderWaveform();
+    RenderTrim();
     
     if (ImGui::Button("Browse for WAV File")) {
-        OpenFileDialog();
+        ToggleLibraryView();
     }
     
     ImGui::SameLine();
     if (ImGui::Button("Clear Selection")) {
+        const std::string previous = wavFilePath;
+        anthemStreamed = false;
+        selectedWav = WavInfo{};
         wavFilePath = "";
+        PublishSelection();
+        EvictUnlessKept(previous);
         selectedFileName = "No file selected";
-        statusMessage = "WAV file selection cleared";
+        SetStatus("WAV file selection cleared");
         LOG("WAV file selection cleared");
     }
+    RenderLibraryView();
+    RenderPlaylist();
+    RenderPlayerAnthems();
     
     ImGui::Spacing();
     
     // PRD Requirement 3: [✓] Fade Out
     if (ImGui::Checkbox("Fade Out", &fadeOutEnabled)) {
-        statusMessage = fadeOutEnabled ? "Fade out enabled" : "Fade out disabled";
+        QueueCvar("helloworld_fade_out", fadeOutEnabled ? "1" : "0");
+        SetStatus(fadeOutEnabled ? "Fade out enabled" : "Fade out disabled");
         LOG("Fade out " + std::string(fadeOutEnabled ? "enabled" : "disabled"));
     }
     ImGui::SameLine();
     ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1.0f), "(anthem will fade out at the end)");
     
+    if (ImGui::Checkbox("Normalize Loudness", &normalizeEnabled)) {
+        QueueCvar("helloworld_normalize", normalizeEnabled ? "1" : "0");
+        SetStatus(normalizeEnabled ? "Loudness normalization enabled" : "Loudness normalization disabled");
+    }
+    ImGui::SameLine();
+    ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1.0f), "(every anthem plays at %.0f LUFS)", loudnessTargetLufs);
+    
     ImGui::Spacing();
     ImGui::Separator();
     
     // Goal Counter (keep for demo/testing)
-    ImGui::Text("Goal Counter: %d", goalCounter);
+    ImGui::TextUnformatted(uiText.goalCounterLine.c_str());
     
     if (ImGui::Button("Reset Counter"))
     {
-        goalCounter = 0;
-        LOG("Goal counter reset");
+        ResetGoalCounters();
     }
     
     ImGui::SameLine();
     if (ImGui::Button("Test Custom Anthem")) {
-        if (customAnthemsEnabled) {
-            PlayCustomAnthem();
+        if (config.Get()->anthemsEnabled) {
+            gameWrapper->Execute([this](GameWrapper*) { PlayCustomAnthem(); });     // Picks from the playlist like a goal
         } else {
-            statusMessage = "Enable custom anthems first!";
+            SetStatus("Enable custom anthems first!");
         }
     }
     
@@ -253,29 +1826,15 @@ void CustomPlayerAnthems::RenderSettings()
     ImGui::Text("Quick Access F-Key Binding");
     ImGui::Separator();
     
-    // Available F-keys (from Deja-Vu implementation)
-    const char* keybindOptions[] = { "None", "F1", "F3", "F4", "F5", "F7", "F8", "F9", "F10", "F11", "F12" };
-    int currentKeybindIndex = 0;
-    
-    // Find current selection index
-    for (int i = 0; i < IM_ARRAYSIZE(keybindOptions); i++) {
-        if (currentKeybind == keybindOptions[i]) {
-            currentKeybindIndex = i;
-            break;
-        }
-    }
-    
-    // F-key selection dropdown
+    // F-key selection dropdown (current index is resolved by RefreshUiText)
+    int currentKeybindIndex = uiText.keybindIndex;
     if (ImGui::Combo("Custom Anthems Keybind", &currentKeybindIndex, keybindOptions, IM_ARRAYSIZE(keybindOptions))) {
-        std::string newKeybind = keybindOptions[currentKeybindIndex];
-        if (keybindCVar) {
-            keybindCVar->setValue(newKeybind);
-        }
+        QueueCvar("helloworld_keybind", keybindOptions[currentKeybindIndex]);
     }
     
-    ImGui::Text("Current Keybind: %s", currentKeybind.c_str());
+    ImGui::TextUnformatted(uiText.currentKeybindLine.c_str());
     if (currentKeybind != "None") {
-        ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.0f, 1.0f), "Press %s to toggle Custom Anthems window!", currentKeybind.c_str());
+        ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.0f, 1.0f), "%s", uiText.toggleKeyLine.c_str());
     }
     
     ImGui::Spacing();
@@ -283,7 +1842,7 @@ void CustomPlayerAnthems::RenderSettings()
     
     // Standalone window controls
     ImGui::Text("Standalone Window Controls");
-    ImGui::Text("Window Status: %s", this->isWindowOpen ? "OPEN" : "CLOSED");
+    ImGui::TextUnformatted(uiText.windowStatusLine.c_str());
     
     // Control buttons for standalone window
     ImGui::Spacing();
@@ -297,10 +1856,47 @@ void CustomPlayerAnthems::RenderSettings()
     
     // Status display
     ImGui::Separator();
-    ImGui::Text("Status: %s", statusMessage.c_str());
-    ImGui::Text("Plugin Version: %s", plugin_version);
-    ImGui::Text("Custom Anthems: %s", customAnthemsEnabled ? "Enabled" : "Disabled");
-    ImGui::Text("Fade Out: %s", fadeOutEnabled ? "Enabled" : "Disabled");
+    ImGui::TextUnformatted(uiText.statusLine.c_str());
+    ImGui::TextUnformatted(uiText.versionLine.c_str());
+    ImGui::TextUnformatted(uiText.anthemsLine.c_str());
+    ImGui::TextUnformatted(uiText.fadeOutLine.c_str());
+    
+    // Diagnostics (collapsed by default so offscreen benchmarks stay deterministic)
+    if (ImGui::CollapsingHeader("Diagnostics")) {
+        ImGui::Text("UI frame time: %.3f ms (avg %.3f ms, max %.3f ms)", uiFrameTime.lastMs, uiFrameTime.avgMs, uiFrameTime.maxMs);
+        const ImFontAtlasCacheProfile& font = ImFontAtlasCache_GetLastProfile();
+        ImGui::Text("Startup: onLoad %.2f ms", onLoadMs);
+        if (font.TexWidth != 0) {
+            ImGui::Text("UI benchmark font atlas: %.2f ms (%s)", font.HashMs + font.LoadMs + font.BakeMs + font.SaveMs, font.CacheHit ? "cached" : "baked");
+        }
+        LibraryScanStats scan = library->GetLastStats();
+        ImGui::Text("Library scan: %.1f ms, %d files, %d probed, %d unchanged", scan.scanMs, scan.files, scan.probed, scan.reused);
+        LibraryWatchStats watch = library->GetWatchStats();
+        FileWatcherStats events = library->GetWatcherStats();
+        ImGui::Text("Library watch: %s, %llu events in %llu batches, %llu re-probed, %llu removed, %llu rescans (last %.2f ms)",
+            library->IsWatching() ? "on" : "off", (unsigned long long)events.rawEvents, (unsigned long long)watch.batches,
+            (unsigned long long)watch.probed, (unsigned long long)watch.removed, (unsigned long long)watch.fullRescans, watch.lastApplyMs);
+        SettingsWriterStats saves = settingsWriter->GetStats(std::chrono::steady_clock::now());
+        ImGui::Text("Settings: %llu writes (%d in the last minute, cap %d), %llu changes, %llu coalesced, %llu throttled, %llu failed",
+            (unsigned long long)saves.writes, saves.writesLastMinute, SettingsWriter::maxWritesPerMinute, (unsigned long long)saves.changes,
+            (unsigned long long)saves.coalesced, (unsigned long long)saves.throttled, (unsigned long long)saves.failed);
+        AudioEngineStats audio = audioEngine->GetStats();
+        ImGui::Text("Audio: %s, %d voice(s), mix %.1f us avg (%.1f us max) per %d frames, %llu underruns",
+            audio.deviceOpen ? "waveOut" : "no device", audio.activeVoices, audio.avgMixUs, audio.maxMixUs, audio.blockFrames,
+            (unsigned long long)audio.underruns);
+        ImGui::Text("Limiter: %.1f us avg (%.1f us max) per block, %.1f ms lookahead, gain reduction %.1f dB",
+            audio.avgLimiterUs, audio.maxLimiterUs, audio.limiterLatencyFrames * 1000.0 / std::max(audio.sampleRate, 1u), audio.limiterReductionDb);
+        ImGui::Text("Ducking: %s, %.1f us avg (%.1f us max) per block, effects bus gain %.1f dB",
+            audio.duckingEnabled ? "on" : "off", audio.avgDuckingUs, audio.maxDuckingUs, audio.duckingGainDb);
+        const AnthemStreamStats& streaming = audio.streaming;
+        ImGui::Text("Streaming: %d stream(s), %.0f KB buffered, %llu refills (%.1f MB read), %llu underruns (%llu frames), lowest fill %d frames",
+            streaming.streams, streaming.memoryBytes / 1024.0, (unsigned long long)streaming.refills, streaming.bytesRead / (1024.0 * 1024.0),
+            (unsigned long long)streaming.underruns, (unsigned long long)streaming.underrunFrames, streaming.lowestFillFrames);
+        AnthemCacheStats cache = anthemCache->GetStats();
+        ImGui::Text("Anthem cache: %d decoded (%.1f MB, %s), %d reloads, %d failures, last decode %.1f ms", cache.entries,
+            cache.bytes / (1024.0 * 1024.0), GetResidentFormatName(cache.format), cache.reloads, cache.failures, cache.lastDecodeMs);
+        ImGui::Text("Compact voices: %.1f us avg (%.1f us max) per block, decode and mix", audio.avgCompactUs, audio.maxCompactUs);
+    }
     
     // Instructions
     ImGui::Separator();
@@ -333,18 +1929,23 @@ void CustomPlayerAnthems::Render()
         return;
     }
     
+    BeginUiFrame();
+    RunPendingUiBenchmark();
+    ScopeTimer timer(uiFrameTime);
+    
     // Set window flags for a nice Hello World window
     ImGuiWindowFlags windowFlags = ImGuiWindowFlags_None;
     
     // Create the Hello World window using GetMenuTitle() and isWindowOpen reference
     if (!ImGui::Begin(GetMenuTitle().c_str(), &this->isWindowOpen, windowFlags))
     {
-        // Early out if the window is collapsed, as an optimization
-        this->shouldBlockInput = ImGui::GetIO().WantCaptureMouse || ImGui::GetIO().WantCaptureKeyboard;
+        // Early out if the window is collapsed, as an optimization (before any text is rebuilt)
         ImGui::End();
         return;
     }
     
+    RefreshUiText();
+    
     // Custom Player Anthems content
     ImGui::TextColored(ImVec4(1.0f, 0.5f, 0.0f, 1.0f), "Custom Player Anthems");
     ImGui::Separator();
@@ -356,44 +1957,44 @@ void CustomPlayerAnthems::Render()
     ImGui::Spacing();
     
     // Custom Player Anthems controls
-    ImGui::Text("Selected WAV File: %s", selectedFileName.c_str());
-    ImGui::Text("Goal Counter: %d", goalCounter);
+    ImGui::TextUnformatted(uiText.selectedFileLine.c_str());
+    ImGui::TextUnformatted(uiText.goalCounterLine.c_str());
     
     if (ImGui::Button("Browse for WAV File")) {
-        OpenFileDialog();
+        ToggleLibraryView();
     }
     
     ImGui::SameLine();
     if (ImGui::Button("Test Custom Anthem")) {
-        if (customAnthemsEnabled) {
-            PlayCustomAnthem();
+        if (config.Get()->anthemsEnabled) {
+            gameWrapper->Execute([this](GameWrapper*) { PlayCustomAnthem(); });     // Picks from the playlist like a goal
         } else {
-            statusMessage = "Enable custom anthems first!";
+            SetStatus("Enable custom anthems first!");
         }
     }
+    RenderLibraryView();
     
     if (ImGui::Button("Reset Counter"))
     {
-        goalCounter = 0;
-        LOG("Goal counter reset");
+        ResetGoalCounters();
     }
     
     ImGui::Spacing();
     ImGui::Separator();
     
     // Status information
-    ImGui::Text("Custom Anthems: %s", customAnthemsEnabled ? "Enabled" : "Disabled");
-    ImGui::Text("Fade Out: %s", fadeOutEnabled ? "Enabled" : "Disabled");
-    ImGui::Text("Current Status: %s", statusMessage.c_str());
-    ImGui::Text("Plugin Version: %s", plugin_version);
+    ImGui::TextUnformatted(uiText.anthemsLine.c_str());
+    ImGui::TextUnformatted(uiText.fadeOutLine.c_str());
+    ImGui::TextUnformatted(uiText.currentStatusLine.c_str());
+    ImGui::TextUnformatted(uiText.versionLine.c_str());
     
     // F-key binding info
     ImGui::Spacing();
     ImGui::Separator();
     ImGui::Text("Keybind Info:");
     if (currentKeybind != "None") {
-        ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.0f, 1.0f), "Bound to: %s", currentKeybind.c_str());
-        ImGui::Text("Press %s to toggle this window!", currentKeybind.c_str());
+        ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.0f, 1.0f), "%s", uiText.boundToLine.c_str());
+        ImGui::TextUnformatted(uiText.pressKeyLine.c_str());
     } else {
         ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "No F-key bound");
         ImGui::Text("Set one in BakkesMod Settings > Plugins > Hello World Plugin");
@@ -407,9 +2008,6 @@ void CustomPlayerAnthems::Render()
     ImGui::BulletText("Browse and select a WAV file for your custom anthem");
     ImGui::BulletText("Your anthem plays when YOU score goals!");
     
-    // Update input blocking
-    this->shouldBlockInput = ImGui::GetIO().WantCaptureMouse || ImGui::GetIO().WantCaptureKeyboard;
-    
     ImGui::End();
 }
 
@@ -425,7 +2023,11 @@ std::string CustomPlayerAnthems::GetMenuTitle()
 
 bool CustomPlayerAnthems::ShouldBlockInput()
 {
-    return this->shouldBlockInput;
+    // Queried on demand rather than recomputed every frame in Render(); nothing to block while the window is closed
+    if (!this->isWindowOpen) {
+        return false;
+    }
+    return ImGui::GetIO().WantCaptureMouse || ImGui::GetIO().WantCaptureKeyboard;
 }
 
 bool CustomPlayerAnthems::IsActiveOverlay()
@@ -4,6 +4,18 @@
 #include "bakkesmod/plugin/pluginwindow.h"
 #include "bakkesmod/plugin/PluginSettingsWindow.h"
 #include "version.h"
+#include "ScopeTimer.h"
+#include "AnthemLibrary.h"
+#include "AudioEngine.h"
+#include "AnthemPlaylist.h"
+#include "AnthemRules.h"
+#include "MatchState.h"
+#include "PlayerAnthems.h"
+#include "GoalReplay.h"
+#include "GoalDedup.h"
+#include "RuntimeConfig.h"
+#include "SettingsWriter.h"
+#include "IMGUI/imgui_virtuallist.h"
 
 constexpr auto plugin_version = stringify(VERSION_MAJOR) "." stringify(VERSION_MINOR) "." stringify(VERSION_PATCH) "." stringify(VERSION_BUILD);
 
@@ -19,7 +31,6 @@ class CustomPlayerAnthems: public BakkesMod::Plugin::BakkesModPlugin, public Bak
 
     // Inherited via PluginWindow  
     bool isWindowOpen = false;
-    bool shouldBlockInput = false;
     std::string menuTitle = "Custom Player Anthems";
 
     void Render() override;
@@ -31,30 +42,229 @@ class CustomPlayerAnthems: public BakkesMod::Plugin::BakkesModPlugin, public Bak
     void OnClose() override;
 
     // Custom Player Anthems functionality (PRD implementation)
-    void OnGoalScored(std::string eventName);
+    void OnGoalScored();
+    void ScoreGoal(ServerWrapper server, PriWrapper scorer);
+    PriWrapper FindScorer(ServerWrapper server);
     void OnBallHit(std::string eventName);  // Keep for demo
     
     // Audio functionality
     void PlayCustomAnthem();
-    void LoadWAVFile(const std::string& filePath);
-    bool IsLocalPlayerGoal();
-    void OpenFileDialog();
+    void PlaySelectedAnthem();
+    void PlayAnthem(const std::string& path, bool streamed, const WavInfo& wav, float trimStart, float trimEnd);
+    // 'wav' is the header the library index or the playlist already probed: the UI never opens the file
+    void LoadWAVFile(const std::string& filePath, const WavInfo& wav);
+    bool IsLocalPlayerGoal(PriWrapper scorer);
+    void ToggleLibraryView();
+    
+    // Offscreen UI benchmark (software rasterizer back-end). It draws the real panels, so helloworld_bench_ui only queues it: it runs
+    // on the render thread, at the start of the next Render/RenderSettings.
+    std::mutex uiBenchMutex;
+    std::vector<std::string> uiBenchArgs;
+    bool uiBenchPending = false;
+    void RunPendingUiBenchmark();
+    void RunUiBenchmarkCommand(std::vector<std::string> args);
+    void RunFontBenchmarkCommand(std::vector<std::string> args);
+    void RunSearchBenchmarkCommand(std::vector<std::string> args);
+    void RunListBenchmarkCommand(std::vector<std::string> args);
+    void RunLibraryBenchmarkCommand(std::vector<std::string> args);
+    void RunLoudnessBenchmarkCommand(std::vector<std::string> args);
+    void RunDuckingBenchmarkCommand(std::vector<std::string> args);
+    void RunCodecBenchmarkCommand(std::vector<std::string> args);
+    void RunResidentBenchmarkCommand(std::vector<std::string> args);
+    void RunGoalDedupBenchmarkCommand(std::vector<std::string> args);
     
 private:
-    // Custom Player Anthems settings (PRD requirements)
-    bool customAnthemsEnabled = true;
+    // Custom Player Anthems settings (PRD requirements), published as snapshots for the hooks and the audio
+    ConfigStore config;
+    // The selected anthem as the UI edits it; PublishSelection() hands it to the hooks through the config
     std::string wavFilePath = "";
-    bool fadeOutEnabled = true;
-    std::string statusMessage = "Plugin loaded successfully!";
+    void PublishSelection();
+    // Status line, set from the game and the render thread. The UI rebuilds its text when the revision changes.
+    struct StatusMessage
+    {
+        uint64_t revision = 0;
+        std::string text;
+    };
+    std::atomic<std::shared_ptr<const StatusMessage>> statusMessage;
+    std::atomic<uint64_t> statusRevision{ 0 };
+    void SetStatus(std::string text);
     
-    // Demo functionality (keep Hello World counter for demo)
-    int goalCounter = 0;
+    // Goals of the current match by player, counted as the goals come in (game thread)
+    MatchState matchState;
+    GoalDedup goalDedup;
+    // What the UI shows of matchState, published after each change
+    struct GoalCounters
+    {
+        uint64_t revision = 0;
+        int totalGoals = 0;
+        int localGoals = 0;
+    };
+    std::atomic<std::shared_ptr<const GoalCounters>> goalCounters;
+    void PublishGoalCounters();
+    void ResetGoalCounters();
     
     // F-key binding functionality (Deja-Vu pattern)  
     std::string currentKeybind = "None";
     std::shared_ptr<CVarWrapper> keybindCVar;
+    // Keybind changes are bound once the settings go idle: the first old key is unbound, the last new one bound
+    bool keybindPending = false;
+    std::string keybindFrom;
+    std::chrono::steady_clock::time_point keybindChanged;
+    void ApplyKeybind();
+    
+    // Cvars saved to settings.cfg in debounced batches (the timer runs on the game thread, only while something is unsaved)
+    std::shared_ptr<SettingsWriter> settingsWriter;
+    bool settingsTimerSet = false;
+    void LoadSettings();
+    void PersistCvar(const std::string& name, const std::string& value);
+    void ScheduleSettingsWrite();
+    void RunSettingsBatch();
+    // UI edits of cvars, coalesced and applied on the game thread in one batch
+    std::mutex queuedCvarMutex;
+    std::map<std::string, std::string> queuedCvars;
+    bool queuedCvarBatch = false;
+    void QueueCvar(const std::string& name, const std::string& value);
     
     // Audio system state
-    bool audioInitialized = false;
+    bool audioInitialized = false;      // An output device was opened
+    std::unique_ptr<AudioEngine> audioEngine;
+    int anthemVoice = 0;
+    std::string anthemVoicePath;        // File of anthemVoice
+    AnthemClip anthemClip;              // Clip of anthemVoice, if it is not streamed
+    // What the UI shows of anthemVoice, published each time the game thread starts an anthem
+    struct PlayingAnthem
+    {
+        int voice = 0;
+        std::string path;
+    };
+    std::atomic<std::shared_ptr<const PlayingAnthem>> playingAnthem;
+    void SetAnthemVoice(int voice, const std::string& path);
+    
+    // Goal replays keep the goal's anthem playing, or restart it when the replay reaches the goal
+    GoalReplayTracker goalReplay;
+    int goalVoice = 0;                  // Voice started by the last goal
+    AnthemClip goalClip;
+    std::string goalPath;
+    void RememberGoalAnthem(int previousVoice);
+    void OnGoalReplayMoment();
     std::string selectedFileName = "No file selected";
+    
+    // UI text shared by Render/RenderSettings, rebuilt by RefreshUiText() only when the state it shows changes
+    struct UiText
+    {
+        uint64_t matchRevision = UINT64_MAX;
+        bool anthemsEnabled = false;
+        bool fadeOutEnabled = false;
+        bool windowOpen = false;
+        uint64_t statusRevision = UINT64_MAX;
+        std::string fileName;
+        std::string keybind;
+        
+        int keybindIndex = 0;
+        std::string selectedFileLine;
+        std::string goalCounterLine;
+        std::string anthemsLine;
+        std::string fadeOutLine;
+        std::string statusLine;
+        std::string currentStatusLine;
+        std::string windowStatusLine;
+        std::string currentKeybindLine;
+        std::string boundToLine;
+        std::string pressKeyLine;
+        std::string toggleKeyLine;
+        std::string versionLine;
+    } uiText;
+    bool RefreshUiText();
+    
+    // Time spent in Render/RenderSettings (UI callbacks only run while something is visible).
+    // uiFrameTime belongs to the render thread; other threads read the copy published each frame and ask for a reset with uiFrameTimeReset.
+    FrameTimeStats uiFrameTime;
+    mutable std::mutex uiFrameTimeMutex;
+    FrameTimeStats uiFrameTimeView;
+    std::atomic<bool> uiFrameTimeReset{ false };
+    std::atomic<int64_t> lastUiFrame{ 0 };      // steady_clock ticks of the last UI callback
+    void BeginUiFrame();
+    void PublishUiFrameTime();
+    FrameTimeStats GetUiFrameTime() const;
+    bool IsUiVisible() const;
+    
+    // Anthem library: WAV, FLAC and Ogg Vorbis files under helloworld_library_folders, indexed in the background (replaces a modal file dialog)
+    std::unique_ptr<AnthemLibrary> library;
+    bool showLibrary = false;
+    uint64_t libraryGeneration = 0;
+    bool libraryWasScanning = false;
+    std::shared_ptr<const std::vector<LibraryEntry>> libraryEntries;
+    std::vector<std::string> libraryNames;      // Items of librarySearch, same order as libraryEntries
+    ImGuiSearchableComboIndex librarySearch;
+    ImGuiVirtualList libraryList;
+    std::string libraryStatusLine;
+    
+    // Decoded samples of the selected anthem and of every playlist entry, reloaded in the background when the files change on disk
+    std::unique_ptr<AnthemCache> anthemCache;
+    bool IsAnthemKept(const std::string& path) const;   // Game thread
+    // Probes 'path' and queues its decode, unless it is longer than helloworld_stream_seconds. Returns whether it will be streamed.
+    bool PrepareAnthem(const std::string& path, WavInfo& wav);
+    // Same with a header probed earlier, without opening the file
+    bool QueueAnthem(const std::string& path, const WavInfo& wav);
+    
+    // Anthems played on goals; goals play the selected anthem while it is empty. The playlist belongs to the game thread, which picks
+    // from it on goals: UI edits are queued there, and the UI draws the copy of the entries published after each edit.
+    std::unique_ptr<AnthemPlaylist> playlist;
+    std::atomic<std::shared_ptr<const std::vector<PlaylistEntry>>> playlistView;
+    int weightEdit = -1;                // Entry whose weight is dragged, applied once it is released
+    float weightEditValue = 0.0f;
+    std::shared_ptr<const std::vector<PlaylistEntry>> weightEditView;   // Drawn until the edit is published
+    void PublishPlaylist();
+    void AddSelectedToPlaylist();
+    void RemoveFromPlaylist(const std::string& path);
+    void SetPlaylistWeight(const std::string& path, float weight);
+    void SetPlaylistTrim(const std::string& path, float start, float end);
+    void EvictUnlessKept(const std::string& path);
+    void RenderPlaylist();
+    
+    // Anthems for overtime, game-winning, hat-trick... goals, from rules.txt; they take precedence over the playlist
+    AnthemRules rules;
+    std::filesystem::path rulesPath;
+    void LoadRules();
+    
+    // Anthems of other players, for spectating and replays. Edits run on the game thread; the UI reads the roster snapshot and the
+    // copy of the entries published after each edit.
+    std::unique_ptr<PlayerAnthems> playerAnthems;
+    std::atomic<std::shared_ptr<const std::vector<RosterPlayer>>> matchRoster;
+    std::atomic<std::shared_ptr<const std::vector<PlayerAnthem>>> playerAnthemsView;
+    ServerWrapper GetMatchServer();
+    bool IsWatching();
+    void RefreshRoster(ServerWrapper server);
+    void PreparePlayerAnthems(const std::vector<std::string>& previous);
+    void MapPlayerAnthem(const std::string& id, const std::string& name, const std::string& path);
+    void RenderPlayerAnthems();
+    
+    // The selected anthem is longer than helloworld_stream_seconds: it is read from disk while it plays instead of decoded
+    bool anthemStreamed = false;
+    WavInfo selectedWav;                // Header of the selected anthem
+    
+    // Waveform preview of the selected anthem: visible range in frames, one min/max pair per column
+    std::shared_ptr<const DecodedAnthem> waveformAnthem;
+    double waveformBegin = 0.0;
+    double waveformEnd = 0.0;
+    std::vector<float> waveformMin;
+    std::vector<float> waveformMax;
+    void RenderWaveform();
+    
+    // Trimmed range of the selected anthem in seconds, reset when another file is selected
+    std::string trimPath;
+    float trimTimes[2] = { 0.0f, 0.0f };
+    bool trimChanged = false;           // Published and saved once the trim handles are released
+    void RenderTrim();
+    void SetLibraryFolders(const std::string& folderList);
+    void StartLibraryScan();
+    void SetLibraryWatch(bool enabled);
+    DuckingParameters GetDuckingParameters();
+    void ApplyDucking();
+    void RefreshLibrarySnapshot();
+    void RenderLibraryView();
+    
+    // Startup profile: onLoad wall time (font atlas timings come from ImFontAtlasCache_GetLastProfile)
+    double onLoadMs = 0.0;
+    void LogStartupProfile();
 };
@@ -0,0 +1,110 @@
+#include "pch.h"
+#include "PeakLimiter.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define LIMITER_SSE2 1
+#endif
+
+void PeakLimiter::Prepare(uint32_t rate, float lookaheadMs)
+{
+    sampleRate = rate;
+    window = std::max(1, (int)std::lround(lookaheadMs * 0.001 * rate));
+    delay.assign((size_t)(window - 1) * 2 + 2, 0.0f);
+    deque.assign(window, Entry{ 0, 1.0f });
+    averageRing.assign(window, 1.0f);
+    gains.reserve(4096);
+    Reset();
+}
+
+void PeakLimiter::SetParameters(float ceilingDb, float releaseMs)
+{
+    ceiling = std::pow(10.0f, std::min(ceilingDb, 0.0f) / 20.0f);
+    releaseCoefficient = 1.0f - std::exp(-1.0f / (std::max(releaseMs, 1.0f) * 0.001f * sampleRate));
+}
+
+void PeakLimiter::Reset()
+{
+    std::fill(delay.begin(), delay.end(), 0.0f);
+    std::fill(averageRing.begin(), averageRing.end(), 1.0f);
+    delayPos = 0;
+    dequeFront = 0;
+    dequeSize = 0;
+    averagePos = 0;
+    averageSum = window;
+    released = 1.0f;
+    frameIndex = 0;
+    lastMinGain = 1.0f;
+}
+
+void PeakLimiter::Process(float* stereo, int frames)
+{
+    if (gains.size() < (size_t)frames) {
+        gains.resize(frames);   // Only when the block size grows
+    }
+    const int delayFrames = window - 1;
+    float minGain = 1.0f;
+
+    for (int i = 0; i < frames; i++) {
+        const float left = stereo[i * 2];
+        const float right = stereo[i * 2 + 1];
+        const float peak = std::max(std::fabs(left), std::fabs(right));
+        const float required = peak > ceiling ? ceiling / peak : 1.0f;
+
+        // Sliding minimum of 'required' over the last 'window' frames. The expired front goes first: with a full ring the new
+        // entry would otherwise land on it.
+        if (dequeSize > 0 && deque[dequeFront].index + window <= frameIndex) {
+            dequeFront = (dequeFront + 1) % window;
+            dequeSize--;
+        }
+        while (dequeSize > 0 && deque[(dequeFront + dequeSize - 1) % window].gain >= required) {
+            dequeSize--;
+        }
+        deque[(dequeFront + dequeSize) % window] = Entry{ frameIndex, required };
+        dequeSize++;
+        const float held = deque[dequeFront].gain;
+
+        // Instant attack (the average below spreads it over the window), exponential release
+        released = std::min(held, released + (1.0f - released) * releaseCoefficient);
+        averageSum += released - averageRing[averagePos];
+        averageRing[averagePos] = released;
+        averagePos = averagePos + 1 == window ? 0 : averagePos + 1;
+        const float gain = std::min((float)(averageSum / window), 1.0f);
+        gains[i] = gain;
+        minGain = std::min(minGain, gain);
+
+        // Delay line: the block becomes the input delayed by window - 1 frames
+        if (delayFrames > 0) {
+            stereo[i * 2] = delay[delayPos * 2];
+            stereo[i * 2 + 1] = delay[delayPos * 2 + 1];
+            delay[delayPos * 2] = left;
+            delay[delayPos * 2 + 1] = right;
+            delayPos = delayPos + 1 == delayFrames ? 0 : delayPos + 1;
+        }
+        frameIndex++;
+    }
+    // The running sum drifts by rounding over hours of playback: resync it once per block
+    averageSum = 0.0;
+    for (float value : averageRing) {
+        averageSum += value;
+    }
+
+    int i = 0;
+#ifdef LIMITER_SSE2
+    for (; i + 4 <= frames; i += 4) {
+        __m128 g = _mm_loadu_ps(&gains[i]);
+        __m128 lo = _mm_unpacklo_ps(g, g);  // g0 g0 g1 g1
+        __m128 hi = _mm_unpackhi_ps(g, g);  // g2 g2 g3 g3
+        _mm_storeu_ps(stereo + i * 2, _mm_mul_ps(_mm_loadu_ps(stereo + i * 2), lo));
+        _mm_storeu_ps(stereo + i * 2 + 4, _mm_mul_ps(_mm_loadu_ps(stereo + i * 2 + 4), hi));
+    }
+#endif
+    for (; i < frames; i++) {
+        stereo[i * 2] *= gains[i];
+        stereo[i * 2 + 1] *= gains[i];
+    }
+    lastMinGain = minGain;
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// Lookahead brickwall limiter for an interleaved stereo bus.
+// Per frame: the gain needed to keep the frame under the ceiling, its minimum over the lookahead window (a monotonic deque, O(1)
+// amortized), an exponential release, then a moving average over the same window. The output is delayed by the window, so the gain
+// has fully ramped down by the time a peak leaves the delay line: no sample exceeds the ceiling and there is no step in the gain.
+// The gain is applied to the delayed block with SSE2.
+class PeakLimiter
+{
+public:
+    // Allocates the delay line and the deque; call before Process(), not from the audio thread
+    void Prepare(uint32_t sampleRate, float lookaheadMs = 5.0f);
+    void SetParameters(float ceilingDb, float releaseMs);
+    void Reset();
+
+    void Process(float* stereo, int frames);
+
+    int GetLatencyFrames() const { return window - 1; }
+    float GetLastMinGain() const { return lastMinGain; }    // Smallest gain applied during the last Process()
+
+private:
+    struct Entry
+    {
+        uint64_t index;
+        float gain;
+    };
+
+    uint32_t sampleRate = 48000;
+    int window = 1;                 // Lookahead in frames, also the length of the moving average
+    float ceiling = 1.0f;
+    float releaseCoefficient = 0.0f;
+
+    std::vector<float> delay;       // window - 1 stereo frames
+    int delayPos = 0;
+    std::vector<Entry> deque;       // Ring of capacity 'window', gains increasing from front to back
+    int dequeFront = 0;
+    int dequeSize = 0;
+    std::vector<float> averageRing; // Last 'window' released gains
+    int averagePos = 0;
+    double averageSum = 0.0;
+    float released = 1.0f;
+    uint64_t frameIndex = 0;
+    std::vector<float> gains;       // Per-frame gains of the current block
+    float lastMinGain = 1.0f;
+};
@@ -0,0 +1,135 @@
+#include "pch.h"
+#include "PlayerAnthems.h"
+#include "FileUtil.h"
+
+#include <algorithm>
+#include <fstream>
+
+PlayerAnthems::PlayerAnthems(std::filesystem::path path)
+    : filePath(std::move(path))
+{
+}
+
+int PlayerAnthems::Find(const std::string& id) const
+{
+    for (size_t i = 0; i < entries.size(); i++) {
+        if (entries[i].id == id) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+void PlayerAnthems::Set(const std::string& id, const std::string& displayName, const std::string& path)
+{
+    // Tabs separate the fields of the saved lines
+    std::string name = displayName;
+    std::replace(name.begin(), name.end(), '\t', ' ');
+    const int index = Find(id);
+    if (index >= 0) {
+        entries[index].name = name;
+        entries[index].path = path;
+        entries[index].wav = WavInfo();
+        entries[index].streamed = false;
+    }
+    else {
+        entries.push_back({ id, name, path, WavInfo{} });
+    }
+    Rebuild();
+}
+
+void PlayerAnthems::Remove(int index)
+{
+    if (index >= 0 && index < (int)entries.size()) {
+        entries.erase(entries.begin() + index);
+        Rebuild();
+    }
+}
+
+void PlayerAnthems::SetProbe(int index, const WavInfo& wav, bool streamed)
+{
+    if (index >= 0 && index < (int)entries.size()) {
+        entries[index].wav = wav;
+        entries[index].streamed = streamed;
+    }
+}
+
+bool PlayerAnthems::BeginMatch(std::vector<std::string> ids)
+{
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    if (ids == roster) {
+        return false;
+    }
+    roster = std::move(ids);
+    Rebuild();
+    return true;
+}
+
+void PlayerAnthems::Rebuild()
+{
+    matchIndex.clear();
+    matchIndex.reserve(roster.size());
+    for (size_t i = 0; i < entries.size(); i++) {
+        if (IsInRoster(entries[i].id)) {
+            matchIndex.emplace(entries[i].id, (int)i);
+        }
+    }
+}
+
+int PlayerAnthems::FindInMatch(const std::string& id) const
+{
+    auto it = matchIndex.find(id);
+    return it != matchIndex.end() ? it->second : -1;
+}
+
+bool PlayerAnthems::IsInRoster(const std::string& id) const
+{
+    return std::binary_search(roster.begin(), roster.end(), id);
+}
+
+bool PlayerAnthems::UsesInMatch(const std::string& path) const
+{
+    for (const auto& [id, index] : matchIndex) {
+        if (entries[index].path == path) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool PlayerAnthems::Load()
+{
+    std::ifstream file(filePath, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    entries.clear();
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        // id \t name \t path
+        const size_t first = line.find('\t');
+        const size_t second = first != std::string::npos ? line.find('\t', first + 1) : std::string::npos;
+        if (first == 0 || second == std::string::npos || second + 1 == line.size()) {
+            continue;
+        }
+        const std::string id = line.substr(0, first);
+        if (Find(id) < 0) {
+            entries.push_back({ id, line.substr(first + 1, second - first - 1), line.substr(second + 1), WavInfo{} });
+        }
+    }
+    Rebuild();
+    return true;
+}
+
+bool PlayerAnthems::Save() const
+{
+    std::string out;
+    for (const PlayerAnthem& entry : entries) {
+        out += entry.id + '\t' + entry.name + '\t' + entry.path + '\n';
+    }
+    return WriteFileAtomic(filePath, out);
+}
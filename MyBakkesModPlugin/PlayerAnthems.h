@@ -0,0 +1,58 @@
+#pragma once
+#include "AnthemLibrary.h"
+
+#include <unordered_map>
+
+struct PlayerAnthem
+{
+    std::string id;                 // Unique id string of the player
+    std::string name;               // Name when the anthem was assigned, for display
+    std::string path;               // UTF-8
+
+    // Probed when the player's match starts, not saved
+    WavInfo wav;
+    bool streamed = false;
+};
+
+struct RosterPlayer
+{
+    std::string id;
+    std::string name;
+};
+
+// Anthems of other players, played for their goals while spectating or watching a replay.
+// The lookup only holds the players of the current match: it is built from the roster when the match starts (and again if the roster
+// changes), so a goal costs one hash lookup however many players are mapped, and only those players' anthems need to be decoded.
+// Saved as text lines (id, name, path), written next to the file then renamed over it.
+class PlayerAnthems
+{
+public:
+    explicit PlayerAnthems(std::filesystem::path filePath);
+
+    const std::vector<PlayerAnthem>& GetEntries() const { return entries; }
+    int Find(const std::string& id) const;
+
+    // Maps 'id' to 'path', replacing its previous anthem
+    void Set(const std::string& id, const std::string& name, const std::string& path);
+    void Remove(int index);
+    void SetProbe(int index, const WavInfo& wav, bool streamed);
+
+    // Rebuilds the lookup from the unique ids of the players in the match. Returns false if the roster did not change.
+    bool BeginMatch(std::vector<std::string> ids);
+    // Index of the entry of a player in the match, or -1
+    int FindInMatch(const std::string& id) const;
+    bool IsInRoster(const std::string& id) const;
+    // Whether a player of the match uses 'path'
+    bool UsesInMatch(const std::string& path) const;
+
+    bool Load();
+    bool Save() const;
+
+private:
+    void Rebuild();
+
+    std::filesystem::path filePath;
+    std::vector<PlayerAnthem> entries;
+    std::vector<std::string> roster;                // Sorted
+    std::unordered_map<std::string, int> matchIndex;
+};
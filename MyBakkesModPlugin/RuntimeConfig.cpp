@@ -0,0 +1,16 @@
+#include "pch.h"
+#include "RuntimeConfig.h"
+
+ConfigStore::ConfigStore()
+    : current(std::make_shared<const RuntimeConfig>())
+{
+}
+
+void ConfigStore::Update(const std::function<void(RuntimeConfig&)>& edit)
+{
+    std::lock_guard<std::mutex> lock(writeMutex);
+    auto next = std::make_shared<RuntimeConfig>(*current.load(std::memory_order_relaxed));
+    edit(*next);
+    current.store(std::move(next), std::memory_order_release);
+    version.fetch_add(1, std::memory_order_relaxed);
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include "AnthemLibrary.h"
+#include "GoalReplay.h"
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+
+// Settings read when a goal, a replay or the audio needs them
+struct RuntimeConfig
+{
+    bool anthemsEnabled = true;
+    bool fadeOut = true;
+    bool normalize = true;                  // Play anthems at loudnessTargetLufs
+    GoalReplayMode goalReplay = GoalReplayMode::KeepPlaying;
+
+    // Selected anthem, played by goals while the playlist is empty
+    std::string anthemPath;                 // UTF-8, empty if none
+    bool anthemStreamed = false;            // Longer than helloworld_stream_seconds
+    WavInfo anthemWav;                      // Probed header, what a streamed anthem plays from
+    float trimStart = 0.0f;                 // Seconds; trimEnd <= trimStart plays the whole file
+    float trimEnd = 0.0f;
+};
+
+// Holds the current RuntimeConfig. A published snapshot is never modified: Update() copies it, edits the copy and swaps it in
+// atomically, so a reader loads one pointer and sees a consistent set of settings for as long as it keeps it, on any thread.
+// Readers never wait on the writers' mutex; the atomic shared_ptr only spins for the instant of a reference count update.
+// A real-time thread should not drop the last reference to an old snapshot (that frees it): hand it back like finished voices.
+class ConfigStore
+{
+public:
+    ConfigStore();
+
+    std::shared_ptr<const RuntimeConfig> Get() const { return current.load(std::memory_order_acquire); }
+    // Writers are serialized, so concurrent edits of different settings are never lost
+    void Update(const std::function<void(RuntimeConfig&)>& edit);
+    // Number of snapshots published
+    uint64_t GetVersion() const { return version.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<std::shared_ptr<const RuntimeConfig>> current;
+    std::mutex writeMutex;
+    std::atomic<uint64_t> version{ 0 };
+};
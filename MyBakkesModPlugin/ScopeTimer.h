@@ -0,0 +1,40 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+// Rolling timing stats for a piece of per-frame work (e.g. the plugin's UI callbacks)
+struct FrameTimeStats
+{
+    double lastMs = 0.0;
+    double avgMs = 0.0;     // Exponential moving average over roughly the last 60 samples
+    double maxMs = 0.0;
+    uint64_t samples = 0;
+
+    void Add(double ms)
+    {
+        lastMs = ms;
+        avgMs = samples == 0 ? ms : avgMs + (ms - avgMs) / 60.0;
+        maxMs = ms > maxMs ? ms : maxMs;
+        samples++;
+    }
+
+    void Reset() { *this = FrameTimeStats(); }
+};
+
+// Adds the wall time of the enclosing scope to a FrameTimeStats when it goes out of scope
+class ScopeTimer
+{
+public:
+    explicit ScopeTimer(FrameTimeStats& stats) : stats(stats), start(std::chrono::steady_clock::now()) {}
+    ~ScopeTimer()
+    {
+        stats.Add(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    ScopeTimer(const ScopeTimer&) = delete;
+    ScopeTimer& operator=(const ScopeTimer&) = delete;
+
+private:
+    FrameTimeStats& stats;
+    std::chrono::steady_clock::time_point start;
+};
@@ -0,0 +1,163 @@
+#include "pch.h"
+#include "SettingsWriter.h"
+#include "FileUtil.h"
+
+#include <algorithm>
+#include <fstream>
+
+SettingsWriter::SettingsWriter(std::filesystem::path path, double idleSeconds, double maxDelaySeconds)
+    : filePath(std::move(path)),
+      idle(std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(idleSeconds))),
+      maxDelay(std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(maxDelaySeconds)))
+{
+}
+
+std::vector<std::pair<std::string, std::string>> SettingsWriter::Load()
+{
+    std::vector<std::pair<std::string, std::string>> loaded;
+    std::ifstream file(filePath, std::ios::binary);
+    if (!file) {
+        return loaded;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        // name "value"
+        const size_t space = line.find(' ');
+        const size_t open = space != std::string::npos ? line.find('"', space) : std::string::npos;
+        const size_t close = line.rfind('"');
+        if (space == 0 || open == std::string::npos || close <= open) {
+            continue;
+        }
+        std::string name = line.substr(0, space);
+        std::string value = line.substr(open + 1, close - open - 1);
+        saved[name] = value;
+        loaded.emplace_back(std::move(name), std::move(value));
+    }
+    return loaded;
+}
+
+bool SettingsWriter::Set(const std::string& name, const std::string& value, Clock::time_point now)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto savedIt = saved.find(name);
+    const bool isSaved = savedIt != saved.end() && savedIt->second == value;
+    auto it = pending.find(name);
+    if (it != pending.end()) {
+        if (it->second == value) {
+            return true;
+        }
+        stats.coalesced++;
+        if (isSaved) {
+            pending.erase(it);      // Changed back before it was written
+            if (pending.empty()) {
+                throttledBatch = false;     // Nothing left to write: the next change starts a new batch
+            }
+        }
+        else {
+            it->second = value;
+        }
+    }
+    else {
+        if (isSaved) {
+            return !pending.empty();
+        }
+        if (pending.empty()) {
+            firstChange = now;
+        }
+        pending.emplace(name, value);
+    }
+    stats.changes++;
+    lastChange = now;
+    return !pending.empty();
+}
+
+bool SettingsWriter::Update(Clock::time_point now)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (pending.empty() || (now - lastChange < idle && now - firstChange < maxDelay)) {
+        return false;
+    }
+    if (CountRecentWrites(now) >= maxWritesPerMinute) {
+        if (!throttledBatch) {
+            stats.throttled++;
+            throttledBatch = true;
+        }
+        return false;
+    }
+    return Write(now);
+}
+
+bool SettingsWriter::Flush(Clock::time_point now)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return pending.empty() || Write(now);
+}
+
+bool SettingsWriter::HasPending() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return !pending.empty();
+}
+
+double SettingsWriter::SecondsUntilDue(Clock::time_point now) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (pending.empty()) {
+        return -1.0;
+    }
+    Clock::time_point due = std::min(lastChange + idle, firstChange + maxDelay);
+    if (CountRecentWrites(now) >= maxWritesPerMinute) {
+        // The ring is full: the oldest write has to leave the minute first
+        due = std::max(due, writeTimes[nextWrite] + std::chrono::minutes(1));
+    }
+    return std::max(0.0, std::chrono::duration<double>(due - now).count());
+}
+
+SettingsWriterStats SettingsWriter::GetStats(Clock::time_point now) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    SettingsWriterStats result = stats;
+    result.writesLastMinute = CountRecentWrites(now);
+    return result;
+}
+
+int SettingsWriter::CountRecentWrites(Clock::time_point now) const
+{
+    int count = 0;
+    for (int i = 0; i < recordedWrites; i++) {
+        if (now - writeTimes[i] < std::chrono::minutes(1)) {
+            count++;
+        }
+    }
+    return count;
+}
+
+bool SettingsWriter::Write(Clock::time_point now)
+{
+    std::map<std::string, std::string> merged = saved;
+    for (const auto& [name, value] : pending) {
+        merged[name] = value;
+    }
+    std::string out;
+    for (const auto& [name, value] : merged) {
+        out += name + " \"" + value + "\"\n";
+    }
+
+    // A failed write counts against the cap too, so a full disk is retried at the capped rate
+    writeTimes[nextWrite] = now;
+    nextWrite = (nextWrite + 1) % writeTimes.size();
+    recordedWrites = std::min(recordedWrites + 1, (int)writeTimes.size());
+    if (!WriteFileAtomic(filePath, out)) {
+        stats.failed++;
+        return false;
+    }
+    saved = std::move(merged);
+    pending.clear();
+    throttledBatch = false;
+    stats.writes++;
+    return true;
+}
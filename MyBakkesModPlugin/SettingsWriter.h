@@ -0,0 +1,69 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct SettingsWriterStats
+{
+    uint64_t changes = 0;           // Set() calls that changed a value
+    uint64_t coalesced = 0;         // Changes replaced by a later value before they were written
+    uint64_t writes = 0;
+    uint64_t failed = 0;
+    uint64_t throttled = 0;         // Batches held back by the per-minute cap
+    int writesLastMinute = 0;
+};
+
+// The plugin settings in settings.cfg, one `name "value"` line per cvar (console syntax). Changes are coalesced, the latest value
+// of each setting wins, and the whole file is rewritten in one batch once the settings have been idle for 'idleSeconds', or
+// 'maxDelaySeconds' after the first unsaved change while they keep changing. At most maxWritesPerMinute writes go out in any
+// rolling minute (a fixed ring of write times); past that the batch waits, so dragging a control never turns into a write per frame.
+// Thread-safe.
+class SettingsWriter
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    static constexpr int maxWritesPerMinute = 12;
+
+    explicit SettingsWriter(std::filesystem::path path, double idleSeconds = 0.5, double maxDelaySeconds = 5.0);
+
+    // Reads the saved settings, in file order
+    std::vector<std::pair<std::string, std::string>> Load();
+
+    // Records a change. Returns whether changes are waiting to be written (false when 'value' is what the file already holds).
+    bool Set(const std::string& name, const std::string& value, Clock::time_point now);
+    // Writes the pending changes if they are due and the cap allows it. Returns true if it wrote.
+    bool Update(Clock::time_point now);
+    // Writes the pending changes now, regardless of the idle time and the cap (unload)
+    bool Flush(Clock::time_point now);
+
+    bool HasPending() const;
+    // Seconds until Update() can write, or a negative value if nothing is pending
+    double SecondsUntilDue(Clock::time_point now) const;
+    SettingsWriterStats GetStats(Clock::time_point now) const;
+
+private:
+    bool Write(Clock::time_point now);
+    int CountRecentWrites(Clock::time_point now) const;
+
+    std::filesystem::path filePath;
+    Clock::duration idle;
+    Clock::duration maxDelay;
+
+    mutable std::mutex mutex;
+    std::map<std::string, std::string> saved;       // What the file holds
+    std::map<std::string, std::string> pending;     // Changed since, not written yet
+    Clock::time_point firstChange;                  // First change of the pending batch
+    Clock::time_point lastChange;
+    bool throttledBatch = false;                    // The pending batch was already counted as throttled
+
+    std::array<Clock::time_point, maxWritesPerMinute> writeTimes{};
+    size_t nextWrite = 0;
+    int recordedWrites = 0;                         // Used entries of writeTimes
+    SettingsWriterStats stats;
+};
@@ -0,0 +1,311 @@
+#include "pch.h"
+#include "UiBenchmark.h"
+#include "IMGUI/imgui_impl_softraster.h"
+#include "IMGUI/imgui_fontcache.h"
+#include "IMGUI/imgui_fontdynamic.h"
+#include "IMGUI/imgui_virtuallist.h"
+#include "IMGUI/imgui_timeline.h"
+
+#include <algorithm>
+#include <chrono>
+
+UiBenchmarkResult RunUiBenchmark(const std::function<void()>& drawFrame, const UiBenchmarkOptions& options)
+{
+    using Clock = std::chrono::steady_clock;
+    UiBenchmarkResult result;
+
+    ImGuiContext* previousContext = ImGui::GetCurrentContext();
+    ImFontAtlas fontAtlas;
+    ImGuiContext* context = ImGui::CreateContext(&fontAtlas);
+    ImGui::SetCurrentContext(context);
+
+    ImGuiIO& io = ImGui::GetIO();
+    io.IniFilename = nullptr;
+    io.LogFilename = nullptr;
+    io.DisplaySize = ImVec2((float)options.width, (float)options.height);
+    io.DeltaTime = 1.0f / 60.0f; // Fixed timestep keeps the output deterministic
+
+    ImGui_ImplSoftRaster_Init(options.width, options.height, options.threads);
+    ImGui_ImplSoftRaster_SetFontCacheFilename(options.fontCachePath.empty() ? nullptr : options.fontCachePath.c_str());
+
+    double totalBuildMs = 0.0;
+    double totalRasterMs = 0.0;
+    for (int frame = 0; frame < options.warmupFrames + options.frames; frame++) {
+        ImGui_ImplSoftRaster_NewFrame();
+
+        auto buildStart = Clock::now();
+        ImGui::NewFrame();
+        drawFrame();
+        ImGui::Render();
+        double buildMs = std::chrono::duration<double, std::milli>(Clock::now() - buildStart).count();
+
+        ImGui_ImplSoftRaster_RenderDrawData(ImGui::GetDrawData());
+        const ImGui_ImplSoftRaster_Stats& stats = ImGui_ImplSoftRaster_GetStats();
+
+        if (frame < options.warmupFrames) {
+            continue;
+        }
+        totalBuildMs += buildMs;
+        totalRasterMs += stats.RasterMs;
+        result.maxFrameMs = std::max(result.maxFrameMs, buildMs + stats.RasterMs);
+        result.triangles = stats.Triangles;
+        result.frames++;
+    }
+
+    if (result.frames > 0) {
+        result.avgBuildMs = totalBuildMs / result.frames;
+        result.avgRasterMs = totalRasterMs / result.frames;
+    }
+    result.framebufferHash = ImGui_ImplSoftRaster_HashFramebuffer();
+
+    // The atlas was built by the first ImGui_ImplSoftRaster_NewFrame()
+    const ImFontAtlasCacheProfile& fontProfile = ImFontAtlasCache_GetLastProfile();
+    result.fontAtlasMs = fontProfile.HashMs + fontProfile.LoadMs + fontProfile.BakeMs + fontProfile.SaveMs;
+    result.fontCacheHit = fontProfile.CacheHit;
+    if (!options.dumpPath.empty()) {
+        ImGui_ImplSoftRaster_WriteTGA(options.dumpPath.c_str());
+    }
+
+    ImGui_ImplSoftRaster_SetFontCacheFilename(nullptr);
+    ImGui_ImplSoftRaster_Shutdown();
+    ImGui::DestroyContext(context);
+    ImGui::SetCurrentContext(previousContext);
+    return result;
+}
+
+// Sample of file-name-like text: 'count' distinct ideographs spread over the CJK Unified Ideographs block, UTF-8 encoded
+static std::string MakeCjkSample(int count)
+{
+    std::string text;
+    for (int i = 0; i < count; i++) {
+        unsigned int c = 0x4E00 + (unsigned int)(i * 97) % (0x9FAF - 0x4E00);
+        text += (char)(0xE0 | (c >> 12));
+        text += (char)(0x80 | ((c >> 6) & 0x3F));
+        text += (char)(0x80 | (c & 0x3F));
+    }
+    return text;
+}
+
+FontBenchmarkResult RunFontBenchmark(const std::string& fontPath, float sizePixels, int sampleGlyphs)
+{
+    using Clock = std::chrono::steady_clock;
+    FontBenchmarkResult result;
+
+    {
+        ImFontAtlas atlas;
+        ImFont* font = atlas.AddFontFromFileTTF(fontPath.c_str(), sizePixels, nullptr, atlas.GetGlyphRangesChineseFull());
+        if (!font) {
+            return result;
+        }
+        auto start = Clock::now();
+        atlas.Build();
+        result.fullBakeMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        result.fullGlyphs = font->Glyphs.Size;
+        result.fullTexWidth = atlas.TexWidth;
+        result.fullTexHeight = atlas.TexHeight;
+    }
+
+    {
+        ImFontAtlas atlas;
+        ImFont* font = atlas.AddFontFromFileTTF(fontPath.c_str(), sizePixels, nullptr, atlas.GetGlyphRangesChineseFull());
+        if (!font || !ImFontAtlasDynamic_Build(&atlas)) {
+            return result;
+        }
+        const ImFontAtlasDynamicStats* stats = ImFontAtlasDynamic_GetStats(&atlas);
+        result.lazyBuildMs = stats->BuildMs;
+        result.lazyGlyphs = font->Glyphs.Size;
+        result.lazyTexWidth = atlas.TexWidth;
+        result.lazyTexHeight = atlas.TexHeight;
+
+        std::string sample = MakeCjkSample(sampleGlyphs);
+        ImFontAtlasDynamic_RequestText(font, sample.c_str(), sample.c_str() + sample.size());
+        int x, y, w, h;
+        result.onDemandGlyphs = ImFontAtlasDynamic_Update(&atlas, &x, &y, &w, &h);
+        result.onDemandMs = stats->RasterMs;
+        ImFontAtlasDynamic_Shutdown(&atlas);
+    }
+
+    result.loaded = true;
+    return result;
+}
+
+// File-name-like entries: "<artist> - <title> <n>.wav", with enough variety that trigrams are selective
+static std::vector<std::string> MakeAnthemLibrary(int count)
+{
+    static const char* artists[] = { "Rocket", "Octane", "Dominus", "Breakout", "Fennec", "Merc", "Hotshot", "Twin Mill",
+        "Gizmo", "Paladin", "Road Hog", "Venom", "Takumi", "Scarab", "Zippy", "Backfire" };
+    static const char* words[] = { "Anthem", "Goal", "Horn", "Victory", "Overtime", "Kickoff", "Aerial", "Demo", "Save",
+        "Flip", "Reset", "Ceiling", "Pinch", "Musty", "Boost", "Supersonic", "Champion", "Hat Trick", "Epic", "Remix" };
+    const int artistCount = (int)(sizeof(artists) / sizeof(artists[0]));
+    const int wordCount = (int)(sizeof(words) / sizeof(words[0]));
+
+    std::vector<std::string> items;
+    items.reserve(count);
+    unsigned int seed = 12345;
+    for (int i = 0; i < count; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        std::string name = artists[(seed >> 8) % artistCount];
+        name += " - ";
+        name += words[(seed >> 16) % wordCount];
+        name += " ";
+        name += words[(seed >> 24) % wordCount];
+        name += " " + std::to_string(i) + ".wav";
+        items.push_back(std::move(name));
+    }
+    return items;
+}
+
+SearchBenchmarkResult RunSearchBenchmark(int itemCount, const std::string& query)
+{
+    using Clock = std::chrono::steady_clock;
+    SearchBenchmarkResult result;
+    result.items = itemCount;
+    std::vector<std::string> items = MakeAnthemLibrary(itemCount);
+
+    // Legacy path: what SearchableCombo(std::vector) did every frame while the popup was open
+    {
+        auto lower = [](std::string text) {
+            std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return (unsigned char)std::tolower(c); });
+            return text;
+        };
+        std::string input = lower(query);
+        auto start = Clock::now();
+        std::vector<std::string> copy = items;
+        int matches = 0;
+        for (const std::string& item : copy) {
+            if (lower(item).find(input) != std::string::npos) {
+                matches++;
+            }
+        }
+        result.legacyKeystrokeMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        result.matches = matches;
+    }
+
+    ImGuiSearchableComboIndex index;
+    index.Build(items);
+    result.indexBuildMs = index.BuildMs;
+    result.trigrams = (int)index.Trigrams.size();
+
+    double totalMs = 0.0;
+    for (size_t length = 1; length <= query.size(); length++) {
+        index.Filter(query.substr(0, length).c_str());
+        totalMs += index.LastFilterMs;
+        result.indexKeystrokeMaxMs = std::max(result.indexKeystrokeMaxMs, index.LastFilterMs);
+    }
+    result.indexKeystrokeMs = query.empty() ? 0.0 : totalMs / query.size();
+    result.matches = (int)index.Matches.size();
+
+    // Jump to an unrelated query, as when the text is replaced or pasted
+    index.Filter("remix");
+    result.indexFreshQueryMs = index.LastFilterMs;
+    return result;
+}
+
+static float ListBenchmarkRowHeight(void*, int idx)
+{
+    return ImGui::GetTextLineHeightWithSpacing() * (idx % 4 == 0 ? 2.0f : 1.0f);
+}
+
+void DrawUiBenchmarkFixture()
+{
+    static const std::vector<std::string> names = MakeAnthemLibrary(200);
+    static ImGuiVirtualList list;
+    bool enabled = true;
+    bool fadeOut = false;
+    float trim[2] = { 4.5f, 31.0f };
+
+    ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f));
+    ImGui::SetNextWindowSize(ImGui::GetIO().DisplaySize);
+    ImGui::Begin("##FixtureBench", nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoSavedSettings);
+    ImGui::Text("Custom Player Anthems");
+    ImGui::Separator();
+    ImGui::Checkbox("Enable Custom Anthems", &enabled);
+    ImGui::Text("Selected WAV File:");
+    ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.0f, 1.0f), "%s", names[7].c_str());
+    if (ImGui::BeginTimeline("##FixtureTrim", 42.0f, ImVec2(0.0f, ImGui::GetTextLineHeightWithSpacing() * 3.0f))) {
+        ImGui::TimelineEvent("Trim", trim);
+    }
+    ImGui::EndTimeline(12.0f);
+    ImGui::Button("Browse for WAV File");
+    ImGui::SameLine();
+    ImGui::Button("Clear Selection");
+    list.SetItems((int)names.size(), ImGui::GetTextLineHeightWithSpacing());
+    if (ImGui::BeginVirtualList("##FixtureLibrary", &list, ImVec2(0.0f, ImGui::GetTextLineHeightWithSpacing() * 10.0f), true)) {
+        for (int i = list.DisplayStart; i < list.DisplayEnd; i++) {
+            ImGui::VirtualListSelectable(&list, i, names[i].c_str());
+        }
+    }
+    ImGui::EndVirtualList(&list);
+    ImGui::Checkbox("Fade Out", &fadeOut);
+    ImGui::SameLine();
+    ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1.0f), "(anthem will fade out at the end)");
+    ImGui::Separator();
+    ImGui::Text("Goals this match: 3 (yours: 2)");
+    ImGui::End();
+}
+
+ListBenchmarkResult RunListBenchmark(int rows, int frames)
+{
+    ListBenchmarkResult result;
+    result.rows = rows;
+    std::vector<std::string> names = MakeAnthemLibrary(rows);
+
+    UiBenchmarkOptions options;
+    options.frames = frames;
+
+    // 0: plain loop, 1: virtualized, 2: virtualized with varying heights
+    for (int mode = 0; mode < 3; mode++) {
+        ImGuiVirtualList list;
+        int frameIndex = 0;     // Scroll on the second frame, once the content height is known
+        UiBenchmarkResult frame = RunUiBenchmark([&]() {
+            ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f));
+            ImGui::SetNextWindowSize(ImGui::GetIO().DisplaySize);
+            ImGui::Begin("##ListBench", nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoSavedSettings);
+            if (mode == 0) {
+                ImGui::BeginChild("##Anthems");
+                for (int i = 0; i < rows; i++) {
+                    ImGui::PushID(i);
+                    ImGui::Selectable(names[i].c_str(), i == rows / 2);
+                    ImGui::PopID();
+                }
+                if (frameIndex == 1) {
+                    ImGui::SetScrollY(ImGui::GetScrollMaxY() * 0.5f);
+                }
+                ImGui::EndChild();
+            }
+            else {
+                if (mode == 1) {
+                    list.SetItems(rows, ImGui::GetTextLineHeightWithSpacing());
+                }
+                else if (list.ItemsCount != rows) {
+                    list.SetItems(rows, ListBenchmarkRowHeight, nullptr);
+                }
+                if (ImGui::BeginVirtualList("##Anthems", &list)) {
+                    for (int i = list.DisplayStart; i < list.DisplayEnd; i++) {
+                        ImGui::VirtualListSelectable(&list, i, names[i].c_str());
+                    }
+                    result.rowsSubmitted = list.DisplayEnd - list.DisplayStart;
+                    if (frameIndex == 1) {
+                        ImGui::SetScrollY(list.GetTotalHeight() * 0.5f);
+                    }
+                }
+                ImGui::EndVirtualList(&list);
+            }
+            frameIndex++;
+            ImGui::End();
+        }, options);
+
+        // Build time only: rasterization depends on the pixels covered, which is the same window whatever the row count
+        double frameMs = frame.avgBuildMs;
+        if (mode == 0) {
+            result.plainMs = frameMs;
+        }
+        else if (mode == 1) {
+            result.virtualMs = frameMs;
+        }
+        else {
+            result.variableMs = frameMs;
+        }
+    }
+    return result;
+}
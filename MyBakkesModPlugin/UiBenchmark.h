@@ -0,0 +1,82 @@
+#pragma once
+#include <functional>
+#include <string>
+
+// Offscreen UI benchmark driven by the software rasterizer back-end (IMGUI/imgui_impl_softraster).
+// Runs in a private ImGui context with its own font atlas, so the overlay's context is never touched.
+struct UiBenchmarkOptions
+{
+    int frames = 120;
+    int warmupFrames = 5;
+    int threads = 1;
+    int width = 1280;
+    int height = 720;
+    std::string dumpPath;   // Optional TGA of the last frame, for golden-image comparison
+    std::string fontCachePath;  // Optional baked font atlas cache (IMGUI/imgui_fontcache), empty bakes every run
+};
+
+struct UiBenchmarkResult
+{
+    int frames = 0;
+    double avgBuildMs = 0.0;    // NewFrame() -> Render(): layout and draw list building
+    double avgRasterMs = 0.0;   // Software rasterization of the draw data
+    double maxFrameMs = 0.0;
+    int triangles = 0;
+    unsigned int framebufferHash = 0;
+    double fontAtlasMs = 0.0;   // Hash + cache read + bake + cache write of the private font atlas
+    bool fontCacheHit = false;
+};
+
+UiBenchmarkResult RunUiBenchmark(const std::function<void()>& drawFrame, const UiBenchmarkOptions& options);
+
+// A panel built from the widgets of the plugin UI (text, checkboxes, buttons, the anthem list, the trim timeline) with fixed content.
+// The real panels show the status, the library and the goal counters, so only this one has a framebuffer hash worth keeping as a golden.
+void DrawUiBenchmarkFixture();
+
+// Font atlas start-up cost: full bake of every glyph range vs lazily rasterized glyphs (IMGUI/imgui_fontdynamic).
+// The glyph ranges are the full CJK set, as needed to show any anthem file name.
+struct FontBenchmarkResult
+{
+    bool loaded = false;
+    double fullBakeMs = 0.0;
+    int fullGlyphs = 0;
+    int fullTexWidth = 0;
+    int fullTexHeight = 0;
+    double lazyBuildMs = 0.0;
+    int lazyGlyphs = 0;
+    int lazyTexWidth = 0;
+    int lazyTexHeight = 0;
+    int onDemandGlyphs = 0;     // Glyphs of the sample text rasterized on first use
+    double onDemandMs = 0.0;
+};
+
+FontBenchmarkResult RunFontBenchmark(const std::string& fontPath, float sizePixels, int sampleGlyphs);
+
+// SearchableCombo filtering cost over a synthetic anthem library of 'itemCount' names:
+// the legacy per-keystroke lowercase scan vs ImGuiSearchableComboIndex (IMGUI/imgui_searchablecombo).
+struct SearchBenchmarkResult
+{
+    int items = 0;
+    double indexBuildMs = 0.0;
+    int trigrams = 0;
+    double legacyKeystrokeMs = 0.0;     // Copy + lowercase + find over every item, as SearchableCombo(std::vector) does per frame
+    double indexKeystrokeMs = 0.0;      // Average Filter() while typing the query one character at a time
+    double indexKeystrokeMaxMs = 0.0;
+    double indexFreshQueryMs = 0.0;     // Filter() of a query unrelated to the previous one
+    int matches = 0;                    // Matches of the full typed query
+};
+
+SearchBenchmarkResult RunSearchBenchmark(int itemCount, const std::string& query);
+
+// Per-frame UI build cost (NewFrame() -> Render()) of a 'rows' long anthem list, scrolled to the middle:
+// a plain Selectable() loop vs ImGuiVirtualList (IMGUI/imgui_virtuallist) with uniform and varying row heights.
+struct ListBenchmarkResult
+{
+    int rows = 0;
+    double plainMs = 0.0;
+    double virtualMs = 0.0;
+    double variableMs = 0.0;            // Every 4th row is two lines high
+    int rowsSubmitted = 0;              // By the virtualized list in the last frame
+};
+
+ListBenchmarkResult RunListBenchmark(int rows, int frames);
@@ -0,0 +1,1389 @@
+#include "pch.h"
+#include "AudioDecoder.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+// Ogg Vorbis I decoder (floor 1 only: floor 0 was never produced by a released encoder).
+// Layout follows the specification: Ogg pages -> packets -> headers (identification, comment, setup) -> audio packets, each
+// decoded to floor curves and residue vectors, inverse coupling, IMDCT, windowing and overlap-add with the previous packet.
+
+static constexpr double pi = 3.14159265358979323846;
+
+static uint32_t OggCrc(const uint8_t* data, size_t size, uint32_t crc)
+{
+    static const auto table = []() {
+        std::array<uint32_t, 256> t{};
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t r = i << 24;
+            for (int b = 0; b < 8; b++) {
+                r = (r & 0x80000000u) ? (r << 1) ^ 0x04C11DB7u : r << 1;
+            }
+            t[i] = r;
+        }
+        return t;
+    }();
+    for (size_t i = 0; i < size; i++) {
+        crc = (crc << 8) ^ table[((crc >> 24) ^ data[i]) & 0xFF];
+    }
+    return crc;
+}
+
+static int ILog(uint32_t value)
+{
+    int bits = 0;
+    while (value) {
+        bits++;
+        value >>= 1;
+    }
+    return bits;
+}
+
+struct OggPage
+{
+    uint64_t offset = 0;
+    uint8_t flags = 0;              // 1: continued packet, 2: first page, 4: last page
+    int64_t granule = -1;           // -1: no packet ends on this page
+    uint32_t serial = 0;
+    std::vector<uint8_t> lacing;
+    std::vector<uint8_t> body;
+};
+
+// Pages of one logical stream and the packets in them. A page that fails its CRC is skipped along with the packets in it.
+class OggReader
+{
+public:
+    bool Open(const std::filesystem::path& path) { return file.Open(path); }
+    FileReader& GetFile() { return file; }
+
+    // The page at the current position, or the next valid one of the stream after it
+    bool NextPage(OggPage& out)
+    {
+        for (;;) {
+            const uint64_t offset = file.Tell();
+            if (!ReadPageAt(offset, out)) {
+                if (!FindPage(offset + 1)) {
+                    return false;
+                }
+                continue;
+            }
+            if (!hasSerial) {
+                serial = out.serial;
+                hasSerial = true;
+            }
+            if (out.serial == serial) {
+                return true;
+            }
+        }
+    }
+
+    // Moves to the first "OggS" at or after 'from'
+    bool FindPage(uint64_t from)
+    {
+        file.Seek(from);
+        uint32_t window = 0;
+        uint8_t byte;
+        for (uint64_t position = from; file.ReadByte(byte); position++) {
+            window = (window << 8) | byte;
+            if (window == 0x4F676753 && position >= from + 3) {
+                file.Seek(position - 3);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Packets from the page at 'offset'; a packet continued from the page before it is dropped
+    void SeekPage(uint64_t offset)
+    {
+        file.Seek(offset);
+        page.lacing.clear();
+        segment = 0;
+        bodyPosition = 0;
+    }
+
+    // The next complete packet. 'granule' is the page granule for the last packet completed on a page, -1 for the others.
+    bool NextPacket(std::vector<uint8_t>& packet, int64_t& granule, bool& lastPage)
+    {
+        packet.clear();
+        bool started = false;
+        for (;;) {
+            if (segment == page.lacing.size()) {
+                if (!NextPage(page)) {
+                    return false;
+                }
+                segment = 0;
+                bodyPosition = 0;
+                if (!started && (page.flags & 1)) {
+                    // The start of this packet is on a page we did not read
+                    while (segment < page.lacing.size()) {
+                        bodyPosition += page.lacing[segment];
+                        if (page.lacing[segment++] < 255) {
+                            break;
+                        }
+                    }
+                    continue;
+                }
+                if (started && !(page.flags & 1)) {
+                    packet.clear();         // A page was lost in the middle of the packet
+                }
+            }
+            const uint8_t size = page.lacing[segment++];
+            packet.insert(packet.end(), page.body.begin() + bodyPosition, page.body.begin() + bodyPosition + size);
+            bodyPosition += size;
+            started = true;
+            if (size < 255) {
+                bool last = std::none_of(page.lacing.begin() + segment, page.lacing.end(), [](uint8_t s) { return s < 255; });
+                granule = last ? page.granule : -1;
+                lastPage = last && (page.flags & 4);
+                return true;
+            }
+        }
+    }
+
+    bool ReadPageAt(uint64_t offset, OggPage& out)
+    {
+        uint8_t header[27];
+        file.Seek(offset);
+        if (file.Read(header, 27) != 27 || memcmp(header, "OggS", 4) != 0 || header[4] != 0) {
+            return false;
+        }
+        out.offset = offset;
+        out.flags = header[5];
+        int64_t granule = 0;
+        for (int i = 7; i >= 0; i--) {
+            granule = (granule << 8) | header[6 + i];
+        }
+        out.granule = granule;
+        out.serial = (uint32_t)header[14] | ((uint32_t)header[15] << 8) | ((uint32_t)header[16] << 16) | ((uint32_t)header[17] << 24);
+        const uint32_t crc = (uint32_t)header[22] | ((uint32_t)header[23] << 8) | ((uint32_t)header[24] << 16) | ((uint32_t)header[25] << 24);
+        out.lacing.resize(header[26]);
+        if (file.Read(out.lacing.data(), out.lacing.size()) != out.lacing.size()) {
+            return false;
+        }
+        size_t bodySize = 0;
+        for (uint8_t size : out.lacing) {
+            bodySize += size;
+        }
+        out.body.resize(bodySize);
+        if (file.Read(out.body.data(), bodySize) != bodySize) {
+            return false;
+        }
+        memset(header + 22, 0, 4);
+        uint32_t check = OggCrc(header, 27, 0);
+        check = OggCrc(out.lacing.data(), out.lacing.size(), check);
+        check = OggCrc(out.body.data(), out.body.size(), check);
+        return check == crc;
+    }
+
+    uint32_t GetSerial() const { return serial; }
+
+private:
+    FileReader file;
+    OggPage page;
+    size_t segment = 0;
+    size_t bodyPosition = 0;
+    uint32_t serial = 0;
+    bool hasSerial = false;
+};
+
+// LSB-first reader over one packet. The packet is followed by 8 zero bytes of padding, so reads past its end return zeros; End()
+// tells when they were consumed.
+class VorbisBits
+{
+public:
+    VorbisBits(const uint8_t* data, size_t size) : data(data), size(size) {}
+
+    uint32_t Peek(int n) const
+    {
+        if ((position >> 3) >= size) {
+            return 0;
+        }
+        uint64_t value;
+        memcpy(&value, data + (position >> 3), sizeof(value));
+        return (uint32_t)((value >> (position & 7)) & ((1ull << n) - 1));
+    }
+
+    void Skip(int n) { position += n; }
+
+    uint32_t Read(int n)
+    {
+        if (n == 0) {
+            return 0;
+        }
+        const uint32_t value = Peek(n);
+        position += n;
+        return value;
+    }
+
+    bool End() const { return position > size * 8; }
+
+private:
+    const uint8_t* data;
+    size_t size;
+    size_t position = 0;
+};
+
+static uint32_t BitReverse(uint32_t n)
+{
+    n = ((n & 0xAAAAAAAAu) >> 1) | ((n & 0x55555555u) << 1);
+    n = ((n & 0xCCCCCCCCu) >> 2) | ((n & 0x33333333u) << 2);
+    n = ((n & 0xF0F0F0F0u) >> 4) | ((n & 0x0F0F0F0Fu) << 4);
+    n = ((n & 0xFF00FF00u) >> 8) | ((n & 0x00FF00FFu) << 8);
+    return (n >> 16) | (n << 16);
+}
+
+static float Float32Unpack(uint32_t x)
+{
+    double mantissa = x & 0x1FFFFF;
+    if (x & 0x80000000u) {
+        mantissa = -mantissa;
+    }
+    return (float)std::ldexp(mantissa, (int)((x >> 21) & 0x3FF) - 788);
+}
+
+// Largest r with r^dimensions <= entries
+static int Lookup1Values(int entries, int dimensions)
+{
+    int r = (int)std::floor(std::exp(std::log((double)entries) / dimensions));
+    while (std::pow(r + 1.0, dimensions) <= entries) {
+        r++;
+    }
+    while (r > 0 && std::pow((double)r, dimensions) > entries) {
+        r--;
+    }
+    return r;
+}
+
+struct VorbisCodebook
+{
+    static constexpr int fastBits = 10;
+
+    int dimensions = 0;
+    int entries = 0;
+    std::vector<uint8_t> lengths;           // Codeword length per entry, 0: unused
+    std::vector<int32_t> fast;              // Entry whose codeword starts the next fastBits bits, -1: a longer codeword
+    std::vector<uint32_t> codes;            // The longer codewords, bit-reversed (first bit in the MSB) and sorted
+    std::vector<int32_t> codeEntries;
+    std::vector<float> vectors;             // entries * dimensions values of the VQ lookup, empty for scalar books
+
+    // Assigns the codewords in entry order, shortest available first (the specification's tree building)
+    bool BuildCodewords()
+    {
+        uint32_t available[33] = {};
+        std::vector<std::pair<uint32_t, int32_t>> longCodes;
+        fast.assign(1 << fastBits, -1);
+        bool first = true;
+        for (int e = 0; e < entries; e++) {
+            const int length = lengths[e];
+            if (length == 0) {
+                continue;
+            }
+            uint32_t code = 0;
+            if (first) {
+                for (int i = 1; i <= length; i++) {
+                    available[i] = 1u << (32 - i);
+                }
+                first = false;
+            }
+            else {
+                int z = length;
+                while (z > 0 && !available[z]) {
+                    z--;
+                }
+                if (z == 0) {
+                    return false;       // Overspecified tree
+                }
+                code = available[z];
+                available[z] = 0;
+                for (int y = length; y > z; y--) {
+                    available[y] = code + (1u << (32 - y));
+                }
+            }
+
+            if (length <= fastBits) {
+                for (uint32_t x = BitReverse(code); x < (1u << fastBits); x += 1u << length) {
+                    fast[x] = e;
+                }
+            }
+            else {
+                longCodes.emplace_back(code, e);
+            }
+        }
+        std::sort(longCodes.begin(), longCodes.end());
+        for (const auto& [code, entry] : longCodes) {
+            codes.push_back(code);
+            codeEntries.push_back(entry);
+        }
+        return true;
+    }
+
+    // The next entry in the packet, -1 at the end of the packet or for an undefined codeword
+    int Decode(VorbisBits& bits) const
+    {
+        int entry = fast[bits.Peek(fastBits)];
+        if (entry < 0) {
+            // Prefix-free codes: the match is the largest codeword not above the next 32 bits
+            const uint32_t next = BitReverse(bits.Peek(32));
+            auto it = std::upper_bound(codes.begin(), codes.end(), next);
+            if (it == codes.begin()) {
+                return -1;
+            }
+            const size_t i = it - codes.begin() - 1;
+            entry = codeEntries[i];
+            if (((next ^ codes[i]) >> (32 - lengths[entry])) != 0) {
+                return -1;
+            }
+        }
+        bits.Skip(lengths[entry]);
+        return bits.End() ? -1 : entry;
+    }
+};
+
+struct VorbisFloor
+{
+    std::vector<int> partitionClasses;
+    int classDimensions[16] = {};
+    int classSubclasses[16] = {};
+    int classMasterbook[16] = {};
+    int subclassBooks[16][8] = {};
+    int multiplier = 1;
+    std::vector<int> x;                     // X list, [0] = 0 and [1] = 1 << rangebits
+    std::vector<int> sorted;                // Indices of x in ascending order
+    std::vector<int> low;                   // Neighbors of every point among the points before it
+    std::vector<int> high;
+};
+
+struct VorbisResidue
+{
+    int type = 0;
+    int begin = 0;
+    int end = 0;
+    int partitionSize = 0;
+    int classifications = 0;
+    int classbook = 0;
+    std::vector<std::array<int, 8>> books;  // Per classification and pass, -1: nothing coded
+};
+
+struct VorbisMapping
+{
+    std::vector<int> magnitude;
+    std::vector<int> angle;
+    std::vector<int> mux;                   // Submap per channel
+    std::vector<int> submapFloor;
+    std::vector<int> submapResidue;
+};
+
+struct VorbisMode
+{
+    bool longBlock = false;
+    int mapping = 0;
+};
+
+// floor1_inverse_dB_table: 1.0649863e-07 (-140 dB) to 1.0 in 255 equal steps of 0.55 dB
+static const std::array<float, 256>& InverseDbTable()
+{
+    static const auto table = []() {
+        std::array<float, 256> t{};
+        for (int i = 0; i < 256; i++) {
+            t[i] = (float)(1.0649863e-07 * std::exp(std::log(1.0 / 1.0649863e-07) * i / 255.0));
+        }
+        t[255] = 1.0f;
+        return t;
+    }();
+    return table;
+}
+
+static int RenderPoint(int x0, int y0, int x1, int y1, int x)
+{
+    const int dy = y1 - y0;
+    const int offset = std::abs(dy) * (x - x0) / (x1 - x0);
+    return dy < 0 ? y0 - offset : y0 + offset;
+}
+
+static void RenderLine(int x0, int y0, int x1, int y1, float* out, int n)
+{
+    const auto& table = InverseDbTable();
+    const int dy = y1 - y0;
+    const int adx = x1 - x0;
+    if (adx <= 0) {
+        return;
+    }
+    const int base = dy / adx;
+    const int sy = dy < 0 ? base - 1 : base + 1;
+    const int ady = std::abs(dy) - std::abs(base) * adx;
+    int y = y0;
+    int err = 0;
+    if (x0 < n) {
+        out[x0] = table[std::clamp(y, 0, 255)];
+    }
+    for (int x = x0 + 1; x < x1 && x < n; x++) {
+        err += ady;
+        if (err >= adx) {
+            err -= adx;
+            y += sy;
+        }
+        else {
+            y += base;
+        }
+        out[x] = table[std::clamp(y, 0, 255)];
+    }
+}
+
+// Inverse MDCT of one block size, y[n] = sum X[k] cos(2pi/N (n + 1/2 + N/4)(k + 1/2)) without normalization (the encoder's
+// forward transform carries the scale). Computed as a DCT-IV of the N/2 coefficients through an N/4-point complex FFT, then
+// unfolded with the DCT-IV symmetries.
+class VorbisMdct
+{
+public:
+    void Init(int n)
+    {
+        size = n;
+        const int m = n / 2;
+        const int l = n / 4;
+        preCos.resize(l);
+        preSin.resize(l);
+        postCos.resize(l);
+        postSin.resize(l);
+        for (int i = 0; i < l; i++) {
+            const double pre = pi * (4.0 * i + 1.0) / (4.0 * m);
+            const double post = pi * (double)i / m;
+            preCos[i] = (float)std::cos(pre);
+            preSin[i] = (float)std::sin(pre);
+            postCos[i] = (float)std::cos(post);
+            postSin[i] = (float)std::sin(post);
+        }
+        twiddleCos.resize(l / 2);
+        twiddleSin.resize(l / 2);
+        for (int i = 0; i < l / 2; i++) {
+            twiddleCos[i] = (float)std::cos(2.0 * pi * i / l);
+            twiddleSin[i] = (float)std::sin(2.0 * pi * i / l);
+        }
+        reversed.resize(l);
+        const int bits = ILog((uint32_t)l) - 1;
+        for (int i = 0; i < l; i++) {
+            reversed[i] = (int)(BitReverse((uint32_t)i) >> (32 - bits));
+        }
+        re.resize(l);
+        im.resize(l);
+        dct.resize(m);
+    }
+
+    void Inverse(const float* coefficients, float* out)
+    {
+        const int m = size / 2;
+        const int l = size / 4;
+
+        // Pairs (X[2i], X[m-1-2i]) as complex numbers, rotated by -pi(4i+1)/4m, in bit-reversed order for the FFT
+        for (int i = 0; i < l; i++) {
+            const float a = coefficients[2 * i];
+            const float b = coefficients[m - 1 - 2 * i];
+            re[reversed[i]] = a * preCos[i] + b * preSin[i];
+            im[reversed[i]] = b * preCos[i] - a * preSin[i];
+        }
+        for (int span = 2; span <= l; span <<= 1) {
+            const int half = span / 2;
+            const int step = l / span;
+            for (int start = 0; start < l; start += span) {
+                for (int k = 0; k < half; k++) {
+                    const float wr = twiddleCos[k * step];
+                    const float wi = -twiddleSin[k * step];
+                    const int a = start + k;
+                    const int b = a + half;
+                    const float tr = re[b] * wr - im[b] * wi;
+                    const float ti = re[b] * wi + im[b] * wr;
+                    re[b] = re[a] - tr;
+                    im[b] = im[a] - ti;
+                    re[a] += tr;
+                    im[a] += ti;
+                }
+            }
+        }
+        for (int k = 0; k < l; k++) {
+            const float r = re[k] * postCos[k] + im[k] * postSin[k];
+            const float i = im[k] * postCos[k] - re[k] * postSin[k];
+            dct[2 * k] = r;
+            dct[m - 1 - 2 * k] = -i;
+        }
+
+        // y[n] = z[n + m/2], with z[2m-1-j] = -z[j] and z[j+2m] = -z[j]
+        for (int n = 0; n < m / 2; n++) {
+            out[n] = dct[n + m / 2];
+        }
+        for (int n = m / 2; n < 3 * m / 2; n++) {
+            out[n] = -dct[3 * m / 2 - 1 - n];
+        }
+        for (int n = 3 * m / 2; n < size; n++) {
+            out[n] = -dct[n - 3 * m / 2];
+        }
+    }
+
+    size_t GetMemoryBytes() const { return (preCos.size() * 4 + twiddleCos.size() * 2 + re.size() * 2 + dct.size()) * sizeof(float); }
+
+private:
+    int size = 0;
+    std::vector<float> preCos, preSin, postCos, postSin;
+    std::vector<float> twiddleCos, twiddleSin;
+    std::vector<int> reversed;
+    std::vector<float> re, im, dct;
+};
+
+class VorbisDecoder : public AudioDecoder
+{
+public:
+    bool Open(const std::filesystem::path& path)
+    {
+        if (!ogg.Open(path) || !ReadHeaders()) {
+            return false;
+        }
+        firstAudio = ogg.GetFile().Tell();
+        const int64_t last = FindLastGranule(ogg, ogg.GetSerial());
+        if (last <= 0) {
+            return false;
+        }
+        frames = (uint64_t)last;
+        FillInfo();
+
+        const int channels = info.channels;
+        residue.assign(channels, std::vector<float>(blockSizes[1] / 2));
+        block.assign(channels, std::vector<float>(blockSizes[1]));
+        previous.assign(channels, std::vector<float>(blockSizes[1] / 2));
+        floorY.assign(channels, std::vector<int>(65));
+        curve.resize(blockSizes[1] / 2);
+        for (int i = 0; i < 2; i++) {
+            mdct[i].Init(blockSizes[i]);
+            slope[i].resize(blockSizes[i] / 2);
+            for (int j = 0; j < blockSizes[i] / 2; j++) {
+                const double s = std::sin((j + 0.5) / (blockSizes[i] / 2) * pi / 2);
+                slope[i][j] = (float)std::sin(pi / 2 * s * s);
+            }
+        }
+        Restart(-1);
+        return true;
+    }
+
+    size_t Read(float* out, size_t count) override
+    {
+        const int channels = info.channels;
+        size_t done = 0;
+        while (done < count) {
+            const size_t available = pending.size() / channels - pendingRead;
+            if (!positionKnown || available == 0) {
+                if (ended || !DecodeNext()) {
+                    ended = true;
+                    break;
+                }
+                continue;
+            }
+            const size_t n = std::min(count - done, available);
+            memcpy(out + done * channels, &pending[pendingRead * channels], n * channels * sizeof(float));
+            pendingRead += n;
+            done += n;
+        }
+        return done;
+    }
+
+    bool Seek(uint64_t frame) override
+    {
+        frame = std::min(frame, frames);
+        const int channels = info.channels;
+        if (positionKnown) {
+            const int64_t start = pendingEnd - (int64_t)(pending.size() / channels);
+            if ((int64_t)frame >= start && (int64_t)frame < pendingEnd) {
+                pendingRead = (size_t)((int64_t)frame - start);        // Already decoded
+                return true;
+            }
+        }
+
+        // From a page two long blocks before the target: the packet after it primes the overlap, and the one after that is output
+        // from a position at or before the target. The position is only known at the next page granule.
+        int64_t goal = (int64_t)frame - 2 * blockSizes[1];
+        for (;;) {
+            Restart(goal);
+            while (!unresolved && !(positionKnown && pendingEnd > (int64_t)frame) && DecodeNext()) {
+            }
+            const int64_t start = pendingEnd - (int64_t)(pending.size() / channels);
+            if (goal > 0 && (unresolved || (positionKnown && start > (int64_t)frame))) {
+                goal = std::max<int64_t>(goal - 4 * blockSizes[1], 0);      // The last page, or a late start: from further back
+                continue;
+            }
+            if (!positionKnown) {
+                ended = true;
+                return frame == frames;
+            }
+            pendingRead = (size_t)std::clamp<int64_t>((int64_t)frame - start, 0, (int64_t)(pending.size() / channels));
+            return true;
+        }
+    }
+
+    size_t GetMemoryBytes() const override
+    {
+        size_t bytes = 64 * 1024 + pending.capacity() * sizeof(float) + curve.capacity() * sizeof(float);
+        for (const VorbisCodebook& book : codebooks) {
+            bytes += book.lengths.capacity() + book.fast.capacity() * sizeof(int32_t) + book.codes.capacity() * sizeof(uint32_t) * 2
+                + book.vectors.capacity() * sizeof(float);
+        }
+        for (int c = 0; c < info.channels; c++) {
+            bytes += (residue[c].capacity() + block[c].capacity() + previous[c].capacity()) * sizeof(float);
+        }
+        return bytes + mdct[0].GetMemoryBytes() + mdct[1].GetMemoryBytes();
+    }
+
+    // Granule of the last page of the stream: its length in frames
+    static int64_t FindLastGranule(OggReader& ogg, uint32_t serial)
+    {
+        FileReader& file = ogg.GetFile();
+        const uint64_t size = file.GetSize();
+        std::vector<uint8_t> tail;
+        for (uint64_t window = 64 * 1024; ; window *= 4) {
+            const uint64_t start = size > window ? size - window : 0;
+            tail.resize((size_t)(size - start));
+            file.Seek(start);
+            file.Read(tail.data(), tail.size());
+            for (size_t i = tail.size() >= 27 ? tail.size() - 26 : 0; i-- > 0; ) {
+                if (memcmp(&tail[i], "OggS", 4) != 0) {
+                    continue;
+                }
+                OggPage page;
+                if (ogg.ReadPageAt(start + i, page) && page.serial == serial && page.granule >= 0) {
+                    return page.granule;
+                }
+            }
+            if (start == 0) {
+                return -1;
+            }
+        }
+    }
+
+private:
+    void FillInfo()
+    {
+        info.formatTag = formatTagVorbis;
+        info.bitsPerSample = 16;
+        info.blockAlign = (uint16_t)(info.channels * 2);
+        info.dataOffset = 0;
+        info.dataBytes = (uint32_t)std::min<uint64_t>(frames * info.blockAlign, UINT32_MAX);
+    }
+
+    // The next packet, if it is the header 'type'; the packet is left padded, its fields start at packet[7]
+    bool NextHeader(int type)
+    {
+        int64_t granule;
+        bool last;
+        if (!ogg.NextPacket(packet, granule, last) || packet.size() < 7 || packet[0] != type || memcmp(&packet[1], "vorbis", 6) != 0) {
+            return false;
+        }
+        packetSize = packet.size();
+        packet.resize(packetSize + 8, 0);
+        return true;
+    }
+
+    bool ReadHeaders()
+    {
+        if (!NextHeader(1)) {
+            return false;
+        }
+        VorbisBits identification(packet.data() + 7, packetSize - 7);
+        if (identification.Read(32) != 0) {
+            return false;
+        }
+        info.channels = (uint16_t)identification.Read(8);
+        info.sampleRate = identification.Read(32);
+        identification.Read(32);
+        identification.Read(32);
+        identification.Read(32);
+        blockSizes[0] = 1 << identification.Read(4);
+        blockSizes[1] = 1 << identification.Read(4);
+        if (info.channels == 0 || info.sampleRate == 0 || blockSizes[0] < 64 || blockSizes[1] > 8192 || blockSizes[0] > blockSizes[1]
+            || !identification.Read(1) || identification.End()) {
+            return false;
+        }
+        if (!NextHeader(3) || !NextHeader(5)) {
+            return false;
+        }
+        VorbisBits setup(packet.data() + 7, packetSize - 7);
+        return ReadSetup(setup);
+    }
+
+    bool ReadSetup(VorbisBits& bits)
+    {
+        codebooks.resize(bits.Read(8) + 1);
+        for (VorbisCodebook& book : codebooks) {
+            if (bits.Read(24) != 0x564342) {
+                return false;
+            }
+            book.dimensions = (int)bits.Read(16);
+            book.entries = (int)bits.Read(24);
+            if (book.dimensions == 0 && book.entries > 0) {
+                return false;
+            }
+            book.lengths.assign(book.entries, 0);
+            if (!bits.Read(1)) {
+                const bool sparse = bits.Read(1) != 0;
+                for (int e = 0; e < book.entries; e++) {
+                    if (!sparse || bits.Read(1)) {
+                        book.lengths[e] = (uint8_t)(bits.Read(5) + 1);
+                    }
+                }
+            }
+            else {
+                int length = (int)bits.Read(5) + 1;
+                for (int e = 0; e < book.entries; length++) {
+                    const int count = (int)bits.Read(ILog((uint32_t)(book.entries - e)));
+                    if (length > 32 || e + count > book.entries) {
+                        return false;
+                    }
+                    std::fill(book.lengths.begin() + e, book.lengths.begin() + e + count, (uint8_t)length);
+                    e += count;
+                }
+            }
+            if (bits.End() || !book.BuildCodewords()) {
+                return false;
+            }
+
+            const int lookup = (int)bits.Read(4);
+            if (lookup == 1 || lookup == 2) {
+                const float minimum = Float32Unpack(bits.Read(32));
+                const float delta = Float32Unpack(bits.Read(32));
+                const int valueBits = (int)bits.Read(4) + 1;
+                const bool sequence = bits.Read(1) != 0;
+                const int64_t values = lookup == 1 ? Lookup1Values(book.entries, book.dimensions) : (int64_t)book.entries * book.dimensions;
+                if (values <= 0 || (int64_t)book.entries * book.dimensions > (1 << 24)) {
+                    return false;
+                }
+                std::vector<uint32_t> multiplicands((size_t)values);
+                for (uint32_t& value : multiplicands) {
+                    value = bits.Read(valueBits);
+                }
+                book.vectors.resize((size_t)book.entries * book.dimensions);
+                for (int e = 0; e < book.entries; e++) {
+                    float last = 0.0f;
+                    int64_t divisor = 1;
+                    for (int d = 0; d < book.dimensions; d++) {
+                        const size_t offset = lookup == 1 ? (size_t)((e / divisor) % values) : (size_t)e * book.dimensions + d;
+                        const float value = multiplicands[offset] * delta + minimum + last;
+                        book.vectors[(size_t)e * book.dimensions + d] = value;
+                        if (sequence) {
+                            last = value;
+                        }
+                        divisor = std::min<int64_t>(divisor * values, INT32_MAX);
+                    }
+                }
+            }
+            else if (lookup != 0) {
+                return false;
+            }
+        }
+        auto validBook = [&](int book) { return book >= 0 && book < (int)codebooks.size(); };
+
+        // Time domain transforms: placeholders
+        for (int i = (int)bits.Read(6) + 1; i > 0; i--) {
+            if (bits.Read(16) != 0) {
+                return false;
+            }
+        }
+
+        floors.resize(bits.Read(6) + 1);
+        for (VorbisFloor& floor : floors) {
+            if (bits.Read(16) != 1) {
+                return false;       // Floor 0
+            }
+            floor.partitionClasses.resize(bits.Read(5));
+            int classes = 0;
+            for (int& c : floor.partitionClasses) {
+                c = (int)bits.Read(4);
+                classes = std::max(classes, c + 1);
+            }
+            for (int c = 0; c < classes; c++) {
+                floor.classDimensions[c] = (int)bits.Read(3) + 1;
+                floor.classSubclasses[c] = (int)bits.Read(2);
+                if (floor.classSubclasses[c]) {
+                    floor.classMasterbook[c] = (int)bits.Read(8);
+                    if (!validBook(floor.classMasterbook[c])) {
+                        return false;
+                    }
+                }
+                for (int j = 0; j < (1 << floor.classSubclasses[c]); j++) {
+                    floor.subclassBooks[c][j] = (int)bits.Read(8) - 1;
+                    if (floor.subclassBooks[c][j] >= (int)codebooks.size()) {
+                        return false;
+                    }
+                }
+            }
+            floor.multiplier = (int)bits.Read(2) + 1;
+            const int rangeBits = (int)bits.Read(4);
+            floor.x = { 0, 1 << rangeBits };
+            for (int c : floor.partitionClasses) {
+                for (int j = 0; j < floor.classDimensions[c]; j++) {
+                    floor.x.push_back((int)bits.Read(rangeBits));
+                }
+            }
+            if (floor.x.size() > 65) {
+                return false;
+            }
+            floor.sorted.resize(floor.x.size());
+            for (size_t i = 0; i < floor.x.size(); i++) {
+                floor.sorted[i] = (int)i;
+            }
+            std::stable_sort(floor.sorted.begin(), floor.sorted.end(), [&](int a, int b) { return floor.x[a] < floor.x[b]; });
+            floor.low.assign(floor.x.size(), 0);
+            floor.high.assign(floor.x.size(), 1);
+            for (size_t i = 2; i < floor.x.size(); i++) {
+                for (size_t j = 0; j < i; j++) {
+                    if (floor.x[j] < floor.x[i] && floor.x[j] > floor.x[floor.low[i]]) {
+                        floor.low[i] = (int)j;
+                    }
+                    if (floor.x[j] > floor.x[i] && floor.x[j] < floor.x[floor.high[i]]) {
+                        floor.high[i] = (int)j;
+                    }
+                }
+            }
+        }
+
+        residues.resize(bits.Read(6) + 1);
+        for (VorbisResidue& r : residues) {
+            r.type = (int)bits.Read(16);
+            r.begin = (int)bits.Read(24);
+            r.end = (int)bits.Read(24);
+            r.partitionSize = (int)bits.Read(24) + 1;
+            r.classifications = (int)bits.Read(6) + 1;
+            r.classbook = (int)bits.Read(8);
+            if (r.type > 2 || !validBook(r.classbook) || codebooks[r.classbook].dimensions == 0) {
+                return false;
+            }
+            std::vector<int> cascade(r.classifications);
+            for (int& c : cascade) {
+                c = (int)bits.Read(3);
+                if (bits.Read(1)) {
+                    c |= (int)bits.Read(5) << 3;
+                }
+            }
+            r.books.resize(r.classifications);
+            for (int c = 0; c < r.classifications; c++) {
+                for (int pass = 0; pass < 8; pass++) {
+                    r.books[c][pass] = (cascade[c] >> pass) & 1 ? (int)bits.Read(8) : -1;
+                    if (r.books[c][pass] >= 0 && (!validBook(r.books[c][pass]) || codebooks[r.books[c][pass]].vectors.empty())) {
+                        return false;
+                    }
+                }
+            }
+        }
+
+        const int channels = info.channels;
+        mappings.resize(bits.Read(6) + 1);
+        for (VorbisMapping& mapping : mappings) {
+            if (bits.Read(16) != 0) {
+                return false;
+            }
+            const int submaps = bits.Read(1) ? (int)bits.Read(4) + 1 : 1;
+            if (bits.Read(1)) {
+                const int steps = (int)bits.Read(8) + 1;
+                const int channelBits = ILog((uint32_t)channels - 1);
+                for (int i = 0; i < steps; i++) {
+                    mapping.magnitude.push_back((int)bits.Read(channelBits));
+                    mapping.angle.push_back((int)bits.Read(channelBits));
+                    if (mapping.magnitude.back() == mapping.angle.back() || mapping.magnitude.back() >= channels
+                        || mapping.angle.back() >= channels) {
+                        return false;
+                    }
+                }
+            }
+            if (bits.Read(2) != 0) {
+                return false;
+            }
+            mapping.mux.assign(channels, 0);
+            if (submaps > 1) {
+                for (int& mux : mapping.mux) {
+                    mux = (int)bits.Read(4);
+                    if (mux >= submaps) {
+                        return false;
+                    }
+                }
+            }
+            for (int s = 0; s < submaps; s++) {
+                bits.Read(8);
+                mapping.submapFloor.push_back((int)bits.Read(8));
+                mapping.submapResidue.push_back((int)bits.Read(8));
+                if (mapping.submapFloor.back() >= (int)floors.size() || mapping.submapResidue.back() >= (int)residues.size()) {
+                    return false;
+                }
+            }
+        }
+
+        modes.resize(bits.Read(6) + 1);
+        for (VorbisMode& mode : modes) {
+            mode.longBlock = bits.Read(1) != 0;
+            bits.Read(16);
+            bits.Read(16);
+            mode.mapping = (int)bits.Read(8);
+            if (mode.mapping >= (int)mappings.size()) {
+                return false;
+            }
+        }
+        return bits.Read(1) == 1 && !bits.End();
+    }
+
+    // Resets decoding to the start of the stream (goal < 0) or to the page after the last one whose granule is at most 'goal'
+    void Restart(int64_t goal)
+    {
+        ogg.SeekPage(goal <= 0 ? firstAudio : FindPageAfter(goal));
+        atStart = goal <= 0;
+        pending.clear();
+        pendingRead = 0;
+        pendingEnd = 0;
+        positionKnown = false;
+        previousSize = 0;
+        ended = false;
+        unresolved = false;
+    }
+
+    // Bisects the file on page granules
+    uint64_t FindPageAfter(int64_t goal)
+    {
+        FileReader& file = ogg.GetFile();
+        uint64_t low = firstAudio;
+        uint64_t high = file.GetSize();
+        uint64_t best = firstAudio;
+        OggPage page;
+        while (high - low > 4096) {
+            const uint64_t middle = low + (high - low) / 2;
+            bool found = false;
+            if (ogg.FindPage(middle)) {
+                while (ogg.NextPage(page) && page.offset < high) {
+                    if (page.granule >= 0) {
+                        found = true;
+                        break;
+                    }
+                }
+            }
+            if (found && page.granule <= goal) {
+                best = file.Tell();
+                low = best;
+            }
+            else {
+                high = middle;
+            }
+        }
+        return best;
+    }
+
+    // Decodes the next packet into 'pending' and applies its page granule, if any. False at the end of the stream.
+    bool DecodeNext()
+    {
+        const int channels = info.channels;
+        if (pendingRead > 0 && pendingRead * channels == pending.size()) {
+            pending.clear();
+            pendingRead = 0;
+        }
+        int64_t granule;
+        bool last;
+        if (!ogg.NextPacket(packet, granule, last)) {
+            return false;
+        }
+        packetSize = packet.size();
+        packet.resize(packetSize + 8, 0);
+        const int produced = DecodeAudio();
+        pendingEnd += produced;
+        if (granule < 0) {
+            return true;
+        }
+
+        const int64_t decoded = (int64_t)(pending.size() / channels);
+        if (!positionKnown && !atStart) {
+            if (last) {
+                unresolved = true;      // A shortened last packet can't be placed from its end
+                return true;
+            }
+            pendingEnd = granule;
+            positionKnown = true;
+            return true;
+        }
+        if (granule < pendingEnd) {
+            const int64_t excess = std::min(pendingEnd - granule, decoded - (int64_t)pendingRead);
+            if (last) {
+                pending.resize(pending.size() - (size_t)excess * channels);        // End trim
+            }
+            else if (atStart) {
+                pendingRead += (size_t)excess;                                      // Start trim
+            }
+            pendingEnd = granule;
+        }
+        positionKnown = true;
+        atStart = false;
+        return true;
+    }
+
+    // One audio packet: returns the frames added to 'pending' (none for the first packet, which only fills the overlap)
+    int DecodeAudio()
+    {
+        VorbisBits bits(packet.data(), packetSize);
+        if (packetSize == 0 || bits.Read(1) != 0) {
+            return 0;
+        }
+        const uint32_t modeIndex = bits.Read(ILog((uint32_t)modes.size() - 1));
+        if (modeIndex >= modes.size()) {
+            return 0;
+        }
+        const VorbisMode& mode = modes[modeIndex];
+        const int n = blockSizes[mode.longBlock];
+        const int n2 = n / 2;
+        bool previousLong = false;
+        bool nextLong = false;
+        if (mode.longBlock) {
+            previousLong = bits.Read(1) != 0;
+            nextLong = bits.Read(1) != 0;
+        }
+        if (bits.End()) {
+            return 0;
+        }
+        const VorbisMapping& mapping = mappings[mode.mapping];
+        const int channels = info.channels;
+
+        bool used[256];
+        bool skip[256];
+        for (int c = 0; c < channels; c++) {
+            const VorbisFloor& floor = floors[mapping.submapFloor[mapping.mux[c]]];
+            used[c] = DecodeFloor(bits, floor, floorY[c].data());
+            skip[c] = !used[c];
+            std::fill(residue[c].begin(), residue[c].begin() + n2, 0.0f);
+        }
+        for (size_t i = 0; i < mapping.magnitude.size(); i++) {
+            if (used[mapping.magnitude[i]] || used[mapping.angle[i]]) {
+                skip[mapping.magnitude[i]] = skip[mapping.angle[i]] = false;
+            }
+        }
+        for (size_t s = 0; s < mapping.submapResidue.size(); s++) {
+            float* vectors[256];
+            bool submapSkip[256];
+            int count = 0;
+            for (int c = 0; c < channels; c++) {
+                if (mapping.mux[c] == (int)s) {
+                    vectors[count] = residue[c].data();
+                    submapSkip[count++] = skip[c];
+                }
+            }
+            DecodeResidue(bits, residues[mapping.submapResidue[s]], n2, vectors, submapSkip, count);
+        }
+
+        for (size_t i = mapping.magnitude.size(); i-- > 0; ) {
+            float* magnitude = residue[mapping.magnitude[i]].data();
+            float* angle = residue[mapping.angle[i]].data();
+            for (int k = 0; k < n2; k++) {
+                const float m = magnitude[k];
+                const float a = angle[k];
+                if (m > 0) {
+                    if (a > 0) {
+                        angle[k] = m - a;
+                    }
+                    else {
+                        angle[k] = m;
+                        magnitude[k] = m + a;
+                    }
+                }
+                else {
+                    if (a > 0) {
+                        angle[k] = m + a;
+                    }
+                    else {
+                        angle[k] = m;
+                        magnitude[k] = m - a;
+                    }
+                }
+            }
+        }
+
+        // Floor curve times residue, then back to the time domain
+        const int leftSize = mode.longBlock && previousLong ? n2 : blockSizes[0] / 2;
+        const int rightSize = mode.longBlock && nextLong ? n2 : blockSizes[0] / 2;
+        const float* leftSlope = slope[leftSize == blockSizes[1] / 2].data();
+        const float* rightSlope = slope[rightSize == blockSizes[1] / 2].data();
+        const int leftStart = n / 4 - leftSize / 2;
+        const int rightStart = 3 * n / 4 - rightSize / 2;
+        for (int c = 0; c < channels; c++) {
+            float* spectrum = residue[c].data();
+            if (used[c]) {
+                RenderFloor(floors[mapping.submapFloor[mapping.mux[c]]], floorY[c].data(), n2);
+                for (int k = 0; k < n2; k++) {
+                    spectrum[k] *= curve[k];
+                }
+            }
+            else {
+                std::fill(spectrum, spectrum + n2, 0.0f);
+            }
+            float* out = block[c].data();
+            mdct[mode.longBlock].Inverse(spectrum, out);
+            std::fill(out, out + leftStart, 0.0f);
+            for (int i = 0; i < leftSize; i++) {
+                out[leftStart + i] *= leftSlope[i];
+            }
+            for (int i = 0; i < rightSize; i++) {
+                out[rightStart + i] *= rightSlope[rightSize - 1 - i];
+            }
+            std::fill(out + rightStart + rightSize, out + n, 0.0f);
+        }
+
+        // Overlap-add: from the center of the previous block to the center of this one
+        int produced = 0;
+        if (previousSize > 0) {
+            produced = previousSize / 4 + n / 4;
+            const size_t base = pending.size();
+            pending.resize(base + (size_t)produced * channels);
+            float* out = &pending[base];
+            const int shift = n / 4 - previousSize / 4;
+            for (int c = 0; c < channels; c++) {
+                const float* left = previous[c].data();
+                const float* right = block[c].data();
+                for (int j = 0; j < produced; j++) {
+                    const int i = j + shift;
+                    out[j * channels + c] = (j < previousSize / 2 ? left[j] : 0.0f) + (i >= 0 ? right[i] : 0.0f);
+                }
+            }
+        }
+        for (int c = 0; c < channels; c++) {
+            std::copy(block[c].begin() + n2, block[c].begin() + n, previous[c].begin());
+        }
+        previousSize = n;
+        return produced;
+    }
+
+    // Floor 1 amplitudes of one channel into floorY, false when the channel is unused in this packet
+    bool DecodeFloor(VorbisBits& bits, const VorbisFloor& floor, int* y)
+    {
+        static const int ranges[4] = { 256, 128, 86, 64 };
+        if (!bits.Read(1)) {
+            return false;
+        }
+        const int rangeBits = ILog((uint32_t)ranges[floor.multiplier - 1] - 1);
+        y[0] = (int)bits.Read(rangeBits);
+        y[1] = (int)bits.Read(rangeBits);
+        int offset = 2;
+        for (int c : floor.partitionClasses) {
+            const int dimensions = floor.classDimensions[c];
+            const int subclassBits = floor.classSubclasses[c];
+            int value = 0;
+            if (subclassBits) {
+                value = codebooks[floor.classMasterbook[c]].Decode(bits);
+                if (value < 0) {
+                    return false;
+                }
+            }
+            for (int j = 0; j < dimensions; j++) {
+                const int book = floor.subclassBooks[c][value & ((1 << subclassBits) - 1)];
+                value >>= subclassBits;
+                y[offset + j] = 0;
+                if (book >= 0) {
+                    y[offset + j] = codebooks[book].Decode(bits);
+                    if (y[offset + j] < 0) {
+                        return false;
+                    }
+                }
+            }
+            offset += dimensions;
+        }
+        return !bits.End();
+    }
+
+    // Amplitude value synthesis and curve rendering into 'curve'
+    void RenderFloor(const VorbisFloor& floor, const int* y, int n2)
+    {
+        static const int ranges[4] = { 256, 128, 86, 64 };
+        const int range = ranges[floor.multiplier - 1];
+        const int count = (int)floor.x.size();
+        int finalY[65];
+        bool step2[65];
+        finalY[0] = y[0];
+        finalY[1] = y[1];
+        step2[0] = step2[1] = true;
+        for (int i = 2; i < count; i++) {
+            const int low = floor.low[i];
+            const int high = floor.high[i];
+            const int predicted = RenderPoint(floor.x[low], finalY[low], floor.x[high], finalY[high], floor.x[i]);
+            const int value = y[i];
+            const int highRoom = range - predicted;
+            const int lowRoom = predicted;
+            const int room = std::min(highRoom, lowRoom) * 2;
+            if (value) {
+                step2[low] = step2[high] = step2[i] = true;
+                if (value >= room) {
+                    finalY[i] = highRoom > lowRoom ? value - lowRoom + predicted : predicted - value + highRoom - 1;
+                }
+                else {
+                    finalY[i] = (value & 1) ? predicted - (value + 1) / 2 : predicted + value / 2;
+                }
+            }
+            else {
+                step2[i] = false;
+                finalY[i] = predicted;
+            }
+        }
+
+        int lx = 0;
+        int ly = finalY[floor.sorted[0]] * floor.multiplier;
+        for (int k = 1; k < count; k++) {
+            const int i = floor.sorted[k];
+            if (step2[i]) {
+                const int hy = finalY[i] * floor.multiplier;
+                RenderLine(lx, ly, floor.x[i], hy, curve.data(), n2);
+                lx = floor.x[i];
+                ly = hy;
+            }
+        }
+        if (lx < n2) {
+            std::fill(curve.begin() + lx, curve.begin() + n2, InverseDbTable()[std::clamp(ly, 0, 255)]);
+        }
+    }
+
+    void DecodeResidue(VorbisBits& bits, const VorbisResidue& r, int n2, float** vectors, const bool* skip, int count)
+    {
+        if (r.type != 2) {
+            DecodePartitions(bits, r, n2, vectors, skip, count, r.type);
+            return;
+        }
+        // Type 2: the channels interleaved into one vector, decoded as type 1
+        if (std::all_of(skip, skip + count, [](bool s) { return s; })) {
+            return;
+        }
+        interleaved.assign((size_t)n2 * count, 0.0f);
+        float* one = interleaved.data();
+        const bool decode = false;
+        DecodePartitions(bits, r, n2 * count, &one, &decode, 1, 1);
+        for (int i = 0; i < n2; i++) {
+            for (int c = 0; c < count; c++) {
+                vectors[c][i] = interleaved[(size_t)i * count + c];
+            }
+        }
+    }
+
+    void DecodePartitions(VorbisBits& bits, const VorbisResidue& r, int size, float** vectors, const bool* skip, int count, int format)
+    {
+        const VorbisCodebook& classbook = codebooks[r.classbook];
+        const int classwords = classbook.dimensions;
+        const int begin = std::min(r.begin, size);
+        const int end = std::min(r.end, size);
+        const int partitions = end > begin ? (end - begin) / r.partitionSize : 0;
+        const int stride = partitions + classwords;
+        classifications.assign((size_t)count * stride, 0);
+
+        for (int pass = 0; pass < 8; pass++) {
+            for (int p = 0; p < partitions; ) {
+                if (pass == 0) {
+                    for (int c = 0; c < count; c++) {
+                        if (skip[c]) {
+                            continue;
+                        }
+                        int word = classbook.Decode(bits);
+                        if (word < 0) {
+                            return;
+                        }
+                        for (int i = classwords - 1; i >= 0; i--) {
+                            classifications[(size_t)c * stride + p + i] = word % r.classifications;
+                            word /= r.classifications;
+                        }
+                    }
+                }
+                for (int i = 0; i < classwords && p < partitions; i++, p++) {
+                    for (int c = 0; c < count; c++) {
+                        if (skip[c]) {
+                            continue;
+                        }
+                        const int book = r.books[classifications[(size_t)c * stride + p]][pass];
+                        if (book < 0) {
+                            continue;
+                        }
+                        const VorbisCodebook& vq = codebooks[book];
+                        const int dimensions = vq.dimensions;
+                        float* v = vectors[c] + begin + p * r.partitionSize;
+                        if (format == 0) {
+                            const int step = r.partitionSize / dimensions;
+                            for (int j = 0; j < step; j++) {
+                                const int entry = vq.Decode(bits);
+                                if (entry < 0) {
+                                    return;
+                                }
+                                const float* values = &vq.vectors[(size_t)entry * dimensions];
+                                for (int k = 0; k < dimensions; k++) {
+                                    v[j + k * step] += values[k];
+                                }
+                            }
+                        }
+                        else {
+                            for (int j = 0; j < r.partitionSize; ) {
+                                const int entry = vq.Decode(bits);
+                                if (entry < 0) {
+                                    return;
+                                }
+                                const float* values = &vq.vectors[(size_t)entry * dimensions];
+                                for (int k = 0; k < dimensions && j < r.partitionSize; k++, j++) {
+                                    v[j] += values[k];
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    OggReader ogg;
+    std::vector<uint8_t> packet;            // The current packet, followed by 8 bytes of padding
+    size_t packetSize = 0;
+    uint64_t firstAudio = 0;                // Offset of the first audio page
+
+    int blockSizes[2] = {};
+    std::vector<VorbisCodebook> codebooks;
+    std::vector<VorbisFloor> floors;
+    std::vector<VorbisResidue> residues;
+    std::vector<VorbisMapping> mappings;
+    std::vector<VorbisMode> modes;
+    VorbisMdct mdct[2];
+    std::vector<float> slope[2];            // Rising half of the short and long window
+
+    std::vector<std::vector<float>> residue;        // Per channel: residue, then spectrum
+    std::vector<std::vector<float>> block;          // Per channel: windowed IMDCT output of the current packet
+    std::vector<std::vector<float>> previous;       // Per channel: right half of the previous packet's block
+    std::vector<std::vector<int>> floorY;
+    std::vector<float> curve;
+    std::vector<float> interleaved;
+    std::vector<int> classifications;
+    int previousSize = 0;                   // Block size of the previous packet, 0 before the first one
+
+    std::vector<float> pending;             // Decoded frames, interleaved, not read yet from pendingRead on
+    size_t pendingRead = 0;
+    int64_t pendingEnd = 0;                 // Stream position of the end of 'pending', once positionKnown
+    bool positionKnown = false;
+    bool atStart = false;                   // Decoding from the first audio packet: the first granule may trim the start
+    bool unresolved = false;                // Reached the last page before any granule after a seek
+    bool ended = false;
+};
+
+std::unique_ptr<AudioDecoder> OpenVorbisDecoder(const std::filesystem::path& path)
+{
+    auto decoder = std::make_unique<VorbisDecoder>();
+    if (!decoder->Open(path)) {
+        return nullptr;
+    }
+    return decoder;
+}
+
+bool ProbeVorbisHeader(const std::filesystem::path& path, WavInfo& info)
+{
+    OggReader ogg;
+    std::vector<uint8_t> packet;
+    int64_t granule;
+    bool last;
+    if (!ogg.Open(path) || !ogg.NextPacket(packet, granule, last) || packet.size() < 30 || packet[0] != 1
+        || memcmp(&packet[1], "vorbis", 6) != 0) {
+        return false;
+    }
+    const int64_t frames = VorbisDecoder::FindLastGranule(ogg, ogg.GetSerial());
+    info.formatTag = formatTagVorbis;
+    info.channels = packet[11];
+    info.sampleRate = (uint32_t)packet[12] | ((uint32_t)packet[13] << 8) | ((uint32_t)packet[14] << 16) | ((uint32_t)packet[15] << 24);
+    info.bitsPerSample = 16;
+    info.blockAlign = (uint16_t)(info.channels * 2);
+    info.dataOffset = 0;
+    info.dataBytes = (uint32_t)std::min<uint64_t>((uint64_t)std::max<int64_t>(frames, 0) * info.blockAlign, UINT32_MAX);
+    return info.channels > 0 && info.sampleRate > 0 && frames > 0;
+}
@@ -0,0 +1,161 @@
+#include "pch.h"
+#include "WaveformPeaks.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+// x64 always has SSE2 (the plugin only ships for x64); other targets use the scalar loops
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define WAVEFORM_SSE2 1
+#endif
+
+static void MinMax(const float* values, size_t count, float& outMin, float& outMax)
+{
+    size_t i = 0;
+    float lo = values[0], hi = values[0];
+#ifdef WAVEFORM_SSE2
+    if (count >= 8) {
+        __m128 min0 = _mm_loadu_ps(values), max0 = min0;
+        __m128 min1 = _mm_loadu_ps(values + 4), max1 = min1;
+        for (i = 8; i + 8 <= count; i += 8) {
+            __m128 a = _mm_loadu_ps(values + i);
+            __m128 b = _mm_loadu_ps(values + i + 4);
+            min0 = _mm_min_ps(min0, a);
+            max0 = _mm_max_ps(max0, a);
+            min1 = _mm_min_ps(min1, b);
+            max1 = _mm_max_ps(max1, b);
+        }
+        min0 = _mm_min_ps(min0, min1);
+        max0 = _mm_max_ps(max0, max1);
+        // Horizontal reduction of the 4 lanes
+        min0 = _mm_min_ps(min0, _mm_shuffle_ps(min0, min0, _MM_SHUFFLE(1, 0, 3, 2)));
+        max0 = _mm_max_ps(max0, _mm_shuffle_ps(max0, max0, _MM_SHUFFLE(1, 0, 3, 2)));
+        min0 = _mm_min_ps(min0, _mm_shuffle_ps(min0, min0, _MM_SHUFFLE(2, 3, 0, 1)));
+        max0 = _mm_max_ps(max0, _mm_shuffle_ps(max0, max0, _MM_SHUFFLE(2, 3, 0, 1)));
+        lo = _mm_cvtss_f32(min0);
+        hi = _mm_cvtss_f32(max0);
+    }
+#endif
+    for (; i < count; i++) {
+        lo = std::min(lo, values[i]);
+        hi = std::max(hi, values[i]);
+    }
+    outMin = lo;
+    outMax = hi;
+}
+
+// Next level: the min of each pair of mins, the max of each pair of maxes
+static void MergePairs(const float* srcMin, const float* srcMax, size_t srcCount, float* dstMin, float* dstMax)
+{
+    const size_t pairs = srcCount / 2;
+    size_t i = 0;
+#ifdef WAVEFORM_SSE2
+    for (; i + 4 <= pairs; i += 4) {
+        __m128 a = _mm_loadu_ps(srcMin + i * 2);
+        __m128 b = _mm_loadu_ps(srcMin + i * 2 + 4);
+        _mm_storeu_ps(dstMin + i, _mm_min_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1))));
+        a = _mm_loadu_ps(srcMax + i * 2);
+        b = _mm_loadu_ps(srcMax + i * 2 + 4);
+        _mm_storeu_ps(dstMax + i, _mm_max_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1))));
+    }
+#endif
+    for (; i < pairs; i++) {
+        dstMin[i] = std::min(srcMin[i * 2], srcMin[i * 2 + 1]);
+        dstMax[i] = std::max(srcMax[i * 2], srcMax[i * 2 + 1]);
+    }
+    if (srcCount & 1) {
+        dstMin[pairs] = srcMin[srcCount - 1];
+        dstMax[pairs] = srcMax[srcCount - 1];
+    }
+}
+
+void WaveformPeaks::Build(const float* samples, size_t frameCount, int channelCount)
+{
+    auto start = std::chrono::steady_clock::now();
+    frames = frameCount;
+    channels = channelCount;
+    levels.clear();
+    if (frameCount == 0 || channelCount <= 0) {
+        return;
+    }
+
+    // Interleaved frames are contiguous: a bucket is one run of baseFrames * channels samples
+    Level base;
+    base.framesPerBucket = baseFrames;
+    const size_t buckets = (frameCount + baseFrames - 1) / baseFrames;
+    base.min.resize(buckets);
+    base.max.resize(buckets);
+    for (size_t b = 0; b < buckets; b++) {
+        size_t first = b * baseFrames;
+        size_t count = std::min<size_t>(baseFrames, frameCount - first) * channelCount;
+        MinMax(samples + first * channelCount, count, base.min[b], base.max[b]);
+    }
+    levels.push_back(std::move(base));
+
+    while (levels.back().min.size() > 1) {
+        const Level& source = levels.back();
+        Level next;
+        next.framesPerBucket = source.framesPerBucket * 2;
+        next.min.resize((source.min.size() + 1) / 2);
+        next.max.resize(next.min.size());
+        MergePairs(source.min.data(), source.max.data(), source.min.size(), next.min.data(), next.max.data());
+        levels.push_back(std::move(next));
+    }
+    buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool WaveformPeaks::Resample(const float* samples, double beginFrame, double endFrame, int columns, float* mins, float* maxs) const
+{
+    if (levels.empty() || columns <= 0 || endFrame <= beginFrame) {
+        return false;
+    }
+    const double framesPerColumn = (endFrame - beginFrame) / columns;
+
+    // Coarsest level with buckets no wider than a column, so each column reads one or two buckets
+    size_t levelIndex = 0;
+    while (levelIndex + 1 < levels.size() && levels[levelIndex + 1].framesPerBucket <= framesPerColumn) {
+        levelIndex++;
+    }
+    const Level& level = levels[levelIndex];
+    const bool useSamples = samples && framesPerColumn < baseFrames;
+
+    for (int c = 0; c < columns; c++) {
+        double from = beginFrame + framesPerColumn * c;
+        double to = from + framesPerColumn;
+        size_t first = (size_t)std::clamp(std::floor(from), 0.0, (double)frames);
+        size_t last = (size_t)std::clamp(std::ceil(to), 0.0, (double)frames);
+        if (last <= first) {
+            if (first >= frames) {
+                mins[c] = maxs[c] = 0.0f;
+                continue;
+            }
+            last = first + 1;
+        }
+        if (useSamples) {
+            MinMax(samples + first * channels, (last - first) * channels, mins[c], maxs[c]);
+            continue;
+        }
+        size_t bucketFirst = first / level.framesPerBucket;
+        size_t bucketLast = std::max(bucketFirst + 1, (last + level.framesPerBucket - 1) / level.framesPerBucket);
+        bucketLast = std::min(bucketLast, level.min.size());
+        float lo = level.min[bucketFirst], hi = level.max[bucketFirst];
+        for (size_t b = bucketFirst + 1; b < bucketLast; b++) {
+            lo = std::min(lo, level.min[b]);
+            hi = std::max(hi, level.max[b]);
+        }
+        mins[c] = lo;
+        maxs[c] = hi;
+    }
+    return true;
+}
+
+size_t WaveformPeaks::GetMemoryBytes() const
+{
+    size_t bytes = 0;
+    for (const Level& level : levels) {
+        bytes += (level.min.size() + level.max.size()) * sizeof(float);
+    }
+    return bytes;
+}
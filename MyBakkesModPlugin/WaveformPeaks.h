@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Min/max envelope of an anthem at power-of-two resolutions, built once when it is decoded.
+// Level 0 has one bucket per 'baseFrames' frames (all channels together), every next level merges pairs of buckets.
+// Drawing a waveform then costs O(columns) at any zoom: each column reads one or two buckets of the coarsest level that still
+// resolves it, or the samples themselves when zoomed in further than level 0.
+struct WaveformPeaks
+{
+    static constexpr uint32_t baseFrames = 64;
+
+    struct Level
+    {
+        uint32_t framesPerBucket = 0;
+        std::vector<float> min;
+        std::vector<float> max;
+    };
+
+    size_t frames = 0;
+    int channels = 0;
+    std::vector<Level> levels;      // Finest first, down to a single bucket
+    double buildMs = 0.0;
+
+    void Build(const float* samples, size_t frameCount, int channelCount);
+
+    // Envelope of frames [beginFrame, endFrame) split into 'columns' equal parts. 'samples' (the ones passed to Build()) is only read when a
+    // column spans fewer than baseFrames frames; with null the level 0 buckets are used instead. Returns false when nothing was built.
+    bool Resample(const float* samples, double beginFrame, double endFrame, int columns, float* mins, float* maxs) const;
+
+    size_t GetMemoryBytes() const;
+};
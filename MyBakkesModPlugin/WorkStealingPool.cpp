@@ -0,0 +1,112 @@
+#include "pch.h"
+#include "WorkStealingPool.h"
+
+#include <algorithm>
+
+// Index of the pool worker running on this thread, -1 on other threads
+static thread_local const WorkStealingPool* currentPool = nullptr;
+static thread_local int currentWorker = -1;
+
+WorkStealingPool::WorkStealingPool(int threads)
+{
+    threads = std::max(1, threads);
+    for (int i = 0; i < threads; i++) {
+        workers.push_back(std::make_unique<Worker>());
+    }
+    for (int i = 0; i < threads; i++) {
+        workers[i]->thread = std::thread([this, i]() { Run(i); });
+    }
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    Wait();
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) {
+        worker->thread.join();
+    }
+}
+
+void WorkStealingPool::Submit(std::function<void()> task)
+{
+    int index = currentPool == this ? currentWorker : (int)(nextQueue++ % workers.size());
+    pending++;
+    {
+        std::lock_guard<std::mutex> lock(workers[index]->mutex);
+        workers[index]->tasks.push_back(std::move(task));
+    }
+    {
+        // Taking the lock orders this notify after a worker's empty check, so the wake-up cannot be missed
+        std::lock_guard<std::mutex> lock(wakeMutex);
+    }
+    wake.notify_one();
+}
+
+void WorkStealingPool::Wait()
+{
+    std::unique_lock<std::mutex> lock(wakeMutex);
+    idle.wait(lock, [this]() { return pending.load() == 0; });
+}
+
+bool WorkStealingPool::TryPop(int index, std::function<void()>& task)
+{
+    {
+        Worker& own = *workers[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    for (size_t offset = 1; offset < workers.size(); offset++) {
+        Worker& victim = *workers[(index + offset) % workers.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            steals++;
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::Run(int index)
+{
+    currentPool = this;
+    currentWorker = index;
+    std::function<void()> task;
+    while (true) {
+        if (TryPop(index, task)) {
+            task();
+            task = nullptr;
+            if (--pending == 0) {
+                std::lock_guard<std::mutex> lock(wakeMutex);
+                idle.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        if (stopping) {
+            return;
+        }
+        // Tasks live in the per-worker deques, so re-check them under the lock before sleeping
+        bool anyQueued = false;
+        for (auto& worker : workers) {
+            std::lock_guard<std::mutex> queueLock(worker->mutex);
+            if (!worker->tasks.empty()) {
+                anyQueued = true;
+                break;
+            }
+        }
+        if (!anyQueued) {
+            wake.wait(lock);
+        }
+    }
+}
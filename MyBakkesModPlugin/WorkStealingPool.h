@@ -0,0 +1,51 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size thread pool for recursive, unevenly sized work (e.g. walking a directory tree).
+// Every worker owns a deque: tasks submitted from a worker go to the back of its own deque and it pops from the back (depth first,
+// cache warm), idle workers steal from the front of the others (the oldest, usually largest, subtrees).
+class WorkStealingPool
+{
+public:
+    explicit WorkStealingPool(int threads);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    // Callable from any thread, including from inside a task
+    void Submit(std::function<void()> task);
+
+    // Blocks until every submitted task, and every task those submitted, has finished
+    void Wait();
+
+    int GetThreadCount() const { return (int)workers.size(); }
+    uint64_t GetStealCount() const { return steals.load(); }
+
+private:
+    struct Worker
+    {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+        std::thread thread;
+    };
+
+    void Run(int index);
+    bool TryPop(int index, std::function<void()>& task);
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<int> pending{ 0 };      // Submitted and not finished
+    std::atomic<unsigned int> nextQueue{ 0 };
+    std::atomic<uint64_t> steals{ 0 };
+    std::atomic<bool> stopping{ false };
+    std::mutex wakeMutex;
+    std::condition_variable wake;       // Workers: new task or stopping
+    std::condition_variable idle;       // Wait(): pending reached 0
+};
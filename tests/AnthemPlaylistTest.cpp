@@ -0,0 +1,166 @@
+#include "Check.h"
+#include "AnthemPlaylist.h"
+
+#include <cmath>
+
+namespace
+{
+    std::filesystem::path TestFile(const char* name)
+    {
+        const std::filesystem::path folder = std::filesystem::temp_directory_path() / "AnthemPlaylistTest";
+        std::filesystem::remove_all(folder / name);
+        return folder / name;
+    }
+
+    AnthemPlaylist MakePlaylist(const char* name, const std::vector<float>& weights)
+    {
+        AnthemPlaylist playlist(TestFile(name));
+        for (size_t i = 0; i < weights.size(); i++) {
+            PlaylistEntry entry;
+            entry.path = "anthem" + std::to_string(i) + ".wav";
+            entry.weight = weights[i];
+            playlist.Add(entry);
+        }
+        return playlist;
+    }
+
+    // Sample() over an even grid of 'u' lands on each index in exact proportion to its weight
+    void AliasTableMatchesTheWeights()
+    {
+        const std::vector<float> weights = { 1.0f, 2.0f, 0.0f, 5.0f, 0.5f, 3.5f };
+        AliasTable table;
+        table.Build(weights);
+        CHECK(table.GetSize() == 6);
+
+        const int samples = 12000;
+        std::vector<int> counts(weights.size(), 0);
+        for (int i = 0; i < samples; i++) {
+            counts[table.Sample((i + 0.5) / samples)]++;
+        }
+        for (size_t i = 0; i < weights.size(); i++) {
+            const double expected = samples * weights[i] / 12.0;
+            CHECK(std::fabs(counts[i] - expected) <= 2.0);
+        }
+        CHECK(counts[2] == 0);
+
+        // All zero: uniform
+        table.Build({ 0.0f, 0.0f, -1.0f, 0.0f });
+        std::vector<int> uniform(4, 0);
+        for (int i = 0; i < 4000; i++) {
+            uniform[table.Sample((i + 0.5) / 4000)]++;
+        }
+        CHECK(uniform[0] == 1000 && uniform[1] == 1000 && uniform[2] == 1000 && uniform[3] == 1000);
+
+        table.Build({});
+        CHECK(table.GetSize() == 0);
+    }
+
+    void WeightedPicksFollowTheWeights()
+    {
+        AnthemPlaylist playlist = MakePlaylist("weighted.txt", { 1.0f, 3.0f, 0.0f, 4.0f });
+        const int picks = 80000;
+        std::vector<int> counts(4, 0);
+        for (int i = 0; i < picks; i++) {
+            const int index = playlist.Next();
+            CHECK(index >= 0 && index < 4);
+            if (index >= 0 && index < 4) {
+                counts[index]++;
+            }
+        }
+        CHECK(counts[2] == 0);
+        // Expected 10000, 30000 and 40000, with a standard deviation under 150
+        CHECK(std::abs(counts[0] - 10000) < 1000);
+        CHECK(std::abs(counts[1] - 30000) < 1000);
+        CHECK(std::abs(counts[3] - 40000) < 1000);
+
+        // A weight set to 0 is never picked again
+        playlist.SetWeight(3, 0.0f);
+        for (int i = 0; i < 10000; i++) {
+            const int index = playlist.Next();
+            CHECK(index == 0 || index == 1);
+        }
+        CHECK(AnthemPlaylist(TestFile("empty.txt")).Next() == -1);
+    }
+
+    void RoundRobinKeepsListOrder()
+    {
+        AnthemPlaylist playlist = MakePlaylist("roundrobin.txt", { 1.0f, 0.0f, 5.0f, 1.0f });
+        playlist.SetMode(PlaylistMode::RoundRobin);
+        CHECK(playlist.Next() == 0);
+        CHECK(playlist.Next() == 1);    // Weights ignored
+        CHECK(playlist.Next() == 2);
+
+        // Removing an entry already played keeps the next one in order
+        playlist.Remove(0);
+        CHECK(playlist.Next() == 2);
+        CHECK(playlist.Next() == 0);
+    }
+
+    void NoRepeatSkipsTheLastPicks()
+    {
+        AnthemPlaylist playlist = MakePlaylist("norepeat.txt", { 1.0f, 1.0f, 20.0f, 1.0f, 0.0f });
+        playlist.SetMode(PlaylistMode::NoRepeat);
+        playlist.SetNoRepeatCount(2);
+        std::vector<int> history;
+        for (int i = 0; i < 5000; i++) {
+            const int index = playlist.Next();
+            CHECK(index >= 0 && index < 4);     // Never the entry that weighs 0
+            const size_t n = history.size();
+            CHECK(n < 1 || history[n - 1] != index);
+            CHECK(n < 2 || history[n - 2] != index);
+            history.push_back(index);
+        }
+
+        // Limited to the playlist size - 1: two entries alternate
+        AnthemPlaylist pair = MakePlaylist("pair.txt", { 1.0f, 9.0f });
+        pair.SetMode(PlaylistMode::NoRepeat);
+        pair.SetNoRepeatCount(5);
+        int last = pair.Next();
+        for (int i = 0; i < 100; i++) {
+            const int index = pair.Next();
+            CHECK(index == 1 - last);
+            last = index;
+        }
+    }
+
+    void LoadsWhatItSaved()
+    {
+        const std::filesystem::path path = TestFile("saved.txt");
+        {
+            AnthemPlaylist playlist(path);
+            PlaylistEntry entry;
+            entry.path = "C:/Anthems/goal horn.wav";
+            entry.weight = 2.5f;
+            entry.trimStart = 1.25f;
+            entry.trimEnd = 8.0f;
+            CHECK(playlist.Add(entry));
+            CHECK(!playlist.Add(entry));
+            entry.path = "D:/ot.flac";
+            entry.weight = 0.0f;
+            CHECK(playlist.Add(entry));
+            CHECK(playlist.Save());
+        }
+        AnthemPlaylist playlist(path);
+        CHECK(playlist.Load());
+        const auto& entries = playlist.GetEntries();
+        CHECK(entries.size() == 2);
+        if (entries.size() == 2) {
+            CHECK(entries[0].path == "C:/Anthems/goal horn.wav");
+            CHECK(entries[0].weight == 2.5f && entries[0].trimStart == 1.25f && entries[0].trimEnd == 8.0f);
+            CHECK(entries[1].path == "D:/ot.flac" && entries[1].weight == 0.0f);
+        }
+        for (int i = 0; i < 1000; i++) {
+            CHECK(playlist.Next() == 0);
+        }
+    }
+}
+
+int main()
+{
+    AliasTableMatchesTheWeights();
+    WeightedPicksFollowTheWeights();
+    RoundRobinKeepsListOrder();
+    NoRepeatSkipsTheLastPicks();
+    LoadsWhatItSaved();
+    return CheckResult();
+}
@@ -0,0 +1,105 @@
+#include "Check.h"
+#include "AnthemRules.h"
+
+namespace
+{
+    const std::filesystem::path folder = std::filesystem::path("anthems");
+
+    GoalFacts Goal(int scorerGoals, int teamScore, int opponentScore, int secondsRemaining, bool overtime = false)
+    {
+        GoalFacts facts;
+        facts.scorerGoals = scorerGoals;
+        facts.teamScore = teamScore;
+        facts.opponentScore = opponentScore;
+        facts.secondsRemaining = secondsRemaining;
+        facts.overtime = overtime;
+        return facts;
+    }
+
+    void PicksTheFirstMatchingRule()
+    {
+        AnthemRules rules;
+        std::vector<std::string> errors;
+        rules.Compile(
+            "# Most specific first\n"
+            "overtime && winner = ot.wav\n"
+            "hattrick = hat trick.flac\n"
+            "goals>=5 && !overtime = five.wav\n"
+            "equalizer && seconds<=30 = late equalizer.ogg\n"
+            "margin==2 = two.wav\n"
+            "\r\n"
+            "default = any.wav\r\n",
+            folder, errors);
+        CHECK(errors.empty());
+        CHECK(rules.GetRules().size() == 6);
+        CHECK(rules.GetConditionCount() == 8);
+
+        CHECK(rules.Evaluate(Goal(1, 3, 2, 0, true)) == 0);
+        CHECK(rules.Evaluate(Goal(3, 3, 2, 0, true)) == 0);     // Overtime winner before hat trick
+        CHECK(rules.Evaluate(Goal(3, 3, 1, 100)) == 1);
+        CHECK(rules.Evaluate(Goal(5, 6, 1, 100)) == 2);
+        CHECK(rules.Evaluate(Goal(1, 2, 2, 30)) == 3);
+        CHECK(rules.Evaluate(Goal(1, 2, 2, 31)) == 5);
+        CHECK(rules.Evaluate(Goal(1, 3, 1, 100)) == 4);
+        CHECK(rules.Evaluate(Goal(1, 1, 0, 200)) == 5);
+        CHECK(rules.GetRules()[1].path == PathToUtf8(folder / "hat trick.flac"));
+        CHECK(rules.Uses(PathToUtf8(folder / "five.wav")));
+    }
+
+    void NoRuleMatches()
+    {
+        AnthemRules rules;
+        std::vector<std::string> errors;
+        CHECK(rules.Evaluate(Goal(1, 1, 0, 100)) == -1);
+        rules.Compile("winner = winner.wav\n", folder, errors);
+        CHECK(rules.Evaluate(Goal(1, 1, 0, 100)) == -1);
+        CHECK(rules.Evaluate(Goal(1, 1, 0, 0)) == 0);
+        CHECK(rules.Evaluate(Goal(1, 1, 1, 0)) == -1);          // No lead when time ran out
+    }
+
+    void ReportsBadLines()
+    {
+        AnthemRules rules;
+        std::vector<std::string> errors;
+        rules.Compile(
+            "overtime\n"                    // No anthem
+            "hattrick =   \n"
+            "goals>5 = a.wav\n"             // Only >=, <= and == compare
+            "!goals>=2 = b.wav\n"
+            "overtime>=1 = c.wav\n"
+            "penalty = d.wav\n"
+            "goals==2 = two.wav\n",
+            folder, errors);
+        CHECK(errors.size() == 6);
+        CHECK(rules.GetRules().size() == 1);
+        CHECK(rules.GetRules().size() == 1 && rules.GetRules()[0].line == 7);
+        CHECK(rules.Evaluate(Goal(2, 2, 0, 100)) == 0);
+    }
+
+    void LimitsTheDistinctConditions()
+    {
+        AnthemRules rules;
+        std::vector<std::string> errors;
+        std::string text;
+        for (int i = 1; i <= AnthemRules::maxConditions; i++) {
+            text += "goals==" + std::to_string(i) + " = " + std::to_string(i) + ".wav\n";
+        }
+        text += "seconds<=10 && goals==1 = over.wav\n";
+        text += "goals==3 && overtime = shared.wav\n";    // Over the limit too, even though goals==3 is known
+        text += "goals==12 && !overtime = last.wav\n";
+        rules.Compile(text, folder, errors);
+        CHECK(errors.size() == 3);
+        CHECK(rules.GetConditionCount() == AnthemRules::maxConditions);
+        CHECK((int)rules.GetRules().size() == AnthemRules::maxConditions);
+        CHECK(rules.Evaluate(Goal(12, 12, 0, 100)) == 11);
+    }
+}
+
+int main()
+{
+    PicksTheFirstMatchingRule();
+    NoRuleMatches();
+    ReportsBadLines();
+    LimitsTheDistinctConditions();
+    return CheckResult();
+}
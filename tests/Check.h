@@ -0,0 +1,26 @@
+#pragma once
+#include <cstdio>
+
+// Each test is its own executable run by CTest: a failed CHECK prints where it failed and makes main() return 1
+inline int& CheckFailures()
+{
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            std::printf("%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #condition); \
+            CheckFailures()++; \
+        } \
+    } while (0)
+
+inline int CheckResult()
+{
+    if (CheckFailures() > 0) {
+        std::printf("%d check(s) failed\n", CheckFailures());
+        return 1;
+    }
+    return 0;
+}
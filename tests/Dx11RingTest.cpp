@@ -0,0 +1,148 @@
+#include "Check.h"
+#include "IMGUI/imgui_impl_dx11_ring.h"
+
+#include <random>
+#include <vector>
+
+namespace
+{
+    // Stands in for the ID3D11Buffer and the device: counts creations and checks each mapped write the way a driver would see it
+    struct FakeBuffer
+    {
+        int capacity = 0;
+        int creates = 0;
+        bool failCreate = false;
+        int discards = 0;
+        int appends = 0;
+        int written = 0;            // Elements written since the last WRITE_DISCARD, which the GPU may still read
+        bool overwrote = false;     // A NO_OVERWRITE write touched one of them
+        bool overflowed = false;    // A write went past the end of the buffer
+
+        static bool Create(int newCapacity, void* userData)
+        {
+            FakeBuffer* buffer = (FakeBuffer*)userData;
+            if (buffer->failCreate) {
+                return false;
+            }
+            buffer->capacity = newCapacity;
+            buffer->creates++;
+            buffer->written = 0;
+            return true;
+        }
+
+        // Map with the result's flag, write 'count' elements at 'offset', unmap
+        void Write(ImGui_ImplDX11_RingResult result, int offset, int count)
+        {
+            if (ImGui_ImplDX11_RingNeedsDiscard(result)) {
+                discards++;
+                written = 0;    // Fresh memory from the driver
+            }
+            else {
+                appends++;
+                overwrote |= offset < written;
+            }
+            overflowed |= offset + count > capacity;
+            written = offset + count;
+        }
+    };
+
+    // One frame through the ring, as ImGui_ImplDX11_RenderDrawData() does it
+    ImGui_ImplDX11_RingResult Frame(ImGui_ImplDX11_Ring& ring, FakeBuffer& buffer, int count)
+    {
+        const ImGui_ImplDX11_RingResult result = ImGui_ImplDX11_RingReserve(&ring, count, FakeBuffer::Create, &buffer);
+        if (result != ImGui_ImplDX11_RingResult_Failed) {
+            buffer.Write(result, ring.Head, count);
+            ImGui_ImplDX11_RingCommit(&ring, count);
+        }
+        return result;
+    }
+
+    void AppendsUntilTheRingWraps()
+    {
+        ImGui_ImplDX11_Ring ring(5000);
+        FakeBuffer buffer;
+        CHECK(Frame(ring, buffer, 1000) == ImGui_ImplDX11_RingResult_Created);
+        CHECK(buffer.capacity == 5000 && ring.Capacity == 5000);
+        for (int i = 1; i < 5; i++) {
+            CHECK(Frame(ring, buffer, 1000) == ImGui_ImplDX11_RingResult_Appended);
+            CHECK(ring.Head == (i + 1) * 1000);
+        }
+        // Full: the next frame starts over at 0 with fresh memory
+        CHECK(Frame(ring, buffer, 1) == ImGui_ImplDX11_RingResult_Wrapped);
+        CHECK(ring.Head == 1);
+        CHECK(buffer.creates == 1);
+        CHECK(buffer.discards == 2 && buffer.appends == 4);
+        CHECK(!buffer.overwrote && !buffer.overflowed);
+    }
+
+    void GrowsToTwiceTheFrame()
+    {
+        ImGui_ImplDX11_Ring ring(5000);
+        FakeBuffer buffer;
+        Frame(ring, buffer, 100);
+        Frame(ring, buffer, 100);
+        // Doubled from the current capacity until two such frames fit
+        CHECK(Frame(ring, buffer, 6000) == ImGui_ImplDX11_RingResult_Created);
+        CHECK(ring.Capacity == 20000 && buffer.capacity == 20000);
+        CHECK(ring.Head == 6000);
+        CHECK(Frame(ring, buffer, 6000) == ImGui_ImplDX11_RingResult_Appended);
+        CHECK(Frame(ring, buffer, 10000) == ImGui_ImplDX11_RingResult_Wrapped);
+        CHECK(buffer.creates == 2);
+
+        // No initial size: from 1
+        ImGui_ImplDX11_Ring empty(0);
+        FakeBuffer other;
+        CHECK(Frame(empty, other, 3) == ImGui_ImplDX11_RingResult_Created);
+        CHECK(empty.Capacity == 8);
+        CHECK(!buffer.overwrote && !buffer.overflowed && !other.overflowed);
+    }
+
+    void RetriesAFailedCreate()
+    {
+        ImGui_ImplDX11_Ring ring(5000);
+        FakeBuffer buffer;
+        buffer.failCreate = true;
+        CHECK(Frame(ring, buffer, 100) == ImGui_ImplDX11_RingResult_Failed);
+        CHECK(!ring.HasBuffer);
+        CHECK(ring.Capacity == 5000);
+        buffer.failCreate = false;
+        CHECK(Frame(ring, buffer, 100) == ImGui_ImplDX11_RingResult_Created);
+
+        // Device objects invalidated: created again at the size reached, from 0
+        Frame(ring, buffer, 3000);
+        ImGui_ImplDX11_RingReset(&ring);
+        CHECK(ring.Head == 0);
+        CHECK(Frame(ring, buffer, 100) == ImGui_ImplDX11_RingResult_Created);
+        CHECK(ring.Capacity == 5000 && buffer.creates == 2);
+    }
+
+    // Frames of random sizes, some larger than the buffer: every write fits, and NO_OVERWRITE never touches what the GPU may read
+    void RandomFramesNeverOverwrite()
+    {
+        ImGui_ImplDX11_Ring ring(5000);
+        FakeBuffer buffer;
+        std::mt19937 rng(1234);
+        std::uniform_int_distribution<int> small(0, 2500);
+        int wraps = 0;
+        for (int i = 0; i < 10000; i++) {
+            const int count = i % 997 == 0 ? 3000 * (1 + i / 997) : small(rng);
+            const ImGui_ImplDX11_RingResult result = Frame(ring, buffer, count);
+            CHECK(result != ImGui_ImplDX11_RingResult_Failed);
+            CHECK(ring.Capacity >= count && ring.Head <= ring.Capacity);
+            wraps += result == ImGui_ImplDX11_RingResult_Wrapped ? 1 : 0;
+        }
+        CHECK(!buffer.overwrote);
+        CHECK(!buffer.overflowed);
+        CHECK(wraps > 0);
+        CHECK(buffer.creates < 10);     // Geometric growth: a handful of reallocations, not one per large frame
+    }
+}
+
+int main()
+{
+    AppendsUntilTheRingWraps();
+    GrowsToTwiceTheFrame();
+    RetriesAFailedCreate();
+    RandomFramesNeverOverwrite();
+    return CheckResult();
+}
@@ -0,0 +1,68 @@
+#include "Check.h"
+#include "GoalDedup.h"
+
+namespace
+{
+    using std::chrono::milliseconds;
+    using std::chrono::seconds;
+
+    const GoalDedup::Clock::time_point start{};
+    const uint64_t match = GoalDedup::HashMatchId("match-a");
+    const uint64_t other = GoalDedup::HashMatchId("match-b");
+
+    void DropsRepeatsWithinTheWindow()
+    {
+        GoalDedup dedup(10.0);
+        CHECK(dedup.Accept(match, 1, 0, start));
+        CHECK(!dedup.Accept(match, 1, 0, start + milliseconds(1)));
+        CHECK(!dedup.Accept(match, 1, 0, start + seconds(6)));      // Again when the goal replay ends
+        CHECK(dedup.Accept(match, 1, 1, start + seconds(30)));
+        CHECK(dedup.GetAccepted() == 2);
+        CHECK(dedup.GetDropped() == 2);
+    }
+
+    void AcceptsTheSameScoreAfterTheWindow()
+    {
+        GoalDedup dedup(10.0);
+        CHECK(dedup.Accept(match, 1, 0, start));
+        CHECK(dedup.Accept(match, 1, 0, start + seconds(12)));      // A rewatched replay plays its anthem again
+
+        // Freeplay: the score may not change between goals
+        dedup.SetWindow(0.5);
+        CHECK(dedup.Accept(match, 0, 0, start + seconds(20)));
+        CHECK(!dedup.Accept(match, 0, 0, start + seconds(20) + milliseconds(100)));
+        CHECK(dedup.Accept(match, 0, 0, start + seconds(21)));
+    }
+
+    void KeysGoalsByMatch()
+    {
+        GoalDedup dedup;
+        CHECK(match != other);
+        CHECK(dedup.Accept(match, 1, 0, start));
+        CHECK(dedup.Accept(other, 1, 0, start + milliseconds(10)));
+        CHECK(!dedup.Accept(other, 1, 0, start + milliseconds(20)));
+    }
+
+    void ForgetsGoalsPastTheRing()
+    {
+        GoalDedup dedup;
+        for (int i = 0; i < (int)GoalDedup::capacity + 1; i++) {
+            CHECK(dedup.Accept(match, i + 1, 0, start + milliseconds(i * 100)));
+        }
+        // The first goal was overwritten, the last 'capacity' are still remembered
+        CHECK(dedup.Accept(match, 1, 0, start + seconds(2)));
+        CHECK(!dedup.Accept(match, (int)GoalDedup::capacity + 1, 0, start + seconds(2)));
+
+        dedup.Clear();
+        CHECK(dedup.Accept(match, (int)GoalDedup::capacity + 1, 0, start + seconds(2)));
+    }
+}
+
+int main()
+{
+    DropsRepeatsWithinTheWindow();
+    AcceptsTheSameScoreAfterTheWindow();
+    KeysGoalsByMatch();
+    ForgetsGoalsPastTheRing();
+    return CheckResult();
+}
@@ -0,0 +1,56 @@
+#include "Check.h"
+#include "MatchState.h"
+
+namespace
+{
+    void CountsGoalsByPlayer()
+    {
+        MatchState state;
+        CHECK(state.SetMatch("match-a"));
+        CHECK(!state.SetMatch("match-a"));
+        const uint64_t revision = state.GetRevision();
+        CHECK(state.AddGoal("steam|1", "Alice", 0) == 1);
+        CHECK(state.AddGoal("epic|2", "Bob", 1) == 1);
+        CHECK(state.AddGoal("steam|1", "Alice", 0) == 2);
+        CHECK(state.GetGoals("steam|1") == 2);
+        CHECK(state.GetGoals("steam|3") == 0);
+        CHECK(state.GetTotalGoals() == 3);
+        CHECK(state.GetRevision() == revision + 3);
+
+        // Another match starts over
+        CHECK(state.SetMatch("match-b"));
+        CHECK(state.GetGoals("steam|1") == 0);
+        CHECK(state.GetTotalGoals() == 0);
+        CHECK(state.GetMatchId() == "match-b");
+    }
+
+    void TellsTheScorerByReportedGoals()
+    {
+        MatchState state;
+        state.SetMatch("match-a");
+        state.SetReportedGoals("steam|1", "Alice", 0, 2);     // Read at the kickoff
+        state.SetReportedGoals("epic|2", "Bob", 1, 0);
+        const uint64_t revision = state.GetRevision();
+        CHECK(state.GetReportedGoals("steam|1") == 2);
+        CHECK(state.GetReportedGoals("steam|3") == 0);        // Joined since: every goal of theirs is new
+        CHECK(state.GetGoals("steam|1") == 0);
+        CHECK(state.GetRevision() == revision);
+
+        // The counted goals and the game's own count are kept apart
+        CHECK(state.AddGoal("steam|1", "Alice", 0) == 1);
+        state.SetReportedGoals("steam|1", "Alice", 0, 3);
+        CHECK(state.GetGoals("steam|1") == 1);
+        CHECK(state.GetReportedGoals("steam|1") == 3);
+
+        state.Reset();
+        CHECK(state.GetReportedGoals("steam|1") == 0);
+        CHECK(state.GetMatchId().empty());
+    }
+}
+
+int main()
+{
+    CountsGoalsByPlayer();
+    TellsTheScorerByReportedGoals();
+    return CheckResult();
+}
@@ -0,0 +1,90 @@
+#include "Check.h"
+#include "PeakLimiter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+    const uint32_t rate = 48000;
+    const double pi = 3.14159265358979323846;
+
+    // A 'hz' stereo sine whose amplitude goes linearly from 'startAmplitude' to 'endAmplitude'
+    std::vector<float> Sine(double hz, double seconds, double startAmplitude, double endAmplitude)
+    {
+        const int frames = (int)(seconds * rate);
+        std::vector<float> samples((size_t)frames * 2);
+        for (int i = 0; i < frames; i++) {
+            const double amplitude = startAmplitude + (endAmplitude - startAmplitude) * i / frames;
+            const float value = (float)(amplitude * std::sin(2.0 * pi * hz * i / rate));
+            samples[i * 2] = value;
+            samples[i * 2 + 1] = -value;
+        }
+        return samples;
+    }
+
+    // Runs 'samples' through a limiter in blocks of 'block' frames; returns how many output samples exceed the ceiling
+    int CountOverCeiling(std::vector<float> samples, float ceilingDb, float releaseMs, int block, float& peak)
+    {
+        PeakLimiter limiter;
+        limiter.Prepare(rate);
+        limiter.SetParameters(ceilingDb, releaseMs);
+        const float ceiling = std::pow(10.0f, ceilingDb / 20.0f) * 1.00001f;
+        const int frames = (int)samples.size() / 2;
+        int over = 0;
+        peak = 0.0f;
+        for (int start = 0; start < frames; start += block) {
+            const int count = std::min(block, frames - start);
+            limiter.Process(samples.data() + (size_t)start * 2, count);
+            for (int i = start * 2; i < (start + count) * 2; i++) {
+                peak = std::max(peak, std::fabs(samples[i]));
+                over += std::fabs(samples[i]) > ceiling ? 1 : 0;
+            }
+        }
+        return over;
+    }
+
+    void SustainedLoudSine()
+    {
+        // Every frame of the window lowers the held gain further: the deque stays full for the whole run
+        float peak = 0.0f;
+        CHECK(CountOverCeiling(Sine(20.0, 2.0, 4.0, 4.0), -1.0f, 10.0f, 480, peak) == 0);
+        CHECK(peak > 0.8f);
+    }
+
+    void RisingPeaks()
+    {
+        const int blocks[] = { 1, 64, 480, 1000 };
+        for (int block : blocks) {
+            float peak = 0.0f;
+            CHECK(CountOverCeiling(Sine(20.0, 3.0, 0.5, 8.0), -1.0f, 10.0f, block, peak) == 0);
+            CHECK(CountOverCeiling(Sine(440.0, 3.0, 0.5, 8.0), -3.0f, 100.0f, block, peak) == 0);
+        }
+    }
+
+    void QuietSignalPassesThrough()
+    {
+        std::vector<float> input = Sine(440.0, 0.5, 0.5, 0.5);
+        std::vector<float> output = input;
+        PeakLimiter limiter;
+        limiter.Prepare(rate);
+        limiter.SetParameters(-1.0f, 100.0f);
+        limiter.Process(output.data(), (int)output.size() / 2);
+        const int latency = limiter.GetLatencyFrames();
+        float maxError = 0.0f;
+        for (size_t i = (size_t)latency * 2; i < output.size(); i++) {
+            maxError = std::max(maxError, std::fabs(output[i] - input[i - (size_t)latency * 2]));
+        }
+        CHECK(maxError < 1e-6f);
+        CHECK(limiter.GetLastMinGain() == 1.0f);
+    }
+}
+
+int main()
+{
+    SustainedLoudSine();
+    RisingPeaks();
+    QuietSignalPassesThrough();
+    return CheckResult();
+}
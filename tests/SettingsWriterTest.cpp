@@ -0,0 +1,164 @@
+#include "Check.h"
+#include "SettingsWriter.h"
+
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+    using Clock = SettingsWriter::Clock;
+    using std::chrono::milliseconds;
+    using std::chrono::seconds;
+
+    const Clock::time_point start{};
+
+    std::filesystem::path TestFolder(const char* name)
+    {
+        std::filesystem::path folder = std::filesystem::temp_directory_path() / "SettingsWriterTest" / name;
+        std::filesystem::remove_all(folder);
+        return folder;
+    }
+
+    std::string ReadFile(const std::filesystem::path& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        std::stringstream text;
+        text << file.rdbuf();
+        return text.str();
+    }
+
+    void CoalescesUntilIdle()
+    {
+        const std::filesystem::path path = TestFolder("coalesce") / "settings.cfg";
+        SettingsWriter writer(path, 0.5, 5.0);
+        for (int i = 0; i <= 20; i++) {
+            CHECK(writer.Set("helloworld_duck_depth", std::to_string(-i), start + milliseconds(i * 16)));
+            CHECK(!writer.Update(start + milliseconds(i * 16)));
+        }
+        CHECK(writer.Set("helloworld_enabled", "0", start + milliseconds(400)));
+        CHECK(!writer.Update(start + milliseconds(800)));
+        CHECK(writer.Update(start + milliseconds(900)));
+        CHECK(!writer.HasPending());
+        CHECK(ReadFile(path) == "helloworld_duck_depth \"-20\"\nhelloworld_enabled \"0\"\n");
+        CHECK(!std::filesystem::exists(path.string() + ".tmp"));
+
+        const SettingsWriterStats stats = writer.GetStats(start + seconds(1));
+        CHECK(stats.writes == 1);
+        CHECK(stats.changes == 22);
+        CHECK(stats.coalesced == 20);
+        CHECK(stats.writesLastMinute == 1);
+    }
+
+    void WritesAfterMaxDelayWhileChanging()
+    {
+        SettingsWriter writer(TestFolder("drag") / "settings.cfg", 0.5, 5.0);
+        int firstWrite = -1;
+        for (int i = 0; i < 100 && firstWrite < 0; i++) {
+            const Clock::time_point now = start + milliseconds(i * 100);
+            writer.Set("helloworld_stream_seconds", std::to_string(i), now);
+            if (writer.Update(now)) {
+                firstWrite = i;
+            }
+        }
+        CHECK(firstWrite == 50);
+    }
+
+    void RevertedChangeClosesTheBatch()
+    {
+        SettingsWriter writer(TestFolder("revert") / "settings.cfg", 0.5, 5.0);
+        writer.Set("helloworld_enabled", "1", start);
+        CHECK(writer.Flush(start));
+        CHECK(writer.Set("helloworld_enabled", "0", start + seconds(1)));
+        CHECK(!writer.Set("helloworld_enabled", "1", start + seconds(2)));
+        CHECK(!writer.HasPending());
+        CHECK(writer.SecondsUntilDue(start + seconds(2)) < 0.0);
+
+        // A change long after the reverted one still waits for the idle time
+        const Clock::time_point later = start + seconds(600);
+        CHECK(writer.Set("helloworld_normalize", "0", later));
+        CHECK(!writer.Update(later + milliseconds(100)));
+        CHECK(writer.SecondsUntilDue(later) > 0.4);
+        CHECK(writer.Update(later + milliseconds(500)));
+    }
+
+    void CapsWritesPerMinute()
+    {
+        SettingsWriter writer(TestFolder("cap") / "settings.cfg", 0.5, 5.0);
+        int writes = 0;
+        for (int i = 0; i < 20; i++) {
+            const Clock::time_point now = start + seconds(i);
+            writer.Set("helloworld_playlist_norepeat", std::to_string(i), now);
+            writes += writer.Update(now + milliseconds(600)) ? 1 : 0;
+        }
+        CHECK(writes == SettingsWriter::maxWritesPerMinute);
+        CHECK(writer.HasPending());
+        const SettingsWriterStats stats = writer.GetStats(start + seconds(20));
+        CHECK(stats.throttled == 1);
+        CHECK(stats.writesLastMinute == SettingsWriter::maxWritesPerMinute);
+
+        // The batch waits for the first write to leave the minute
+        CHECK(writer.SecondsUntilDue(start + seconds(20)) > 40.0);
+        CHECK(!writer.Update(start + seconds(60)));
+        CHECK(writer.Update(start + milliseconds(60600)));
+    }
+
+    void FailedWriteKeepsTheChanges()
+    {
+        // A folder where the file should be: the temporary file is written, the rename over it fails
+        const std::filesystem::path path = TestFolder("failed") / "settings.cfg";
+        std::filesystem::create_directories(path);
+        std::ofstream(path / "keep").put('x');
+        SettingsWriter writer(path, 0.5, 5.0);
+        CHECK(writer.Set("helloworld_enabled", "0", start));
+        CHECK(!writer.Flush(start));
+        CHECK(writer.HasPending());
+        CHECK(!std::filesystem::exists(path.string() + ".tmp"));
+        CHECK(std::filesystem::exists(path / "keep"));
+        SettingsWriterStats stats = writer.GetStats(start);
+        CHECK(stats.failed == 1);
+        CHECK(stats.writes == 0);
+
+        // The temporary file cannot be created either
+        std::filesystem::remove_all(path);
+        std::filesystem::create_directories(path.string() + ".tmp");
+        CHECK(!writer.Flush(start + seconds(1)));
+        CHECK(writer.GetStats(start + seconds(1)).failed == 2);
+        CHECK(!std::filesystem::exists(path));
+
+        // Retried once the path is usable again
+        std::filesystem::remove_all(path.string() + ".tmp");
+        CHECK(writer.Flush(start + seconds(2)));
+        CHECK(!writer.HasPending());
+        CHECK(ReadFile(path) == "helloworld_enabled \"0\"\n");
+    }
+
+    void LoadsWhatItWrote()
+    {
+        const std::filesystem::path path = TestFolder("load") / "settings.cfg";
+        {
+            SettingsWriter writer(path);
+            writer.Set("helloworld_library_folders", "C:/Anthems;D:/More Anthems", start);
+            writer.Set("helloworld_keybind", "F3", start);
+            CHECK(writer.Flush(start));
+        }
+        SettingsWriter writer(path);
+        const auto loaded = writer.Load();
+        CHECK(loaded.size() == 2);
+        CHECK(loaded.size() == 2 && loaded[0].first == "helloworld_keybind" && loaded[0].second == "F3");
+        CHECK(loaded.size() == 2 && loaded[1].second == "C:/Anthems;D:/More Anthems");
+        // Values the file already holds are not written again
+        CHECK(!writer.Set("helloworld_keybind", "F3", start));
+        CHECK(!writer.HasPending());
+    }
+}
+
+int main()
+{
+    CoalescesUntilIdle();
+    WritesAfterMaxDelayWhileChanging();
+    RevertedChangeClosesTheBatch();
+    CapsWritesPerMinute();
+    FailedWriteKeepsTheChanges();
+    LoadsWhatItWrote();
+    return CheckResult();
+}
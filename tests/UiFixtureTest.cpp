@@ -0,0 +1,41 @@
+#include "Check.h"
+#include "UiBenchmark.h"
+
+namespace
+{
+    // Framebuffer hash of DrawUiBenchmarkFixture() with the default UiBenchmarkOptions size. When the fixture or the rasterizer changes
+    // on purpose, check the new bench_fixture.tga written by helloworld_bench_ui and update the value.
+    const unsigned int goldenFixtureHash = 0x44cf15bd;
+
+    UiBenchmarkResult RenderFixture(int threads)
+    {
+        UiBenchmarkOptions options;
+        options.frames = 3;
+        options.threads = threads;
+        return RunUiBenchmark(DrawUiBenchmarkFixture, options);
+    }
+
+    void FixtureMatchesTheGolden()
+    {
+        const UiBenchmarkResult result = RenderFixture(1);
+        CHECK(result.frames == 3);
+        CHECK(result.triangles > 0);
+        if (result.framebufferHash != goldenFixtureHash) {
+            std::printf("fixture framebuffer hash: %08x\n", result.framebufferHash);
+        }
+        CHECK(result.framebufferHash == goldenFixtureHash);
+    }
+
+    // The bands are rasterized in parallel, the image must not depend on it
+    void ThreadsDoNotChangeTheImage()
+    {
+        CHECK(RenderFixture(4).framebufferHash == goldenFixtureHash);
+    }
+}
+
+int main()
+{
+    FixtureMatchesTheGolden();
+    ThreadsDoNotChangeTheImage();
+    return CheckResult();
+}
@@ -0,0 +1,3 @@
+#pragma once
+// Stands in for the BakkesMod SDK header that pch.h includes: the modules under test do not use the SDK
+#include "bakkesmod/wrappers/cvarmanagerwrapper.h"
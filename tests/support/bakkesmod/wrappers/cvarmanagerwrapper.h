@@ -0,0 +1,10 @@
+#pragma once
+#include <string>
+
+// The part of the SDK console that logging.h uses
+class CVarManagerWrapper
+{
+public:
+    void log(std::string) {}
+    void log(std::wstring) {}
+};